@@ -19,6 +19,7 @@
 #define MACE_PUBLIC_MACE_H_
 
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -176,6 +177,30 @@ class RunMetadata {
   std::vector<OperatorStats> op_stats;
 };
 
+struct MemoryStats {
+  // bytes held now
+  int64_t current_bytes;
+  // the most bytes held at once since the engine was created
+  int64_t peak_bytes;
+};
+
+struct MemoryUsage {
+  // weight tensors of the model, in the model data or copied into private
+  // buffers (then also counted by private_buffers)
+  MemoryStats weights;
+  // buffers of single tensors: copied or transformed weights, folded
+  // constants, and outputs grown beyond their planned buffers
+  MemoryStats private_buffers;
+  // buffers shared by the intermediate tensors
+  MemoryStats activations;
+  // temporary buffers of the operators, e.g. Winograd transforms, GEMM
+  // packing and padding
+  MemoryStats scratch;
+  // all the buffers of the runtimes and the model data file mapped by the
+  // engine, the peak is summed over the memory managers of the runtimes
+  MemoryStats total;
+};
+
 /// Consistent with Android NNAPI
 struct PerformanceInfo {
   // Time of executing some workload(millisecond).
@@ -223,6 +248,8 @@ class MACE_API MaceStatus {
     MACE_OUT_OF_RESOURCES = 2,
     MACE_UNSUPPORTED = 3,
     MACE_RUNTIME_ERROR = 4,
+    MACE_CANCELLED = 5,
+    MACE_DEADLINE_EXCEEDED = 6,
   };
 
  public:
@@ -450,6 +477,56 @@ class MACE_API MaceEngineConfig {
                          const std::string &binary_file,
                          const std::string &storage_file);
 
+  /// \brief Reuse the results of runs with unchanged inputs
+  ///
+  /// Off by default. When enabled, the engine keeps the inputs and outputs
+  /// of the last max_entries distinct runs, a run whose inputs are equal
+  /// byte for byte to those of one of them, with the same requested outputs,
+  /// copies the kept outputs instead of running the model. For models with
+  /// several inputs, the CPU operators depending only on the inputs which
+  /// did not change since the previous run are skipped as well, at the cost
+  /// of keeping a copy of their outputs and of the inputs.
+  /// Caution: models with operators keeping state across runs (e.g.
+  /// IfDefined or DynamicLSTM) must not enable it.
+  ///
+  /// \param max_entries number of runs kept, 0 disables the cache.
+  /// \return MaceStatus::MACE_SUCCESS for success, other for failure.
+  MaceStatus SetResultCache(int max_entries);
+
+  /// \brief Recompute only what the changed input pixels affect (experimental)
+  ///
+  /// Off by default. Meant for streams of similar inputs such as the frames
+  /// of a video: every run compares the inputs with those of the previous
+  /// run and bounds the changed pixels by a box. CPU float convolutions,
+  /// poolings and element-wise operators recompute only the part of their
+  /// outputs this box reaches, the other operators rerun when one of their
+  /// inputs changed, and the operators whose inputs did not change are
+  /// skipped. All the intermediate outputs are kept between runs, so it uses
+  /// more memory, and it supersedes the operator reuse of SetResultCache.
+  /// Caution: models with operators keeping state across runs (e.g.
+  /// IfDefined or DynamicLSTM) must not enable it.
+  ///
+  /// \param enable whether to run incrementally.
+  /// \return MaceStatus::MACE_SUCCESS for success, other for failure.
+  MaceStatus SetIncrementalRun(bool enable);
+
+  /// \brief Limit the memory held by the buffers of the engine
+  ///
+  /// Unlimited by default. The budget covers the private, intermediate and
+  /// scratch buffers of the runtimes the engine creates, see
+  /// MaceEngine::GetMemoryUsage. When a buffer would exceed it, the engine
+  /// first frees the private and scratch buffers it keeps for reuse, then
+  /// the allocation fails: Init (or a Run growing a tensor) returns
+  /// MaceStatus::MACE_OUT_OF_RESOURCES instead of allocating. Init gives up
+  /// SetIncrementalRun rather than fail. A Run also fails so when the
+  /// scratch buffers of an operator do not fit, though the CPU GEMM kernels,
+  /// on ARM as on x86, fall back to slower ones needing no scratch. Runtimes
+  /// shared with a tutor engine keep the budget of the tutor.
+  ///
+  /// \param bytes limit in bytes, 0 for no limit.
+  /// \return MaceStatus::MACE_SUCCESS for success, other for failure.
+  MaceStatus SetMemoryBudget(int64_t bytes);
+
  private:
   std::shared_ptr<MaceEngineCfgImpl> impl_;
 };
@@ -506,6 +583,47 @@ class MACE_API MaceTensor {
   std::unique_ptr<Impl> impl_;
 };
 
+/// \brief Handle of a run submitted by MaceEngine::RunAsync.
+///
+/// Copies of a handle refer to the same run.
+/// Thread-safe.
+class MACE_API MaceRunHandle {
+ public:
+  MaceRunHandle();
+  MaceRunHandle(const MaceRunHandle &other);
+  MaceRunHandle &operator=(const MaceRunHandle &other);
+  ~MaceRunHandle();
+
+  /// \brief Whether the handle refers to a submitted run
+  bool Valid() const;
+
+  /// \brief Whether the run has finished, including failed or cancelled runs
+  bool IsDone() const;
+
+  /// \brief Block until the run is done
+  ///
+  /// \return status of the run, MaceStatus::MACE_CANCELLED if it was
+  ///         cancelled and MaceStatus::MACE_DEADLINE_EXCEEDED if its
+  ///         deadline passed before it finished.
+  MaceStatus Wait() const;
+
+  /// \brief Block until the run is done or timeout_us microseconds passed
+  ///
+  /// \return true if the run is done.
+  bool WaitFor(int64_t timeout_us) const;
+
+  /// \brief Request cancellation of the run
+  ///
+  /// A queued run is dropped when it reaches the head of the queue, a running
+  /// one stops before its next operator. A finished run is not affected.
+  void Cancel();
+
+ private:
+  friend class MaceEngine;
+  class Impl;
+  std::shared_ptr<Impl> impl_;
+};
+
 class MACE_API MaceEngine {
  public:
   explicit MaceEngine(const MaceEngineConfig &config);
@@ -532,6 +650,27 @@ class MACE_API MaceEngine {
                  std::map<std::string, MaceTensor> *outputs,
                  RunMetadata *run_metadata);
 
+  /// \brief Run the model without blocking the calling thread
+  ///
+  /// The run is queued on an executor owned by the engine and runs
+  /// serialized with the other Run and RunAsync calls of the engine.
+  /// The input tensors are retained by the run, the output map must stay
+  /// alive until the run is done.
+  ///
+  /// \param callback[in]: called on the executor thread with the status of
+  ///                      the run before the handle becomes done, so it
+  ///                      must not wait on the handle. It may release the
+  ///                      last reference to the engine, the queued runs are
+  ///                      then cancelled.
+  /// \param timeout_us[in]: deadline of the run in microseconds from now,
+  ///                        negative for no deadline.
+  /// \return handle to wait for or cancel the run.
+  MaceRunHandle RunAsync(
+      const std::map<std::string, MaceTensor> &inputs,
+      std::map<std::string, MaceTensor> *outputs,
+      std::function<void(const MaceStatus &)> callback = nullptr,
+      int64_t timeout_us = -1);
+
   // @Deprecated, will be removed in future version
   MaceStatus Init(const NetDef *net_def,
                   const std::vector<std::string> &input_nodes,
@@ -562,6 +701,15 @@ class MACE_API MaceEngine {
   /// \return MaceStatus::MACE_SUCCESS for success, other for failure.
   MaceStatus ReleaseIntermediateBuffer();
 
+  /// \brief Report the memory held by the engine
+  ///
+  /// Waits for the run in progress. Runtimes shared with a tutor engine are
+  /// reported by both engines.
+  ///
+  /// \param usage[out]: the bytes held, now and at peak, per kind of buffer.
+  /// \return MaceStatus::MACE_SUCCESS for success, other for failure.
+  MaceStatus GetMemoryUsage(MemoryUsage *usage) const;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
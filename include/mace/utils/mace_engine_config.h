@@ -48,6 +48,12 @@ class MaceEngineCfgImpl {
                          const std::string &binary_file,
                          const std::string &storage_file);
 
+  MaceStatus SetResultCache(int max_entries);
+
+  MaceStatus SetIncrementalRun(bool enable);
+
+  MaceStatus SetMemoryBudget(int64_t bytes);
+
   int num_threads() const;
 
   CPUAffinityPolicy cpu_affinity_policy() const;
@@ -72,6 +78,12 @@ class MaceEngineCfgImpl {
 
   RuntimeType runtime_type(const std::string &sub_graph_name) const;
 
+  int result_cache_size() const;
+
+  bool incremental_run() const;
+
+  int64_t memory_budget() const;
+
  private:
   int num_threads_;
   CPUAffinityPolicy cpu_affinity_policy_;
@@ -84,6 +96,9 @@ class MaceEngineCfgImpl {
   APUCachePolicy apu_cache_policy_;
   std::string apu_binary_file_;
   std::string apu_storage_file_;
+  int result_cache_size_;
+  bool incremental_run_;
+  int64_t memory_budget_;
   std::unordered_map<std::string, int> runtime_map_;
 };
 
@@ -124,6 +124,16 @@ MaceStatus BaseFlow::AllocateIntermediateBuffer() {
   return MaceStatus::MACE_SUCCESS;
 }
 
+void BaseFlow::SetRunInterrupter(const std::function<bool()> &interrupter) {
+  if (net_ != nullptr) {
+    net_->SetRunInterrupter(interrupter);
+  }
+}
+
+index_t BaseFlow::GetWeightBytes() const {
+  return ws_ == nullptr ? 0 : ws_->GetWeightBytes();
+}
+
 MaceStatus BaseFlow::TransposeInput(
     const std::pair<const std::string, MaceTensor> &input,
     Tensor *input_tensor) {
@@ -16,6 +16,7 @@
 #define MACE_CORE_FLOW_BASE_FLOW_H_
 
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -83,6 +84,10 @@ class BaseFlow {
 
   MaceStatus AllocateIntermediateBuffer();
 
+  void SetRunInterrupter(const std::function<bool()> &interrupter);
+
+  index_t GetWeightBytes() const;
+
  protected:
   virtual MaceStatus GetInputTransposeDims(
       const std::pair<const std::string, MaceTensor> &input,
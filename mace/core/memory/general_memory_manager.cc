@@ -29,7 +29,8 @@ GeneralMemoryManager::~GeneralMemoryManager() {}
 void *GeneralMemoryManager::ObtainMemory(const MemInfo &info,
                                          const BufRentType rent_type) {
   if (shared_pools_.count(rent_type) == 0) {
-    shared_pools_.emplace(rent_type, make_unique<MemoryPool>(allocator_));
+    shared_pools_.emplace(rent_type,
+                          make_unique<MemoryPool>(this, rent_type));
   }
   return shared_pools_.at(rent_type)->ObtainMemory(info);
 }
@@ -62,8 +63,18 @@ void GeneralMemoryManager::ReleaseAllMemory(const BufRentType rent_type,
   }
 }
 
-GeneralMemoryManager::MemoryPool::MemoryPool(Allocator *allocator)
-    : allocator_(allocator) {}
+void GeneralMemoryManager::TrimMemory() {
+  for (auto rent_type : {RENT_PRIVATE, RENT_SCRATCH}) {
+    if (shared_pools_.count(rent_type) > 0) {
+      shared_pools_.at(rent_type)->ClearFreeMemory();
+    }
+  }
+}
+
+GeneralMemoryManager::MemoryPool::MemoryPool(GeneralMemoryManager *manager,
+                                             BufRentType rent_type)
+    : manager_(manager), rent_type_(rent_type),
+      allocator_(manager->allocator_) {}
 
 GeneralMemoryManager::MemoryPool::~MemoryPool() {
   ClearMemory();
@@ -74,13 +85,19 @@ void GeneralMemoryManager::MemoryPool::ClearMemory() {
        iter != mem_used_blocks_.end(); ++iter) {
     VLOG(2) << "Finally release used memory, size: " << iter->first;
     allocator_->Delete(iter->second);
+    manager_->OnMemoryDeleted(rent_type_, iter->first);
   }
   mem_used_blocks_.clear();
 
+  ClearFreeMemory();
+}
+
+void GeneralMemoryManager::MemoryPool::ClearFreeMemory() {
   for (BlockList::iterator iter = mem_free_blocks_.begin();
        iter != mem_free_blocks_.end(); ++iter) {
     VLOG(2) << "Finally release unused memory, size: " << iter->first;
     allocator_->Delete(iter->second);
+    manager_->OnMemoryDeleted(rent_type_, iter->first);
   }
   mem_free_blocks_.clear();
 }
@@ -91,6 +108,9 @@ void *GeneralMemoryManager::MemoryPool::ObtainMemory(const MemInfo &mem_info) {
   auto iter = mem_free_blocks_.lower_bound(bytes);
   void *ptr = nullptr;
   if (iter == mem_free_blocks_.end()) {
+    if (!manager_->AcquireMemory(rent_type_, static_cast<index_t>(bytes))) {
+      return nullptr;
+    }
     MACE_CHECK_SUCCESS(allocator_->New(mem_info, &ptr));
     mem_used_blocks_.emplace(bytes, ptr);
     VLOG(2) << "GeneralMemoryManager::MemoryPool::ObtainMemory New memory: "
@@ -37,18 +37,22 @@ class GeneralMemoryManager : public MemoryManager {
   std::vector<index_t> GetMemoryRealSize(const void *ptr) override;
   void ReleaseAllMemory(const BufRentType rent_type, bool del_buf) override;
 
+ protected:
+  void TrimMemory() override;
 
+ public:
   typedef std::multimap<index_t, void *> BlockList;
   class MemoryPool {
    public:
     MemoryPool() {}
-    explicit MemoryPool(Allocator *allocator);
+    MemoryPool(GeneralMemoryManager *manager, BufRentType rent_type);
     ~MemoryPool();
 
     void *ObtainMemory(const MemInfo &info);
     void ReleaseMemory(void *ptr);
     std::vector<index_t> GetMemoryRealSize(const void *ptr);
     void ReleaseAllMemory(bool del_buf);
+    void ClearFreeMemory();
 
    private:
     void ClearMemory();
@@ -56,6 +60,8 @@ class GeneralMemoryManager : public MemoryManager {
    private:
     BlockList mem_used_blocks_;
     BlockList mem_free_blocks_;
+    GeneralMemoryManager *manager_;
+    BufRentType rent_type_;
     Allocator *allocator_;
   };
 
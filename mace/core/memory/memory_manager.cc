@@ -0,0 +1,71 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/core/memory/memory_manager.h"
+
+#include <utility>
+
+#include "mace/utils/logging.h"
+
+namespace mace {
+
+MemoryCounter MemoryManager::GetMemoryCounter(
+    const BufRentType rent_type) const {
+  return counters_[rent_type];
+}
+
+MemoryCounter MemoryManager::GetMemoryCounter() const {
+  return total_counter_;
+}
+
+void MemoryManager::SetMemoryBudget(std::shared_ptr<MemoryBudget> budget) {
+  if (budget_ != nullptr) {
+    budget_->counter().Sub(total_counter_.current);
+  }
+  budget_ = std::move(budget);
+  if (budget_ != nullptr) {
+    budget_->counter().Add(total_counter_.current);
+  }
+}
+
+bool MemoryManager::AcquireMemory(const BufRentType rent_type,
+                                  const index_t bytes) {
+  if (budget_ != nullptr && !budget_->Fits(bytes)) {
+    TrimMemory();
+    if (!budget_->Fits(bytes)) {
+      LOG(WARNING) << "Memory budget " << budget_->limit()
+                   << " bytes exceeded, held: "
+                   << budget_->counter().current << ", requested: " << bytes
+                   << ", rent type: " << rent_type;
+      return false;
+    }
+  }
+  counters_[rent_type].Add(bytes);
+  total_counter_.Add(bytes);
+  if (budget_ != nullptr) {
+    budget_->counter().Add(bytes);
+  }
+  return true;
+}
+
+void MemoryManager::OnMemoryDeleted(const BufRentType rent_type,
+                                    const index_t bytes) {
+  counters_[rent_type].Sub(bytes);
+  total_counter_.Sub(bytes);
+  if (budget_ != nullptr) {
+    budget_->counter().Sub(bytes);
+  }
+}
+
+}  // namespace mace
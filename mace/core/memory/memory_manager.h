@@ -15,8 +15,11 @@
 #ifndef MACE_CORE_MEMORY_MEMORY_MANAGER_H_
 #define MACE_CORE_MEMORY_MEMORY_MANAGER_H_
 
+#include <algorithm>
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "mace/core/memory/allocator.h"
 
@@ -25,9 +28,45 @@ namespace mace {
 struct MemInfo;
 class Allocator;
 
+// Bytes obtained from an allocator and not deleted yet, and the most of them
+// held at once.
+struct MemoryCounter {
+  index_t current;
+  index_t peak;
+
+  MemoryCounter() : current(0), peak(0) {}
+
+  void Add(const index_t bytes) {
+    current += bytes;
+    peak = std::max(peak, current);
+  }
+  void Sub(const index_t bytes) {
+    current -= bytes;
+  }
+};
+
+// The bytes the memory managers of an engine hold together, checked against
+// an optional limit.
+class MemoryBudget {
+ public:
+  // `limit` <= 0 means no limit.
+  explicit MemoryBudget(const index_t limit) : limit_(limit) {}
+
+  bool Fits(const index_t bytes) const {
+    return limit_ <= 0 || counter_.current + bytes <= limit_;
+  }
+  index_t limit() const { return limit_; }
+  MemoryCounter &counter() { return counter_; }
+
+ private:
+  const index_t limit_;
+  MemoryCounter counter_;
+};
+
 class MemoryManager {
  public:
-  explicit MemoryManager(Allocator *allocator) : allocator_(allocator) {}
+  explicit MemoryManager(Allocator *allocator)
+      : allocator_(allocator), counters_(RENT_SLICE + 1) {}
   virtual ~MemoryManager() {}
   Allocator *GetAllocator() { return allocator_; }
 
@@ -39,8 +78,30 @@ class MemoryManager {
 
   virtual void ReleaseAllMemory(const BufRentType rent_type, bool del_buf) = 0;
 
+  // The memory held for `rent_type`, the free blocks kept for reuse included.
+  MemoryCounter GetMemoryCounter(const BufRentType rent_type) const;
+  // The memory held for all the rent types.
+  MemoryCounter GetMemoryCounter() const;
+  void SetMemoryBudget(std::shared_ptr<MemoryBudget> budget);
+
+ protected:
+  // Counts `bytes` about to be obtained from the allocator for `rent_type`.
+  // If they exceed the budget, the free blocks kept for reuse are deleted
+  // first, then false is returned and ObtainMemory should return nullptr.
+  bool AcquireMemory(const BufRentType rent_type, const index_t bytes);
+  // Counts `bytes` given back to the allocator.
+  void OnMemoryDeleted(const BufRentType rent_type, const index_t bytes);
+  // Deletes the private and scratch blocks kept for reuse, the shared ones
+  // are still referenced by the tensors of the planned memory.
+  virtual void TrimMemory() {}
+
  protected:
   Allocator *allocator_;
+
+ private:
+  std::vector<MemoryCounter> counters_;
+  MemoryCounter total_counter_;
+  std::shared_ptr<MemoryBudget> budget_;
 };
 
 }  // namespace mace
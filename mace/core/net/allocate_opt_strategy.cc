@@ -154,7 +154,7 @@ void SimulateDeleteBuffer(std::shared_ptr<TensorRef> tensor_ref,
   used_buf_list->erase(idx);
 }
 
-void ReallyAllocateBuffer(
+MaceStatus ReallyAllocateBuffer(
     std::unordered_map<std::string, std::shared_ptr<TensorRef>> tensor_refs) {
   for (auto i = tensor_refs.begin(); i != tensor_refs.end(); ++i) {
     Buffer *buffer = i->second->buffer;
@@ -166,6 +166,11 @@ void ReallyAllocateBuffer(
     Runtime *runtime = i->second->tensor->GetCurRuntime();
     if (buffer->memory<void>() == nullptr) {
       auto new_buf = runtime->ObtainBuffer(*buffer, RENT_SHARE);
+      if (new_buf->memory<void>() == nullptr) {
+        LOG(ERROR) << "Can not allocate " << buffer->bytes()
+                   << " bytes for tensor " << i->second->tensor->name();
+        return MaceStatus::MACE_OUT_OF_RESOURCES;
+      }
       buffer->SetBuf(new_buf->mutable_memory<void>());
       VLOG(3) << "ReallyAllocateBuffer, allocate: " << buffer->memory<void>()
               << ", buffer dim is: " << MakeString(buffer->dims)
@@ -175,6 +180,7 @@ void ReallyAllocateBuffer(
     Tensor *tensor = i->second->tensor;
     runtime->SetBufferToTensor(make_unique<Buffer>(*buffer), tensor);
   }
+  return MaceStatus::MACE_SUCCESS;
 }
 }  // namespace
 
@@ -280,9 +286,7 @@ MaceStatus AllocateTensorMemory<SERIAL_OPT>(const OperationArray &operators) {
     }
   }
 
-  ReallyAllocateBuffer(tensor_refs);
-
-  return MaceStatus::MACE_SUCCESS;
+  return ReallyAllocateBuffer(tensor_refs);
 }
 
 }  // namespace mace
@@ -25,11 +25,12 @@ struct MemBlock {
 
   explicit MemBlock(Tensor *tensor_ptr) : refs(1), tensor(tensor_ptr) {}
 
-  void AllocateBuffer() {
+  MaceStatus AllocateBuffer() {
     if (tensor->memory<void>() == nullptr) {
       auto *runtime = tensor->GetCurRuntime();
-      runtime->AllocateBufferForTensor(tensor, RENT_SHARE);
+      return runtime->AllocateBufferForTensor(tensor, RENT_SHARE);
     }
+    return MaceStatus::MACE_SUCCESS;
   }
 
   void DeleteBuffer() {
@@ -111,7 +112,7 @@ MaceStatus AllocateTensorMemory<SERIAL_REF>(const OperationArray &operators) {
         tensor_refs.emplace(tensor_name, std::make_shared<MemBlock>(tensor));
         VLOG(2) << "tensor " << tensor_name << " is model's output";
       }
-      tensor_refs.at(tensor_name)->AllocateBuffer();
+      MACE_RETURN_IF_ERROR(tensor_refs.at(tensor_name)->AllocateBuffer());
 
       auto data_format = ProtoArgHelper::GetOptionalArg<OperatorDef, int>(
           op->debug_def(), "data_format", static_cast<int>(DataFormat::NONE));
@@ -15,6 +15,10 @@
 #ifndef MACE_CORE_NET_BASE_NET_H_
 #define MACE_CORE_NET_BASE_NET_H_
 
+#include <functional>
+#include <string>
+#include <vector>
+
 #include "mace/public/mace.h"
 #include "mace/utils/macros.h"
 
@@ -43,9 +47,34 @@ class BaseNet {
 
   virtual MaceStatus Run(RunMetadata *run_metadata = nullptr) = 0;
 
+  // Runs only the operators the given output tensors depend on. Nets which
+  // can not prune their graph run it as a whole.
+  virtual MaceStatus RunPartial(const std::vector<std::string> &output_names,
+                                RunMetadata *run_metadata = nullptr) {
+    MACE_UNUSED(output_names);
+    return Run(run_metadata);
+  }
+
   virtual MaceStatus AllocateIntermediateBuffer() = 0;
 
+  // Lets the net skip the operators whose inputs did not change since they
+  // last ran, must be called before Init. Nets which can not tell ignore it.
+  virtual void EnableResultReuse() {}
+
+  // Lets the net recompute only the part of the operator outputs affected by
+  // the input pixels changed since the previous run, must be called before
+  // Init. Nets which can not tell ignore it.
+  virtual void EnableIncrementalRun() {}
+
+  // Polled between operators, the run stops with MACE_CANCELLED as soon as
+  // it returns true. An empty interrupter never stops the run.
+  void SetRunInterrupter(const std::function<bool()> &interrupter) {
+    run_interrupter_ = interrupter;
+  }
+
  protected:
+  std::function<bool()> run_interrupter_;
+
   MACE_DISABLE_COPY_AND_ASSIGN(BaseNet);
 };
 
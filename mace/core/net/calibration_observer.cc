@@ -0,0 +1,405 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif  // MACE_ENABLE_NEON
+
+#include "mace/core/net/calibration_observer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+#include "mace/core/quantize.h"
+#include "mace/port/env.h"
+#include "mace/port/file_system.h"
+#include "mace/utils/logging.h"
+
+namespace mace {
+
+namespace {
+// int8 and uint8
+const int kQuantizeLevels = 256;
+const char kCalibrationMagic[4] = {'M', 'C', 'A', 'L'};
+
+// Counts `data` into `bins` bins of [min, min + bins / scale).
+void CountBins(const float *data, const index_t size, const float min,
+               const float scale, const int bins,
+               std::vector<index_t> *counts) {
+  index_t *count = counts->data();
+  index_t i = 0;
+#if defined(MACE_ENABLE_NEON)
+  const float32x4_t vmin = vdupq_n_f32(min);
+  const float32x4_t vscale = vdupq_n_f32(scale);
+  const int32x4_t vzero = vdupq_n_s32(0);
+  const int32x4_t vlast = vdupq_n_s32(bins - 1);
+  int32_t index[4];
+  for (; i + 4 <= size; i += 4) {
+    float32x4_t v = vmulq_f32(vsubq_f32(vld1q_f32(data + i), vmin), vscale);
+    int32x4_t vindex = vminq_s32(vmaxq_s32(vcvtq_s32_f32(v), vzero), vlast);
+    vst1q_s32(index, vindex);
+    ++count[index[0]];
+    ++count[index[1]];
+    ++count[index[2]];
+    ++count[index[3]];
+  }
+#endif  // MACE_ENABLE_NEON
+  for (; i < size; ++i) {
+    int index = static_cast<int>((data[i] - min) * scale);
+    ++count[std::max(0, std::min(index, bins - 1))];
+  }
+}
+
+CalibrationMethod ParseCalibrationMethod(const std::string &method) {
+  if (method.empty() || method == "kl") {
+    return CALIBRATION_KL_DIVERGENCE;
+  } else if (method == "minmax") {
+    return CALIBRATION_MINMAX;
+  } else if (method == "percentile") {
+    return CALIBRATION_PERCENTILE;
+  } else if (method == "mse") {
+    return CALIBRATION_MSE;
+  }
+  LOG(WARNING) << "Unknown calibration method " << method << ", use kl";
+  return CALIBRATION_KL_DIVERGENCE;
+}
+
+template<typename T>
+void AppendValue(const T value, std::string *buffer) {
+  buffer->append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+}  // namespace
+
+CalibrationHistogram::CalibrationHistogram()
+    : min_(0.f), max_(0.f), total_(0), counts_(kBins, 0) {}
+
+float CalibrationHistogram::BinWidth() const {
+  return (max_ - min_) / kBins;
+}
+
+void CalibrationHistogram::Add(const float *data, const index_t size) {
+  if (size <= 0) {
+    return;
+  }
+  float min = 0.f;
+  float max = 0.f;
+  FindMinMax(data, size, &min, &max);
+  if (total_ == 0) {
+    min_ = min;
+    max_ = max;
+  } else if (min < min_ || max > max_) {
+    Rebin(std::min(min, min_), std::max(max, max_));
+  }
+
+  if (max_ == min_) {
+    counts_[0] += size;
+  } else {
+    std::vector<index_t> counts(kBins, 0);
+    CountBins(data, size, min_, kBins / (max_ - min_), kBins, &counts);
+    for (int i = 0; i < kBins; ++i) {
+      counts_[i] += counts[i];
+    }
+  }
+  total_ += size;
+}
+
+void CalibrationHistogram::Rebin(const float min, const float max) {
+  const float width = BinWidth();
+  const float new_width = (max - min) / kBins;
+  std::vector<double> counts(kBins, 0);
+  auto bin_of = [&](const float value) {
+    int bin = static_cast<int>((value - min) / new_width);
+    return std::max(0, std::min(bin, kBins - 1));
+  };
+  for (int i = 0; i < kBins; ++i) {
+    if (counts_[i] == 0) {
+      continue;
+    }
+    const float begin = min_ + i * width;
+    const float end = begin + width;
+    const int first = bin_of(begin);
+    const int last = bin_of(end);
+    if (width == 0 || first == last) {
+      counts[first] += counts_[i];
+      continue;
+    }
+    // spreads the count evenly over the new bins the old one overlaps
+    for (int j = first; j <= last; ++j) {
+      const float overlap =
+          std::min(end, min + (j + 1) * new_width) -
+              std::max(begin, min + j * new_width);
+      if (overlap > 0) {
+        counts[j] += counts_[i] * overlap / width;
+      }
+    }
+  }
+  counts_.swap(counts);
+  min_ = min;
+  max_ = max;
+}
+
+void CalibrationHistogram::SelectRange(const CalibrationMethod method,
+                                       const float percentile,
+                                       const int levels,
+                                       float *min, float *max) const {
+  *min = min_;
+  *max = max_;
+  if (total_ == 0 || max_ == min_) {
+    return;
+  }
+  switch (method) {
+    case CALIBRATION_MINMAX:
+      break;
+    case CALIBRATION_PERCENTILE:
+      PercentileRange(percentile, min, max);
+      break;
+    case CALIBRATION_KL_DIVERGENCE:
+      SearchRange(levels, [&](const int begin, const int end) {
+        return KLDivergence(begin, end, levels);
+      }, min, max);
+      break;
+    case CALIBRATION_MSE:
+      SearchRange(levels, [&](const int begin, const int end) {
+        return QuantizeError(begin, end, levels);
+      }, min, max);
+      break;
+    default:
+      LOG(FATAL) << "Unknown calibration method " << method;
+  }
+}
+
+void CalibrationHistogram::PercentileRange(const float percentile,
+                                           float *min, float *max) const {
+  const double ratio = std::max(0.f, std::min(percentile, 100.f)) / 100.;
+  const float width = BinWidth();
+  // the value below which `target` values are, interpolated in its bin
+  auto value_at = [&](const double target) {
+    double sum = 0;
+    for (int i = 0; i < kBins; ++i) {
+      if (counts_[i] > 0 && sum + counts_[i] >= target) {
+        return min_ + (i + (target - sum) / counts_[i]) * width;
+      }
+      sum += counts_[i];
+    }
+    return static_cast<double>(max_);
+  };
+  *min = static_cast<float>(value_at(total_ * (1. - ratio)));
+  *max = static_cast<float>(value_at(total_ * ratio));
+}
+
+template<typename Cost>
+void CalibrationHistogram::SearchRange(const int levels, Cost cost,
+                                       float *min, float *max) const {
+  int begin = 0;
+  int end = kBins;
+  int best_begin = begin;
+  int best_end = end;
+  double best_cost = cost(begin, end);
+  while (end - begin > std::min(levels, kBins)) {
+    const double cost_begin = cost(begin + 1, end);
+    const double cost_end = cost(begin, end - 1);
+    double window_cost = 0;
+    if (cost_begin < cost_end) {
+      ++begin;
+      window_cost = cost_begin;
+    } else {
+      --end;
+      window_cost = cost_end;
+    }
+    if (window_cost < best_cost) {
+      best_cost = window_cost;
+      best_begin = begin;
+      best_end = end;
+    }
+  }
+  const float width = BinWidth();
+  *min = min_ + best_begin * width;
+  *max = min_ + best_end * width;
+}
+
+// KL divergence between the bins in [begin, end), the clipped values added
+// to the edge bins, and their quantization into `levels` values.
+double CalibrationHistogram::KLDivergence(const int begin, const int end,
+                                          const int levels) const {
+  const int size = end - begin;
+  std::vector<double> reference(counts_.begin() + begin,
+                                counts_.begin() + end);
+  for (int i = 0; i < begin; ++i) {
+    reference[0] += counts_[i];
+  }
+  for (int i = end; i < kBins; ++i) {
+    reference[size - 1] += counts_[i];
+  }
+
+  // the mass of each level spreads over its non-empty bins
+  std::vector<double> level_counts(levels, 0);
+  std::vector<int> level_bins(levels, 0);
+  for (int i = 0; i < size; ++i) {
+    const int level = static_cast<int>(
+        static_cast<int64_t>(i) * levels / size);
+    level_counts[level] += counts_[begin + i];
+    level_bins[level] += counts_[begin + i] > 0 ? 1 : 0;
+  }
+  double quantized_total = 0;
+  for (int i = 0; i < levels; ++i) {
+    quantized_total += level_counts[i];
+  }
+
+  const double kEpsilon = 1e-10;
+  double divergence = 0;
+  for (int i = 0; i < size; ++i) {
+    if (reference[i] <= 0) {
+      continue;
+    }
+    const double p = reference[i] / total_;
+    double q = kEpsilon;
+    const int level = static_cast<int>(
+        static_cast<int64_t>(i) * levels / size);
+    if (counts_[begin + i] > 0 && quantized_total > 0) {
+      q = std::max(
+          kEpsilon,
+          level_counts[level] / level_bins[level] / quantized_total);
+    }
+    divergence += p * std::log(p / q);
+  }
+  return divergence;
+}
+
+// Expected squared error of quantizing the values into `levels` values
+// evenly covering the bins in [begin, end).
+double CalibrationHistogram::QuantizeError(const int begin, const int end,
+                                           const int levels) const {
+  const float width = BinWidth();
+  const double min = min_ + begin * width;
+  const double max = min_ + end * width;
+  const double step = (max - min) / (levels - 1);
+  const double rounding_error = step * step / 12;
+  double error = 0;
+  for (int i = 0; i < kBins; ++i) {
+    if (counts_[i] == 0) {
+      continue;
+    }
+    const double center = min_ + (i + 0.5) * width;
+    double bin_error = rounding_error;
+    if (center < min) {
+      bin_error = (min - center) * (min - center);
+    } else if (center > max) {
+      bin_error = (center - max) * (center - max);
+    }
+    error += bin_error * counts_[i];
+  }
+  return error;
+}
+
+CalibrationObserver::CalibrationObserver(const std::string &file_path,
+                                         const CalibrationMethod method,
+                                         const float percentile)
+    : file_path_(file_path), method_(method), percentile_(percentile) {}
+
+CalibrationObserver::~CalibrationObserver() {
+  if (Save() != MaceStatus::MACE_SUCCESS) {
+    LOG(ERROR) << "Failed to save the calibration ranges to " << file_path_;
+  }
+}
+
+std::shared_ptr<CalibrationObserver> CalibrationObserver::CreateFromEnv() {
+  std::string file_path;
+  GetEnv("MACE_CALIBRATION_FILE", &file_path);
+  if (file_path.empty()) {
+    return nullptr;
+  }
+
+  static std::mutex observers_mutex;
+  static std::map<std::string, std::weak_ptr<CalibrationObserver>> observers;
+  std::lock_guard<std::mutex> lock(observers_mutex);
+  std::shared_ptr<CalibrationObserver> observer =
+      observers[file_path].lock();
+  if (observer == nullptr) {
+    std::string method;
+    GetEnv("MACE_CALIBRATION_METHOD", &method);
+    std::string percentile;
+    GetEnv("MACE_CALIBRATION_PERCENTILE", &percentile);
+    observer = std::make_shared<CalibrationObserver>(
+        file_path, ParseCalibrationMethod(method),
+        percentile.empty() ? 99.99f : std::strtof(percentile.c_str(),
+                                                  nullptr));
+    observers[file_path] = observer;
+  }
+  return observer;
+}
+
+void CalibrationObserver::Observe(const std::string &name,
+                                  const Tensor *tensor) {
+  if (tensor->dtype() != DT_FLOAT) {
+    return;
+  }
+  Tensor::MappingGuard guard(tensor);
+  Observe(name, tensor->data<float>(), tensor->size());
+}
+
+void CalibrationObserver::Observe(const std::string &name,
+                                  const float *data,
+                                  const index_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = histograms_.find(name);
+  if (iter == histograms_.end()) {
+    iter = histograms_.emplace(name, CalibrationHistogram()).first;
+    names_.push_back(name);
+  }
+  iter->second.Add(data, size);
+}
+
+bool CalibrationObserver::GetRange(const std::string &name,
+                                   float *min, float *max) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = histograms_.find(name);
+  if (iter == histograms_.end()) {
+    return false;
+  }
+  iter->second.SelectRange(method_, percentile_, kQuantizeLevels, min, max);
+  return true;
+}
+
+MaceStatus CalibrationObserver::Save() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string buffer(kCalibrationMagic, sizeof(kCalibrationMagic));
+  AppendValue(static_cast<uint32_t>(kVersion), &buffer);
+  AppendValue(static_cast<uint32_t>(method_), &buffer);
+  AppendValue(static_cast<uint32_t>(names_.size()), &buffer);
+  for (auto &name : names_) {
+    const CalibrationHistogram &histogram = histograms_.at(name);
+    float min = 0.f;
+    float max = 0.f;
+    histogram.SelectRange(method_, percentile_, kQuantizeLevels, &min, &max);
+    AppendValue(static_cast<uint32_t>(name.size()), &buffer);
+    buffer.append(name);
+    AppendValue(min, &buffer);
+    AppendValue(max, &buffer);
+    AppendValue(histogram.min(), &buffer);
+    AppendValue(histogram.max(), &buffer);
+  }
+
+  std::unique_ptr<port::WritableFile> file;
+  MACE_RETURN_IF_ERROR(
+      GetFileSystem()->NewWritableFile(file_path_.c_str(), &file));
+  MACE_RETURN_IF_ERROR(file->Append(buffer.data(), buffer.size()));
+  MACE_RETURN_IF_ERROR(file->Close());
+  VLOG(1) << "Saved the calibration ranges of " << names_.size()
+          << " tensors to " << file_path_;
+  return MaceStatus::MACE_SUCCESS;
+}
+
+}  // namespace mace
@@ -0,0 +1,120 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_CORE_NET_CALIBRATION_OBSERVER_H_
+#define MACE_CORE_NET_CALIBRATION_OBSERVER_H_
+
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <vector>
+
+#include "mace/core/tensor.h"
+#include "mace/public/mace.h"
+#include "mace/utils/macros.h"
+
+namespace mace {
+
+enum CalibrationMethod {
+  CALIBRATION_MINMAX = 0,
+  CALIBRATION_PERCENTILE = 1,
+  CALIBRATION_KL_DIVERGENCE = 2,
+  CALIBRATION_MSE = 3,
+};
+
+// Streaming histogram of the values of one tensor over many runs. The bins
+// evenly cover the observed range, which grows by re-binning the counts.
+class CalibrationHistogram {
+ public:
+  static const int kBins = 2048;
+
+  CalibrationHistogram();
+
+  void Add(const float *data, const index_t size);
+
+  float min() const { return min_; }
+  float max() const { return max_; }
+  double total() const { return total_; }
+  const std::vector<double> &counts() const { return counts_; }
+
+  // Chooses the range quantized into `levels` values.
+  void SelectRange(const CalibrationMethod method, const float percentile,
+                   const int levels, float *min, float *max) const;
+
+ private:
+  void Rebin(const float min, const float max);
+  float BinWidth() const;
+  void PercentileRange(const float percentile, float *min, float *max) const;
+  // Shrinks the window of bins one bin at a time from the end costing less,
+  // returns the window of the lowest cost seen.
+  template<typename Cost>
+  void SearchRange(const int levels, Cost cost, float *min, float *max) const;
+  double KLDivergence(const int begin, const int end, const int levels) const;
+  double QuantizeError(const int begin, const int end, const int levels) const;
+
+ private:
+  float min_;
+  float max_;
+  double total_;
+  std::vector<double> counts_;
+};
+
+// Collects the histograms of the float outputs of a net to choose their
+// quantization ranges, replaces the "Tensor range" log parsed by
+// tools/python/quantize/quantize_stat.py.
+//
+// The ranges are saved when the observer is destroyed, in the binary format
+// read by the converter as `quantize_range_file`:
+//   char[4] "MCAL", uint32 version, uint32 method, uint32 tensor count,
+//   then for each tensor: uint32 name length, name, float min, float max,
+//   float observed min, float observed max.
+class CalibrationObserver {
+ public:
+  static const int kVersion = 1;
+
+  CalibrationObserver(const std::string &file_path,
+                      const CalibrationMethod method,
+                      const float percentile);
+  ~CalibrationObserver();
+
+  // Returns the observer shared by the nets of the process if
+  // MACE_CALIBRATION_FILE is set, or null. MACE_CALIBRATION_METHOD is one of
+  // minmax, percentile, kl (default) and mse, MACE_CALIBRATION_PERCENTILE
+  // defaults to 99.99.
+  static std::shared_ptr<CalibrationObserver> CreateFromEnv();
+
+  void Observe(const std::string &name, const Tensor *tensor);
+  void Observe(const std::string &name, const float *data,
+               const index_t size);
+
+  // Returns false if `name` was never observed.
+  bool GetRange(const std::string &name, float *min, float *max) const;
+  MaceStatus Save() const;
+
+ private:
+  const std::string file_path_;
+  const CalibrationMethod method_;
+  const float percentile_;
+  mutable std::mutex mutex_;
+  std::map<std::string, CalibrationHistogram> histograms_;
+  // the observation order, the order of the ranges in the file
+  std::vector<std::string> names_;
+
+  MACE_DISABLE_COPY_AND_ASSIGN(CalibrationObserver);
+};
+
+}  // namespace mace
+
+#endif  // MACE_CORE_NET_CALIBRATION_OBSERVER_H_
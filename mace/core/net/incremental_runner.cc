@@ -0,0 +1,543 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/core/net/incremental_runner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <unordered_set>
+
+#include "mace/core/ops/op_context.h"
+#include "mace/core/ops/op_init_context.h"
+#include "mace/core/proto/arg_helper.h"
+#include "mace/core/registry/ops_registry.h"
+#include "mace/utils/logging.h"
+#include "mace/utils/memory.h"
+
+namespace mace {
+
+namespace {
+// the values of ops::Padding::VALID and ops::PoolingType
+constexpr int kValidPadding = 0;
+constexpr int kAvgPooling = 1;
+constexpr int kMaxPooling = 2;
+
+typedef IncrementalRunner::Region Region;
+
+Region WholeRegion(const Tensor *tensor) {
+  if (tensor->dim_size() == 4) {
+    return {0, tensor->dim(2), 0, tensor->dim(3)};
+  }
+  return {0, 1, 0, 1};
+}
+
+// Gives the private buffer of `tensor` back to the pool, the tensor keeps its
+// data type and memory type.
+void ReleasePrivateBuffer(Tensor *tensor) {
+  Runtime *runtime = tensor->GetCurRuntime();
+  const MemoryType mem_type = tensor->memory_type();
+  const DataType data_type = tensor->dtype();
+  runtime->ReleaseBufferForTensor(tensor, BufRentType::RENT_PRIVATE);
+  runtime->SetBufferToTensor(make_unique<Buffer>(mem_type, data_type), tensor);
+}
+
+// Resizes a tensor of the crops, whose buffer only grows.
+MaceStatus ResizeTile(const std::vector<index_t> &shape, index_t *capacity,
+                      Tensor *tile) {
+  tile->Reshape(shape);
+  if (tile->size() > *capacity) {
+    if (*capacity > 0) {
+      ReleasePrivateBuffer(tile);
+      *capacity = 0;
+    }
+    MACE_RETURN_IF_ERROR(tile->GetCurRuntime()->AllocateBufferForTensor(
+        tile, BufRentType::RENT_PRIVATE));
+    *capacity = tile->size();
+    return MaceStatus::MACE_SUCCESS;
+  }
+  return tile->Resize(shape);
+}
+
+// Copies the rows and columns `crop` of the NCHW `input` to `tile`, the
+// pixels out of the input are set to `fill`.
+void CopyCrop(const Tensor *input, const Region &crop, const float fill,
+              Tensor *tile) {
+  const index_t height = input->dim(2);
+  const index_t width = input->dim(3);
+  const index_t planes = input->dim(0) * input->dim(1);
+  const index_t crop_height = crop.bottom - crop.top;
+  const index_t crop_width = crop.right - crop.left;
+  const index_t left = std::max<index_t>(crop.left, 0);
+  const index_t right = std::min(crop.right, width);
+  const float *src = input->data<float>();
+  float *dst = tile->mutable_data<float>();
+  for (index_t p = 0; p < planes; ++p) {
+    for (index_t h = crop.top; h < crop.bottom; ++h) {
+      float *dst_row = dst + (p * crop_height + h - crop.top) * crop_width;
+      if (h < 0 || h >= height || left >= right) {
+        std::fill_n(dst_row, crop_width, fill);
+        continue;
+      }
+      std::fill(dst_row, dst_row + left - crop.left, fill);
+      memcpy(dst_row + left - crop.left, src + (p * height + h) * width + left,
+             (right - left) * sizeof(float));
+      std::fill(dst_row + right - crop.left, dst_row + crop_width, fill);
+    }
+  }
+}
+
+// Writes the NCHW `tile` to the rows and columns `region` of `output`.
+void PasteRegion(const Tensor *tile, const Region &region, Tensor *output) {
+  const index_t height = output->dim(2);
+  const index_t width = output->dim(3);
+  const index_t planes = output->dim(0) * output->dim(1);
+  const index_t region_height = region.bottom - region.top;
+  const index_t region_width = region.right - region.left;
+  MACE_CHECK(tile->dim_size() == 4 && tile->dim(0) * tile->dim(1) == planes &&
+                 tile->dim(2) == region_height && tile->dim(3) == region_width,
+             "Unexpected shape of the recomputed region: ",
+             MakeString(tile->shape()));
+  const float *src = tile->data<float>();
+  float *dst = output->mutable_data<float>();
+  for (index_t p = 0; p < planes; ++p) {
+    for (index_t h = 0; h < region_height; ++h) {
+      memcpy(dst + (p * height + region.top + h) * width + region.left,
+             src + (p * region_height + h) * region_width,
+             region_width * sizeof(float));
+    }
+  }
+}
+}  // namespace
+
+IncrementalRunner::IncrementalRunner(
+    const OpRegistry *op_registry,
+    Workspace *ws,
+    Runtime *cpu_runtime,
+    const std::vector<std::unique_ptr<Operation>> *operators)
+    : op_registry_(op_registry),
+      ws_(ws),
+      cpu_runtime_(cpu_runtime),
+      operators_(operators),
+      running_(false) {}
+
+IncrementalRunner::~IncrementalRunner() = default;
+
+MaceStatus IncrementalRunner::Init() {
+  const size_t op_count = operators_->size();
+  states_.clear();
+  states_.resize(op_count);
+  inputs_.clear();
+  std::unordered_set<const Tensor *> known;
+  size_t tiled_count = 0;
+  for (size_t i = 0; i < op_count; ++i) {
+    Operation *op = (*operators_)[i].get();
+    for (int j = 0; j < op->InputSize(); ++j) {
+      const Tensor *input = op->Input(j);
+      if (!input->is_weight() && known.insert(input).second) {
+        inputs_.push_back({input, {}, {}});
+      }
+    }
+    for (int j = 0; j < op->OutputSize(); ++j) {
+      known.insert(op->Output(j));
+    }
+
+    OpState &state = states_[i];
+    state.kind = OTHER;
+    state.max_pooling = false;
+    state.avg_pooling = false;
+    state.tile_output_capacity = 0;
+    state.valid = false;
+    state.full = true;
+    MACE_RETURN_IF_ERROR(InitTileOperator(op, &state));
+    if (state.tile_op != nullptr) {
+      ++tiled_count;
+    }
+  }
+  VLOG(1) << tiled_count << " of " << op_count << " operators rerun on the "
+          << "changed region of " << inputs_.size() << " inputs";
+  running_ = false;
+
+  return AllocateOutputs();
+}
+
+MaceStatus IncrementalRunner::InitTileOperator(Operation *op,
+                                               OpState *state) {
+  const OperatorDef &op_def = op->debug_def();
+  const std::string &type = op_def.type();
+  if (op->runtime_type() != RuntimeType::RT_CPU || op->OutputSize() != 1 ||
+      op->InputSize() == 0 ||
+      op->GetOptionalArg<int>("T", static_cast<int>(DT_FLOAT)) != DT_FLOAT) {
+    return MaceStatus::MACE_SUCCESS;
+  }
+  const Tensor *output = op->Output(0);
+  if (output->dtype() != DT_FLOAT ||
+      output->memory_type() != MemoryType::CPU_BUFFER) {
+    return MaceStatus::MACE_SUCCESS;
+  }
+  for (int i = 0; i < op->InputSize(); ++i) {
+    const Tensor *input = op->Input(i);
+    if (input->memory_type() != MemoryType::CPU_BUFFER ||
+        (input->is_weight() && input->GetCurRuntime() != cpu_runtime_) ||
+        (!input->is_weight() && input->dtype() != DT_FLOAT)) {
+      return MaceStatus::MACE_SUCCESS;
+    }
+  }
+
+  OpKind kind = OTHER;
+  if (type == "Conv2D" || type == "DepthwiseConv2d" || type == "Pooling") {
+    if (op->Input(0)->is_weight()) {
+      return MaceStatus::MACE_SUCCESS;
+    }
+    for (int i = 1; i < op->InputSize(); ++i) {
+      if (!op->Input(i)->is_weight()) {
+        return MaceStatus::MACE_SUCCESS;
+      }
+    }
+    const std::vector<int> strides = op->GetRepeatedArgs<int>("strides");
+    const std::vector<int> dilations =
+        op->GetRepeatedArgs<int>("dilations", {1, 1});
+    std::vector<int> kernels;
+    if (type == "Pooling") {
+      kernels = op->GetRepeatedArgs<int>("kernels");
+      const int pooling_type =
+          op->GetOptionalArg<int>("pooling_type", kAvgPooling);
+      state->max_pooling = pooling_type == kMaxPooling;
+      state->avg_pooling = pooling_type == kAvgPooling;
+      if (!state->max_pooling && !state->avg_pooling) {
+        return MaceStatus::MACE_SUCCESS;
+      }
+    } else if (op->InputSize() >= 2 && op->Input(1)->dim_size() == 4) {
+      kernels = {static_cast<int>(op->Input(1)->dim(2)),
+                 static_cast<int>(op->Input(1)->dim(3))};
+    }
+    state->paddings = op->GetRepeatedArgs<int>("padding_values");
+    if (strides.size() != 2 || dilations.size() != 2 || kernels.size() != 2 ||
+        (!state->paddings.empty() && state->paddings.size() != 2)) {
+      return MaceStatus::MACE_SUCCESS;
+    }
+    for (int i = 0; i < 2; ++i) {
+      state->kernels[i] = kernels[i];
+      state->strides[i] = strides[i];
+      state->dilations[i] = dilations[i];
+    }
+    kind = WINDOW;
+  } else if (type == "Activation" || type == "BiasAdd" ||
+      type == "BatchNorm" || type == "Eltwise") {
+    // the constant inputs hold one value per channel at most, a 1-D tensor
+    // of Eltwise may broadcast along W
+    for (int i = 0; i < op->InputSize(); ++i) {
+      const Tensor *input = op->Input(i);
+      if (input->is_weight() && input->size() != 1 &&
+          !(input->dim_size() == 4 && input->dim(2) == 1 &&
+              input->dim(3) == 1) &&
+          !(input->dim_size() == 1 && type != "Eltwise")) {
+        return MaceStatus::MACE_SUCCESS;
+      }
+    }
+    kind = ELEMENTWISE;
+  } else {
+    return MaceStatus::MACE_SUCCESS;
+  }
+
+  OperatorDef tile_def(op_def);
+  tile_def.clear_output_shape();
+  if (kind == WINDOW) {
+    // the crops carry the padding
+    auto *args = tile_def.mutable_arg();
+    for (int i = args->size() - 1; i >= 0; --i) {
+      if (args->Get(i).name() == "padding" ||
+          args->Get(i).name() == "padding_values") {
+        args->DeleteSubrange(i, 1);
+      }
+    }
+    Argument *padding = tile_def.add_arg();
+    padding->set_name("padding");
+    padding->set_i(kValidPadding);
+  }
+
+  state->tile_ws = make_unique<Workspace>(ws_->GetDelegatorRegistry(),
+                                          nullptr);
+  state->tile_inputs.assign(op->InputSize(), nullptr);
+  state->tile_capacities.assign(op->InputSize(), 0);
+  for (int i = 0; i < op->InputSize(); ++i) {
+    const Tensor *input = op->Input(i);
+    Tensor *tile = state->tile_ws->CreateTensor(
+        input->name(), cpu_runtime_, input->dtype(), input->is_weight(),
+        MemoryType::CPU_BUFFER);
+    tile->set_data_format(input->data_format());
+    if (input->is_weight()) {
+      tile->ReuseTensorBuffer(*input);
+      tile->Reshape(input->shape());
+    } else {
+      state->tile_inputs[i] = tile;
+    }
+  }
+  OpConstructContext construct_context(state->tile_ws.get());
+  construct_context.set_runtime(cpu_runtime_);
+  construct_context.set_operator_def(std::make_shared<OperatorDef>(tile_def));
+  state->tile_op = op_registry_->CreateOperation(&construct_context,
+                                                 RuntimeType::RT_CPU);
+  OpInitContext init_context(state->tile_ws.get());
+  init_context.set_runtime(cpu_runtime_);
+  MACE_RETURN_IF_ERROR(state->tile_op->Init(&init_context));
+  state->kind = kind;
+
+  return MaceStatus::MACE_SUCCESS;
+}
+
+MaceStatus IncrementalRunner::AllocateOutputs() {
+  std::vector<Tensor *> allocated;
+  for (auto &op : *operators_) {
+    for (int i = 0; i < op->OutputSize(); ++i) {
+      Tensor *output = op->Output(i);
+      auto data_format = ProtoArgHelper::GetOptionalArg<OperatorDef, int>(
+          op->debug_def(), "data_format", static_cast<int>(DataFormat::NONE));
+      output->set_data_format(static_cast<DataFormat>(data_format));
+      // the output takes the buffer of the input when running
+      if (op->ReuseTensorMapId(i) >= 0) {
+        continue;
+      }
+      const std::vector<index_t> max_shape = output->max_shape();
+      if (!max_shape.empty()) {
+        output->Reshape(max_shape);
+        MaceStatus status = output->GetCurRuntime()->AllocateBufferForTensor(
+            output, BufRentType::RENT_PRIVATE);
+        if (status != MaceStatus::MACE_SUCCESS) {
+          // leave the outputs to the memory planner of the net
+          for (Tensor *tensor : allocated) {
+            ReleasePrivateBuffer(tensor);
+          }
+          return status;
+        }
+        allocated.push_back(output);
+      }
+    }
+  }
+  return MaceStatus::MACE_SUCCESS;
+}
+
+IncrementalRunner::Region IncrementalRunner::DiffInput(InputState *input) {
+  const Tensor *tensor = input->tensor;
+  Tensor::MappingGuard guard(tensor);
+  const char *data = static_cast<const char *>(tensor->raw_data());
+  const size_t bytes = static_cast<size_t>(tensor->raw_size());
+  Region region = WholeRegion(tensor);
+  if (input->shape == tensor->shape() && input->data.size() == bytes) {
+    const char *prev = input->data.data();
+    if (tensor->dim_size() == 4 && tensor->dtype() == DT_FLOAT) {
+      const index_t height = tensor->dim(2);
+      const index_t width = tensor->dim(3);
+      const index_t rows = tensor->dim(0) * tensor->dim(1) * height;
+      const size_t pixel_bytes = sizeof(float);
+      const size_t row_bytes = width * pixel_bytes;
+      region = {0, 0, 0, 0};
+      for (index_t r = 0; r < rows; ++r) {
+        const char *row = data + r * row_bytes;
+        const char *prev_row = prev + r * row_bytes;
+        if (memcmp(row, prev_row, row_bytes) == 0) {
+          continue;
+        }
+        index_t left = 0;
+        while (memcmp(row + left * pixel_bytes, prev_row + left * pixel_bytes,
+                      pixel_bytes) == 0) {
+          ++left;
+        }
+        index_t right = width;
+        while (memcmp(row + (right - 1) * pixel_bytes,
+                      prev_row + (right - 1) * pixel_bytes,
+                      pixel_bytes) == 0) {
+          --right;
+        }
+        const index_t h = r % height;
+        region.Unite({h, h + 1, left, right});
+      }
+    } else if (memcmp(data, prev, bytes) == 0) {
+      region = {0, 0, 0, 0};
+    }
+  }
+  input->shape = tensor->shape();
+  input->data.assign(data, data + bytes);
+  return region;
+}
+
+void IncrementalRunner::BeginRun(const std::vector<bool> *plan) {
+  for (size_t i = 0; i < states_.size(); ++i) {
+    // An interrupted run leaves the outputs of the operators it did not
+    // reach, and the operators out of the plan miss the current inputs.
+    if (running_ || (plan != nullptr && !(*plan)[i])) {
+      states_[i].valid = false;
+    }
+  }
+  running_ = true;
+
+  dirty_.clear();
+  for (auto &input : inputs_) {
+    const Region region = DiffInput(&input);
+    if (!region.Empty()) {
+      VLOG(2) << "Input " << input.tensor->name() << " changed in rows ["
+              << region.top << ", " << region.bottom << "), columns ["
+              << region.left << ", " << region.right << ")";
+      dirty_[input.tensor] = region;
+    }
+  }
+}
+
+bool IncrementalRunner::PlanOperator(const size_t op_idx) {
+  Operation *op = (*operators_)[op_idx].get();
+  OpState &state = states_[op_idx];
+  Region dirty = {0, 0, 0, 0};
+  bool changed = false;
+  bool spatial = true;
+  for (int i = 0; i < op->InputSize(); ++i) {
+    auto iter = dirty_.find(op->Input(i));
+    if (iter != dirty_.end()) {
+      changed = true;
+      spatial = spatial && op->Input(i)->dim_size() == 4;
+      dirty.Unite(iter->second);
+    }
+  }
+  if (state.valid && !changed) {
+    return false;
+  }
+
+  state.full = true;
+  if (!state.valid || state.tile_op == nullptr || !spatial ||
+      !OutputRegion(op, dirty, &state)) {
+    return true;
+  }
+  if (state.region.Empty()) {
+    // the changed pixels are skipped by the strides
+    return false;
+  }
+  // a large region is cheaper to compute with the operator itself
+  const Tensor *output = op->Output(0);
+  state.full = 2 * state.region.Area() > output->dim(2) * output->dim(3);
+  return true;
+}
+
+bool IncrementalRunner::OutputRegion(Operation *op, const Region &dirty,
+                                     OpState *state) {
+  const Tensor *output = op->Output(0);
+  if (output->dim_size() != 4) {
+    return false;
+  }
+  if (state->kind == ELEMENTWISE) {
+    for (int i = 0; i < op->InputSize(); ++i) {
+      const Tensor *input = op->Input(i);
+      if (!input->is_weight() && input->shape() != output->shape()) {
+        return false;
+      }
+    }
+    state->region = dirty;
+    state->crop = dirty;
+    return true;
+  }
+
+  const Tensor *input = op->Input(0);
+  if (input->shape() != state->input_shape) {
+    return false;
+  }
+  index_t out_begin[2];
+  index_t out_end[2];
+  index_t crop_begin[2];
+  index_t crop_end[2];
+  const index_t dirty_begin[2] = {dirty.top, dirty.left};
+  const index_t dirty_end[2] = {dirty.bottom, dirty.right};
+  for (int i = 0; i < 2; ++i) {
+    const index_t in_size = input->dim(2 + i);
+    const index_t out_size = output->dim(2 + i);
+    const index_t stride = state->strides[i];
+    const index_t extent = (state->kernels[i] - 1) * state->dilations[i] + 1;
+    const index_t pad_size = state->paddings.empty() ?
+        std::max<index_t>(0, (out_size - 1) * stride + extent - in_size) :
+        state->paddings[i];
+    const index_t pad = pad_size / 2;
+    // the outputs whose window overlaps [dirty_begin, dirty_end)
+    const index_t first = dirty_begin[i] + pad - extent + 1;
+    out_begin[i] = first <= 0 ? 0 : (first + stride - 1) / stride;
+    out_end[i] = std::min(out_size, (dirty_end[i] - 1 + pad) / stride + 1);
+    crop_begin[i] = out_begin[i] * stride - pad;
+    crop_end[i] = (out_end[i] - 1) * stride - pad + extent;
+    // the padding is not averaged
+    if (state->avg_pooling && out_begin[i] < out_end[i] &&
+        (crop_begin[i] < 0 || crop_end[i] > in_size)) {
+      return false;
+    }
+  }
+  state->region = {out_begin[0], out_end[0], out_begin[1], out_end[1]};
+  state->crop = {crop_begin[0], crop_end[0], crop_begin[1], crop_end[1]};
+  return true;
+}
+
+MaceStatus IncrementalRunner::RunOperator(const size_t op_idx,
+                                          OpContext *context) {
+  Operation *op = (*operators_)[op_idx].get();
+  OpState &state = states_[op_idx];
+  state.valid = false;
+  if (state.full) {
+    MACE_RETURN_IF_ERROR(op->Forward(context));
+    for (int i = 0; i < op->OutputSize(); ++i) {
+      dirty_[op->Output(i)] = WholeRegion(op->Output(i));
+    }
+  } else {
+    const Region &region = state.region;
+    VLOG(2) << "Rerun " << op->debug_def().name() << " on rows ["
+            << region.top << ", " << region.bottom << "), columns ["
+            << region.left << ", " << region.right << ")";
+    MACE_RETURN_IF_ERROR(RunRegion(op, &state, context));
+    dirty_[op->Output(0)] = region;
+  }
+  if (state.kind == WINDOW) {
+    state.input_shape = op->Input(0)->shape();
+  }
+  state.valid = true;
+
+  return MaceStatus::MACE_SUCCESS;
+}
+
+MaceStatus IncrementalRunner::RunRegion(Operation *op, OpState *state,
+                                        OpContext *context) {
+  const Region &crop = state->crop;
+  // the padded pixels never win a max pooling
+  const float fill = state->max_pooling ?
+                     std::numeric_limits<float>::lowest() : 0.f;
+  for (size_t i = 0; i < state->tile_inputs.size(); ++i) {
+    Tensor *tile = state->tile_inputs[i];
+    if (tile == nullptr) {
+      continue;
+    }
+    const Tensor *input = op->Input(i);
+    MACE_RETURN_IF_ERROR(ResizeTile(
+        {input->dim(0), input->dim(1), crop.bottom - crop.top,
+         crop.right - crop.left}, &state->tile_capacities[i], tile));
+    CopyCrop(input, crop, fill, tile);
+  }
+
+  Tensor *output = op->Output(0);
+  Tensor *tile_output = state->tile_op->Output(0);
+  MACE_RETURN_IF_ERROR(ResizeTile(output->shape(),
+                                  &state->tile_output_capacity, tile_output));
+  MACE_RETURN_IF_ERROR(state->tile_op->Forward(context));
+  PasteRegion(tile_output, state->region, output);
+
+  return MaceStatus::MACE_SUCCESS;
+}
+
+void IncrementalRunner::EndRun() {
+  running_ = false;
+}
+
+}  // namespace mace
@@ -0,0 +1,151 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_CORE_NET_INCREMENTAL_RUNNER_H_
+#define MACE_CORE_NET_INCREMENTAL_RUNNER_H_
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "mace/core/ops/operator.h"
+#include "mace/core/workspace.h"
+
+namespace mace {
+
+class OpContext;
+class OpRegistry;
+
+// Runs a net on a stream of similar inputs, e.g. the frames of a video, by
+// recomputing only the part of each operator output which depends on the
+// input pixels changed since the previous run.
+//
+// The changed pixels of a 4-D (NCHW) net input are bounded by one box over H
+// and W. Convolutions and poolings grow the box by their receptive field and
+// element-wise operators pass it on, these operators rerun on a crop of their
+// inputs through a copy of the operator and paste the result into the output
+// of the previous run. The other operators rerun fully when one of their
+// inputs changed. Operators whose inputs did not change are skipped, so every
+// operator output is allocated privately to outlive the run.
+class IncrementalRunner {
+ public:
+  IncrementalRunner(const OpRegistry *op_registry,
+                    Workspace *ws,
+                    Runtime *cpu_runtime,
+                    const std::vector<std::unique_ptr<Operation>> *operators);
+  ~IncrementalRunner();
+
+  MaceStatus Init();
+
+  // Finds the pixels of the net inputs changed since the previous run. Only
+  // the operators flagged in `plan` run if it is not null.
+  void BeginRun(const std::vector<bool> *plan);
+  // Returns false if the outputs of operator `op_idx` are still up to date.
+  bool PlanOperator(const size_t op_idx);
+  // Recomputes the part of the outputs planned by PlanOperator.
+  MaceStatus RunOperator(const size_t op_idx, OpContext *context);
+  void EndRun();
+
+  // rows [top, bottom) and columns [left, right) of H and W in NCHW
+  struct Region {
+    index_t top;
+    index_t bottom;
+    index_t left;
+    index_t right;
+
+    bool Empty() const {
+      return top >= bottom || left >= right;
+    }
+    index_t Area() const {
+      return Empty() ? 0 : (bottom - top) * (right - left);
+    }
+    void Unite(const Region &other) {
+      if (other.Empty()) {
+        return;
+      }
+      if (Empty()) {
+        *this = other;
+        return;
+      }
+      top = std::min(top, other.top);
+      bottom = std::max(bottom, other.bottom);
+      left = std::min(left, other.left);
+      right = std::max(right, other.right);
+    }
+  };
+
+ private:
+  enum OpKind {
+    OTHER,
+    ELEMENTWISE,
+    WINDOW,
+  };
+  struct OpState {
+    OpKind kind;
+    // WINDOW only
+    int kernels[2];
+    int strides[2];
+    int dilations[2];
+    std::vector<int> paddings;
+    bool max_pooling;
+    bool avg_pooling;
+    std::vector<index_t> input_shape;
+
+    // the copy of the operator running on crops of the inputs, bound to the
+    // tensors of its own workspace
+    std::unique_ptr<Workspace> tile_ws;
+    std::unique_ptr<Operation> tile_op;
+    // null for the constant inputs shared with the operator
+    std::vector<Tensor *> tile_inputs;
+    std::vector<index_t> tile_capacities;
+    index_t tile_output_capacity;
+
+    // the outputs are those of the current inputs
+    bool valid;
+    bool full;
+    Region region;
+    Region crop;
+  };
+  struct InputState {
+    const Tensor *tensor;
+    std::vector<index_t> shape;
+    std::vector<char> data;
+  };
+
+  MaceStatus AllocateOutputs();
+  MaceStatus InitTileOperator(Operation *op, OpState *state);
+  bool OutputRegion(Operation *op, const Region &dirty,
+                    OpState *state);
+  MaceStatus RunRegion(Operation *op, OpState *state, OpContext *context);
+  Region DiffInput(InputState *input);
+
+ private:
+  const OpRegistry *op_registry_;
+  Workspace *ws_;
+  Runtime *cpu_runtime_;
+  const std::vector<std::unique_ptr<Operation>> *operators_;
+  std::vector<OpState> states_;
+  std::vector<InputState> inputs_;
+  // the changed region of the tensors written in the current run
+  std::unordered_map<const Tensor *, Region> dirty_;
+  // the previous run was interrupted
+  bool running_;
+
+  MACE_DISABLE_COPY_AND_ASSIGN(IncrementalRunner);
+};
+
+}  // namespace mace
+
+#endif  // MACE_CORE_NET_INCREMENTAL_RUNNER_H_
@@ -15,6 +15,7 @@
 #include "mace/core/net/serial_net.h"
 
 #include <algorithm>
+#include <cstring>
 #include <limits>
 #include <set>
 #include <unordered_set>
@@ -43,9 +44,14 @@ SerialNet::SerialNet(const OpRegistry *op_registry,
                      Runtime *target_runtime,
                      Runtime *cpu_runtime)
     : BaseNet(),
+      op_registry_(op_registry),
       ws_(ws),
       target_runtime_(target_runtime),
-      cpu_runtime_(cpu_runtime) {
+      cpu_runtime_(cpu_runtime),
+      reuse_results_(false),
+      reuse_version_(0),
+      incremental_run_(false),
+      calibration_observer_(CalibrationObserver::CreateFromEnv()) {
   MACE_LATENCY_LOGGER(1, "Constructing SerialNet");
 
   OpConstructContext construct_context(ws_);
@@ -88,12 +94,309 @@ MaceStatus SerialNet::Init() {
     MACE_RETURN_IF_ERROR(op->Init(&init_context));
   }
 
-  MACE_RETURN_IF_ERROR(AllocateTensorMemory<SERIAL_OPT>(operators_));
+  MACE_RETURN_IF_ERROR(FoldConstantOperators());
+  if (incremental_run_) {
+    incremental_runner_ = make_unique<IncrementalRunner>(
+        op_registry_, ws_, cpu_runtime_, &operators_);
+    MaceStatus init_status = incremental_runner_->Init();
+    if (init_status == MaceStatus::MACE_OUT_OF_RESOURCES) {
+      // keeping every output does not fit in the memory budget, share the
+      // planned buffers instead
+      LOG(WARNING) << "Not enough memory for the incremental run, "
+                   << "run the whole net instead";
+      incremental_runner_.reset();
+      incremental_run_ = false;
+    } else {
+      MACE_RETURN_IF_ERROR(init_status);
+    }
+  }
+  if (!incremental_run_) {
+    MACE_RETURN_IF_ERROR(AllocateTensorMemory<SERIAL_OPT>(operators_));
+    InitResultReuse();
+  }
 
   return MaceStatus::MACE_SUCCESS;
 }
 
+MaceStatus SerialNet::FoldConstantOperators() {
+  MACE_LATENCY_LOGGER(1, "Folding constant operators");
+  OpContext context(ws_, cpu_runtime_);
+  std::vector<std::unique_ptr<Operation>> remaining;
+  remaining.reserve(operators_.size());
+  for (auto &op : operators_) {
+    bool foldable = op->runtime_type() == RuntimeType::RT_CPU &&
+        op->InputSize() > 0 && op->OutputSize() > 0;
+    for (int i = 0; foldable && i < op->InputSize(); ++i) {
+      foldable = op->Input(i)->is_weight();
+    }
+    for (int i = 0; foldable && i < op->OutputSize(); ++i) {
+      const Tensor *output = op->Output(i);
+      foldable = !output->is_weight() &&
+          output->memory_type() == MemoryType::CPU_BUFFER;
+    }
+    if (!foldable) {
+      remaining.emplace_back(std::move(op));
+      continue;
+    }
+
+    // the outputs live as long as the net, as the other weights do
+    for (int i = 0; i < op->OutputSize(); ++i) {
+      Tensor *output = op->Output(i);
+      const std::vector<index_t> max_shape = output->max_shape();
+      if (!max_shape.empty()) {
+        output->Reshape(max_shape);
+        MACE_RETURN_IF_ERROR(output->GetCurRuntime()->AllocateBufferForTensor(
+            output, BufRentType::RENT_PRIVATE));
+      }
+    }
+    VLOG(1) << "Fold constant operator " << op->debug_def().name() << "<"
+            << op->debug_def().type() << ">";
+    context.set_runtime(cpu_runtime_);
+    MACE_RETURN_IF_ERROR(op->Forward(&context));
+    for (int i = 0; i < op->OutputSize(); ++i) {
+      op->Output(i)->SetIsWeight(true);
+    }
+  }
+
+  VLOG(1) << "Folded " << operators_.size() - remaining.size() << " of "
+          << operators_.size() << " operators";
+  operators_.swap(remaining);
+  return MaceStatus::MACE_SUCCESS;
+}
+
 MaceStatus SerialNet::Run(RunMetadata *run_metadata) {
+  return RunOperators(nullptr, run_metadata);
+}
+
+MaceStatus SerialNet::RunPartial(const std::vector<std::string> &output_names,
+                                 RunMetadata *run_metadata) {
+  std::vector<std::string> sorted_names(output_names);
+  std::sort(sorted_names.begin(), sorted_names.end());
+  const std::string key = MakeString(sorted_names);
+  auto iter = run_plans_.find(key);
+  if (iter == run_plans_.end()) {
+    iter = run_plans_.emplace(key, BuildRunPlan(sorted_names)).first;
+  }
+  return RunOperators(&iter->second, run_metadata);
+}
+
+std::vector<bool> SerialNet::BuildRunPlan(
+    const std::vector<std::string> &output_names) const {
+  std::unordered_set<std::string> needed(output_names.begin(),
+                                         output_names.end());
+  const size_t op_count = operators_.size();
+  std::vector<bool> plan(op_count, false);
+  size_t planned_count = 0;
+  for (size_t i = op_count; i > 0; --i) {
+    const OperatorDef &op_def = operators_[i - 1]->debug_def();
+    bool is_needed = false;
+    for (const auto &output : op_def.output()) {
+      if (needed.count(output) > 0) {
+        is_needed = true;
+        break;
+      }
+    }
+    if (is_needed) {
+      plan[i - 1] = true;
+      ++planned_count;
+      needed.insert(op_def.input().begin(), op_def.input().end());
+    }
+  }
+  VLOG(1) << "Run plan for " << MakeString(output_names) << " executes "
+          << planned_count << " of " << op_count << " operators";
+  return plan;
+}
+
+void SerialNet::EnableResultReuse() {
+  reuse_results_ = true;
+}
+
+void SerialNet::EnableIncrementalRun() {
+  incremental_run_ = true;
+}
+
+void SerialNet::InitResultReuse() {
+  reuse_inputs_.clear();
+  reuse_states_.clear();
+  if (!reuse_results_) {
+    return;
+  }
+
+  const size_t op_count = operators_.size();
+  std::vector<OpReuseState> states(op_count);
+  std::vector<bool> cpu_inputs;
+  std::unordered_map<std::string, size_t> producers;
+  std::unordered_map<std::string, int> input_ids;
+  std::unordered_set<std::string> consumed;
+  for (size_t i = 0; i < op_count; ++i) {
+    auto &op = operators_[i];
+    OpReuseState &state = states[i];
+    bool cpu_only = op->runtime_type() == RuntimeType::RT_CPU;
+    std::set<int> inputs;
+    for (int j = 0; j < op->InputSize(); ++j) {
+      const Tensor *input = op->Input(j);
+      if (input->is_weight()) {
+        continue;
+      }
+      consumed.insert(input->name());
+      auto producer = producers.find(input->name());
+      if (producer != producers.end()) {
+        OpReuseState &producer_state = states[producer->second];
+        inputs.insert(producer_state.inputs.begin(),
+                      producer_state.inputs.end());
+        producer_state.consumers.push_back(i);
+        continue;
+      }
+      auto id = input_ids.emplace(input->name(),
+                                  static_cast<int>(reuse_inputs_.size()));
+      if (id.second) {
+        reuse_inputs_.push_back(input);
+        cpu_inputs.push_back(input->memory_type() == MemoryType::CPU_BUFFER);
+      }
+      inputs.insert(id.first->second);
+    }
+    for (int j = 0; j < op->OutputSize(); ++j) {
+      cpu_only = cpu_only &&
+          op->Output(j)->memory_type() == MemoryType::CPU_BUFFER;
+      producers[op->Output(j)->name()] = i;
+    }
+    for (int input : inputs) {
+      cpu_only = cpu_only && cpu_inputs[input];
+    }
+    state.inputs.assign(inputs.begin(), inputs.end());
+    state.reusable = cpu_only && op->OutputSize() > 0;
+    state.valid = false;
+    state.key = 0;
+  }
+
+  // with a single input the whole net reruns or not
+  const size_t input_count = reuse_inputs_.size();
+  if (input_count < 2) {
+    reuse_inputs_.clear();
+    return;
+  }
+  size_t reusable_count = 0;
+  for (size_t i = 0; i < op_count; ++i) {
+    OpReuseState &state = states[i];
+    state.reusable = state.reusable && state.inputs.size() < input_count;
+    if (!state.reusable) {
+      continue;
+    }
+    ++reusable_count;
+    state.keep_outputs = false;
+    for (int j = 0; j < operators_[i]->OutputSize(); ++j) {
+      state.keep_outputs = state.keep_outputs ||
+          consumed.count(operators_[i]->Output(j)->name()) == 0;
+    }
+    for (size_t consumer : state.consumers) {
+      state.keep_outputs = state.keep_outputs || !states[consumer].reusable ||
+          states[consumer].inputs.size() > state.inputs.size();
+    }
+  }
+  VLOG(1) << reusable_count << " of " << op_count << " operators depend on "
+          << "a part of the " << input_count << " inputs and are reusable";
+  reuse_states_.swap(states);
+  reuse_keys_.resize(op_count);
+  reuse_input_copies_.resize(input_count);
+  reuse_input_versions_.assign(input_count, 0);
+}
+
+void SerialNet::PrepareResultReuse(const std::vector<bool> *plan,
+                                   std::vector<bool> *skip) {
+  // An input which differs from its copy of the previous run gets a new
+  // version, larger than all the ones before.
+  for (size_t i = 0; i < reuse_inputs_.size(); ++i) {
+    const Tensor *input = reuse_inputs_[i];
+    Tensor::MappingGuard guard(input);
+    const char *data = static_cast<const char *>(input->raw_data());
+    const size_t size = static_cast<size_t>(input->raw_size());
+    KeptTensor &copy = reuse_input_copies_[i];
+    if (reuse_input_versions_[i] > 0 && copy.shape == input->shape() &&
+        copy.data.size() == size &&
+        std::memcmp(copy.data.data(), data, size) == 0) {
+      continue;
+    }
+    copy.shape = input->shape();
+    copy.data.assign(data, data + size);
+    reuse_input_versions_[i] = ++reuse_version_;
+  }
+
+  const size_t op_count = operators_.size();
+  skip->assign(op_count, false);
+  for (size_t i = 0; i < op_count; ++i) {
+    const OpReuseState &state = reuse_states_[i];
+    if (!state.reusable) {
+      continue;
+    }
+    // the latest version grows whenever any of the inputs changes
+    uint64_t key = 0;
+    for (int input : state.inputs) {
+      key = std::max(key, reuse_input_versions_[input]);
+    }
+    reuse_keys_[i] = key;
+    (*skip)[i] = state.valid && state.key == key &&
+        (plan == nullptr || (*plan)[i]);
+  }
+  // An operator whose outputs are not kept has to rerun for its consumers.
+  for (size_t i = op_count; i > 0; --i) {
+    const OpReuseState &state = reuse_states_[i - 1];
+    if (!(*skip)[i - 1] || state.keep_outputs) {
+      continue;
+    }
+    for (size_t consumer : state.consumers) {
+      if ((plan == nullptr || (*plan)[consumer]) && !(*skip)[consumer]) {
+        (*skip)[i - 1] = false;
+        break;
+      }
+    }
+  }
+}
+
+void SerialNet::KeepResult(const size_t op_idx) {
+  OpReuseState &state = reuse_states_[op_idx];
+  if (!state.reusable) {
+    return;
+  }
+  const uint64_t key = reuse_keys_[op_idx];
+  if (state.keep_outputs && !(state.valid && state.key == key)) {
+    auto &op = operators_[op_idx];
+    state.outputs.resize(op->OutputSize());
+    for (int i = 0; i < op->OutputSize(); ++i) {
+      const Tensor *output = op->Output(i);
+      KeptTensor &kept = state.outputs[i];
+      Tensor::MappingGuard guard(output);
+      const char *data = static_cast<const char *>(output->raw_data());
+      kept.shape = output->shape();
+      kept.data.assign(data, data + output->raw_size());
+      kept.scale = output->scale();
+      kept.zero_point = output->zero_point();
+    }
+  }
+  state.valid = true;
+  state.key = key;
+}
+
+MaceStatus SerialNet::RestoreResult(const size_t op_idx) {
+  const OpReuseState &state = reuse_states_[op_idx];
+  if (!state.keep_outputs) {
+    return MaceStatus::MACE_SUCCESS;
+  }
+  auto &op = operators_[op_idx];
+  for (int i = 0; i < op->OutputSize(); ++i) {
+    Tensor *output = op->Output(i);
+    const KeptTensor &kept = state.outputs[i];
+    MACE_RETURN_IF_ERROR(output->Resize(kept.shape));
+    Tensor::MappingGuard guard(output);
+    std::memcpy(output->raw_mutable_data(), kept.data.data(),
+                kept.data.size());
+    output->SetScale(kept.scale);
+    output->SetZeroPoint(kept.zero_point);
+  }
+  return MaceStatus::MACE_SUCCESS;
+}
+
+MaceStatus SerialNet::RunOperators(const std::vector<bool> *plan,
+                                   RunMetadata *run_metadata) {
   const char *profiling = getenv("MACE_OPENCL_PROFILING");
   bool enable_opencl_profiling =
       profiling != nullptr && strlen(profiling) == 1 && profiling[0] == '1';
@@ -101,8 +404,33 @@ MaceStatus SerialNet::Run(RunMetadata *run_metadata) {
   MACE_MEMORY_LOGGING_GUARD();
   MACE_LATENCY_LOGGER(1, "Running net");
   OpContext context(ws_, cpu_runtime_);
-  for (auto iter = operators_.begin(); iter != operators_.end(); ++iter) {
-    auto &op = *iter;
+  std::vector<bool> skip;
+  if (!reuse_inputs_.empty()) {
+    PrepareResultReuse(plan, &skip);
+  }
+  if (incremental_runner_ != nullptr) {
+    incremental_runner_->BeginRun(plan);
+  }
+  for (size_t op_idx = 0; op_idx < operators_.size(); ++op_idx) {
+    if (plan != nullptr && !(*plan)[op_idx]) {
+      continue;
+    }
+    auto &op = operators_[op_idx];
+    if (run_interrupter_ && run_interrupter_()) {
+      VLOG(1) << "Net run interrupted before " << op->debug_def().name();
+      return MaceStatus::MACE_CANCELLED;
+    }
+    if (!skip.empty() && skip[op_idx]) {
+      VLOG(2) << "Reuse the outputs of " << op->debug_def().name();
+      MACE_RETURN_IF_ERROR(RestoreResult(op_idx));
+      continue;
+    }
+    if (incremental_runner_ != nullptr &&
+        !incremental_runner_->PlanOperator(op_idx)) {
+      VLOG(2) << "The outputs of " << op->debug_def().name()
+              << " did not change";
+      continue;
+    }
     RuntimeType runtime_type = op->runtime_type();
     MACE_LATENCY_LOGGER(1, "Running operator ", op->debug_def().name(),
                         "<", runtime_type, ", ", op->debug_def().type(),
@@ -118,18 +446,18 @@ MaceStatus SerialNet::Run(RunMetadata *run_metadata) {
 
     CallStats call_stats;
     if (run_metadata == nullptr) {
-      MACE_RETURN_IF_ERROR(op->Forward(&context));
+      MACE_RETURN_IF_ERROR(ForwardOperator(op_idx, &context));
     } else {
       if (runtime_type == RuntimeType::RT_CPU
           || (runtime_type == RuntimeType::RT_OPENCL
               && !enable_opencl_profiling)) {
         call_stats.start_micros = NowMicros();
-        MACE_RETURN_IF_ERROR(op->Forward(&context));
+        MACE_RETURN_IF_ERROR(ForwardOperator(op_idx, &context));
         call_stats.end_micros = NowMicros();
       } else if (runtime_type == RuntimeType::RT_OPENCL) {
         StatsFuture future;
         context.set_future(&future);
-        MACE_RETURN_IF_ERROR(op->Forward(&context));
+        MACE_RETURN_IF_ERROR(ForwardOperator(op_idx, &context));
         future.wait_fn(&call_stats);
       }
 
@@ -175,10 +503,21 @@ MaceStatus SerialNet::Run(RunMetadata *run_metadata) {
                                  kernels}, call_stats};
       run_metadata->op_stats.emplace_back(op_stats);
     }
+    if (!reuse_inputs_.empty()) {
+      KeepResult(op_idx);
+    }
 
     VLOG(3) << "Operator " << op->debug_def().name()
             << " has shape: " << MakeString(op->Output(0)->shape());
 
+    if (calibration_observer_ != nullptr &&
+        op->debug_def().quantize_info_size() == 0) {
+      for (int i = 0; i < op->OutputSize(); ++i) {
+        calibration_observer_->Observe(op->debug_def().output(i),
+                                       op->Output(i));
+      }
+    }
+
     if (EnvConfEnabled("MACE_LOG_TENSOR_RANGE")) {
       for (int i = 0; i < op->OutputSize(); ++i) {
         if (op->debug_def().quantize_info_size() == 0) {
@@ -220,12 +559,31 @@ MaceStatus SerialNet::Run(RunMetadata *run_metadata) {
       }
     }
   }
+  if (incremental_runner_ != nullptr) {
+    incremental_runner_->EndRun();
+  }
 
   return MaceStatus::MACE_SUCCESS;
 }
 
+MaceStatus SerialNet::ForwardOperator(const size_t op_idx,
+                                      OpContext *context) {
+  if (incremental_runner_ != nullptr) {
+    return incremental_runner_->RunOperator(op_idx, context);
+  }
+  return operators_[op_idx]->Forward(context);
+}
+
 MaceStatus SerialNet::AllocateIntermediateBuffer() {
+  // the outputs of the incremental run are private
+  if (incremental_runner_ != nullptr) {
+    return MaceStatus::MACE_SUCCESS;
+  }
   MACE_RETURN_IF_ERROR(AllocateTensorMemory<SERIAL_OPT>(operators_));
+  // the outputs which are not kept were in the released buffers
+  for (auto &state : reuse_states_) {
+    state.valid = state.valid && state.keep_outputs;
+  }
   return MaceStatus::MACE_SUCCESS;
 }
 
@@ -23,6 +23,8 @@
 
 #include "mace/core/ops/operator.h"
 #include "mace/core/net/base_net.h"
+#include "mace/core/net/calibration_observer.h"
+#include "mace/core/net/incremental_runner.h"
 
 namespace mace {
 
@@ -42,14 +44,86 @@ class SerialNet : public BaseNet {
 
   MaceStatus Run(RunMetadata *run_metadata = nullptr) override;
 
+  MaceStatus RunPartial(const std::vector<std::string> &output_names,
+                        RunMetadata *run_metadata = nullptr) override;
+
   MaceStatus AllocateIntermediateBuffer() override;
 
+  // Only the CPU operators depending on a part of the net inputs are
+  // skipped, the whole net depending on all of them is left to the caller.
+  void EnableResultReuse() override;
+
+  // Supersedes the result reuse, all the operator outputs are kept.
+  void EnableIncrementalRun() override;
+
+ protected:
+  // Runs the CPU operators whose inputs are all constant once and turns
+  // their outputs into constants, so that they are not run again.
+  MaceStatus FoldConstantOperators();
+  // Runs the operators whose flag in `plan` is set, or all of them if `plan`
+  // is null.
+  MaceStatus RunOperators(const std::vector<bool> *plan,
+                          RunMetadata *run_metadata);
+  // Runs operator `op_idx` or the part of it the changed inputs affect.
+  MaceStatus ForwardOperator(const size_t op_idx, OpContext *context);
+  // Flags the operators the outputs depend on by backward reachability.
+  std::vector<bool> BuildRunPlan(
+      const std::vector<std::string> &output_names) const;
+  // Finds the net inputs every operator depends on.
+  void InitResultReuse();
+  // Flags in `skip` the operators of `plan` whose inputs did not change
+  // since they last ran.
+  void PrepareResultReuse(const std::vector<bool> *plan,
+                          std::vector<bool> *skip);
+  // Records the outputs operator `op_idx` just computed.
+  void KeepResult(const size_t op_idx);
+  // Writes the recorded outputs of skipped operator `op_idx` back.
+  MaceStatus RestoreResult(const size_t op_idx);
+
+ protected:
+  struct KeptTensor {
+    std::vector<index_t> shape;
+    std::vector<char> data;
+    float scale;
+    int32_t zero_point;
+  };
+  struct OpReuseState {
+    // indices into reuse_inputs_ of the net inputs the operator depends on
+    std::vector<int> inputs;
+    // the operators reading its outputs
+    std::vector<size_t> consumers;
+    bool reusable;
+    // Keep a copy of the outputs for the consumers running while the
+    // operator is skipped, the outputs are in shared memory.
+    bool keep_outputs;
+    // the outputs are those of the inputs whose latest version is `key`
+    bool valid;
+    uint64_t key;
+    std::vector<KeptTensor> outputs;
+  };
+
  protected:
+  const OpRegistry *op_registry_;
   Workspace *ws_;
   Runtime *target_runtime_;
   // CPU is base device.
   Runtime *cpu_runtime_;
   std::vector<std::unique_ptr<Operation>> operators_;
+  // run plans keyed by the sorted requested output names
+  std::unordered_map<std::string, std::vector<bool>> run_plans_;
+  bool reuse_results_;
+  // empty unless results are reused
+  std::vector<const Tensor *> reuse_inputs_;
+  std::vector<OpReuseState> reuse_states_;
+  std::vector<uint64_t> reuse_keys_;
+  // the inputs of the previous run and the version they got
+  std::vector<KeptTensor> reuse_input_copies_;
+  std::vector<uint64_t> reuse_input_versions_;
+  uint64_t reuse_version_;
+  bool incremental_run_;
+  std::unique_ptr<IncrementalRunner> incremental_runner_;
+  // null unless MACE_CALIBRATION_FILE is set
+  std::shared_ptr<CalibrationObserver> calibration_observer_;
 
  protected:
   MACE_DISABLE_COPY_AND_ASSIGN(SerialNet);
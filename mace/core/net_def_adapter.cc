@@ -338,6 +338,13 @@ MaceStatus NetDefAdapter::AdaptNetDef(const NetDef *net_def,
     }
   }
 
+  const int op_size = target_net_def->op_size();
+  const int removed = net_optimizer_.EliminateRedundantOps(target_net_def);
+  VLOG(1) << "Removed " << removed << " of " << op_size
+          << " operators after adapting";
+  const int fused = net_optimizer_.FuseInputQuantize(target_net_def);
+  VLOG(1) << "Fused " << fused << " quantize operators";
+
   VLOG(3) << DebugString(target_net_def);
   return MaceStatus::MACE_SUCCESS;
 }
@@ -61,6 +61,8 @@ class NetDefAdapter {
   //                       and add transpose if necessary.
   // 4. Adapt memory type: Add BufferTransform if necessary
   //                       for transforming memory type between ops.
+  // 5. Remove redundant ops: merge duplicated ops, cancel inverse
+  //                          transposes and drop dead ops.
   MaceStatus AdaptNetDef(const NetDef *net_def,
                          Runtime *target_runtime,
                          Runtime *cpu_runtime,
@@ -15,9 +15,69 @@
 #include "mace/core/net_optimizer.h"
 
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "mace/core/proto/arg_helper.h"
+#include "mace/utils/logging.h"
 
 namespace mace {
 
+namespace {
+// Everything but the op name and outputs, two ops with the same signature
+// compute the same outputs.
+std::string OpSignature(const OperatorDef &op_def) {
+  OperatorDef signature(op_def);
+  signature.clear_name();
+  signature.clear_output();
+  signature.clear_mem_id();
+  return signature.SerializeAsString();
+}
+
+bool IsCpuTranspose(const OperatorDef &op_def) {
+  return op_def.type() == "Transpose" && op_def.input_size() == 1 &&
+      op_def.output_size() == 1 &&
+      op_def.device_type() == static_cast<int>(RuntimeType::RT_CPU);
+}
+
+// Whether `second` transposes the output of `first` back.
+bool IsInverseTranspose(const OperatorDef &first, const OperatorDef &second) {
+  auto first_dims =
+      ProtoArgHelper::GetRepeatedArgs<OperatorDef, int>(first, "dims");
+  auto second_dims =
+      ProtoArgHelper::GetRepeatedArgs<OperatorDef, int>(second, "dims");
+  if (first_dims.size() != second_dims.size() ||
+      ProtoArgHelper::GetOptionalArg<OperatorDef, int>(first, "T", DT_FLOAT)
+          != ProtoArgHelper::GetOptionalArg<OperatorDef, int>(
+              second, "T", DT_FLOAT)) {
+    return false;
+  }
+  const int rank = static_cast<int>(first_dims.size());
+  for (int i = 0; i < rank; ++i) {
+    if (second_dims[i] < 0 || second_dims[i] >= rank ||
+        first_dims[second_dims[i]] != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsCpuUint8Op(const OperatorDef &op_def) {
+  return op_def.device_type() == static_cast<int>(RuntimeType::RT_CPU) &&
+      ProtoArgHelper::GetOptionalArg<OperatorDef, int>(
+          op_def, "T", DT_FLOAT) == DT_UINT8;
+}
+
+Argument *MutableArg(OperatorDef *op_def, const std::string &arg_name) {
+  for (auto &arg : *op_def->mutable_arg()) {
+    if (arg.name() == arg_name) return &arg;
+  }
+  auto *arg = op_def->add_arg();
+  arg->set_name(arg_name);
+  return arg;
+}
+}  // namespace
+
 RuntimeType NetOptimizer::SelectBestRuntime(
     const OperatorDef *op_def,
     RuntimeType target_runtime_type,
@@ -47,4 +107,171 @@ RuntimeType NetOptimizer::SelectBestRuntime(
   }
   return RuntimeType::RT_CPU;
 }
+
+int NetOptimizer::EliminateRedundantOps(NetDef *net_def) {
+  std::unordered_set<std::string> net_outputs;
+  for (auto &output_info : net_def->output_info()) {
+    net_outputs.insert(output_info.name());
+  }
+  auto is_net_output = [&net_outputs](const OperatorDef &op_def) -> bool {
+    for (auto &output : op_def.output()) {
+      if (net_outputs.count(output) > 0) return true;
+    }
+    return false;
+  };
+
+  // Forward: redirect the consumers of merged and bypassed ops.
+  const int op_size = net_def->op_size();
+  std::vector<bool> removed(op_size, false);
+  std::unordered_map<std::string, std::string> renamed;
+  std::unordered_map<std::string, int> producers;
+  std::unordered_map<std::string, int> signatures;
+  for (int idx = 0; idx < op_size; ++idx) {
+    OperatorDef *op_def = net_def->mutable_op(idx);
+    for (int i = 0; i < op_def->input_size(); ++i) {
+      auto iter = renamed.find(op_def->input(i));
+      if (iter != renamed.end()) {
+        op_def->set_input(i, iter->second);
+      }
+    }
+    if (op_def->input_size() == 0 || is_net_output(*op_def)) {
+      continue;
+    }
+
+    if (IsCpuTranspose(*op_def)) {
+      auto producer = producers.find(op_def->input(0));
+      if (producer != producers.end()) {
+        const OperatorDef &first = net_def->op(producer->second);
+        if (IsCpuTranspose(first) && IsInverseTranspose(first, *op_def)) {
+          renamed[op_def->output(0)] = first.input(0);
+          removed[idx] = true;
+          continue;
+        }
+      }
+    }
+
+    auto signature = signatures.emplace(OpSignature(*op_def), idx);
+    if (!signature.second) {
+      const OperatorDef &origin = net_def->op(signature.first->second);
+      for (int i = 0; i < op_def->output_size(); ++i) {
+        renamed[op_def->output(i)] = origin.output(i);
+      }
+      removed[idx] = true;
+      continue;
+    }
+    for (auto &output : op_def->output()) {
+      producers[output] = idx;
+    }
+  }
+
+  // Backward: keep the ops the net outputs depend on, a net without
+  // output_info is taken as is.
+  if (!net_outputs.empty()) {
+    std::unordered_set<std::string> live(net_outputs);
+    for (int idx = op_size - 1; idx >= 0; --idx) {
+      if (removed[idx]) continue;
+      const OperatorDef &op_def = net_def->op(idx);
+      bool is_live = op_def.output_size() == 0;
+      for (auto &output : op_def.output()) {
+        is_live = is_live || live.count(output) > 0;
+      }
+      if (is_live) {
+        live.insert(op_def.input().begin(), op_def.input().end());
+      } else {
+        removed[idx] = true;
+      }
+    }
+  }
+
+  int kept = 0;
+  auto *ops = net_def->mutable_op();
+  for (int idx = 0; idx < op_size; ++idx) {
+    if (removed[idx]) {
+      VLOG(2) << "Remove redundant op " << ops->Get(idx).name() << "<"
+              << ops->Get(idx).type() << ">";
+    } else {
+      if (kept != idx) ops->SwapElements(kept, idx);
+      ++kept;
+    }
+  }
+  ops->DeleteSubrange(kept, op_size - kept);
+  return op_size - kept;
+}
+
+int NetOptimizer::FuseInputQuantize(NetDef *net_def) {
+  static const std::set<std::string> kFusibleOps = {
+      "Conv2D", "FullyConnected", "Eltwise"
+  };
+  std::unordered_set<std::string> net_outputs;
+  for (auto &output_info : net_def->output_info()) {
+    net_outputs.insert(output_info.name());
+  }
+  std::unordered_map<std::string, int> input_counts;
+  for (auto &op_def : net_def->op()) {
+    for (auto &input : op_def.input()) {
+      ++input_counts[input];
+    }
+  }
+
+  const int op_size = net_def->op_size();
+  std::vector<bool> removed(op_size, false);
+  std::unordered_map<std::string, int> quantizes;
+  for (int idx = 0; idx < op_size; ++idx) {
+    const OperatorDef &op_def = net_def->op(idx);
+    if (op_def.type() == "Quantize" && op_def.input_size() == 1 &&
+        op_def.output_size() == 1 && IsCpuUint8Op(op_def) &&
+        net_outputs.count(op_def.output(0)) == 0 &&
+        input_counts[op_def.output(0)] == 1) {
+      quantizes[op_def.output(0)] = idx;
+    }
+  }
+  if (quantizes.empty()) {
+    return 0;
+  }
+
+  int fused = 0;
+  for (int idx = 0; idx < op_size; ++idx) {
+    OperatorDef *op_def = net_def->mutable_op(idx);
+    if (kFusibleOps.count(op_def->type()) == 0 || !IsCpuUint8Op(*op_def)) {
+      continue;
+    }
+    for (int i = 0; i < op_def->input_size(); ++i) {
+      auto iter = quantizes.find(op_def->input(i));
+      if (iter == quantizes.end()) continue;
+      const OperatorDef &quantize = net_def->op(iter->second);
+      float scale = 0.f;
+      int zero_point = 0;
+      if (quantize.quantize_info_size() > 0) {
+        scale = quantize.quantize_info(0).scale();
+        zero_point = quantize.quantize_info(0).zero_point();
+      }
+      MutableArg(op_def, "fused_quantize_inputs")->add_ints(i);
+      MutableArg(op_def, "fused_quantize_scales")->add_floats(scale);
+      MutableArg(op_def, "fused_quantize_zero_points")->add_ints(zero_point);
+      MutableArg(op_def, "fused_quantize_find_ranges")->add_ints(
+          ProtoArgHelper::GetOptionalArg<OperatorDef, int>(
+              quantize, "find_range_every_time", 0));
+      MutableArg(op_def, "fused_quantize_non_zeros")->add_ints(
+          ProtoArgHelper::GetOptionalArg<OperatorDef, int>(
+              quantize, "non_zero", 0));
+      op_def->set_input(i, quantize.input(0));
+      removed[iter->second] = true;
+      ++fused;
+    }
+  }
+
+  int kept = 0;
+  auto *ops = net_def->mutable_op();
+  for (int idx = 0; idx < op_size; ++idx) {
+    if (removed[idx]) {
+      VLOG(2) << "Fuse quantize op " << ops->Get(idx).name();
+    } else {
+      if (kept != idx) ops->SwapElements(kept, idx);
+      ++kept;
+    }
+  }
+  ops->DeleteSubrange(kept, op_size - kept);
+  return fused;
+}
+
 }  // namespace mace
@@ -43,6 +43,26 @@ class NetOptimizer {
       const OperatorDef *op_def, RuntimeType target_device,
       const std::set<RuntimeType> &available_devices,
       const std::vector<RuntimeType> &inputs_op_devices);
+
+  /// Remove the redundant ops left in an adapted net:
+  /// 1. Identical ops (same type, device, arguments and inputs) are merged
+  ///    into the first one.
+  /// 2. A CPU Transpose undoing the Transpose it reads from is bypassed.
+  /// 3. Ops not contributing to any output of the net are removed.
+  /// The outputs listed in output_info are kept as they are.
+  ///
+  /// \param net_def the net to optimize, its ops are in topological order
+  /// \return Number of ops removed
+  int EliminateRedundantOps(NetDef *net_def);
+
+  /// Fuse a CPU Quantize op into the quantized CPU op consuming its output
+  /// alone (Conv2D, FullyConnected or Eltwise), which then quantizes the
+  /// float input itself with ops::InputQuantizer. This saves the write and
+  /// the read back of the whole uint8 tensor.
+  ///
+  /// \param net_def the net to optimize, its ops are in topological order
+  /// \return Number of Quantize ops fused
+  int FuseInputQuantize(NetDef *net_def);
 };
 
 }  // namespace mace
@@ -20,6 +20,65 @@
 
 namespace mace {
 
+void FindMinMax(const float *input,
+                const index_t size,
+                float *min_val, float *max_val) {
+#if defined(MACE_ENABLE_X86_QUANTIZE)
+  const quantize_x86::QuantizeKernels *kernels =
+      quantize_x86::GetQuantizeKernels(quantize_x86::DetectIsa());
+  if (kernels != nullptr) {
+    kernels->find_min_max(input, size, min_val, max_val);
+    return;
+  }
+#endif  // MACE_ENABLE_X86_QUANTIZE
+  float max_v = std::numeric_limits<float>::lowest();
+  float min_v = std::numeric_limits<float>::max();
+  index_t i = 0;
+#if defined(MACE_ENABLE_NEON)
+  if (size >= 8) {
+    float32x4_t vmin0 = vld1q_f32(input);
+    float32x4_t vmax0 = vmin0;
+    float32x4_t vmin1 = vld1q_f32(input + 4);
+    float32x4_t vmax1 = vmin1;
+    for (i = 8; i + 8 <= size; i += 8) {
+      float32x4_t v0 = vld1q_f32(input + i);
+      float32x4_t v1 = vld1q_f32(input + i + 4);
+      vmin0 = vminq_f32(vmin0, v0);
+      vmax0 = vmaxq_f32(vmax0, v0);
+      vmin1 = vminq_f32(vmin1, v1);
+      vmax1 = vmaxq_f32(vmax1, v1);
+    }
+    float lanes[4];
+    vst1q_f32(lanes, vminq_f32(vmin0, vmin1));
+    min_v = std::min(std::min(lanes[0], lanes[1]),
+                     std::min(lanes[2], lanes[3]));
+    vst1q_f32(lanes, vmaxq_f32(vmax0, vmax1));
+    max_v = std::max(std::max(lanes[0], lanes[1]),
+                     std::max(lanes[2], lanes[3]));
+  }
+#else
+  // independent lanes the compiler vectorizes
+  if (size >= 4) {
+    float mins[4] = {input[0], input[1], input[2], input[3]};
+    float maxs[4] = {input[0], input[1], input[2], input[3]};
+    for (i = 4; i + 4 <= size; i += 4) {
+      for (int j = 0; j < 4; ++j) {
+        mins[j] = std::min(mins[j], input[i + j]);
+        maxs[j] = std::max(maxs[j], input[i + j]);
+      }
+    }
+    min_v = std::min(std::min(mins[0], mins[1]), std::min(mins[2], mins[3]));
+    max_v = std::max(std::max(maxs[0], maxs[1]), std::max(maxs[2], maxs[3]));
+  }
+#endif  // MACE_ENABLE_NEON
+  for (; i < size; ++i) {
+    max_v = std::max(max_v, input[i]);
+    min_v = std::min(min_v, input[i]);
+  }
+  *min_val = min_v;
+  *max_val = max_v;
+}
+
 #ifdef MACE_ENABLE_NEON
 
 template<>
@@ -125,6 +184,91 @@ void QuantizeUtil<float, int32_t>::Dequantize(const int *input,
     output[i] = scale * (input[i] - zero_point);
   }
 }
-#endif
+#elif defined(MACE_ENABLE_X86_QUANTIZE)
+
+namespace {
+// The number of values each parallel task gets at least.
+const index_t kX86BlockSize = 64;
+
+const quantize_x86::QuantizeKernels *X86Kernels() {
+  return quantize_x86::GetQuantizeKernels(quantize_x86::DetectIsa());
+}
+}  // namespace
+
+template<>
+void QuantizeUtil<float, uint8_t>::QuantizeWithScaleAndZeropoint(
+    const float *input,
+    const index_t size,
+    float scale,
+    int32_t zero_point,
+    uint8_t *output) {
+  const float recip_scale = 1.f / scale;
+  const quantize_x86::QuantizeKernels *kernels = X86Kernels();
+  const index_t block_count = (size + kX86BlockSize - 1) / kX86BlockSize;
+
+  thread_pool_->Compute1D([=](index_t start, index_t end, index_t step) {
+    MACE_UNUSED(step);
+    const index_t offset = start * kX86BlockSize;
+    const index_t count = std::min(end * kX86BlockSize, size) - offset;
+    if (kernels != nullptr) {
+      kernels->quantize_uint8(input + offset, count, recip_scale, zero_point,
+                              output + offset);
+      return;
+    }
+    for (index_t i = offset; i < offset + count; ++i) {
+      output[i] =
+          Saturate<uint8_t>(roundf(zero_point + recip_scale * input[i]));
+    }
+  }, 0, block_count, 1);
+}
+
+template<>
+void QuantizeUtil<float, uint8_t>::Dequantize(const uint8_t *input,
+                                              const index_t size,
+                                              const float scale,
+                                              const int32_t zero_point,
+                                              float *output) {
+  const quantize_x86::QuantizeKernels *kernels = X86Kernels();
+  const index_t block_count = (size + kX86BlockSize - 1) / kX86BlockSize;
+
+  thread_pool_->Compute1D([=](index_t start, index_t end, index_t step) {
+    MACE_UNUSED(step);
+    const index_t offset = start * kX86BlockSize;
+    const index_t count = std::min(end * kX86BlockSize, size) - offset;
+    if (kernels != nullptr) {
+      kernels->dequantize_uint8(input + offset, count, scale, zero_point,
+                                output + offset);
+      return;
+    }
+    for (index_t i = offset; i < offset + count; ++i) {
+      output[i] = scale * (input[i] - zero_point);
+    }
+  }, 0, block_count, 1);
+}
+
+template<>
+void QuantizeUtil<float, int32_t>::Dequantize(const int *input,
+                                              const index_t size,
+                                              const float scale,
+                                              const int32_t zero_point,
+                                              float *output) {
+  const quantize_x86::QuantizeKernels *kernels = X86Kernels();
+  const index_t block_count = (size + kX86BlockSize - 1) / kX86BlockSize;
+
+  thread_pool_->Compute1D([=](index_t start, index_t end, index_t step) {
+    MACE_UNUSED(step);
+    const index_t offset = start * kX86BlockSize;
+    const index_t count = std::min(end * kX86BlockSize, size) - offset;
+    if (kernels != nullptr) {
+      kernels->dequantize_int32(input + offset, count, scale, zero_point,
+                                output + offset);
+      return;
+    }
+    for (index_t i = offset; i < offset + count; ++i) {
+      output[i] = scale * (input[i] - zero_point);
+    }
+  }, 0, block_count, 1);
+}
+#endif  // MACE_ENABLE_NEON
 
 }  // namespace mace
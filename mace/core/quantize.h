@@ -18,9 +18,11 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <vector>
 
 #include "mace/utils/logging.h"
 #include "mace/utils/thread_pool.h"
+#include "mace/core/quantize_x86.h"
 #include "mace/core/tensor.h"
 
 namespace mace {
@@ -82,18 +84,10 @@ inline Q Quantize(float value, float scale, int32_t zero_point) {
   return Saturate<Q>(std::roundf(value / scale + zero_point));
 }
 
-inline void FindMinMax(const float *input,
-                       const index_t size,
-                       float *min_val, float *max_val) {
-  float max_v = std::numeric_limits<float>::lowest();
-  float min_v = std::numeric_limits<float>::max();
-  for (index_t i = 0; i < size; ++i) {
-    max_v = std::max(max_v, input[i]);
-    min_v = std::min(min_v, input[i]);
-  }
-  *min_val = min_v;
-  *max_val = max_v;
-}
+// Vectorized with NEON, or with SSE4.1/AVX2 when the x86 cpu supports them.
+void FindMinMax(const float *input,
+                const index_t size,
+                float *min_val, float *max_val);
 
 inline void QuantizeMultiplier(double multiplier,
                                int32_t *output_multiplier,
@@ -141,6 +135,32 @@ class QuantizeUtil {
     }, 0, size, 1);
   }
 
+  // FindMinMax over blocks of `input` in parallel.
+  void ParallelFindMinMax(const float *input,
+                          const index_t size,
+                          float *min_val,
+                          float *max_val) {
+    const index_t kBlockSize = 16384;
+    const index_t block_count = (size + kBlockSize - 1) / kBlockSize;
+    if (block_count <= 1) {
+      FindMinMax(input, size, min_val, max_val);
+      return;
+    }
+    std::vector<float> mins(block_count);
+    std::vector<float> maxs(block_count);
+    float *mins_data = mins.data();
+    float *maxs_data = maxs.data();
+    thread_pool_->Compute1D([=](index_t start, index_t end, index_t step) {
+      for (index_t i = start; i < end; i += step) {
+        const index_t offset = i * kBlockSize;
+        FindMinMax(input + offset, std::min(kBlockSize, size - offset),
+                   mins_data + i, maxs_data + i);
+      }
+    }, 0, block_count, 1);
+    *min_val = *std::min_element(mins.begin(), mins.end());
+    *max_val = *std::max_element(maxs.begin(), maxs.end());
+  }
+
   void Quantize(const float *input,
                 const index_t size,
                 bool non_zero,
@@ -149,7 +169,7 @@ class QuantizeUtil {
                 int32_t *zero_point) {
     float in_min_data;
     float in_max_data;
-    FindMinMax(input, size, &in_min_data, &in_max_data);
+    ParallelFindMinMax(input, size, &in_min_data, &in_max_data);
 
     AdjustRange<Q>(in_min_data, in_max_data, non_zero,
                    scale, zero_point);
@@ -208,7 +228,7 @@ class QuantizeUtil {
   utils::ThreadPool *thread_pool_;
 };
 
-#ifdef MACE_ENABLE_NEON
+#if defined(MACE_ENABLE_NEON) || defined(MACE_ENABLE_X86_QUANTIZE)
 
 template<>
 void QuantizeUtil<float, uint8_t>::QuantizeWithScaleAndZeropoint(
@@ -232,7 +252,7 @@ void QuantizeUtil<float, int32_t>::Dequantize(const int *input,
                                               const int32_t zero_point,
                                               float *output);
 
-#endif
+#endif  // MACE_ENABLE_NEON || MACE_ENABLE_X86_QUANTIZE
 
 }  // namespace mace
 
@@ -0,0 +1,363 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/core/quantize_x86.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "mace/core/quantize.h"
+#include "mace/utils/macros.h"
+
+#ifdef MACE_ENABLE_X86_QUANTIZE
+#include <immintrin.h>
+
+#define MACE_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define MACE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif  // MACE_ENABLE_X86_QUANTIZE
+
+namespace mace {
+namespace quantize_x86 {
+
+#ifdef MACE_ENABLE_X86_QUANTIZE
+
+namespace {
+
+void FindMinMaxTail(const float *input,
+                    const index_t start,
+                    const index_t size,
+                    float *min_val,
+                    float *max_val) {
+  for (index_t i = start; i < size; ++i) {
+    *max_val = std::max(*max_val, input[i]);
+    *min_val = std::min(*min_val, input[i]);
+  }
+}
+
+void QuantizeUint8Tail(const float *input,
+                       const index_t start,
+                       const index_t size,
+                       const float recip_scale,
+                       const int32_t zero_point,
+                       uint8_t *output) {
+  for (index_t i = start; i < size; ++i) {
+    output[i] =
+        Saturate<uint8_t>(roundf(zero_point + recip_scale * input[i]));
+  }
+}
+
+template<typename Q>
+void DequantizeTail(const Q *input,
+                    const index_t start,
+                    const index_t size,
+                    const float scale,
+                    const int32_t zero_point,
+                    float *output) {
+  for (index_t i = start; i < size; ++i) {
+    output[i] = scale * (input[i] - zero_point);
+  }
+}
+
+// SSE4.1
+
+MACE_TARGET_SSE41 void FindMinMaxSse41(const float *input,
+                                       const index_t size,
+                                       float *min_val,
+                                       float *max_val) {
+  float max_v = std::numeric_limits<float>::lowest();
+  float min_v = std::numeric_limits<float>::max();
+  index_t i = 0;
+  if (size >= 8) {
+    __m128 vmin0 = _mm_loadu_ps(input);
+    __m128 vmax0 = vmin0;
+    __m128 vmin1 = _mm_loadu_ps(input + 4);
+    __m128 vmax1 = vmin1;
+    for (i = 8; i + 8 <= size; i += 8) {
+      __m128 v0 = _mm_loadu_ps(input + i);
+      __m128 v1 = _mm_loadu_ps(input + i + 4);
+      vmin0 = _mm_min_ps(vmin0, v0);
+      vmax0 = _mm_max_ps(vmax0, v0);
+      vmin1 = _mm_min_ps(vmin1, v1);
+      vmax1 = _mm_max_ps(vmax1, v1);
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_min_ps(vmin0, vmin1));
+    min_v = std::min(std::min(lanes[0], lanes[1]),
+                     std::min(lanes[2], lanes[3]));
+    _mm_storeu_ps(lanes, _mm_max_ps(vmax0, vmax1));
+    max_v = std::max(std::max(lanes[0], lanes[1]),
+                     std::max(lanes[2], lanes[3]));
+  }
+  FindMinMaxTail(input, i, size, &min_v, &max_v);
+  *min_val = min_v;
+  *max_val = max_v;
+}
+
+// Quantizes 4 floats into [0, 255]. The values are clamped before they are
+// rounded half away from zero, which gives the same result as roundf followed
+// by Saturate.
+MACE_TARGET_SSE41 inline __m128i QuantizeToS32(const __m128 value,
+                                               const __m128 vrecip_scale,
+                                               const __m128 vzero) {
+  __m128 v = _mm_add_ps(vzero, _mm_mul_ps(vrecip_scale, value));
+  v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(255.f));
+  const __m128 vtrunc =
+      _mm_round_ps(v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+  const __m128 vround_up = _mm_and_ps(
+      _mm_cmpge_ps(_mm_sub_ps(v, vtrunc), _mm_set1_ps(0.5f)),
+      _mm_set1_ps(1.f));
+  return _mm_cvttps_epi32(_mm_add_ps(vtrunc, vround_up));
+}
+
+MACE_TARGET_SSE41 void QuantizeUint8Sse41(const float *input,
+                                          const index_t size,
+                                          const float recip_scale,
+                                          const int32_t zero_point,
+                                          uint8_t *output) {
+  const __m128 vrecip_scale = _mm_set1_ps(recip_scale);
+  const __m128 vzero = _mm_set1_ps(static_cast<float>(zero_point));
+  index_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const float *in = input + i;
+    __m128i vo0 = QuantizeToS32(_mm_loadu_ps(in), vrecip_scale, vzero);
+    __m128i vo1 = QuantizeToS32(_mm_loadu_ps(in + 4), vrecip_scale, vzero);
+    __m128i vo2 = QuantizeToS32(_mm_loadu_ps(in + 8), vrecip_scale, vzero);
+    __m128i vo3 = QuantizeToS32(_mm_loadu_ps(in + 12), vrecip_scale, vzero);
+    __m128i vo = _mm_packus_epi16(_mm_packs_epi32(vo0, vo1),
+                                  _mm_packs_epi32(vo2, vo3));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), vo);
+  }
+  QuantizeUint8Tail(input, i, size, recip_scale, zero_point, output);
+}
+
+MACE_TARGET_SSE41 inline __m128 DequantizeS32(const __m128i value,
+                                              const __m128 vscale,
+                                              const __m128i vzero) {
+  return _mm_mul_ps(vscale, _mm_cvtepi32_ps(_mm_sub_epi32(value, vzero)));
+}
+
+MACE_TARGET_SSE41 void DequantizeUint8Sse41(const uint8_t *input,
+                                            const index_t size,
+                                            const float scale,
+                                            const int32_t zero_point,
+                                            float *output) {
+  const __m128i vzero = _mm_set1_epi32(zero_point);
+  const __m128 vscale = _mm_set1_ps(scale);
+  index_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i vi =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+    float *out = output + i;
+    _mm_storeu_ps(out, DequantizeS32(_mm_cvtepu8_epi32(vi), vscale, vzero));
+    _mm_storeu_ps(out + 4, DequantizeS32(
+        _mm_cvtepu8_epi32(_mm_srli_si128(vi, 4)), vscale, vzero));
+    _mm_storeu_ps(out + 8, DequantizeS32(
+        _mm_cvtepu8_epi32(_mm_srli_si128(vi, 8)), vscale, vzero));
+    _mm_storeu_ps(out + 12, DequantizeS32(
+        _mm_cvtepu8_epi32(_mm_srli_si128(vi, 12)), vscale, vzero));
+  }
+  DequantizeTail(input, i, size, scale, zero_point, output);
+}
+
+MACE_TARGET_SSE41 void DequantizeInt32Sse41(const int32_t *input,
+                                            const index_t size,
+                                            const float scale,
+                                            const int32_t zero_point,
+                                            float *output) {
+  const __m128i vzero = _mm_set1_epi32(zero_point);
+  const __m128 vscale = _mm_set1_ps(scale);
+  index_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m128i *in = reinterpret_cast<const __m128i *>(input + i);
+    _mm_storeu_ps(output + i,
+                  DequantizeS32(_mm_loadu_si128(in), vscale, vzero));
+    _mm_storeu_ps(output + i + 4,
+                  DequantizeS32(_mm_loadu_si128(in + 1), vscale, vzero));
+  }
+  DequantizeTail(input, i, size, scale, zero_point, output);
+}
+
+// AVX2
+
+MACE_TARGET_AVX2 void FindMinMaxAvx2(const float *input,
+                                     const index_t size,
+                                     float *min_val,
+                                     float *max_val) {
+  float max_v = std::numeric_limits<float>::lowest();
+  float min_v = std::numeric_limits<float>::max();
+  index_t i = 0;
+  if (size >= 16) {
+    __m256 vmin0 = _mm256_loadu_ps(input);
+    __m256 vmax0 = vmin0;
+    __m256 vmin1 = _mm256_loadu_ps(input + 8);
+    __m256 vmax1 = vmin1;
+    for (i = 16; i + 16 <= size; i += 16) {
+      __m256 v0 = _mm256_loadu_ps(input + i);
+      __m256 v1 = _mm256_loadu_ps(input + i + 8);
+      vmin0 = _mm256_min_ps(vmin0, v0);
+      vmax0 = _mm256_max_ps(vmax0, v0);
+      vmin1 = _mm256_min_ps(vmin1, v1);
+      vmax1 = _mm256_max_ps(vmax1, v1);
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, _mm256_min_ps(vmin0, vmin1));
+    min_v = *std::min_element(lanes, lanes + 8);
+    _mm256_storeu_ps(lanes, _mm256_max_ps(vmax0, vmax1));
+    max_v = *std::max_element(lanes, lanes + 8);
+  }
+  FindMinMaxTail(input, i, size, &min_v, &max_v);
+  *min_val = min_v;
+  *max_val = max_v;
+}
+
+MACE_TARGET_AVX2 inline __m256i QuantizeToS32(const __m256 value,
+                                              const __m256 vrecip_scale,
+                                              const __m256 vzero) {
+  __m256 v = _mm256_add_ps(vzero, _mm256_mul_ps(vrecip_scale, value));
+  v = _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()),
+                    _mm256_set1_ps(255.f));
+  const __m256 vtrunc =
+      _mm256_round_ps(v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+  const __m256 vround_up = _mm256_and_ps(
+      _mm256_cmp_ps(_mm256_sub_ps(v, vtrunc), _mm256_set1_ps(0.5f),
+                    _CMP_GE_OQ),
+      _mm256_set1_ps(1.f));
+  return _mm256_cvttps_epi32(_mm256_add_ps(vtrunc, vround_up));
+}
+
+MACE_TARGET_AVX2 void QuantizeUint8Avx2(const float *input,
+                                        const index_t size,
+                                        const float recip_scale,
+                                        const int32_t zero_point,
+                                        uint8_t *output) {
+  const __m256 vrecip_scale = _mm256_set1_ps(recip_scale);
+  const __m256 vzero = _mm256_set1_ps(static_cast<float>(zero_point));
+  // packing interleaves the 128-bit lanes, this puts them back in order
+  const __m256i vorder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  index_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    const float *in = input + i;
+    __m256i vo0 = QuantizeToS32(_mm256_loadu_ps(in), vrecip_scale, vzero);
+    __m256i vo1 =
+        QuantizeToS32(_mm256_loadu_ps(in + 8), vrecip_scale, vzero);
+    __m256i vo2 =
+        QuantizeToS32(_mm256_loadu_ps(in + 16), vrecip_scale, vzero);
+    __m256i vo3 =
+        QuantizeToS32(_mm256_loadu_ps(in + 24), vrecip_scale, vzero);
+    __m256i vo = _mm256_packus_epi16(_mm256_packs_epi32(vo0, vo1),
+                                     _mm256_packs_epi32(vo2, vo3));
+    vo = _mm256_permutevar8x32_epi32(vo, vorder);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i), vo);
+  }
+  QuantizeUint8Tail(input, i, size, recip_scale, zero_point, output);
+}
+
+MACE_TARGET_AVX2 inline __m256 DequantizeS32(const __m256i value,
+                                             const __m256 vscale,
+                                             const __m256i vzero) {
+  return _mm256_mul_ps(vscale,
+                       _mm256_cvtepi32_ps(_mm256_sub_epi32(value, vzero)));
+}
+
+MACE_TARGET_AVX2 void DequantizeUint8Avx2(const uint8_t *input,
+                                          const index_t size,
+                                          const float scale,
+                                          const int32_t zero_point,
+                                          float *output) {
+  const __m256i vzero = _mm256_set1_epi32(zero_point);
+  const __m256 vscale = _mm256_set1_ps(scale);
+  index_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i vi =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+    _mm256_storeu_ps(output + i, DequantizeS32(
+        _mm256_cvtepu8_epi32(vi), vscale, vzero));
+    _mm256_storeu_ps(output + i + 8, DequantizeS32(
+        _mm256_cvtepu8_epi32(_mm_srli_si128(vi, 8)), vscale, vzero));
+  }
+  DequantizeTail(input, i, size, scale, zero_point, output);
+}
+
+MACE_TARGET_AVX2 void DequantizeInt32Avx2(const int32_t *input,
+                                          const index_t size,
+                                          const float scale,
+                                          const int32_t zero_point,
+                                          float *output) {
+  const __m256i vzero = _mm256_set1_epi32(zero_point);
+  const __m256 vscale = _mm256_set1_ps(scale);
+  index_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    __m256i vi =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));
+    _mm256_storeu_ps(output + i, DequantizeS32(vi, vscale, vzero));
+  }
+  DequantizeTail(input, i, size, scale, zero_point, output);
+}
+
+const QuantizeKernels kSse41Kernels = {
+    &FindMinMaxSse41,
+    &QuantizeUint8Sse41,
+    &DequantizeUint8Sse41,
+    &DequantizeInt32Sse41,
+};
+
+const QuantizeKernels kAvx2Kernels = {
+    &FindMinMaxAvx2,
+    &QuantizeUint8Avx2,
+    &DequantizeUint8Avx2,
+    &DequantizeInt32Avx2,
+};
+
+}  // namespace
+
+Isa DetectIsa() {
+  static const Isa isa = []() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return ISA_AVX2;
+    } else if (__builtin_cpu_supports("sse4.1")) {
+      return ISA_SSE41;
+    }
+    return ISA_NONE;
+  }();
+  return isa;
+}
+
+const QuantizeKernels *GetQuantizeKernels(const Isa isa) {
+  switch (isa) {
+    case ISA_AVX2:
+      return &kAvx2Kernels;
+    case ISA_SSE41:
+      return &kSse41Kernels;
+    default:
+      return nullptr;
+  }
+}
+
+#else
+
+Isa DetectIsa() {
+  return ISA_NONE;
+}
+
+const QuantizeKernels *GetQuantizeKernels(const Isa isa) {
+  MACE_UNUSED(isa);
+  return nullptr;
+}
+
+#endif  // MACE_ENABLE_X86_QUANTIZE
+
+}  // namespace quantize_x86
+}  // namespace mace
@@ -0,0 +1,72 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_CORE_QUANTIZE_X86_H_
+#define MACE_CORE_QUANTIZE_X86_H_
+
+#include <cstdint>
+
+#include "mace/core/types.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MACE_ENABLE_X86_QUANTIZE
+#endif
+
+namespace mace {
+namespace quantize_x86 {
+
+// Quantize and dequantize kernels for x86. Each kernel is compiled for SSE4.1
+// and AVX2 whatever instruction set the compiler targets, and the widest one
+// the cpu supports is picked at run time.
+
+enum Isa {
+  ISA_NONE = 0,
+  ISA_SSE41,
+  ISA_AVX2,
+};
+
+// The widest instruction set the running cpu supports, detected once.
+Isa DetectIsa();
+
+// The kernels take any size, the tails are done with the scalar formulas of
+// quantize.h so the results are the same bit for bit.
+struct QuantizeKernels {
+  void (*find_min_max)(const float *input,
+                       const index_t size,
+                       float *min_val,
+                       float *max_val);
+  void (*quantize_uint8)(const float *input,
+                         const index_t size,
+                         const float recip_scale,
+                         const int32_t zero_point,
+                         uint8_t *output);
+  void (*dequantize_uint8)(const uint8_t *input,
+                           const index_t size,
+                           const float scale,
+                           const int32_t zero_point,
+                           float *output);
+  void (*dequantize_int32)(const int32_t *input,
+                           const index_t size,
+                           const float scale,
+                           const int32_t zero_point,
+                           float *output);
+};
+
+// Returns the kernels of `isa`, nullptr for ISA_NONE.
+const QuantizeKernels *GetQuantizeKernels(const Isa isa);
+
+}  // namespace quantize_x86
+}  // namespace mace
+
+#endif  // MACE_CORE_QUANTIZE_X86_H_
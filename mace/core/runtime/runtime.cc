@@ -130,6 +130,23 @@ void Runtime::ReleaseAllBuffer(BufRentType rent_type, bool del_buf) {
   }
 }
 
+std::vector<MemoryManager *> Runtime::GetMemoryManagers() {
+  std::vector<MemoryManager *> memory_managers;
+  auto mem_type = GetUsedMemoryType();
+  memory_managers.push_back(GetMemoryManager(mem_type));
+  auto base_mem_type = GetBaseMemoryType();
+  if (base_mem_type != mem_type) {
+    memory_managers.push_back(GetMemoryManager(base_mem_type));
+  }
+  return memory_managers;
+}
+
+void Runtime::SetMemoryBudget(std::shared_ptr<MemoryBudget> budget) {
+  for (auto *memory_manager : GetMemoryManagers()) {
+    memory_manager->SetMemoryBudget(budget);
+  }
+}
+
 std::vector<index_t> Runtime::ComputeBufDimFromTensorDim(
     const std::vector<index_t> &dims, MemoryType mem_type,
     const BufferContentType content_type, const unsigned int content_param) {
@@ -171,6 +188,11 @@ MaceStatus Runtime::AllocateBufferForTensor(
     MemoryManager *memory_manager = GetMemoryManager(mem_type);
     buffer.reset(new Buffer(mem_type, data_type, mem_dims, nullptr));
     buffer->SetBuf(memory_manager->ObtainMemory(*buffer, rent_type));
+    if (buffer->memory<void>() == nullptr) {
+      LOG(ERROR) << "Can not allocate " << buffer->bytes()
+                 << " bytes for tensor " << tensor->name();
+      return MaceStatus::MACE_OUT_OF_RESOURCES;
+    }
   }
 
   MACE_CHECK(buffer->memory<void>() != nullptr);
@@ -69,6 +69,7 @@ class Runtime {
                                      index_t offset = 0);
   void ReleaseBufferForTensor(Tensor *tensor, const BufRentType rent_type);
 
+  // The memory of the buffer is null if the memory budget refuses it.
   std::unique_ptr<Buffer> ObtainBuffer(const MemInfo &info,
                                        BufRentType rent_type);
   void ReleaseBuffer(Buffer *buffer, BufRentType rent_type);
@@ -85,6 +86,9 @@ class Runtime {
                                       const ConstTensor &const_tensor);
 
   virtual MemoryManager *GetMemoryManager(const MemoryType mem_type) = 0;
+  // the distinct memory managers of the used and the base memory types
+  std::vector<MemoryManager *> GetMemoryManagers();
+  void SetMemoryBudget(std::shared_ptr<MemoryBudget> budget);
 
   void SetBufferToTensor(std::unique_ptr<Buffer> buffer, Tensor *tensor);
 
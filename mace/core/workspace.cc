@@ -14,6 +14,8 @@
 
 #include "mace/core/workspace.h"
 
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
@@ -42,6 +44,30 @@ void DequantizeTensor(Runtime *runtime,
                            dequantized_data);
 }
 
+// Const tensors only read as the params of Gather ops. They can stay in
+// their fp16 or uint8 storage, the Gather op dequantizes the rows it reads.
+std::unordered_set<std::string> GatherOnlyTensors(const NetDef &net_def) {
+  std::unordered_map<std::string, bool> gather_only;
+  for (const auto &op : net_def.op()) {
+    for (int i = 0; i < op.input_size(); ++i) {
+      const bool is_params = op.type() == "Gather" && i == 0;
+      auto iter = gather_only.find(op.input(i));
+      if (iter == gather_only.end()) {
+        gather_only.emplace(op.input(i), is_params);
+      } else {
+        iter->second = iter->second && is_params;
+      }
+    }
+  }
+  std::unordered_set<std::string> tensors;
+  for (const auto &entry : gather_only) {
+    if (entry.second) {
+      tensors.insert(entry.first);
+    }
+  }
+  return tensors;
+}
+
 }  // namespace
 
 Workspace::Workspace(const OpDelegatorRegistry *registry, BaseFlow *flow) :
@@ -99,6 +125,16 @@ std::vector<std::string> Workspace::Tensors() const {
   return names;
 }
 
+index_t Workspace::GetWeightBytes() const {
+  index_t bytes = 0;
+  for (auto &entry : tensor_map_) {
+    if (entry.second->is_weight()) {
+      bytes += entry.second->raw_size();
+    }
+  }
+  return bytes;
+}
+
 MaceStatus Workspace::LoadModelTensor(const NetDef &net_def, Runtime *runtime,
                                       const unsigned char *model_data,
                                       const index_t model_data_size) {
@@ -116,6 +152,8 @@ MaceStatus Workspace::LoadModelTensor(const NetDef &net_def, Runtime *runtime,
   diffused_buffer_ = (slice_parent == nullptr);
   if (diffused_buffer_) {
     bool is_quantize_model = NetDefHelper::IsQuantizedModel(net_def);
+    const auto gather_tables = runtime_type == RuntimeType::RT_CPU ?
+        GatherOnlyTensors(net_def) : std::unordered_set<std::string>();
     for (const auto &const_tensor : net_def.tensors()) {
       MACE_LATENCY_LOGGER(2, "Load tensor ", const_tensor.name());
       VLOG(3) << "Tensor name: " << const_tensor.name()
@@ -127,18 +165,30 @@ MaceStatus Workspace::LoadModelTensor(const NetDef &net_def, Runtime *runtime,
         dims.push_back(d);
       }
 
-      auto dst_data_type =
-          runtime->GetComputeDataType(net_def, const_tensor);
+      const bool compressed_table =
+          gather_tables.count(const_tensor.name()) > 0 &&
+          (const_tensor.data_type() == DataType::DT_HALF ||
+              (!is_quantize_model && const_tensor.quantized() &&
+                  const_tensor.data_type() == DataType::DT_UINT8));
+      auto dst_data_type = compressed_table ? const_tensor.data_type() :
+                           runtime->GetComputeDataType(net_def, const_tensor);
       auto tensor = make_unique<Tensor>(
           runtime, dst_data_type, dims, true, const_tensor.name());
-      runtime->AllocateBufferForTensor(tensor.get(), BufRentType::RENT_PRIVATE);
+      MACE_RETURN_IF_ERROR(runtime->AllocateBufferForTensor(
+          tensor.get(), BufRentType::RENT_PRIVATE));
 
       const index_t tensor_end = const_tensor.offset() +
           tensor->size() * GetEnumTypeSize(const_tensor.data_type());
       MACE_CHECK(tensor_end <= model_data_size, "tensor_end (", tensor_end,
                  ") should <= ", model_data_size);
 
-      if (runtime_type == RuntimeType::RT_CPU &&
+      if (compressed_table) {
+        tensor->SetScale(const_tensor.scale());
+        tensor->SetZeroPoint(const_tensor.zero_point());
+        tensor->CopyBytes(model_data + const_tensor.offset(),
+                          const_tensor.data_size() *
+                              GetEnumTypeSize(const_tensor.data_type()));
+      } else if (runtime_type == RuntimeType::RT_CPU &&
           const_tensor.data_type() == DataType::DT_HALF) {
         // uncompress the weights of fp16
         auto org_data = reinterpret_cast<const half *>(
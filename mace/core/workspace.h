@@ -56,6 +56,9 @@ class Workspace {
 
   std::vector<std::string> Tensors() const;
 
+  // bytes of the weight tensors, in the model data or in private buffers
+  index_t GetWeightBytes() const;
+
   MaceStatus LoadModelTensor(const NetDef &net_def, Runtime *runtime,
                              const unsigned char *model_data,
                              const index_t model_data_size);
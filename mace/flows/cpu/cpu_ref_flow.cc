@@ -20,6 +20,7 @@
 #include "mace/core/net/serial_net.h"
 #include "mace/core/workspace.h"
 #include "mace/proto/mace.pb.h"
+#include "mace/utils/mace_engine_config.h"
 
 namespace mace {
 
@@ -49,6 +50,12 @@ MaceStatus CpuRefFlow::Init(const NetDef *net_def,
                                                 ws_.get(),
                                                 main_runtime_,
                                                 cpu_runtime_));
+  if (config_impl_->result_cache_size() > 0) {
+    net_->EnableResultReuse();
+  }
+  if (config_impl_->incremental_run()) {
+    net_->EnableIncrementalRun();
+  }
   if (model_data_unused != nullptr) {
     *model_data_unused = ws_->diffused_buffer();
   }
@@ -70,7 +77,16 @@ MaceStatus CpuRefFlow::Run(TensorMap *input_tensors,
                            RunMetadata *run_metadata) {
   VLOG(1) << "CpuRefFlow::Run";
   MACE_UNUSED(input_tensors);
-  MACE_UNUSED(output_tensors);
+  // skip the operators which only lead to outputs the caller didn't ask for
+  if (output_tensors != nullptr && !output_tensors->empty() &&
+      output_tensors->size() < output_info_map_.size()) {
+    std::vector<std::string> output_names;
+    output_names.reserve(output_tensors->size());
+    for (auto &output : *output_tensors) {
+      output_names.push_back(output.first);
+    }
+    return net_->RunPartial(output_names, run_metadata);
+  }
   return net_->Run(run_metadata);
 }
 
@@ -0,0 +1,81 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/libmace/async_executor.h"
+
+#include <utility>
+
+namespace mace {
+
+AsyncExecutor::AsyncExecutor() : state_(std::make_shared<State>()) {}
+
+AsyncExecutor::~AsyncExecutor() {
+  std::deque<Job> dropped;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->stopped = true;
+    dropped.swap(state_->jobs);
+  }
+  state_->cond.notify_all();
+  if (worker_.joinable()) {
+    if (worker_.get_id() == std::this_thread::get_id()) {
+      // a job releases the executor, the worker can not join itself
+      worker_.detach();
+    } else {
+      worker_.join();
+    }
+  }
+  // run outside the lock, the jobs may report to user callbacks
+  for (auto &job : dropped) {
+    job(false);
+  }
+}
+
+void AsyncExecutor::Submit(Job job) {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (!state_->stopped) {
+      state_->jobs.push_back(std::move(job));
+      if (!worker_.joinable()) {
+        worker_ = std::thread(&AsyncExecutor::Loop, state_);
+      }
+      job = nullptr;
+    }
+  }
+  if (job) {
+    job(false);
+  } else {
+    state_->cond.notify_one();
+  }
+}
+
+void AsyncExecutor::Loop(std::shared_ptr<State> state) {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(state->mutex);
+      state->cond.wait(lock, [&state] {
+        return state->stopped || !state->jobs.empty();
+      });
+      if (state->stopped) {
+        return;
+      }
+      job = std::move(state->jobs.front());
+      state->jobs.pop_front();
+    }
+    job(true);
+  }
+}
+
+}  // namespace mace
@@ -0,0 +1,65 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_LIBMACE_ASYNC_EXECUTOR_H_
+#define MACE_LIBMACE_ASYNC_EXECUTOR_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+
+#include "mace/utils/macros.h"
+
+namespace mace {
+
+// First-in first-out job queue served by a single worker thread, which is
+// only started by the first submitted job.
+class AsyncExecutor {
+ public:
+  // The argument is false when the job is dropped without being run because
+  // the executor is destroyed, the job should then only release its state.
+  typedef std::function<void(bool run)> Job;
+
+  AsyncExecutor();
+  // Waits for the running job and drops the queued ones. When destroyed by
+  // a job, it detaches the worker instead, which exits once the job returns.
+  ~AsyncExecutor();
+
+  void Submit(Job job);
+
+ private:
+  // shared with the worker, which may outlive the executor
+  struct State {
+    State() : stopped(false) {}
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<Job> jobs;
+    bool stopped;
+  };
+
+  static void Loop(std::shared_ptr<State> state);
+
+  std::shared_ptr<State> state_;
+  std::thread worker_;
+
+  MACE_DISABLE_COPY_AND_ASSIGN(AsyncExecutor);
+};
+
+}  // namespace mace
+
+#endif  // MACE_LIBMACE_ASYNC_EXECUTOR_H_
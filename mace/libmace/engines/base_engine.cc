@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <numeric>
 #include <memory>
+#include <set>
 #include <utility>
 
 #include "mace/core/flow/base_flow.h"
@@ -41,13 +42,19 @@ BaseEngine::BaseEngine(const MaceEngineConfig &config)
                                          config.impl_->cpu_affinity_policy())),
       model_data_(nullptr), op_registry_(new OpRegistry),
       op_delegator_registry_(new OpDelegatorRegistry),
-      config_impl_(config.impl_) {
+      config_impl_(config.impl_),
+      memory_budget_(std::make_shared<MemoryBudget>(
+          config.impl_->memory_budget())) {
 #ifdef MACE_ENABLE_RPCMEM
   runtime_context_ = make_unique<IonRuntimeContext>(
       thread_pool_.get(), rpcmem_factory::CreateRpcmem());
 #else
   runtime_context_ = make_unique<RuntimeContext>(thread_pool_.get());
 #endif  // MACE_ENABLE_RPCMEM
+  if (config_impl_->result_cache_size() > 0) {
+    output_cache_ = make_unique<OutputCache>(
+        static_cast<size_t>(config_impl_->result_cache_size()));
+  }
 }
 
 MaceStatus BaseEngine::Init(
@@ -173,12 +180,71 @@ RuntimesMap &BaseEngine::GetRuntimesOfTutor(BaseEngine *tutor) {
   return tutor->runtimes_;
 }
 
+index_t BaseEngine::GetWeightBytes() const {
+  return 0;
+}
+
 MaceStatus BaseEngine::Forward(const std::map<std::string, MaceTensor> &inputs,
                                std::map<std::string, MaceTensor> *outputs,
                                RunMetadata *run_metadata) {
+  uint64_t cache_key = 0;
+  const bool cacheable = output_cache_ != nullptr &&
+      output_cache_->ComputeKey(inputs, *outputs, &cache_key);
+  if (cacheable && output_cache_->Lookup(cache_key, inputs, outputs)) {
+    return MaceStatus::MACE_SUCCESS;
+  }
+
   MACE_RETURN_IF_ERROR(BeforeRun());
   MACE_RETURN_IF_ERROR(Run(inputs, outputs, run_metadata));
-  return AfterRun();
+  MACE_RETURN_IF_ERROR(AfterRun());
+  if (cacheable) {
+    output_cache_->Insert(cache_key, inputs, *outputs);
+  }
+  return MaceStatus::MACE_SUCCESS;
+}
+
+void BaseEngine::SetRunInterrupter(const std::function<bool()> &interrupter) {
+  run_interrupter_ = interrupter;
+}
+
+namespace {
+void AddMemoryCounter(const MemoryCounter &counter, MemoryStats *stats) {
+  stats->current_bytes += counter.current;
+  stats->peak_bytes += counter.peak;
+}
+}  // namespace
+
+MaceStatus BaseEngine::GetMemoryUsage(MemoryUsage *usage) const {
+  MACE_CHECK_NOTNULL(usage);
+  *usage = MemoryUsage();
+  const index_t weight_bytes = GetWeightBytes();
+  usage->weights.current_bytes = weight_bytes;
+  usage->weights.peak_bytes = weight_bytes;
+
+  std::set<MemoryManager *> memory_managers;
+  for (auto i = runtimes_.begin(); i != runtimes_.end(); ++i) {
+    for (auto *memory_manager : i->second->GetMemoryManagers()) {
+      if (!memory_managers.insert(memory_manager).second) {
+        continue;
+      }
+      AddMemoryCounter(memory_manager->GetMemoryCounter(RENT_PRIVATE),
+                       &usage->private_buffers);
+      AddMemoryCounter(memory_manager->GetMemoryCounter(RENT_SHARE),
+                       &usage->activations);
+      AddMemoryCounter(memory_manager->GetMemoryCounter(RENT_SCRATCH),
+                       &usage->scratch);
+      // the peak of every manager, which bounds the peak of their sum
+      AddMemoryCounter(memory_manager->GetMemoryCounter(), &usage->total);
+    }
+  }
+
+  // the model data file mapped by the engine
+  if (model_data_ != nullptr) {
+    const int64_t model_data_bytes = model_data_->length();
+    usage->total.current_bytes += model_data_bytes;
+    usage->total.peak_bytes += model_data_bytes;
+  }
+  return MaceStatus::MACE_SUCCESS;
 }
 
 MaceStatus BaseEngine::BeforeRun() {
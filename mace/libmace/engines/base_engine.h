@@ -15,6 +15,7 @@
 #ifndef MACE_LIBMACE_ENGINES_BASE_ENGINE_H_
 #define MACE_LIBMACE_ENGINES_BASE_ENGINE_H_
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -23,6 +24,7 @@
 #include "mace/core/registry/op_delegator_registry.h"
 #include "mace/core/registry/ops_registry.h"
 #include "mace/core/runtime/runtime.h"
+#include "mace/libmace/engines/output_cache.h"
 #include "mace/port/file_system.h"
 #include "mace/public/mace.h"
 #include "mace/utils/macros.h"
@@ -75,6 +77,14 @@ class BaseEngine {
   virtual MaceStatus ReleaseIntermediateBuffer();
   virtual MaceStatus AllocateIntermediateBuffer();
 
+  // Installs the interrupter polled by the following runs, they stop with
+  // MACE_CANCELLED once it returns true. Pass an empty function to clear it.
+  virtual void SetRunInterrupter(const std::function<bool()> &interrupter);
+
+  // Sums the memory managers of the runtimes, the ones shared with a tutor
+  // engine included.
+  MaceStatus GetMemoryUsage(MemoryUsage *usage) const;
+
  protected:
   virtual MaceStatus BeforeRun();
   virtual MaceStatus Run(const std::map<std::string, MaceTensor> &inputs,
@@ -83,6 +93,7 @@ class BaseEngine {
   virtual MaceStatus AfterRun();
 
   RuntimesMap &GetRuntimesOfTutor(BaseEngine *tutor);
+  virtual index_t GetWeightBytes() const;
 
  protected:
   std::unique_ptr<utils::ThreadPool> thread_pool_;
@@ -92,6 +103,11 @@ class BaseEngine {
   std::unique_ptr<OpDelegatorRegistry> op_delegator_registry_;
   std::shared_ptr<MaceEngineCfgImpl> config_impl_;
   RuntimesMap runtimes_;
+  // shared by the memory managers of the runtimes created by this engine
+  std::shared_ptr<MemoryBudget> memory_budget_;
+  std::function<bool()> run_interrupter_;
+  // null unless MaceEngineConfig::SetResultCache enabled it
+  std::unique_ptr<OutputCache> output_cache_;
 
   MACE_DISABLE_COPY_AND_ASSIGN(BaseEngine);
 };
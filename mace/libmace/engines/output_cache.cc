@@ -0,0 +1,178 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/libmace/engines/output_cache.h"
+
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <utility>
+
+#include "mace/core/types.h"
+#include "mace/utils/hash.h"
+#include "mace/utils/logging.h"
+
+namespace mace {
+
+namespace {
+int64_t ElementCount(const std::vector<int64_t> &shape) {
+  return std::accumulate(shape.begin(), shape.end(), static_cast<int64_t>(1),
+                         std::multiplies<int64_t>());
+}
+
+size_t ByteSize(const std::vector<int64_t> &shape, const IDataType dt) {
+  return static_cast<size_t>(ElementCount(shape)) *
+      GetEnumTypeSize(static_cast<DataType>(dt));
+}
+
+uint64_t HashString(const uint64_t seed, const std::string &str) {
+  return hash::XXHash64(str.data(), str.size(), seed);
+}
+
+uint64_t HashTensorInfo(uint64_t seed, const MaceTensor &tensor) {
+  seed = hash::HashCombine(seed, static_cast<uint64_t>(tensor.data_type()));
+  seed = hash::HashCombine(seed,
+                           static_cast<uint64_t>(tensor.data_format()));
+  for (auto dim : tensor.shape()) {
+    seed = hash::HashCombine(seed, static_cast<uint64_t>(dim));
+  }
+  return seed;
+}
+}  // namespace
+
+OutputCache::OutputCache(const size_t capacity) : capacity_(capacity) {}
+
+bool OutputCache::ComputeKey(
+    const std::map<std::string, MaceTensor> &inputs,
+    const std::map<std::string, MaceTensor> &outputs, uint64_t *key) const {
+  uint64_t seed = 0;
+  for (auto &input : inputs) {
+    const MaceTensor &tensor = input.second;
+    if (tensor.memory_type() != MemoryType::CPU_BUFFER) {
+      return false;
+    }
+    seed = HashTensorInfo(HashString(seed, input.first), tensor);
+    seed = hash::XXHash64(tensor.data<void>().get(),
+                          ByteSize(tensor.shape(), tensor.data_type()), seed);
+  }
+  // the outputs asked for, with their format, are part of the key
+  for (auto &output : outputs) {
+    if (output.second.memory_type() != MemoryType::CPU_BUFFER) {
+      return false;
+    }
+    seed = hash::HashCombine(HashString(seed, output.first),
+                             static_cast<uint64_t>(output.second.data_type()));
+    seed = hash::HashCombine(
+        seed, static_cast<uint64_t>(output.second.data_format()));
+  }
+  *key = seed;
+  return true;
+}
+
+bool OutputCache::Lookup(const uint64_t key,
+                         const std::map<std::string, MaceTensor> &inputs,
+                         std::map<std::string, MaceTensor> *outputs) {
+  auto iter = index_.find(key);
+  if (iter == index_.end()) {
+    return false;
+  }
+  const Entry &entry = *iter->second;
+  // the key is only a hash, the inputs themselves have to match
+  if (entry.inputs.size() != inputs.size() ||
+      entry.outputs.size() != outputs->size()) {
+    return false;
+  }
+  for (auto &input : inputs) {
+    auto cached = entry.inputs.find(input.first);
+    if (cached == entry.inputs.end() ||
+        !IsSameTensor(input.second, cached->second)) {
+      VLOG(2) << "Output cache hash collision: " << key;
+      return false;
+    }
+  }
+  // the buffers of the caller must hold the cached outputs
+  for (auto &output : *outputs) {
+    auto cached = entry.outputs.find(output.first);
+    if (cached == entry.outputs.end() ||
+        cached->second.data_type != output.second.data_type() ||
+        cached->second.data_format != output.second.data_format() ||
+        ElementCount(cached->second.shape) >
+            ElementCount(output.second.shape())) {
+      return false;
+    }
+  }
+
+  for (auto &output : *outputs) {
+    const CachedTensor &cached = entry.outputs.at(output.first);
+    MaceTensor &tensor = output.second;
+    std::memcpy(tensor.data<void>().get(), cached.data.data(),
+                cached.data.size());
+    if (tensor.shape() != cached.shape) {
+      tensor = MaceTensor(cached.shape, tensor.data<void>(),
+                          tensor.data_format(), tensor.data_type(),
+                          tensor.memory_type());
+    }
+  }
+  entries_.splice(entries_.begin(), entries_, iter->second);
+  VLOG(2) << "Output cache hit: " << key;
+  return true;
+}
+
+void OutputCache::Insert(const uint64_t key,
+                         const std::map<std::string, MaceTensor> &inputs,
+                         const std::map<std::string, MaceTensor> &outputs) {
+  if (capacity_ == 0) {
+    return;
+  }
+  auto iter = index_.find(key);
+  if (iter != index_.end()) {
+    entries_.erase(iter->second);
+    index_.erase(iter);
+  }
+  if (entries_.size() >= capacity_) {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+
+  Entry entry;
+  entry.key = key;
+  for (auto &input : inputs) {
+    CopyTensor(input.second, &entry.inputs[input.first]);
+  }
+  for (auto &output : outputs) {
+    CopyTensor(output.second, &entry.outputs[output.first]);
+  }
+  entries_.push_front(std::move(entry));
+  index_.emplace(key, entries_.begin());
+}
+
+void OutputCache::CopyTensor(const MaceTensor &tensor, CachedTensor *cached) {
+  cached->shape = tensor.shape();
+  cached->data_type = tensor.data_type();
+  cached->data_format = tensor.data_format();
+  const char *data = static_cast<const char *>(tensor.data<void>().get());
+  cached->data.assign(data,
+                      data + ByteSize(tensor.shape(), tensor.data_type()));
+}
+
+bool OutputCache::IsSameTensor(const MaceTensor &tensor,
+                               const CachedTensor &cached) {
+  return tensor.shape() == cached.shape &&
+      tensor.data_type() == cached.data_type &&
+      tensor.data_format() == cached.data_format &&
+      std::memcmp(tensor.data<void>().get(), cached.data.data(),
+                  cached.data.size()) == 0;
+}
+
+}  // namespace mace
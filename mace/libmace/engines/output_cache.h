@@ -0,0 +1,83 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_LIBMACE_ENGINES_OUTPUT_CACHE_H_
+#define MACE_LIBMACE_ENGINES_OUTPUT_CACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mace/public/mace.h"
+#include "mace/utils/macros.h"
+
+namespace mace {
+
+// LRU cache of the outputs of engine runs, keyed by a hash of the input
+// buffers and of the requested outputs. Every entry keeps a copy of its
+// inputs too, a hash hit is only taken when they are equal byte for byte.
+// Only runs whose inputs and outputs are all in CPU memory are cached.
+class OutputCache {
+ public:
+  explicit OutputCache(const size_t capacity);
+
+  // Returns false when the run can not be cached.
+  bool ComputeKey(const std::map<std::string, MaceTensor> &inputs,
+                  const std::map<std::string, MaceTensor> &outputs,
+                  uint64_t *key) const;
+
+  // Copies the outputs cached under `key` into `outputs`, returns false on
+  // a miss or when the cached run had other inputs or outputs.
+  bool Lookup(const uint64_t key,
+              const std::map<std::string, MaceTensor> &inputs,
+              std::map<std::string, MaceTensor> *outputs);
+
+  // Keeps a copy of `inputs` and `outputs` under `key`, dropping the least
+  // recently used entry when the cache is full.
+  void Insert(const uint64_t key,
+              const std::map<std::string, MaceTensor> &inputs,
+              const std::map<std::string, MaceTensor> &outputs);
+
+ private:
+  struct CachedTensor {
+    std::vector<int64_t> shape;
+    IDataType data_type;
+    DataFormat data_format;
+    std::vector<char> data;
+  };
+  typedef std::map<std::string, CachedTensor> CachedTensorMap;
+  struct Entry {
+    uint64_t key;
+    CachedTensorMap inputs;
+    CachedTensorMap outputs;
+  };
+  typedef std::list<Entry> EntryList;
+
+  static void CopyTensor(const MaceTensor &tensor, CachedTensor *cached);
+  static bool IsSameTensor(const MaceTensor &tensor,
+                           const CachedTensor &cached);
+
+  const size_t capacity_;
+  // the most recently used entry comes first
+  EntryList entries_;
+  std::unordered_map<uint64_t, EntryList::iterator> index_;
+
+  MACE_DISABLE_COPY_AND_ASSIGN(OutputCache);
+};
+
+}  // namespace mace
+
+#endif  // MACE_LIBMACE_ENGINES_OUTPUT_CACHE_H_
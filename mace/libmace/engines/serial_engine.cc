@@ -15,11 +15,13 @@
 
 #include "mace/libmace/engines/serial_engine.h"
 
+#include <algorithm>
 #include <functional>
 #include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -93,15 +95,35 @@ MaceStatus SerialEngine::Run(
     (*(run_helper_[iter->first]))[iter->first] = iter->second;
   }
 
-  auto flow_num = flows_.size();
-  for (size_t i = 0; i < flow_num; ++i) {
-    auto *flow = flows_[i].get();
+  MaceStatus ret = MaceStatus::MACE_SUCCESS;
+  const RunPlan &run_plan = GetRunPlan(*outputs);
+  for (auto &step : run_plan) {
+    if (run_interrupter_ && run_interrupter_()) {
+      ret = MaceStatus::MACE_CANCELLED;
+      break;
+    }
+    auto *flow = step.flow;
+    auto *flow_outputs = output_tensors_[flow].get();
     VLOG(1) << "start run flow: " << flow->GetName();
-    auto ret = flow->Run(*(input_tensors_[flow]), output_tensors_[flow].get(),
-                         run_metadata);
-    MACE_RETURN_IF_ERROR(ret);
+    if (step.output_names.empty()) {
+      ret = flow->Run(*(input_tensors_[flow]), flow_outputs, run_metadata);
+    } else {
+      MaceTensorInfo partial_outputs;
+      for (auto &output_name : step.output_names) {
+        partial_outputs.emplace(output_name, flow_outputs->at(output_name));
+      }
+      ret = flow->Run(*(input_tensors_[flow]), &partial_outputs,
+                      run_metadata);
+      for (auto &output : partial_outputs) {
+        flow_outputs->at(output.first) = output.second;
+      }
+    }
+    if (ret != MaceStatus::MACE_SUCCESS) {
+      break;
+    }
   }
 
+  // drop the references to the user buffers even if the run was interrupted
   for (auto iter = inputs.begin(); iter != inputs.end(); ++iter) {
     run_helper_[iter->first]->erase(iter->first);
   }
@@ -109,7 +131,51 @@ MaceStatus SerialEngine::Run(
     run_helper_[iter->first]->erase(iter->first);
   }
 
-  return MaceStatus::MACE_SUCCESS;
+  return ret;
+}
+
+const SerialEngine::RunPlan &SerialEngine::GetRunPlan(
+    const std::map<std::string, MaceTensor> &outputs) {
+  std::vector<std::string> requested;
+  for (auto &output : outputs) {
+    requested.push_back(output.first);
+  }
+  const std::string key = MakeString(requested);
+  auto iter = run_plans_.find(key);
+  if (iter != run_plans_.end()) {
+    return iter->second;
+  }
+
+  // walk the flows backward, a flow is needed if one of its outputs is
+  // requested or consumed by a needed flow. No requested output means all.
+  std::unordered_set<std::string> needed(requested.begin(), requested.end());
+  RunPlan run_plan;
+  for (auto flow_iter = flows_.rbegin(); flow_iter != flows_.rend();
+       ++flow_iter) {
+    BaseFlow *flow = flow_iter->get();
+    const FlowOutputKeys &output_keys = flow_output_keys_[flow];
+    std::vector<std::string> output_names;
+    for (auto &output_key : output_keys) {
+      if (requested.empty() || needed.count(output_key.first) > 0 ||
+          needed.count(output_key.second) > 0) {
+        output_names.push_back(output_key.first);
+      }
+    }
+    if (!requested.empty() && output_names.empty()) {
+      VLOG(1) << "Skip flow " << flow->GetName() << " for outputs " << key;
+      continue;
+    }
+    if (output_names.size() == output_keys.size()) {
+      output_names.clear();
+    }
+    for (auto &input : *(input_tensors_[flow])) {
+      needed.insert(input.first);
+    }
+    run_plan.push_back({flow, std::move(output_names)});
+  }
+  std::reverse(run_plan.begin(), run_plan.end());
+
+  return run_plans_.emplace(key, std::move(run_plan)).first->second;
 }
 
 MaceStatus SerialEngine::AfterRun() {
@@ -131,6 +197,22 @@ MaceStatus SerialEngine::ReleaseIntermediateBuffer() {
   return MaceStatus::MACE_SUCCESS;
 }
 
+void SerialEngine::SetRunInterrupter(
+    const std::function<bool()> &interrupter) {
+  BaseEngine::SetRunInterrupter(interrupter);
+  for (auto &flow : flows_) {
+    flow->SetRunInterrupter(interrupter);
+  }
+}
+
+index_t SerialEngine::GetWeightBytes() const {
+  index_t bytes = 0;
+  for (auto &flow : flows_) {
+    bytes += flow->GetWeightBytes();
+  }
+  return bytes;
+}
+
 MaceStatus SerialEngine::AllocateIntermediateBuffer() {
   if (!inter_mem_released_) {
     return MaceStatus::MACE_SUCCESS;
@@ -163,6 +245,7 @@ MaceStatus SerialEngine::CreateAndInitRuntimes(
     auto cpu_runtime = SmartCreateRuntime(
         runtime_registry.get(), RuntimeType::RT_CPU, runtime_context_.get());
     MACE_RETURN_IF_ERROR(cpu_runtime->Init(config_impl_.get(), CPU_BUFFER));
+    cpu_runtime->SetMemoryBudget(memory_budget_);
     cpu_runtime_ = std::move(cpu_runtime);
   }
   runtimes_.emplace(cpu_rt_key, cpu_runtime_);
@@ -214,6 +297,7 @@ MaceStatus SerialEngine::CreateAndInitRuntimes(
                    "no mem type specified");
         MACE_RETURN_IF_ERROR(unique_runtime->Init(config_impl_.get(),
                                                   mem_type_i));
+        unique_runtime->SetMemoryBudget(memory_budget_);
         runtime = std::move(unique_runtime);
       }
       runtimes_.emplace(key, runtime);
@@ -340,12 +424,14 @@ MaceStatus SerialEngine::CreateTensorsForFlows(
     const NetDef *net_def = iter->second;
     int output_size = net_def->output_info_size();
     auto tensor_info = std::make_shared<MaceTensorInfo>();
+    auto &output_keys = flow_output_keys_[flows_[k].get()];
     for (int i = 0; i < output_size; ++i) {
       const InputOutputInfo &output_info = net_def->output_info(i);
       const auto &output_name = output_info.name();
       const auto &output_alias = output_info.alias();
       const auto
           &output_key = output_alias.empty() ? output_name : output_alias;
+      output_keys.emplace_back(output_name, output_key);
       auto find_iter = std::find(out_nodes.begin(), out_nodes.end(),
                                  output_name);
       if (find_iter != out_nodes.end()) {  // no need to allocate
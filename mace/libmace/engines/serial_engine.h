@@ -15,10 +15,12 @@
 #ifndef MACE_LIBMACE_ENGINES_SERIAL_ENGINE_H_
 #define MACE_LIBMACE_ENGINES_SERIAL_ENGINE_H_
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "mace/core/flow/base_flow.h"
@@ -50,8 +52,10 @@ class SerialEngine : public BaseEngine {
 
   MaceStatus ReleaseIntermediateBuffer() override;
   MaceStatus AllocateIntermediateBuffer() override;
+  void SetRunInterrupter(const std::function<bool()> &interrupter) override;
 
  protected:
+  index_t GetWeightBytes() const override;
   MaceStatus BeforeRun() override;
   MaceStatus Run(const std::map<std::string, MaceTensor> &inputs,
                  std::map<std::string, MaceTensor> *outputs,
@@ -66,6 +70,16 @@ class SerialEngine : public BaseEngine {
                              std::shared_ptr<MaceTensorInfo>> FlowTensorMap;
   typedef std::vector<std::unique_ptr<BaseFlow>> FlowArray;
   typedef std::map<int, const NetDef *> NetDefMap;
+  // The output name and the key the following flows refer to the output by.
+  typedef std::vector<std::pair<std::string, std::string>> FlowOutputKeys;
+  // A flow to run with the outputs it has to produce, all of its outputs
+  // when output_names is empty.
+  struct FlowRunStep {
+    BaseFlow *flow;
+    std::vector<std::string> output_names;
+  };
+  typedef std::vector<FlowRunStep> RunPlan;
+
   MaceStatus DoInit(const MultiNetDef *multi_net_def,
                     const std::vector<std::string> &input_nodes,
                     const std::vector<std::string> &output_nodes,
@@ -89,12 +103,18 @@ class SerialEngine : public BaseEngine {
       const NetDefMap &net_defs, const std::vector<std::string> &input_nodes,
       const std::vector<std::string> &output_nodes);
 
+  // Flows and flow outputs the requested outputs depend on, cached per
+  // requested output set.
+  const RunPlan &GetRunPlan(const std::map<std::string, MaceTensor> &outputs);
+
  private:
   std::shared_ptr<Runtime> cpu_runtime_;
   FlowArray flows_;
 
   FlowTensorMap input_tensors_;
   FlowTensorMap output_tensors_;
+  std::unordered_map<const BaseFlow *, FlowOutputKeys> flow_output_keys_;
+  std::unordered_map<std::string, RunPlan> run_plans_;
   std::vector<std::shared_ptr<void>> output_tensor_buffers_;
   std::unordered_map<std::string, std::shared_ptr<MaceTensorInfo>> run_helper_;
 
@@ -51,6 +51,7 @@ MaceStatus SingleFlowEngine::CreateAndInitRuntimes(const NetDef *net_def,
     auto cpu_runtime = SmartCreateRuntime(
         runtime_registry.get(), RuntimeType::RT_CPU, runtime_context_.get());
     MACE_RETURN_IF_ERROR(cpu_runtime->Init(config_impl_.get(), CPU_BUFFER));
+    cpu_runtime->SetMemoryBudget(memory_budget_);
     cpu_runtime_ = std::move(cpu_runtime);
   }
   runtimes_.emplace(cpu_rt_key, cpu_runtime_);
@@ -77,6 +78,7 @@ MaceStatus SingleFlowEngine::CreateAndInitRuntimes(const NetDef *net_def,
     auto runtime = SmartCreateRuntime(
         runtime_registry.get(), target_runtime_type, runtime_context_.get());
     MACE_RETURN_IF_ERROR(runtime->Init(config_impl_.get(), mem_type));
+    runtime->SetMemoryBudget(memory_budget_);
     runtime_ = std::move(runtime);
   }
   runtimes_.emplace(target_rt_key, runtime_);
@@ -135,6 +137,18 @@ MaceStatus SingleFlowEngine::Init(const MultiNetDef *multi_net_def,
                 model_data, model_data_size, model_data_unused, tutor);
 }
 
+void SingleFlowEngine::SetRunInterrupter(
+    const std::function<bool()> &interrupter) {
+  BaseEngine::SetRunInterrupter(interrupter);
+  if (single_flow_ != nullptr) {
+    single_flow_->SetRunInterrupter(interrupter);
+  }
+}
+
+index_t SingleFlowEngine::GetWeightBytes() const {
+  return single_flow_ == nullptr ? 0 : single_flow_->GetWeightBytes();
+}
+
 MaceStatus SingleFlowEngine::Run(
     const std::map<std::string, MaceTensor> &inputs,
     std::map<std::string, MaceTensor> *outputs,
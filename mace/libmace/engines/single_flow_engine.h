@@ -15,6 +15,7 @@
 #ifndef MACE_LIBMACE_ENGINES_SINGLE_FLOW_ENGINE_H_
 #define MACE_LIBMACE_ENGINES_SINGLE_FLOW_ENGINE_H_
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -46,7 +47,10 @@ class SingleFlowEngine : public BaseEngine {
                   const int64_t model_data_size,
                   bool *model_data_unused) override;
 
+  void SetRunInterrupter(const std::function<bool()> &interrupter) override;
+
  protected:
+  index_t GetWeightBytes() const override;
   MaceStatus Run(const std::map<std::string, MaceTensor> &inputs,
                  std::map<std::string, MaceTensor> *outputs,
                  RunMetadata *run_metadata) override;
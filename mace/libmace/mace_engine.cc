@@ -12,6 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "mace/libmace/async_executor.h"
 #include "mace/libmace/engines/base_engine.h"
 #include "mace/libmace/engines/engine_registry.h"
 #include "mace/port/logger.h"
@@ -23,6 +31,96 @@
 
 namespace mace {
 
+class MaceRunHandle::Impl {
+ public:
+  explicit Impl(const int64_t timeout_us)
+      : has_deadline_(timeout_us >= 0),
+        deadline_(std::chrono::steady_clock::now() +
+            std::chrono::microseconds(std::max<int64_t>(timeout_us, 0))),
+        cancelled_(false),
+        done_(false) {}
+
+  void Cancel() { cancelled_ = true; }
+
+  bool Interrupted() const {
+    return cancelled_ || (has_deadline_ &&
+        std::chrono::steady_clock::now() >= deadline_);
+  }
+
+  // Only meaningful once Interrupted() returned true.
+  MaceStatus InterruptStatus() const {
+    return cancelled_ ? MaceStatus::MACE_CANCELLED
+                      : MaceStatus::MACE_DEADLINE_EXCEEDED;
+  }
+
+  void Finish(const MaceStatus &status) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      status_ = status;
+      done_ = true;
+    }
+    cond_.notify_all();
+  }
+
+  bool IsDone() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return done_;
+  }
+
+  MaceStatus Wait() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return done_; });
+    return status_;
+  }
+
+  bool WaitFor(const int64_t timeout_us) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cond_.wait_for(lock, std::chrono::microseconds(timeout_us),
+                          [this] { return done_; });
+  }
+
+ private:
+  const bool has_deadline_;
+  const std::chrono::steady_clock::time_point deadline_;
+  std::atomic<bool> cancelled_;
+  mutable std::mutex mutex_;
+  mutable std::condition_variable cond_;
+  bool done_;
+  MaceStatus status_;
+
+  MACE_DISABLE_COPY_AND_ASSIGN(Impl);
+};
+
+MaceRunHandle::MaceRunHandle() = default;
+MaceRunHandle::MaceRunHandle(const MaceRunHandle &other) = default;
+MaceRunHandle &MaceRunHandle::operator=(
+    const MaceRunHandle &other) = default;
+MaceRunHandle::~MaceRunHandle() = default;
+
+bool MaceRunHandle::Valid() const {
+  return impl_ != nullptr;
+}
+
+bool MaceRunHandle::IsDone() const {
+  MACE_CHECK(Valid(), "Invalid run handle.");
+  return impl_->IsDone();
+}
+
+MaceStatus MaceRunHandle::Wait() const {
+  MACE_CHECK(Valid(), "Invalid run handle.");
+  return impl_->Wait();
+}
+
+bool MaceRunHandle::WaitFor(int64_t timeout_us) const {
+  MACE_CHECK(Valid(), "Invalid run handle.");
+  return impl_->WaitFor(timeout_us);
+}
+
+void MaceRunHandle::Cancel() {
+  MACE_CHECK(Valid(), "Invalid run handle.");
+  impl_->Cancel();
+}
+
 class MaceEngine::Impl {
  public:
   explicit Impl(const MaceEngineConfig &config)
@@ -60,12 +158,22 @@ class MaceEngine::Impl {
 
   MaceStatus Run(const std::map<std::string, MaceTensor> &inputs,
                  std::map<std::string, MaceTensor> *outputs,
-                 RunMetadata *run_metadata);
+                 RunMetadata *run_metadata,
+                 const std::function<bool()> &interrupter = nullptr);
+
+  void Submit(AsyncExecutor::Job job);
 
   MaceStatus ReleaseIntermediateBuffer();
 
+  MaceStatus GetMemoryUsage(MemoryUsage *usage);
+
  private:
   std::unique_ptr<BaseEngine> engine_;
+  // serializes the synchronous and the asynchronous runs
+  std::mutex run_mutex_;
+  std::mutex executor_mutex_;
+  // declared last so that the worker is joined before the engine goes away
+  std::unique_ptr<AsyncExecutor> executor_;
 
   MACE_DISABLE_COPY_AND_ASSIGN(Impl);
 };
@@ -124,14 +232,36 @@ MaceStatus MaceEngine::Impl::Init(
 MaceStatus MaceEngine::Impl::Run(
     const std::map<std::string, MaceTensor> &inputs,
     std::map<std::string, MaceTensor> *outputs,
-    RunMetadata *run_metadata) {
-  return engine_->Forward(inputs, outputs, run_metadata);
+    RunMetadata *run_metadata,
+    const std::function<bool()> &interrupter) {
+  std::lock_guard<std::mutex> lock(run_mutex_);
+  if (!interrupter) {
+    return engine_->Forward(inputs, outputs, run_metadata);
+  }
+  engine_->SetRunInterrupter(interrupter);
+  MaceStatus status = engine_->Forward(inputs, outputs, run_metadata);
+  engine_->SetRunInterrupter(nullptr);
+  return status;
+}
+
+void MaceEngine::Impl::Submit(AsyncExecutor::Job job) {
+  std::lock_guard<std::mutex> lock(executor_mutex_);
+  if (executor_ == nullptr) {
+    executor_ = make_unique<AsyncExecutor>();
+  }
+  executor_->Submit(std::move(job));
 }
 
 MaceStatus MaceEngine::Impl::ReleaseIntermediateBuffer() {
+  std::lock_guard<std::mutex> lock(run_mutex_);
   return engine_->ReleaseIntermediateBuffer();
 }
 
+MaceStatus MaceEngine::Impl::GetMemoryUsage(MemoryUsage *usage) {
+  std::lock_guard<std::mutex> lock(run_mutex_);
+  return engine_->GetMemoryUsage(usage);
+}
+
 MaceEngine::MaceEngine(const MaceEngineConfig &config) :
     impl_(make_unique<MaceEngine::Impl>(config)) {}
 
@@ -189,6 +319,37 @@ MaceStatus MaceEngine::Run(const std::map<std::string, MaceTensor> &inputs,
   return impl_->Run(inputs, outputs, nullptr);
 }
 
+MaceRunHandle MaceEngine::RunAsync(
+    const std::map<std::string, MaceTensor> &inputs,
+    std::map<std::string, MaceTensor> *outputs,
+    std::function<void(const MaceStatus &)> callback,
+    int64_t timeout_us) {
+  MACE_CHECK_NOTNULL(outputs);
+  MaceRunHandle handle;
+  handle.impl_ = std::make_shared<MaceRunHandle::Impl>(timeout_us);
+  std::shared_ptr<MaceRunHandle::Impl> run = handle.impl_;
+  MaceEngine::Impl *engine = impl_.get();
+  impl_->Submit([engine, run, inputs, outputs, callback](bool to_run) {
+    MaceStatus status;
+    if (!to_run) {
+      status = MaceStatus(MaceStatus::MACE_CANCELLED, "engine destroyed");
+    } else if (run->Interrupted()) {
+      status = run->InterruptStatus();
+    } else {
+      status = engine->Run(inputs, outputs, nullptr,
+                           [run]() { return run->Interrupted(); });
+      if (status == MaceStatus::MACE_CANCELLED) {
+        status = run->InterruptStatus();
+      }
+    }
+    if (callback) {
+      callback(status);
+    }
+    run->Finish(status);
+  });
+  return handle;
+}
+
 // Deprecated, will be removed in future version.
 MaceStatus MaceEngine::Init(const NetDef *net_def,
                             const std::vector<std::string> &input_nodes,
@@ -203,6 +364,10 @@ MaceStatus MaceEngine::ReleaseIntermediateBuffer() {
   return impl_->ReleaseIntermediateBuffer();
 }
 
+MaceStatus MaceEngine::GetMemoryUsage(MemoryUsage *usage) const {
+  return impl_->GetMemoryUsage(usage);
+}
+
 
 MaceStatus CreateMaceEngineFromProto(
     const unsigned char *model_graph_proto,
@@ -33,7 +33,10 @@ MaceEngineCfgImpl::MaceEngineCfgImpl()
       hexagon_latency_(100),
       apu_cache_policy_(APUCachePolicy::APU_CACHE_NONE),
       apu_binary_file_(""),
-      apu_storage_file_("") {}
+      apu_storage_file_(""),
+      result_cache_size_(0),
+      incremental_run_(false),
+      memory_budget_(0) {}
 
 void MaceEngineCfgImpl::SetRuntimeType(const RuntimeType runtime_type,
                                        const char *sub_graph_name) {
@@ -84,6 +87,18 @@ std::string MaceEngineCfgImpl::apu_storage_file() const {
   return apu_storage_file_;
 }
 
+int MaceEngineCfgImpl::result_cache_size() const {
+  return result_cache_size_;
+}
+
+bool MaceEngineCfgImpl::incremental_run() const {
+  return incremental_run_;
+}
+
+int64_t MaceEngineCfgImpl::memory_budget() const {
+  return memory_budget_;
+}
+
 RuntimeType MaceEngineCfgImpl::runtime_type(
     const std::string &sub_graph_name) const {
   if (runtime_map_.count(sub_graph_name) == 0) {
@@ -153,6 +168,27 @@ MaceStatus MaceEngineCfgImpl::SetAPUCache(
   return ret ? MaceStatus::MACE_SUCCESS : MaceStatus::MACE_RUNTIME_ERROR;
 }
 
+MaceStatus MaceEngineCfgImpl::SetResultCache(int max_entries) {
+  if (max_entries < 0) {
+    return MaceStatus::MACE_INVALID_ARGS;
+  }
+  result_cache_size_ = max_entries;
+  return MaceStatus::MACE_SUCCESS;
+}
+
+MaceStatus MaceEngineCfgImpl::SetIncrementalRun(bool enable) {
+  incremental_run_ = enable;
+  return MaceStatus::MACE_SUCCESS;
+}
+
+MaceStatus MaceEngineCfgImpl::SetMemoryBudget(int64_t bytes) {
+  if (bytes < 0) {
+    return MaceStatus::MACE_INVALID_ARGS;
+  }
+  memory_budget_ = bytes;
+  return MaceStatus::MACE_SUCCESS;
+}
+
 MaceEngineConfig::MaceEngineConfig() : impl_(new MaceEngineCfgImpl()) {}
 
 MaceEngineConfig::~MaceEngineConfig() = default;
@@ -202,4 +238,16 @@ MaceStatus MaceEngineConfig::SetAPUCache(
   return impl_->SetAPUCache(policy, binary_file, storage_file);
 }
 
+MaceStatus MaceEngineConfig::SetResultCache(int max_entries) {
+  return impl_->SetResultCache(max_entries);
+}
+
+MaceStatus MaceEngineConfig::SetIncrementalRun(bool enable) {
+  return impl_->SetIncrementalRun(enable);
+}
+
+MaceStatus MaceEngineConfig::SetMemoryBudget(int64_t bytes) {
+  return impl_->SetMemoryBudget(bytes);
+}
+
 }  // namespace mace
@@ -16,14 +16,87 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <numeric>
+#include <utility>
 #include <vector>
 
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "mace/core/ops/operator.h"
 #include "mace/core/registry/ops_registry.h"
 
 namespace mace {
 namespace ops {
 
+namespace {
+template <typename T>
+int ScanExtremeIndex(const T *data, const int size, const bool argmin) {
+  int index = 0;
+  for (int i = 1; i < size; ++i) {
+    if (argmin ? data[i] < data[index] : data[i] >= data[index]) {
+      index = i;
+    }
+  }
+  return index;
+}
+
+template <typename T>
+int FindExtremeIndex(const T *data, const int size, const bool argmin) {
+  return ScanExtremeIndex(data, size, argmin);
+}
+
+#if defined(MACE_ENABLE_NEON) || defined(__SSE2__)
+// Finds the extreme value with vector min/max first, then its index.
+template <>
+int FindExtremeIndex<float>(const float *data, const int size,
+                            const bool argmin) {
+  int i = 0;
+  float lanes[4] = {data[0], data[0], data[0], data[0]};
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t extremes = vdupq_n_f32(data[0]);
+  for (; i + 4 <= size; i += 4) {
+    const float32x4_t values = vld1q_f32(data + i);
+    extremes = argmin ? vminq_f32(extremes, values)
+                      : vmaxq_f32(extremes, values);
+  }
+  vst1q_f32(lanes, extremes);
+#else
+  __m128 extremes = _mm_set1_ps(data[0]);
+  for (; i + 4 <= size; i += 4) {
+    const __m128 values = _mm_loadu_ps(data + i);
+    extremes = argmin ? _mm_min_ps(extremes, values)
+                      : _mm_max_ps(extremes, values);
+  }
+  _mm_storeu_ps(lanes, extremes);
+#endif
+  float extreme = lanes[0];
+  for (int lane = 1; lane < 4; ++lane) {
+    extreme = argmin ? std::min(extreme, lanes[lane])
+                     : std::max(extreme, lanes[lane]);
+  }
+  for (; i < size; ++i) {
+    extreme = argmin ? std::min(extreme, data[i])
+                     : std::max(extreme, data[i]);
+  }
+  if (argmin) {
+    for (int k = 0; k < size; ++k) {
+      if (data[k] == extreme) return k;
+    }
+  } else {
+    for (int k = size - 1; k >= 0; --k) {
+      if (data[k] == extreme) return k;
+    }
+  }
+  // NaNs are not ordered
+  return ScanExtremeIndex(data, size, argmin);
+}
+#endif  // MACE_ENABLE_NEON || __SSE2__
+}  // namespace
+
 template<RuntimeType D, class T>
 class ArgMaxOp : public Operation {
  public:
@@ -40,7 +113,6 @@ class ArgMaxOp : public Operation {
         keep_dims_(Operation::GetOptionalArg<bool>("keepdims", true)) {}
 
   MaceStatus Run(OpContext *context) override {
-    MACE_UNUSED(context);
     const Tensor *input = this->Input(0);
     Tensor *output = this->Output(0);
 
@@ -64,57 +136,119 @@ class ArgMaxOp : public Operation {
       axis_dist = 1;
     }
     const auto output_loop = input->size() / axis_dim;
+    utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
 
-    for (int i = 0; i < output_loop; i += 1) {
-      std::vector<std::pair<T, int>> input_data_vector(axis_dim);
-      const auto axis_base = i / axis_dist * axis_dim;
-      const auto axis_offset = i % axis_dist;
-      for (int d = 0; d < axis_dim; ++d) {
-        const auto input_idx = (axis_base + d) * axis_dist + axis_offset;
-        input_data_vector[d] = std::make_pair(input_data[input_idx], d);
-      }
-
-      if (argmin_) {
-        std::partial_sort(input_data_vector.begin(),
-                          input_data_vector.begin() + top_k_,
-                          input_data_vector.end(),
-                          std::less<std::pair<T, int>>());
-      } else {
-        std::partial_sort(input_data_vector.begin(),
-                          input_data_vector.begin() + top_k_,
-                          input_data_vector.end(),
-                          std::greater<std::pair<T, int>>());
-      }
+    if (top_k_ == 1) {
+      // The extreme of the rows along the axis, the last max or the first
+      // min as partial_sort of the pairs gives.
+      const index_t outer_size = output_loop / axis_dist;
+      const bool argmin = argmin_;
+      int32_t *index_data =
+          out_val_ ? nullptr : output->mutable_data<int32_t>();
+      T *value_data = out_val_ ? output->mutable_data<T>() : nullptr;
+      thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                                index_t start1, index_t end1, index_t step1) {
+        std::vector<T> best_values(end1 - start1);
+        std::vector<int> best_indices(end1 - start1);
+        for (index_t o = start0; o < end0; o += step0) {
+          const T *outer_data = input_data + o * axis_dim * axis_dist;
+          if (axis_dist == 1) {
+            const int index = FindExtremeIndex(outer_data, axis_dim, argmin);
+            WriteResult(o, outer_data[index], index, index_data, value_data);
+            continue;
+          }
+          for (index_t j = start1; j < end1; j += step1) {
+            best_values[j - start1] = outer_data[j];
+            best_indices[j - start1] = 0;
+          }
+          for (int d = 1; d < axis_dim; ++d) {
+            const T *row_data = outer_data + d * axis_dist;
+            for (index_t j = start1; j < end1; j += step1) {
+              const T value = row_data[j];
+              T &best_value = best_values[j - start1];
+              const bool better = argmin ? value < best_value
+                                         : value >= best_value;
+              if (better) {
+                best_value = value;
+                best_indices[j - start1] = d;
+              }
+            }
+          }
+          for (index_t j = start1; j < end1; j += step1) {
+            WriteResult(o * axis_dist + j, best_values[j - start1],
+                        best_indices[j - start1], index_data, value_data);
+          }
+        }
+      }, 0, outer_size, 1, 0, axis_dist, 1);
+      return MaceStatus::MACE_SUCCESS;
+    }
 
-      if (!out_val_) {
-        auto output_data = output->mutable_data<int32_t>();
-        const auto top_k_base = i / axis_dist * top_k_;
-        for (int j = 0; j < top_k_; ++j) {
-          const auto output_idx = (top_k_base + j) * axis_dist + axis_offset;
-          output_data[output_idx] = input_data_vector[j].second;
+    thread_pool.Compute1D([=](index_t start, index_t end, index_t step) {
+      std::vector<std::pair<T, int>> input_data_vector(axis_dim);
+      for (index_t i = start; i < end; i += step) {
+        const auto axis_base = i / axis_dist * axis_dim;
+        const auto axis_offset = i % axis_dist;
+        for (int d = 0; d < axis_dim; ++d) {
+          const auto input_idx = (axis_base + d) * axis_dist + axis_offset;
+          input_data_vector[d] = std::make_pair(input_data[input_idx], d);
         }
-      } else if (has_axis_) {  // Produces max/min value per axis
-        auto output_data = output->mutable_data<T>();
-        const auto top_k_base = i / axis_dist * top_k_;
-        for (int j = 0; j < top_k_; ++j) {
-          auto output_idx = (top_k_base + j) * axis_dist + axis_offset;
-          output_data[output_idx] = input_data_vector[j].first;
+
+        if (argmin_) {
+          std::partial_sort(input_data_vector.begin(),
+                            input_data_vector.begin() + top_k_,
+                            input_data_vector.end(),
+                            std::less<std::pair<T, int>>());
+        } else {
+          std::partial_sort(input_data_vector.begin(),
+                            input_data_vector.begin() + top_k_,
+                            input_data_vector.end(),
+                            std::greater<std::pair<T, int>>());
         }
-      } else {  // Produces max_ind and max/min value
-        auto output_data = output->mutable_data<T>();
-        const auto top_k_base_pos = 2 * i * top_k_;
-        const auto top_k_base_value = top_k_base_pos + top_k_;
-        for (int j = 0; j < top_k_; ++j) {
-          output_data[top_k_base_pos + j] = input_data_vector[j].second;
-          output_data[top_k_base_value + j] = input_data_vector[j].first;
+
+        if (!out_val_) {
+          auto output_data = output->mutable_data<int32_t>();
+          const auto top_k_base = i / axis_dist * top_k_;
+          for (int j = 0; j < top_k_; ++j) {
+            const auto output_idx =
+                (top_k_base + j) * axis_dist + axis_offset;
+            output_data[output_idx] = input_data_vector[j].second;
+          }
+        } else if (has_axis_) {  // Produces max/min value per axis
+          auto output_data = output->mutable_data<T>();
+          const auto top_k_base = i / axis_dist * top_k_;
+          for (int j = 0; j < top_k_; ++j) {
+            auto output_idx = (top_k_base + j) * axis_dist + axis_offset;
+            output_data[output_idx] = input_data_vector[j].first;
+          }
+        } else {  // Produces max_ind and max/min value
+          auto output_data = output->mutable_data<T>();
+          const auto top_k_base_pos = 2 * i * top_k_;
+          const auto top_k_base_value = top_k_base_pos + top_k_;
+          for (int j = 0; j < top_k_; ++j) {
+            output_data[top_k_base_pos + j] = input_data_vector[j].second;
+            output_data[top_k_base_value + j] = input_data_vector[j].first;
+          }
         }
       }
-    }
+    }, 0, output_loop, 1);
 
     return MaceStatus::MACE_SUCCESS;
   }
 
  private:
+  // Writes the top 1 of output position i to the index or value output.
+  void WriteResult(const index_t i, const T value, const int index,
+                   int32_t *index_data, T *value_data) const {
+    if (!out_val_) {
+      index_data[i] = index;
+    } else if (has_axis_) {
+      value_data[i] = value;
+    } else {
+      value_data[2 * i] = index;
+      value_data[2 * i + 1] = value;
+    }
+  }
+
   int GetAxisValue(const index_t input_dim_size) {
     const Tensor *axis = this->InputSize() == 2 ? this->Input(1) : nullptr;
     int axis_value = 0;
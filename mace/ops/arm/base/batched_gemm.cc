@@ -0,0 +1,171 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/ops/arm/base/batched_gemm.h"
+
+#include <algorithm>
+
+namespace mace {
+namespace ops {
+namespace arm {
+
+template<typename T>
+MaceStatus BatchedGemm<T>::Compute(const OpContext *context,
+                                   const Tensor *lhs,
+                                   const Tensor *rhs,
+                                   const index_t batch,
+                                   const index_t rows,
+                                   const index_t cols,
+                                   const index_t depth,
+                                   const MatrixMajor lhs_major,
+                                   const MatrixMajor rhs_major,
+                                   const MatrixMajor output_major,
+                                   const index_t lhs_batch_stride,
+                                   const index_t rhs_batch_stride,
+                                   Tensor *output) {
+  MACE_CHECK(output->size() == batch * rows * cols,
+             "Need resize output tensor before call gemm.");
+  const T *lhs_data = lhs->data<T>();
+  const T *rhs_data = rhs->data<T>();
+  T *output_data = output->mutable_data<T>();
+
+#ifdef __aarch64__
+  const index_t row_block_size = 8;
+#else
+  const index_t row_block_size = 4;
+#endif
+  const index_t col_block_size = 8;
+  const index_t depth_block_size = 4;
+  const index_t row_block_count = RoundUpDiv(rows, row_block_size);
+  const index_t col_block_count = RoundUpDiv(cols, col_block_size);
+  const index_t rows_padded = RoundUp(rows, row_block_size);
+  const index_t cols_padded = RoundUp(cols, col_block_size);
+  const index_t depth_padded = RoundUp(depth, depth_block_size);
+  const index_t packed_lhs_size = rows_padded * depth_padded;
+  const index_t packed_rhs_size = depth_padded * cols_padded;
+  // a broadcast operand is packed only once
+  const index_t lhs_count = lhs_batch_stride == 0 ? 1 : batch;
+  const index_t rhs_count = rhs_batch_stride == 0 ? 1 : batch;
+
+  auto *runtime = context->runtime();
+  MemInfo mem_info(output->memory_type(), DataTypeToEnum<T>::value,
+                   {lhs_count * packed_lhs_size});
+  auto packed_lhs_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
+  mem_info.dims = {rhs_count * packed_rhs_size};
+  auto packed_rhs_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
+  Gemm<T> *gemm = &gemm_;
+  // without room for the packing, the operands are multiplied in place
+  if (packed_lhs_buffer->memory<void>() == nullptr ||
+      packed_rhs_buffer->memory<void>() == nullptr) {
+    gemm->ComputeUnpacked(context, lhs, rhs, batch, rows, cols, depth,
+                          lhs_major, rhs_major, output_major,
+                          lhs_batch_stride, rhs_batch_stride, row_block_size,
+                          col_block_size, depth_padded, output);
+    return MaceStatus::MACE_SUCCESS;
+  }
+  T *packed_lhs_data = packed_lhs_buffer->mutable_data<T>();
+  T *packed_rhs_data = packed_rhs_buffer->mutable_data<T>();
+
+  utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+
+  // pack lhs
+  thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                            index_t start1, index_t end1, index_t step1) {
+    for (index_t b = start0; b < end0; b += step0) {
+      MatrixMap<const T> lhs_matrix(lhs_data + b * lhs_batch_stride,
+                                    lhs_major, rows, depth);
+      for (index_t row_block_idx = start1; row_block_idx < end1;
+           row_block_idx += step1) {
+        const index_t start_row = row_block_idx * row_block_size;
+        const index_t
+            row_block_len = std::min(row_block_size, rows - start_row);
+        gemm->PackLhs(lhs_matrix.block(start_row, 0, row_block_len, depth),
+                      packed_lhs_data + b * packed_lhs_size +
+                          row_block_idx * row_block_size * depth_padded);
+      }  // row_block_idx
+    }  // b
+  }, 0, lhs_count, 1, 0, row_block_count, 1);
+
+  // pack rhs
+  thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                            index_t start1, index_t end1, index_t step1) {
+    for (index_t b = start0; b < end0; b += step0) {
+      MatrixMap<const T> rhs_matrix(rhs_data + b * rhs_batch_stride,
+                                    rhs_major, depth, cols);
+      for (index_t col_block_idx = start1; col_block_idx < end1;
+           col_block_idx += step1) {
+        const index_t start_col = col_block_idx * col_block_size;
+        const index_t
+            col_block_len = std::min(col_block_size, cols - start_col);
+        gemm->PackRhs(rhs_matrix.block(0, start_col, depth, col_block_len),
+                      packed_rhs_data + b * packed_rhs_size +
+                          col_block_idx * col_block_size * depth_padded);
+      }  // col_block_idx
+    }  // b
+  }, 0, rhs_count, 1, 0, col_block_count, 1);
+
+  // multiply lhs and rhs
+  thread_pool.Compute3D([=](index_t start0, index_t end0, index_t step0,
+                            index_t start1, index_t end1, index_t step1,
+                            index_t start2, index_t end2, index_t step2) {
+    T packed_output_data[row_block_size * col_block_size];
+    for (index_t b = start0; b < end0; b += step0) {
+      const T *packed_lhs_matrix =
+          packed_lhs_data + (lhs_count == 1 ? 0 : b) * packed_lhs_size;
+      const T *packed_rhs_matrix =
+          packed_rhs_data + (rhs_count == 1 ? 0 : b) * packed_rhs_size;
+      MatrixMap<T> output_matrix(output_data + b * rows * cols,
+                                 output_major, rows, cols);
+      for (index_t row_block_idx = start1; row_block_idx < end1;
+           row_block_idx += step1) {
+        const index_t start_row = row_block_idx * row_block_size;
+        const index_t
+            row_block_len = std::min(row_block_size, rows - start_row);
+        for (index_t col_block_idx = start2; col_block_idx < end2;
+             col_block_idx += step2) {
+          const index_t start_col = col_block_idx * col_block_size;
+          const index_t
+              col_block_len = std::min(col_block_size, cols - start_col);
+          gemm->ComputeBlock(
+              packed_lhs_matrix + row_block_idx * row_block_size * depth_padded,
+              packed_rhs_matrix + col_block_idx * col_block_size * depth_padded,
+              depth_padded,
+              packed_output_data);
+          MatrixMap<T> output_block = output_matrix.block(start_row,
+                                                          start_col,
+                                                          row_block_len,
+                                                          col_block_len);
+          gemm->UnpackOutput(packed_output_data, &output_block);
+        }  // col_block_idx
+      }  // row_block_idx
+    }  // b
+  }, 0, batch, 1, 0, row_block_count, 1, 0, col_block_count, 1);
+
+  return MaceStatus::MACE_SUCCESS;
+}
+
+void RegisterBatchedGemmDelegator(OpDelegatorRegistry *registry) {
+  MACE_REGISTER_DELEGATOR(
+      registry, BatchedGemm<float>, DelegatorParam,
+      MACE_DELEGATOR_KEY(BatchedGemm, RuntimeType::RT_CPU, float,
+                         ImplType::NEON));
+
+  MACE_REGISTER_BF16_DELEGATOR(
+      registry, BatchedGemm<BFloat16>, DelegatorParam,
+      MACE_DELEGATOR_KEY(BatchedGemm, RuntimeType::RT_CPU, BFloat16,
+                         ImplType::NEON));
+}
+}  // namespace arm
+}  // namespace ops
+}  // namespace mace
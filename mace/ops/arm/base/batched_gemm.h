@@ -0,0 +1,62 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_OPS_ARM_BASE_BATCHED_GEMM_H_
+#define MACE_OPS_ARM_BASE_BATCHED_GEMM_H_
+
+#include "mace/core/ops/op_context.h"
+#include "mace/core/tensor.h"
+#include "mace/ops/arm/base/gemm.h"
+#include "mace/ops/common/matrix.h"
+#include "mace/ops/delegator/batched_gemm.h"
+#include "mace/public/mace.h"
+
+namespace mace {
+namespace ops {
+namespace arm {
+
+// Runs the packing and the block kernels of Gemm over the whole batch:
+// every lhs and rhs matrix is packed in one pass, a broadcast one only
+// once, then all of the batch x row blocks x col blocks are multiplied in a
+// single dispatch.
+template<typename T>
+class BatchedGemm : public delegator::BatchedGemm {
+ public:
+  explicit BatchedGemm(const DelegatorParam &param)
+      : delegator::BatchedGemm(param), gemm_(delegator::GemmParam()) {}
+  ~BatchedGemm() {}
+
+  MaceStatus Compute(const OpContext *context,
+                     const Tensor *lhs,
+                     const Tensor *rhs,
+                     const index_t batch,
+                     const index_t rows,
+                     const index_t cols,
+                     const index_t depth,
+                     const MatrixMajor lhs_major,
+                     const MatrixMajor rhs_major,
+                     const MatrixMajor output_major,
+                     const index_t lhs_batch_stride,
+                     const index_t rhs_batch_stride,
+                     Tensor *output) override;
+
+ private:
+  Gemm<T> gemm_;
+};
+
+}  // namespace arm
+}  // namespace ops
+}  // namespace mace
+
+#endif  // MACE_OPS_ARM_BASE_BATCHED_GEMM_H_
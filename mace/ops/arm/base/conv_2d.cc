@@ -166,7 +166,8 @@ MaceStatus Conv2dBase::ResizeOutAndPadInOut(const OpContext *context,
         {batch, in_channels, padded_in_height, padded_in_width};
     std::unique_ptr<Tensor> padded_in = make_unique<Tensor>(
         runtime, input->dtype(), MemoryType::CPU_BUFFER, padded_in_shape);
-    runtime->AllocateBufferForTensor(padded_in.get(), RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(padded_in.get(), RENT_SCRATCH));
     MACE_CHECK(padded_in->data<float>() != nullptr);
     PadInput(*input, in_pad_size[0], in_pad_size[2], padded_in.get());
     *padded_input = std::move(padded_in);
@@ -176,7 +177,8 @@ MaceStatus Conv2dBase::ResizeOutAndPadInOut(const OpContext *context,
         {batch, out_channels, padded_out_height, padded_out_width};
     std::unique_ptr<Tensor> padded_out = make_unique<Tensor>(
         runtime, output->dtype(), MemoryType::CPU_BUFFER, padded_out_shape);
-    runtime->AllocateBufferForTensor(padded_out.get(), RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(padded_out.get(), RENT_SCRATCH));
     *padded_output = std::move(padded_out);
   }
   return MaceStatus::MACE_SUCCESS;
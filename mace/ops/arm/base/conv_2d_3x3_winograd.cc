@@ -89,7 +89,8 @@ MaceStatus Conv2dK3x3Winograd<T>::Compute(const OpContext *context,
     auto tensor_shape = {batch, in_channels, padded_in_height, padded_in_width};
     tmp_padded_in = make_unique<Tensor>(runtime, DataTypeToEnum<T>::v(),
                                         mem_type, tensor_shape);
-    runtime->AllocateBufferForTensor(tmp_padded_in.get(), RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(tmp_padded_in.get(), RENT_SCRATCH));
     PadInput(*input, pad_top, pad_left, tmp_padded_in.get());
     padded_in = tmp_padded_in.get();
   }
@@ -101,7 +102,8 @@ MaceStatus Conv2dK3x3Winograd<T>::Compute(const OpContext *context,
         {batch, out_channels, padded_out_height, padded_out_width};
     tmp_padded_out = make_unique<Tensor>(runtime, DataTypeToEnum<T>::v(),
                                          mem_type, tensor_shape);
-    runtime->AllocateBufferForTensor(tmp_padded_out.get(), RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(tmp_padded_out.get(), RENT_SCRATCH));
     padded_out = tmp_padded_out.get();
   }
 
@@ -110,6 +112,10 @@ MaceStatus Conv2dK3x3Winograd<T>::Compute(const OpContext *context,
   auto transformed_in = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
   mem_info.dims = {batch, in_tile_area, out_channels, tile_count};
   auto transformed_out = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
+  if (transformed_in->memory<void>() == nullptr ||
+      transformed_out->memory<void>() == nullptr) {
+    return MaceStatus::MACE_OUT_OF_RESOURCES;
+  }
 
   auto *padded_in_data = padded_in->data<T>();
   auto *padded_out_data = padded_out->mutable_data<T>();
@@ -119,10 +125,16 @@ MaceStatus Conv2dK3x3Winograd<T>::Compute(const OpContext *context,
 
   if (!filter->is_weight() || out_tile_size != out_tile_size_) {
     out_tile_size_ = out_tile_size;
+    if (transformed_filter_ != nullptr &&
+        transformed_filter_->memory<void>() != nullptr) {
+      // give the previous filter back to the pool for reuse
+      runtime->ReleaseBufferForTensor(transformed_filter_.get(), RENT_PRIVATE);
+    }
     auto filter_shape = {in_tile_area, out_channels, in_channels};
     transformed_filter_.reset(new Tensor(runtime, DataTypeToEnum<T>::v(),
                                          mem_type, filter_shape));
-    runtime->AllocateBufferForTensor(transformed_filter_.get(), RENT_PRIVATE);
+    MACE_RETURN_IF_ERROR(runtime->AllocateBufferForTensor(
+        transformed_filter_.get(), RENT_PRIVATE));
     auto transformed_filter_data = transformed_filter_->mutable_data<T>();
 
     switch (out_tile_size) {
@@ -65,7 +65,8 @@ MaceStatus Deconv2dBase::ResizeOutAndPadOut(
     auto *runtime = context->runtime();
     *padded_output = make_unique<Tensor>(
         runtime, output->dtype(), output->memory_type(), padded_out_shape);
-    runtime->AllocateBufferForTensor(padded_output->get(), RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(padded_output->get(), RENT_SCRATCH));
   }
 
   return MaceStatus::MACE_SUCCESS;
@@ -18,11 +18,17 @@
 #include <utility>
 
 #include "mace/ops/arm/base/common_neon.h"
+#include "mace/ops/common/gemm_split.h"
 
 namespace mace {
 namespace ops {
 namespace arm {
 
+namespace {
+// The shortest depth slice worth a partial output.
+const index_t kMinDepthSliceSize = 256;
+}  // namespace
+
 template<typename T>
 void Gemm<T>::Pack4x4(const MatrixMap<const T> &matrix,
                       MatrixMajor dst_major, T *packed_matrix) {
@@ -542,14 +548,39 @@ MaceStatus Gemm<T>::Compute(
   const index_t cols_padded = RoundUp(cols, col_block_size);
   const index_t depth_padded = RoundUp(depth, depth_block_size);
 
+  const index_t block_count = row_block_count * col_block_count;
+  const index_t depth_block_count = depth_padded / depth_block_size;
+  const index_t output_block_size = row_block_size * col_block_size;
+
+  utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+  index_t slice_count = GemmDepthSliceCount(
+      block_count, depth, kMinDepthSliceSize, thread_pool.thread_count());
+
   auto *runtime = context->runtime();
   MemInfo mem_info(output->memory_type(), DataTypeToEnum<T>::value,
                    {rows_padded * depth_padded});
   auto packed_lhs_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
   mem_info.dims = {depth_padded * cols_padded};
   auto packed_rhs_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
-  mem_info.dims = {rows_padded * cols_padded};
+  // one packed output per depth slice
+  mem_info.dims = {slice_count * rows_padded * cols_padded};
   auto packed_output_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
+  // without room for the partial outputs, the depth is not split
+  if (slice_count > 1 && packed_output_buffer->memory<void>() == nullptr) {
+    slice_count = 1;
+    mem_info.dims = {rows_padded * cols_padded};
+    packed_output_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
+  }
+  // without room for the packing, the operands are multiplied in place
+  if ((cached_ != kCacheLhs && packed_lhs_buffer->memory<void>() == nullptr) ||
+      (cached_ != kCacheRhs && packed_rhs_buffer->memory<void>() == nullptr) ||
+      packed_output_buffer->memory<void>() == nullptr) {
+    ComputeUnpacked(context, lhs, rhs, batch, rows, cols, depth, lhs_major,
+                    rhs_major, output_major, lhs_batched ? rows * depth : 0,
+                    rhs_batched ? depth * cols : 0, row_block_size,
+                    col_block_size, depth_padded, output);
+    return MaceStatus::MACE_SUCCESS;
+  }
 
   // resize to the total size of lhs & rhs & output anyway,
   // in case we do not cache const tensor for saving memory
@@ -575,7 +606,17 @@ MaceStatus Gemm<T>::Compute(
     }
   }
 
-  utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+  auto unpack_block = [=](const index_t row_block_idx,
+                          const index_t col_block_idx,
+                          const T *packed_output_data_block,
+                          MatrixMap<T> *output_matrix) {
+    const index_t start_row = row_block_idx * row_block_size;
+    const index_t start_col = col_block_idx * col_block_size;
+    MatrixMap<T> output_block = output_matrix->block(
+        start_row, start_col, std::min(row_block_size, rows - start_row),
+        std::min(col_block_size, cols - start_col));
+    UnpackOutput(packed_output_data_block, &output_block);
+  };
 
   for (index_t b = 0; b < batch; ++b) {
     MatrixMap<const T>
@@ -644,39 +685,74 @@ MaceStatus Gemm<T>::Compute(
     }
 
     // multiply lhs and rhs
+    if (slice_count == 1) {
+      thread_pool.Compute2D([=, &output_matrix](
+          index_t start0, index_t end0, index_t step0,
+          index_t start1, index_t end1, index_t step1) {
+        for (index_t row_block_idx = start0; row_block_idx < end0;
+             row_block_idx += step0) {
+          for (index_t col_block_idx = start1; col_block_idx < end1;
+               col_block_idx += step1) {
+            T *packed_output_data_block = packed_output_data +
+                (row_block_idx * col_block_count + col_block_idx) *
+                    output_block_size;
+            ComputeBlock(
+                packed_lhs_data + row_block_idx * row_block_size * depth_padded,
+                packed_rhs_data + col_block_idx * col_block_size * depth_padded,
+                depth_padded,
+                packed_output_data_block);
+            unpack_block(row_block_idx, col_block_idx,
+                         packed_output_data_block, &output_matrix);
+          }  // col_block_idx
+        }  // row_block_idx
+      }, 0, row_block_count, 1, 0, col_block_count, 1);
+      continue;
+    }
+
+    // split-k: each depth slice is multiplied into its own packed partial
+    // output, the slices are aligned to the packed depth blocks
+    thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                              index_t start1, index_t end1, index_t step1) {
+      for (index_t s = start0; s < end0; s += step0) {
+        const index_t depth_begin =
+            depth_block_count * s / slice_count * depth_block_size;
+        const index_t depth_end =
+            depth_block_count * (s + 1) / slice_count * depth_block_size;
+        T *packed_partial_data =
+            packed_output_data + s * block_count * output_block_size;
+        for (index_t block_idx = start1; block_idx < end1;
+             block_idx += step1) {
+          const index_t row_block_idx = block_idx / col_block_count;
+          const index_t col_block_idx = block_idx % col_block_count;
+          ComputeBlock(packed_lhs_data + row_block_idx * row_block_size *
+                           depth_padded + depth_begin * row_block_size,
+                       packed_rhs_data + col_block_idx * col_block_size *
+                           depth_padded + depth_begin * col_block_size,
+                       depth_end - depth_begin,
+                       packed_partial_data + block_idx * output_block_size);
+        }  // block_idx
+      }  // s
+    }, 0, slice_count, 1, 0, block_count, 1);
+
+    // sum the partial outputs into the first one and unpack it
     thread_pool.Compute1D([=, &output_matrix](index_t start,
                                               index_t end,
                                               index_t step) {
-      for (index_t row_block_idx = start; row_block_idx < end;
-           row_block_idx += step) {
-        const index_t start_row = row_block_idx * row_block_size;
-        const index_t
-            row_block_len = std::min(row_block_size, rows - start_row);
-        const T *packed_lhs_data_block =
-            packed_lhs_data + row_block_idx * row_block_size * depth_padded;
-
-        for (index_t col_block_idx = 0; col_block_idx < col_block_count;
-             ++col_block_idx) {
-          const index_t start_col = col_block_idx * col_block_size;
-          const index_t
-              col_block_len = std::min(col_block_size, cols - start_col);
-          const T *packed_rhs_data_block =
-              packed_rhs_data + col_block_idx * col_block_size * depth_padded;
-          T *packed_output_data_block =
-              packed_output_data + row_block_idx * row_block_size * cols_padded
-                  + col_block_idx * col_block_size;
-          ComputeBlock(packed_lhs_data_block,
-                       packed_rhs_data_block,
-                       depth_padded,
-                       packed_output_data_block);
-          MatrixMap<T> output_block = output_matrix.block(start_row,
-                                                          start_col,
-                                                          row_block_len,
-                                                          col_block_len);
-          UnpackOutput(packed_output_data_block, &output_block);
-        }  // col_block_idx
-      }  // row_block_idx
-    }, 0, row_block_count, 1);
+      for (index_t block_idx = start; block_idx < end; block_idx += step) {
+        T *packed_output_data_block =
+            packed_output_data + block_idx * output_block_size;
+        for (index_t i = 0; i < output_block_size; ++i) {
+          float sum = packed_output_data_block[i];
+          for (index_t s = 1; s < slice_count; ++s) {
+            sum += packed_output_data_block[
+                s * block_count * output_block_size + i];
+          }  // s
+          packed_output_data_block[i] = sum;
+        }  // i
+        unpack_block(block_idx / col_block_count, block_idx % col_block_count,
+                     packed_output_data_block, &output_matrix);
+      }  // block_idx
+    }, 0, block_count, 1);
   }  // b
 
   return MaceStatus::MACE_SUCCESS;
@@ -33,6 +33,9 @@ namespace arm {
 
 enum { kNoCache, kCacheLhs, kCacheRhs };
 
+template<typename T>
+class BatchedGemm;
+
 template<typename T>
 class Gemm : public delegator::Gemm {
  public:
@@ -123,12 +126,110 @@ class Gemm : public delegator::Gemm {
                MatrixMajor dst_major,
                T *packed_matrix);
 
+  // Multiplies the operands in place, for when the memory budget refuses the
+  // packing buffers. The batch strides are counted in elements. An operand
+  // cached in pack_cache_ is read from its packing, whose blocks of
+  // `row_block_size` rows (lhs) or `col_block_size` columns (rhs) hold
+  // `depth_padded` depths each.
+  void ComputeUnpacked(const OpContext *context,
+                       const Tensor *lhs,
+                       const Tensor *rhs,
+                       const index_t batch,
+                       const index_t rows,
+                       const index_t cols,
+                       const index_t depth,
+                       const MatrixMajor lhs_major,
+                       const MatrixMajor rhs_major,
+                       const MatrixMajor output_major,
+                       const index_t lhs_batch_stride,
+                       const index_t rhs_batch_stride,
+                       const index_t row_block_size,
+                       const index_t col_block_size,
+                       const index_t depth_padded,
+                       Tensor *output);
+
  private:
+  // shares the packing and the block kernels
+  friend class BatchedGemm<T>;
+
   std::unique_ptr<Buffer> pack_cache_;
   bool should_cache_pack_;
   int cached_;
 };
 
+template<typename T>
+void Gemm<T>::ComputeUnpacked(const OpContext *context,
+                              const Tensor *lhs,
+                              const Tensor *rhs,
+                              const index_t batch,
+                              const index_t rows,
+                              const index_t cols,
+                              const index_t depth,
+                              const MatrixMajor lhs_major,
+                              const MatrixMajor rhs_major,
+                              const MatrixMajor output_major,
+                              const index_t lhs_batch_stride,
+                              const index_t rhs_batch_stride,
+                              const index_t row_block_size,
+                              const index_t col_block_size,
+                              const index_t depth_padded,
+                              Tensor *output) {
+  // the memory of a cached operand may have been advised free
+  const T *packed_lhs_data =
+      cached_ == kCacheLhs ? pack_cache_->data<T>() : nullptr;
+  const T *packed_rhs_data =
+      cached_ == kCacheRhs ? pack_cache_->data<T>() : nullptr;
+  const T *lhs_data = packed_lhs_data == nullptr ? lhs->data<T>() : nullptr;
+  const T *rhs_data = packed_rhs_data == nullptr ? rhs->data<T>() : nullptr;
+  T *output_data = output->mutable_data<T>();
+
+  utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+  thread_pool.Compute3D([=](index_t start0, index_t end0, index_t step0,
+                            index_t start1, index_t end1, index_t step1,
+                            index_t start2, index_t end2, index_t step2) {
+    for (index_t b = start0; b < end0; b += step0) {
+      MatrixMap<const T> lhs_matrix(lhs_data + b * lhs_batch_stride,
+                                    lhs_major, rows, depth);
+      MatrixMap<const T> rhs_matrix(rhs_data + b * rhs_batch_stride,
+                                    rhs_major, depth, cols);
+      MatrixMap<T> output_matrix(output_data + b * rows * cols,
+                                 output_major, rows, cols);
+      for (index_t r = start1; r < end1; r += step1) {
+        const T *lhs_row = nullptr;
+        index_t lhs_depth_stride = 0;
+        if (packed_lhs_data != nullptr) {
+          lhs_row = packed_lhs_data +
+              r / row_block_size * row_block_size * depth_padded +
+              r % row_block_size;
+          lhs_depth_stride = row_block_size;
+        } else {
+          lhs_row = lhs_matrix.data(r, 0);
+          lhs_depth_stride = lhs_matrix.cols_stride();
+        }
+        for (index_t c = start2; c < end2; c += step2) {
+          const T *rhs_col = nullptr;
+          index_t rhs_depth_stride = 0;
+          if (packed_rhs_data != nullptr) {
+            rhs_col = packed_rhs_data +
+                c / col_block_size * col_block_size * depth_padded +
+                c % col_block_size;
+            rhs_depth_stride = col_block_size;
+          } else {
+            rhs_col = rhs_matrix.data(0, c);
+            rhs_depth_stride = rhs_matrix.rows_stride();
+          }
+          float sum = 0;
+          for (index_t d = 0; d < depth; ++d) {
+            sum += static_cast<float>(lhs_row[d * lhs_depth_stride]) *
+                static_cast<float>(rhs_col[d * rhs_depth_stride]);
+          }  // d
+          *output_matrix.data(r, c) = sum;
+        }  // c
+      }  // r
+    }  // b
+  }, 0, batch, 1, 0, rows, 1, 0, cols, 1);
+}
+
 }  // namespace arm
 }  // namespace ops
 }  // namespace mace
@@ -608,6 +608,16 @@ MaceStatus Gemm<float16_t>::Compute(const OpContext *context,
   auto packed_rhs_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
   mem_info.dims = {rows_padded * cols_padded};
   auto packed_output_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
+  // without room for the packing, the operands are multiplied in place
+  if ((cached_ != kCacheLhs && packed_lhs_buffer->memory<void>() == nullptr) ||
+      (cached_ != kCacheRhs && packed_rhs_buffer->memory<void>() == nullptr) ||
+      packed_output_buffer->memory<void>() == nullptr) {
+    ComputeUnpacked(context, lhs, rhs, batch, rows, cols, depth, lhs_major,
+                    rhs_major, output_major, lhs_batched ? rows * depth : 0,
+                    rhs_batched ? depth * cols : 0, row_block_size,
+                    col_block_size, depth_padded, output);
+    return MaceStatus::MACE_SUCCESS;
+  }
 
   float16_t *packed_lhs_data = packed_lhs_buffer->mutable_data<float16_t>();
   float16_t *packed_rhs_data = packed_rhs_buffer->mutable_data<float16_t>();
@@ -0,0 +1,48 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_OPS_COMMON_GEMM_SPLIT_H_
+#define MACE_OPS_COMMON_GEMM_SPLIT_H_
+
+#include <algorithm>
+
+#include "mace/core/types.h"
+#include "mace/utils/math.h"
+
+namespace mace {
+namespace ops {
+
+// Returns the number of slices the depth of a gemm is partitioned into, 1 for
+// no partition. A gemm with fewer output tiles than threads, e.g. a few rows
+// by a few columns over a long depth, can not occupy all threads by tiling
+// the output alone. Each depth slice is then accumulated into a partial
+// output of its own, and the partial outputs are summed at last. A slice is
+// kept at least `min_slice_depth` long to pay for the reduction.
+inline index_t GemmDepthSliceCount(const index_t tile_count,
+                                   const index_t depth,
+                                   const index_t min_slice_depth,
+                                   const int thread_count) {
+  if (thread_count <= 1 || tile_count >= thread_count) {
+    return 1;
+  }
+  const index_t slice_count = std::min(
+      RoundUpDiv(static_cast<index_t>(thread_count), tile_count),
+      depth / min_slice_depth);
+  return std::max(slice_count, static_cast<index_t>(1));
+}
+
+}  // namespace ops
+}  // namespace mace
+
+#endif  // MACE_OPS_COMMON_GEMM_SPLIT_H_
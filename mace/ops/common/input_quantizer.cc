@@ -0,0 +1,95 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/ops/common/input_quantizer.h"
+
+#include "mace/core/ops/op_context.h"
+#include "mace/core/proto/arg_helper.h"
+#include "mace/core/runtime/runtime.h"
+#include "mace/utils/memory.h"
+
+namespace mace {
+namespace ops {
+
+InputQuantizer::InputQuantizer(const OperatorDef &op_def,
+                               utils::ThreadPool *thread_pool)
+    : quantize_util_(thread_pool) {
+  auto indices = ProtoArgHelper::GetRepeatedArgs<OperatorDef, int>(
+      op_def, "fused_quantize_inputs");
+  auto scales = ProtoArgHelper::GetRepeatedArgs<OperatorDef, float>(
+      op_def, "fused_quantize_scales");
+  auto zero_points = ProtoArgHelper::GetRepeatedArgs<OperatorDef, int>(
+      op_def, "fused_quantize_zero_points");
+  auto find_ranges = ProtoArgHelper::GetRepeatedArgs<OperatorDef, int>(
+      op_def, "fused_quantize_find_ranges");
+  auto non_zeros = ProtoArgHelper::GetRepeatedArgs<OperatorDef, int>(
+      op_def, "fused_quantize_non_zeros");
+  MACE_CHECK(scales.size() == indices.size() &&
+      zero_points.size() == indices.size() &&
+      find_ranges.size() == indices.size() &&
+      non_zeros.size() == indices.size(),
+             "Fused quantize arguments mismatch in ", op_def.name());
+  inputs_.resize(indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    inputs_[i].index = indices[i];
+    inputs_[i].scale = scales[i];
+    inputs_[i].zero_point = zero_points[i];
+    inputs_[i].find_range = find_ranges[i] != 0 || scales[i] <= 0.f;
+    inputs_[i].non_zero = non_zeros[i] != 0;
+  }
+}
+
+const Tensor *InputQuantizer::Quantize(OpContext *context, const int index,
+                                       const Tensor *input) {
+  if (input->dtype() != DT_FLOAT) {
+    return input;
+  }
+  for (auto &fused_input : inputs_) {
+    if (fused_input.index != index) {
+      continue;
+    }
+    Runtime *runtime = context->runtime();
+    fused_input.quantized = make_unique<Tensor>(
+        runtime, DT_UINT8, input->memory_type(), input->shape());
+    Tensor *quantized = fused_input.quantized.get();
+    if (runtime->AllocateBufferForTensor(quantized, RENT_SCRATCH) !=
+        MaceStatus::MACE_SUCCESS) {
+      return nullptr;
+    }
+    Tensor::MappingGuard input_guard(input);
+    Tensor::MappingGuard quantized_guard(quantized);
+    const float *input_data = input->data<float>();
+    uint8_t *quantized_data = quantized->mutable_data<uint8_t>();
+    if (fused_input.find_range) {
+      float scale = 0.f;
+      int32_t zero_point = 0;
+      quantize_util_.Quantize(input_data, input->size(),
+                              fused_input.non_zero, quantized_data,
+                              &scale, &zero_point);
+      quantized->SetScale(scale);
+      quantized->SetZeroPoint(zero_point);
+    } else {
+      quantize_util_.QuantizeWithScaleAndZeropoint(
+          input_data, input->size(), fused_input.scale,
+          fused_input.zero_point, quantized_data);
+      quantized->SetScale(fused_input.scale);
+      quantized->SetZeroPoint(fused_input.zero_point);
+    }
+    return quantized;
+  }
+  return input;
+}
+
+}  // namespace ops
+}  // namespace mace
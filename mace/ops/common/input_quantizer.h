@@ -0,0 +1,62 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_OPS_COMMON_INPUT_QUANTIZER_H_
+#define MACE_OPS_COMMON_INPUT_QUANTIZER_H_
+
+#include <memory>
+#include <vector>
+
+#include "mace/core/quantize.h"
+#include "mace/core/tensor.h"
+#include "mace/proto/mace.pb.h"
+
+namespace mace {
+
+class OpContext;
+
+namespace ops {
+
+// Quantizes to uint8 the float inputs of a quantized CPU operator whose
+// Quantize op was fused into it by NetOptimizer::FuseInputQuantize, right
+// before the operator reads them.
+class InputQuantizer {
+ public:
+  InputQuantizer(const OperatorDef &op_def, utils::ThreadPool *thread_pool);
+
+  // Returns `input` if input `index` is not fused, or its quantization into
+  // a scratch tensor living until the operator ends, or nullptr if the
+  // memory budget refuses the scratch tensor.
+  const Tensor *Quantize(OpContext *context, const int index,
+                         const Tensor *input);
+
+ private:
+  struct FusedInput {
+    int index;
+    float scale;
+    int32_t zero_point;
+    // finds the range of every input instead of using scale and zero point
+    bool find_range;
+    bool non_zero;
+    std::unique_ptr<Tensor> quantized;
+  };
+
+  std::vector<FusedInput> inputs_;
+  QuantizeUtil<float, uint8_t> quantize_util_;
+};
+
+}  // namespace ops
+}  // namespace mace
+
+#endif  // MACE_OPS_COMMON_INPUT_QUANTIZER_H_
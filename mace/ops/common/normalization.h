@@ -0,0 +1,196 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_OPS_COMMON_NORMALIZATION_H_
+#define MACE_OPS_COMMON_NORMALIZATION_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "mace/core/types.h"
+#include "mace/utils/thread_pool.h"
+
+namespace mace {
+namespace ops {
+namespace common {
+namespace normalization {
+
+// Running statistics of a Welford accumulation, m2 is the sum of squared
+// differences from the mean.
+struct Moments {
+  index_t count;
+  float mean;
+  float m2;
+
+  float Variance() const {
+    return count > 0 ? m2 / count : 0.f;
+  }
+};
+
+// Chan's pairwise combination of two partial Welford accumulations.
+inline Moments MergeMoments(const Moments &a, const Moments &b) {
+  if (a.count == 0) return b;
+  if (b.count == 0) return a;
+  const index_t count = a.count + b.count;
+  const float b_ratio = static_cast<float>(b.count) / count;
+  const float delta = b.mean - a.mean;
+  Moments result;
+  result.count = count;
+  result.mean = a.mean + delta * b_ratio;
+  result.m2 = a.m2 + b.m2 + delta * delta * a.count * b_ratio;
+  return result;
+}
+
+// Mean and variance of `size` elements in a single pass. kLanes independent
+// Welford accumulators walk interleaved elements with a shared count, so
+// the inner loop has no dependency across lanes and is auto-vectorized.
+template<typename T>
+Moments ComputeMoments(const T *data, const index_t size) {
+  constexpr index_t kLanes = 8;
+  float mean[kLanes] = {0.f};
+  float m2[kLanes] = {0.f};
+  const index_t blocks = size / kLanes;
+  for (index_t b = 0; b < blocks; ++b) {
+    const float inv_count = 1.f / (b + 1);
+    const T *block = data + b * kLanes;
+    for (index_t l = 0; l < kLanes; ++l) {
+      const float x = static_cast<float>(block[l]);
+      const float delta = x - mean[l];
+      mean[l] += delta * inv_count;
+      m2[l] += delta * (x - mean[l]);
+    }
+  }
+
+  Moments result = {0, 0.f, 0.f};
+  if (blocks > 0) {
+    for (index_t l = 0; l < kLanes; ++l) {
+      result = MergeMoments(result, {blocks, mean[l], m2[l]});
+    }
+  }
+  for (index_t i = blocks * kLanes; i < size; ++i) {
+    result = MergeMoments(result, {1, static_cast<float>(data[i]), 0.f});
+  }
+  return result;
+}
+
+// output = (input - mean) * inv_std * gamma + beta, gamma and beta are
+// optional and indexed by the element position.
+template<typename T>
+void NormalizeAffine(const T *input, const index_t size, const float mean,
+                     const float inv_std, const float *gamma,
+                     const float *beta, T *output) {
+  if (gamma == nullptr && beta == nullptr) {
+    const float shift = -mean * inv_std;
+    for (index_t i = 0; i < size; ++i) {
+      output[i] = static_cast<float>(input[i]) * inv_std + shift;
+    }
+  } else if (beta == nullptr) {
+    for (index_t i = 0; i < size; ++i) {
+      output[i] =
+          (static_cast<float>(input[i]) - mean) * inv_std * gamma[i];
+    }
+  } else if (gamma == nullptr) {
+    for (index_t i = 0; i < size; ++i) {
+      output[i] = (static_cast<float>(input[i]) - mean) * inv_std + beta[i];
+    }
+  } else {
+    for (index_t i = 0; i < size; ++i) {
+      output[i] =
+          (static_cast<float>(input[i]) - mean) * inv_std * gamma[i] +
+              beta[i];
+    }
+  }
+}
+
+// Normalizes `rows` contiguous rows of `row_size` elements each:
+//   output = (input - mean) * inv_std_func(variance) * gamma + beta
+// with the statistics of every row computed in one pass. Rows are
+// processed in parallel and each row is normalized right after its
+// statistics, while it is still in cache. When there are too few rows to
+// keep the thread pool busy, long rows are split into chunks whose partial
+// statistics are merged before the normalization.
+template<typename T, typename InvStdFunc>
+void NormalizeRows(utils::ThreadPool *thread_pool, const T *input,
+                   const index_t rows, const index_t row_size,
+                   InvStdFunc inv_std_func, const float *gamma,
+                   const float *beta, T *output) {
+  constexpr index_t kMinParallelRows = 16;
+  constexpr index_t kMinChunkSize = 4096;
+  const index_t chunk_count = rows >= kMinParallelRows ? 1 : std::min(
+      (kMinParallelRows + rows - 1) / rows,
+      (row_size + kMinChunkSize - 1) / kMinChunkSize);
+
+  if (chunk_count <= 1) {
+    thread_pool->Compute1D([=](index_t start, index_t end, index_t step) {
+      for (index_t i = start; i < end; i += step) {
+        const T *in_row = input + i * row_size;
+        const Moments moments = ComputeMoments(in_row, row_size);
+        NormalizeAffine(in_row, row_size, moments.mean,
+                        inv_std_func(moments.Variance()), gamma, beta,
+                        output + i * row_size);
+      }
+    }, 0, rows, 1);
+    return;
+  }
+
+  const index_t chunk_size = (row_size + chunk_count - 1) / chunk_count;
+  std::vector<Moments> partial(rows * chunk_count);
+  Moments *partial_ptr = partial.data();
+  thread_pool->Compute2D([=](index_t start0, index_t end0, index_t step0,
+                             index_t start1, index_t end1, index_t step1) {
+    for (index_t i = start0; i < end0; i += step0) {
+      for (index_t c = start1; c < end1; c += step1) {
+        const index_t begin = c * chunk_size;
+        const index_t size = std::min(chunk_size, row_size - begin);
+        partial_ptr[i * chunk_count + c] =
+            ComputeMoments(input + i * row_size + begin, size);
+      }
+    }
+  }, 0, rows, 1, 0, chunk_count, 1);
+
+  std::vector<float> mean(rows);
+  std::vector<float> inv_std(rows);
+  for (index_t i = 0; i < rows; ++i) {
+    Moments moments = {0, 0.f, 0.f};
+    for (index_t c = 0; c < chunk_count; ++c) {
+      moments = MergeMoments(moments, partial[i * chunk_count + c]);
+    }
+    mean[i] = moments.mean;
+    inv_std[i] = inv_std_func(moments.Variance());
+  }
+
+  const float *mean_ptr = mean.data();
+  const float *inv_std_ptr = inv_std.data();
+  thread_pool->Compute2D([=](index_t start0, index_t end0, index_t step0,
+                             index_t start1, index_t end1, index_t step1) {
+    for (index_t i = start0; i < end0; i += step0) {
+      for (index_t c = start1; c < end1; c += step1) {
+        const index_t begin = c * chunk_size;
+        const index_t size = std::min(chunk_size, row_size - begin);
+        const index_t offset = i * row_size + begin;
+        NormalizeAffine(input + offset, size, mean_ptr[i], inv_std_ptr[i],
+                        gamma == nullptr ? nullptr : gamma + begin,
+                        beta == nullptr ? nullptr : beta + begin,
+                        output + offset);
+      }
+    }
+  }, 0, rows, 1, 0, chunk_count, 1);
+}
+
+}  // namespace normalization
+}  // namespace common
+}  // namespace ops
+}  // namespace mace
+
+#endif  // MACE_OPS_COMMON_NORMALIZATION_H_
@@ -0,0 +1,353 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/ops/common/scan.h"
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "mace/utils/logging.h"
+
+namespace mace {
+namespace ops {
+
+namespace {
+
+// The rows longer than this are scanned in parallel blocks.
+const index_t kRowBlockSize = 8192;
+
+template <ScanType type>
+struct ScanFunctor;
+
+template <>
+struct ScanFunctor<SCAN_SUM> {
+  static float Identity() { return 0.f; }
+  static float Apply(const float a, const float b) { return a + b; }
+#if defined(MACE_ENABLE_NEON)
+  static float32x4_t Apply(const float32x4_t a, const float32x4_t b) {
+    return vaddq_f32(a, b);
+  }
+#elif defined(__SSE2__)
+  static __m128 Apply(const __m128 a, const __m128 b) {
+    return _mm_add_ps(a, b);
+  }
+#endif
+};
+
+template <>
+struct ScanFunctor<SCAN_PROD> {
+  static float Identity() { return 1.f; }
+  static float Apply(const float a, const float b) { return a * b; }
+#if defined(MACE_ENABLE_NEON)
+  static float32x4_t Apply(const float32x4_t a, const float32x4_t b) {
+    return vmulq_f32(a, b);
+  }
+#elif defined(__SSE2__)
+  static __m128 Apply(const __m128 a, const __m128 b) {
+    return _mm_mul_ps(a, b);
+  }
+#endif
+};
+
+template <>
+struct ScanFunctor<SCAN_MAX> {
+  static float Identity() { return -std::numeric_limits<float>::infinity(); }
+  static float Apply(const float a, const float b) { return std::max(a, b); }
+#if defined(MACE_ENABLE_NEON)
+  static float32x4_t Apply(const float32x4_t a, const float32x4_t b) {
+    return vmaxq_f32(a, b);
+  }
+#elif defined(__SSE2__)
+  static __m128 Apply(const __m128 a, const __m128 b) {
+    return _mm_max_ps(a, b);
+  }
+#endif
+};
+
+// Scans `size` contiguous values forward starting from `carry`, returns the
+// carry for the values after them.
+template <ScanType type, typename T>
+struct RowScanner {
+  static float Forward(const T *input, const index_t size,
+                       const bool exclusive, float carry, T *output) {
+    for (index_t i = 0; i < size; ++i) {
+      const float value =
+          ScanFunctor<type>::Apply(carry, static_cast<float>(input[i]));
+      output[i] = exclusive ? carry : value;
+      carry = value;
+    }
+    return carry;
+  }
+};
+
+#if defined(MACE_ENABLE_NEON) || defined(__SSE2__)
+// Scans four values in register: combined with the values shifted by one
+// lane, then by two lanes, each lane holds the scan of the lanes up to it.
+template <ScanType type>
+struct RowScanner<type, float> {
+  static float Forward(const float *input, const index_t size,
+                       const bool exclusive, float carry, float *output) {
+    typedef ScanFunctor<type> F;
+    const float identity = F::Identity();
+    index_t i = 0;
+#if defined(MACE_ENABLE_NEON)
+    const float32x4_t identities = vdupq_n_f32(identity);
+    float32x4_t carries = vdupq_n_f32(carry);
+    for (; i + 4 <= size; i += 4) {
+      float32x4_t values = vld1q_f32(input + i);
+      values = F::Apply(values, vextq_f32(identities, values, 3));
+      values = F::Apply(values, vextq_f32(identities, values, 2));
+      const float32x4_t inclusive = F::Apply(values, carries);
+      if (exclusive) {
+        vst1q_f32(output + i,
+                  F::Apply(vextq_f32(identities, values, 3), carries));
+      } else {
+        vst1q_f32(output + i, inclusive);
+      }
+      carries = vdupq_n_f32(vgetq_lane_f32(inclusive, 3));
+    }
+    carry = vgetq_lane_f32(carries, 0);
+#else
+    // the lanes shifted in are all zero bits, or-ed with the identity
+    const __m128 head1 = _mm_setr_ps(identity, 0.f, 0.f, 0.f);
+    const __m128 head2 = _mm_setr_ps(identity, identity, 0.f, 0.f);
+    __m128 carries = _mm_set1_ps(carry);
+    for (; i + 4 <= size; i += 4) {
+      __m128 values = _mm_loadu_ps(input + i);
+      const __m128 shifted1 = _mm_or_ps(head1, _mm_castsi128_ps(
+          _mm_slli_si128(_mm_castps_si128(values), 4)));
+      values = F::Apply(values, shifted1);
+      const __m128 shifted2 = _mm_or_ps(head2, _mm_castsi128_ps(
+          _mm_slli_si128(_mm_castps_si128(values), 8)));
+      values = F::Apply(values, shifted2);
+      const __m128 inclusive = F::Apply(values, carries);
+      if (exclusive) {
+        const __m128 shifted = _mm_or_ps(head1, _mm_castsi128_ps(
+            _mm_slli_si128(_mm_castps_si128(values), 4)));
+        _mm_storeu_ps(output + i, F::Apply(shifted, carries));
+      } else {
+        _mm_storeu_ps(output + i, inclusive);
+      }
+      carries = _mm_shuffle_ps(inclusive, inclusive, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    carry = _mm_cvtss_f32(carries);
+#endif
+    for (; i < size; ++i) {
+      const float value = F::Apply(carry, input[i]);
+      output[i] = exclusive ? carry : value;
+      carry = value;
+    }
+    return carry;
+  }
+};
+#endif  // MACE_ENABLE_NEON || __SSE2__
+
+template <ScanType type, typename T>
+float ScanRowBackward(const T *input, const index_t size,
+                      const bool exclusive, float carry, T *output) {
+  for (index_t i = size - 1; i >= 0; --i) {
+    const float value =
+        ScanFunctor<type>::Apply(carry, static_cast<float>(input[i]));
+    output[i] = exclusive ? carry : value;
+    carry = value;
+  }
+  return carry;
+}
+
+template <ScanType type, typename T>
+float ScanRow(const T *input, const index_t size, const bool exclusive,
+              const bool reverse, const float carry, T *output) {
+  if (reverse) {
+    return ScanRowBackward<type, T>(input, size, exclusive, carry, output);
+  }
+  return RowScanner<type, T>::Forward(input, size, exclusive, carry, output);
+}
+
+}  // namespace
+
+template <ScanType type, typename T>
+void Scanner::ComputeRows(utils::ThreadPool *thread_pool,
+                          const T *input,
+                          const index_t outer_size,
+                          const index_t scan_size,
+                          T *output) const {
+  typedef ScanFunctor<type> F;
+  const bool exclusive = exclusive_;
+  const bool reverse = reverse_;
+  const index_t block_count = (scan_size + kRowBlockSize - 1) / kRowBlockSize;
+  if (block_count <= 1) {
+    thread_pool->Compute1D([=](index_t start, index_t end, index_t step) {
+      for (index_t i = start; i < end; i += step) {
+        ScanRow<type, T>(input + i * scan_size, scan_size, exclusive,
+                         reverse, F::Identity(), output + i * scan_size);
+      }
+    }, 0, outer_size, 1);
+    return;
+  }
+
+  // First pass: scan each block on its own and keep its total.
+  std::vector<float> carries(outer_size * block_count);
+  float *carries_data = carries.data();
+  thread_pool->Compute2D([=](index_t start0, index_t end0, index_t step0,
+                             index_t start1, index_t end1, index_t step1) {
+    for (index_t i = start0; i < end0; i += step0) {
+      for (index_t b = start1; b < end1; b += step1) {
+        const index_t offset = i * scan_size + b * kRowBlockSize;
+        const index_t size =
+            std::min(kRowBlockSize, scan_size - b * kRowBlockSize);
+        carries_data[i * block_count + b] =
+            ScanRow<type, T>(input + offset, size, exclusive, reverse,
+                             F::Identity(), output + offset);
+      }
+    }
+  }, 0, outer_size, 1, 0, block_count, 1);
+
+  // The carry of a block is the total of the blocks before it.
+  for (index_t i = 0; i < outer_size; ++i) {
+    float *row_carries = carries_data + i * block_count;
+    float carry = F::Identity();
+    for (index_t k = 0; k < block_count; ++k) {
+      const index_t b = reverse ? block_count - 1 - k : k;
+      const float total = row_carries[b];
+      row_carries[b] = carry;
+      carry = F::Apply(carry, total);
+    }
+  }
+
+  // Second pass: combine the carries into the blocks but the first one.
+  const index_t first_block = reverse ? block_count - 1 : 0;
+  thread_pool->Compute2D([=](index_t start0, index_t end0, index_t step0,
+                             index_t start1, index_t end1, index_t step1) {
+    for (index_t i = start0; i < end0; i += step0) {
+      for (index_t b = start1; b < end1; b += step1) {
+        if (b == first_block) continue;
+        const float carry = carries_data[i * block_count + b];
+        T *block_output = output + i * scan_size + b * kRowBlockSize;
+        const index_t size =
+            std::min(kRowBlockSize, scan_size - b * kRowBlockSize);
+        for (index_t j = 0; j < size; ++j) {
+          block_output[j] =
+              F::Apply(carry, static_cast<float>(block_output[j]));
+        }
+      }
+    }
+  }, 0, outer_size, 1, 0, block_count, 1);
+}
+
+template <ScanType type, typename T>
+void Scanner::ComputeColumns(utils::ThreadPool *thread_pool,
+                             const T *input,
+                             const index_t outer_size,
+                             const index_t scan_size,
+                             const index_t inner_size,
+                             T *output) const {
+  typedef ScanFunctor<type> F;
+  const bool exclusive = exclusive_;
+  const bool reverse = reverse_;
+  thread_pool->Compute2D([=](index_t start0, index_t end0, index_t step0,
+                             index_t start1, index_t end1, index_t step1) {
+    // the running values of the columns, kept in float rather than read
+    // back from the output, which may be rounded to a narrower type
+    std::vector<float> carries((end1 - start1 + step1 - 1) / step1);
+    for (index_t i = start0; i < end0; i += step0) {
+      const T *outer_input = input + i * scan_size * inner_size;
+      T *outer_output = output + i * scan_size * inner_size;
+      std::fill(carries.begin(), carries.end(), F::Identity());
+      for (index_t k = 0; k < scan_size; ++k) {
+        const index_t c = reverse ? scan_size - 1 - k : k;
+        const T *row_input = outer_input + c * inner_size;
+        T *row_output = outer_output + c * inner_size;
+        float *carry = carries.data();
+        for (index_t j = start1; j < end1; j += step1, ++carry) {
+          const float value =
+              F::Apply(*carry, static_cast<float>(row_input[j]));
+          row_output[j] = exclusive ? *carry : value;
+          *carry = value;
+        }
+      }
+    }
+  }, 0, outer_size, 1, 0, inner_size, 1);
+}
+
+template <typename T>
+void Scanner::Compute(utils::ThreadPool *thread_pool,
+                      const T *input,
+                      const index_t outer_size,
+                      const index_t scan_size,
+                      const index_t inner_size,
+                      T *output) const {
+  if (outer_size == 0 || scan_size == 0 || inner_size == 0) {
+    return;
+  }
+  if (inner_size == 1) {
+    switch (type_) {
+      case SCAN_SUM:
+        ComputeRows<SCAN_SUM, T>(thread_pool, input, outer_size, scan_size,
+                                 output);
+        break;
+      case SCAN_PROD:
+        ComputeRows<SCAN_PROD, T>(thread_pool, input, outer_size, scan_size,
+                                  output);
+        break;
+      case SCAN_MAX:
+        ComputeRows<SCAN_MAX, T>(thread_pool, input, outer_size, scan_size,
+                                 output);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported scan type: " << type_;
+    }
+    return;
+  }
+  switch (type_) {
+    case SCAN_SUM:
+      ComputeColumns<SCAN_SUM, T>(thread_pool, input, outer_size, scan_size,
+                                  inner_size, output);
+      break;
+    case SCAN_PROD:
+      ComputeColumns<SCAN_PROD, T>(thread_pool, input, outer_size, scan_size,
+                                   inner_size, output);
+      break;
+    case SCAN_MAX:
+      ComputeColumns<SCAN_MAX, T>(thread_pool, input, outer_size, scan_size,
+                                  inner_size, output);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported scan type: " << type_;
+  }
+}
+
+template void Scanner::Compute<float>(utils::ThreadPool *thread_pool,
+                                      const float *input,
+                                      const index_t outer_size,
+                                      const index_t scan_size,
+                                      const index_t inner_size,
+                                      float *output) const;
+#ifdef MACE_ENABLE_BFLOAT16
+template void Scanner::Compute<BFloat16>(utils::ThreadPool *thread_pool,
+                                         const BFloat16 *input,
+                                         const index_t outer_size,
+                                         const index_t scan_size,
+                                         const index_t inner_size,
+                                         BFloat16 *output) const;
+#endif  // MACE_ENABLE_BFLOAT16
+
+}  // namespace ops
+}  // namespace mace
@@ -0,0 +1,73 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_OPS_COMMON_SCAN_H_
+#define MACE_OPS_COMMON_SCAN_H_
+
+#include "mace/core/types.h"
+#include "mace/utils/thread_pool.h"
+
+namespace mace {
+namespace ops {
+
+enum ScanType {
+  SCAN_SUM = 0,
+  SCAN_PROD = 1,
+  SCAN_MAX = 2,
+};
+
+// Prefix scan along the middle axis of a [outer, scan, inner] tensor, values
+// are accumulated in float.
+// With inner size 1 the scanned rows are contiguous, a long row is split into
+// blocks scanned in parallel, then the totals of the preceding blocks are
+// combined into each block. Otherwise the rows are combined one by one, in
+// parallel over the outer and inner dims.
+class Scanner {
+ public:
+  Scanner(const ScanType type, const bool exclusive, const bool reverse)
+      : type_(type), exclusive_(exclusive), reverse_(reverse) {}
+
+  template <typename T>
+  void Compute(utils::ThreadPool *thread_pool,
+               const T *input,
+               const index_t outer_size,
+               const index_t scan_size,
+               const index_t inner_size,
+               T *output) const;
+
+ private:
+  template <ScanType type, typename T>
+  void ComputeRows(utils::ThreadPool *thread_pool,
+                   const T *input,
+                   const index_t outer_size,
+                   const index_t scan_size,
+                   T *output) const;
+
+  template <ScanType type, typename T>
+  void ComputeColumns(utils::ThreadPool *thread_pool,
+                      const T *input,
+                      const index_t outer_size,
+                      const index_t scan_size,
+                      const index_t inner_size,
+                      T *output) const;
+
+  const ScanType type_;
+  const bool exclusive_;
+  const bool reverse_;
+};
+
+}  // namespace ops
+}  // namespace mace
+
+#endif  // MACE_OPS_COMMON_SCAN_H_
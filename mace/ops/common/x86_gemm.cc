@@ -0,0 +1,148 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/ops/common/x86_gemm.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "mace/ops/common/x86_kernels.h"
+#include "mace/utils/math.h"
+
+namespace mace {
+namespace ops {
+namespace x86 {
+
+// The lhs is packed into panels of mr rows and the rhs into panels of nr
+// columns, both depth-major and zero-padded, then each pair of panels is
+// multiplied by the kernel into an mr x nr output block. All matrices of the
+// batch are packed first, so that the whole batch x row blocks x col blocks
+// grid is computed in a single dispatch.
+bool ComputeGemm(const OpContext *context,
+                 const Tensor *lhs,
+                 const Tensor *rhs,
+                 const index_t batch,
+                 const index_t rows,
+                 const index_t cols,
+                 const index_t depth,
+                 const MatrixMajor lhs_major,
+                 const MatrixMajor rhs_major,
+                 const MatrixMajor output_major,
+                 const index_t lhs_batch_stride,
+                 const index_t rhs_batch_stride,
+                 Tensor *output) {
+  const GemmKernel *kernel = GetGemmKernel(DetectIsa(), rows, cols);
+  if (kernel == nullptr || batch == 0 || rows == 0 || cols == 0 ||
+      depth == 0) {
+    return false;
+  }
+  const index_t mr = kernel->mr;
+  const index_t nr = kernel->nr;
+  const index_t row_blocks = RoundUpDiv(rows, mr);
+  const index_t col_blocks = RoundUpDiv(cols, nr);
+  const index_t packed_lhs_size = row_blocks * mr * depth;
+  const index_t packed_rhs_size = col_blocks * nr * depth;
+  // a broadcast operand is packed only once
+  const index_t lhs_count = lhs_batch_stride == 0 ? 1 : batch;
+  const index_t rhs_count = rhs_batch_stride == 0 ? 1 : batch;
+  MemInfo mem_info(output->memory_type(), DataType::DT_FLOAT,
+                   {lhs_count * packed_lhs_size +
+                       rhs_count * packed_rhs_size});
+  std::unique_ptr<Buffer> packed_buffer =
+      context->runtime()->ObtainBuffer(mem_info, RENT_SCRATCH);
+  if (packed_buffer->memory<void>() == nullptr) {
+    return false;
+  }
+  float *packed_lhs = packed_buffer->mutable_data<float>();
+  float *packed_rhs = packed_lhs + lhs_count * packed_lhs_size;
+
+  const float *lhs_data = lhs->data<float>();
+  const float *rhs_data = rhs->data<float>();
+  float *output_data = output->mutable_data<float>();
+  utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+
+  // pack lhs
+  thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                            index_t start1, index_t end1, index_t step1) {
+    for (index_t b = start0; b < end0; b += step0) {
+      MatrixMap<const float> lhs_matrix(lhs_data + b * lhs_batch_stride,
+                                        lhs_major, rows, depth);
+      for (index_t block = start1; block < end1; block += step1) {
+        float *panel = packed_lhs + b * packed_lhs_size + block * mr * depth;
+        for (index_t d = 0; d < depth; ++d) {
+          for (index_t r = block * mr; r < (block + 1) * mr; ++r) {
+            *panel++ = r < rows ? lhs_matrix(r, d) : 0;
+          }  // r
+        }  // d
+      }  // block
+    }  // b
+  }, 0, lhs_count, 1, 0, row_blocks, 1);
+
+  // pack rhs
+  thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                            index_t start1, index_t end1, index_t step1) {
+    for (index_t b = start0; b < end0; b += step0) {
+      MatrixMap<const float> rhs_matrix(rhs_data + b * rhs_batch_stride,
+                                        rhs_major, depth, cols);
+      for (index_t block = start1; block < end1; block += step1) {
+        float *panel = packed_rhs + b * packed_rhs_size + block * nr * depth;
+        for (index_t d = 0; d < depth; ++d) {
+          for (index_t c = block * nr; c < (block + 1) * nr; ++c) {
+            *panel++ = c < cols ? rhs_matrix(d, c) : 0;
+          }  // c
+        }  // d
+      }  // block
+    }  // b
+  }, 0, rhs_count, 1, 0, col_blocks, 1);
+
+  // multiply lhs and rhs
+  thread_pool.Compute3D([=](index_t start0, index_t end0, index_t step0,
+                            index_t start1, index_t end1, index_t step1,
+                            index_t start2, index_t end2, index_t step2) {
+    float tile[kMaxGemmTileSize];
+    for (index_t b = start0; b < end0; b += step0) {
+      const float *lhs_panels =
+          packed_lhs + (lhs_count == 1 ? 0 : b) * packed_lhs_size;
+      const float *rhs_panels =
+          packed_rhs + (rhs_count == 1 ? 0 : b) * packed_rhs_size;
+      MatrixMap<float> output_matrix(output_data + b * rows * cols,
+                                     output_major, rows, cols);
+      for (index_t row_block = start1; row_block < end1;
+           row_block += step1) {
+        const index_t row_begin = row_block * mr;
+        const index_t row_count = std::min(mr, rows - row_begin);
+        for (index_t col_block = start2; col_block < end2;
+             col_block += step2) {
+          const index_t col_begin = col_block * nr;
+          const index_t col_count = std::min(nr, cols - col_begin);
+          kernel->compute(lhs_panels + row_block * mr * depth,
+                          rhs_panels + col_block * nr * depth,
+                          depth, tile);
+          for (index_t i = 0; i < row_count; ++i) {
+            for (index_t j = 0; j < col_count; ++j) {
+              *output_matrix.data(row_begin + i, col_begin + j) =
+                  tile[i * nr + j];
+            }  // j
+          }  // i
+        }  // col_block
+      }  // row_block
+    }  // b
+  }, 0, batch, 1, 0, row_blocks, 1, 0, col_blocks, 1);
+
+  return true;
+}
+
+}  // namespace x86
+}  // namespace ops
+}  // namespace mace
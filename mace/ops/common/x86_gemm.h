@@ -0,0 +1,49 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_OPS_COMMON_X86_GEMM_H_
+#define MACE_OPS_COMMON_X86_GEMM_H_
+
+#include "mace/core/ops/op_context.h"
+#include "mace/core/tensor.h"
+#include "mace/ops/common/matrix.h"
+
+namespace mace {
+namespace ops {
+namespace x86 {
+
+// Multiplies a batch of float matrices with the gemm kernel of the cpu,
+// returns false if there is none or if the memory budget refuses the packed
+// operands. The batch strides are counted in elements and a stride of 0
+// broadcasts a single matrix, which is then packed only once. The output is
+// dense.
+bool ComputeGemm(const OpContext *context,
+                 const Tensor *lhs,
+                 const Tensor *rhs,
+                 const index_t batch,
+                 const index_t rows,
+                 const index_t cols,
+                 const index_t depth,
+                 const MatrixMajor lhs_major,
+                 const MatrixMajor rhs_major,
+                 const MatrixMajor output_major,
+                 const index_t lhs_batch_stride,
+                 const index_t rhs_batch_stride,
+                 Tensor *output);
+
+}  // namespace x86
+}  // namespace ops
+}  // namespace mace
+
+#endif  // MACE_OPS_COMMON_X86_GEMM_H_
@@ -0,0 +1,87 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/ops/common/x86_kernels.h"
+
+#include "mace/ops/common/x86_kernels_impl.h"
+#include "mace/utils/macros.h"
+
+namespace mace {
+namespace ops {
+namespace x86 {
+
+Isa DetectIsa() {
+#ifdef MACE_ENABLE_X86_KERNELS
+  static const Isa isa = []() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return ISA_AVX512;
+    } else if (__builtin_cpu_supports("avx2") &&
+        __builtin_cpu_supports("fma")) {
+      return ISA_AVX2;
+    }
+    return ISA_NONE;
+  }();
+  return isa;
+#else
+  return ISA_NONE;
+#endif  // MACE_ENABLE_X86_KERNELS
+}
+
+const GemmKernel *GetGemmKernel(const Isa isa,
+                                const index_t rows,
+                                const index_t cols) {
+#ifdef MACE_ENABLE_X86_KERNELS
+  switch (isa) {
+    case ISA_AVX512:
+      return avx512::GetGemmKernel(rows, cols);
+    case ISA_AVX2:
+      return avx2::GetGemmKernel(rows, cols);
+    default:
+      return nullptr;
+  }
+#else
+  MACE_UNUSED(isa);
+  MACE_UNUSED(rows);
+  MACE_UNUSED(cols);
+  return nullptr;
+#endif  // MACE_ENABLE_X86_KERNELS
+}
+
+DepthwiseConv2dRowKernel GetDepthwiseConv2dRowKernel(const Isa isa,
+                                                     const int filter_h,
+                                                     const int filter_w,
+                                                     const int stride_w) {
+#ifdef MACE_ENABLE_X86_KERNELS
+  switch (isa) {
+    case ISA_AVX512:
+      return avx512::GetDepthwiseConv2dRowKernel(filter_h, filter_w,
+                                                 stride_w);
+    case ISA_AVX2:
+      return avx2::GetDepthwiseConv2dRowKernel(filter_h, filter_w, stride_w);
+    default:
+      return nullptr;
+  }
+#else
+  MACE_UNUSED(isa);
+  MACE_UNUSED(filter_h);
+  MACE_UNUSED(filter_w);
+  MACE_UNUSED(stride_w);
+  return nullptr;
+#endif  // MACE_ENABLE_X86_KERNELS
+}
+
+}  // namespace x86
+}  // namespace ops
+}  // namespace mace
@@ -0,0 +1,84 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_OPS_COMMON_X86_KERNELS_H_
+#define MACE_OPS_COMMON_X86_KERNELS_H_
+
+#include "mace/core/types.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MACE_ENABLE_X86_KERNELS
+#endif
+
+namespace mace {
+namespace ops {
+namespace x86 {
+
+// Vector float kernels for x86. Each kernel is compiled once per instruction
+// set and register blocking, so the mace library still runs on any x86 cpu,
+// and the widest instruction set the cpu supports is picked at run time.
+
+enum Isa {
+  ISA_NONE = 0,
+  ISA_AVX2,
+  ISA_AVX512,
+};
+
+// The widest instruction set the running cpu supports, detected once.
+Isa DetectIsa();
+
+// The largest mr * nr of all gemm kernels.
+const index_t kMaxGemmTileSize = 384;
+
+// Multiplies a packed mr x depth lhs panel, `lhs_panel[d * mr + i]`, by a
+// packed depth x nr rhs panel, `rhs_panel[d * nr + j]`, into a row-major
+// mr x nr tile.
+typedef void (*GemmMicroKernel)(const float *lhs_panel,
+                                const float *rhs_panel,
+                                const index_t depth,
+                                float *tile);
+
+struct GemmKernel {
+  index_t mr;
+  index_t nr;
+  GemmMicroKernel compute;
+};
+
+// Returns the kernel whose register blocking suits a rows x cols output,
+// nullptr if `isa` has no gemm kernels.
+const GemmKernel *GetGemmKernel(const Isa isa,
+                                const index_t rows,
+                                const index_t cols);
+
+// Computes `count` consecutive outputs of one depthwise conv row, none of
+// which touches the padding. `input` points at the top-left input of the
+// first output and `filter` is the filter_h x filter_w filter of the channel.
+typedef void (*DepthwiseConv2dRowKernel)(const float *input,
+                                         const index_t in_width,
+                                         const float *filter,
+                                         const index_t count,
+                                         float *output);
+
+// Returns the kernel specialized for the filter size and the stride along
+// the row, nullptr if there is none.
+DepthwiseConv2dRowKernel GetDepthwiseConv2dRowKernel(const Isa isa,
+                                                     const int filter_h,
+                                                     const int filter_w,
+                                                     const int stride_w);
+
+}  // namespace x86
+}  // namespace ops
+}  // namespace mace
+
+#endif  // MACE_OPS_COMMON_X86_KERNELS_H_
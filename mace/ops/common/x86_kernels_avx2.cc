@@ -0,0 +1,101 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Everything included must come before the instruction set is enabled.
+#include "mace/ops/common/x86_kernels.h"
+
+#ifdef MACE_ENABLE_X86_KERNELS
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), \
+                             apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+#include "mace/ops/common/x86_kernels_impl.h"
+
+namespace mace {
+namespace ops {
+namespace x86 {
+namespace avx2 {
+
+namespace {
+
+struct Vec {
+  typedef __m256 Type;
+  static const int kLanes = 8;
+
+  static inline Type Zero() { return _mm256_setzero_ps(); }
+  static inline Type Load(const float *p) { return _mm256_loadu_ps(p); }
+  // p[0], p[2], ..., p[14]
+  static inline Type LoadEven(const float *p) {
+    const __m256 even = _mm256_shuffle_ps(_mm256_loadu_ps(p),
+                                          _mm256_loadu_ps(p + 8),
+                                          _MM_SHUFFLE(2, 0, 2, 0));
+    return _mm256_castpd_ps(_mm256_permute4x64_pd(
+        _mm256_castps_pd(even), _MM_SHUFFLE(3, 1, 2, 0)));
+  }
+  static inline Type Broadcast(const float *p) {
+    return _mm256_broadcast_ss(p);
+  }
+  static inline Type Fma(const Type a, const Type b, const Type c) {
+    return _mm256_fmadd_ps(a, b, c);
+  }
+  static inline void Store(float *p, const Type v) { _mm256_storeu_ps(p, v); }
+};
+
+}  // namespace
+
+// 16 registers: the accumulators take 12, the rhs and the lhs the rest.
+const GemmKernel *GetGemmKernel(const index_t rows, const index_t cols) {
+  static const GemmKernel kNarrow = {12, 8, GemmBlock<Vec, 12, 1>};
+  static const GemmKernel kShort = {3, 32, GemmBlock<Vec, 3, 4>};
+  static const GemmKernel kSquare = {6, 16, GemmBlock<Vec, 6, 2>};
+  if (cols <= 8) {
+    return &kNarrow;
+  } else if (rows <= 3) {
+    return &kShort;
+  }
+  return &kSquare;
+}
+
+DepthwiseConv2dRowKernel GetDepthwiseConv2dRowKernel(const int filter_h,
+                                                     const int filter_w,
+                                                     const int stride_w) {
+  if (filter_h == 3 && filter_w == 3) {
+    return stride_w == 1 ? DepthwiseConv2dRowBlock<Vec, 3, 3, 1> :
+           stride_w == 2 ? DepthwiseConv2dRowBlock<Vec, 3, 3, 2> : nullptr;
+  } else if (filter_h == 5 && filter_w == 5) {
+    return stride_w == 1 ? DepthwiseConv2dRowBlock<Vec, 5, 5, 1> :
+           stride_w == 2 ? DepthwiseConv2dRowBlock<Vec, 5, 5, 2> : nullptr;
+  }
+  return nullptr;
+}
+
+}  // namespace avx2
+}  // namespace x86
+}  // namespace ops
+}  // namespace mace
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif  // MACE_ENABLE_X86_KERNELS
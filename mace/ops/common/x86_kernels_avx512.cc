@@ -0,0 +1,98 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Everything included must come before the instruction set is enabled.
+#include "mace/ops/common/x86_kernels.h"
+
+#ifdef MACE_ENABLE_X86_KERNELS
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f,avx2,fma"))), \
+                             apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx2,fma")
+#endif
+
+#include "mace/ops/common/x86_kernels_impl.h"
+
+namespace mace {
+namespace ops {
+namespace x86 {
+namespace avx512 {
+
+namespace {
+
+struct Vec {
+  typedef __m512 Type;
+  static const int kLanes = 16;
+
+  static inline Type Zero() { return _mm512_setzero_ps(); }
+  static inline Type Load(const float *p) { return _mm512_loadu_ps(p); }
+  // p[0], p[2], ..., p[30]
+  static inline Type LoadEven(const float *p) {
+    const __m512i even = _mm512_set_epi32(30, 28, 26, 24, 22, 20, 18, 16,
+                                          14, 12, 10, 8, 6, 4, 2, 0);
+    return _mm512_permutex2var_ps(_mm512_loadu_ps(p), even,
+                                  _mm512_loadu_ps(p + 16));
+  }
+  static inline Type Broadcast(const float *p) { return _mm512_set1_ps(*p); }
+  static inline Type Fma(const Type a, const Type b, const Type c) {
+    return _mm512_fmadd_ps(a, b, c);
+  }
+  static inline void Store(float *p, const Type v) { _mm512_storeu_ps(p, v); }
+};
+
+}  // namespace
+
+// 32 registers: the accumulators take up to 24, the rhs and the lhs the rest.
+const GemmKernel *GetGemmKernel(const index_t rows, const index_t cols) {
+  static const GemmKernel kNarrow = {24, 16, GemmBlock<Vec, 24, 1>};
+  static const GemmKernel kShort = {4, 64, GemmBlock<Vec, 4, 4>};
+  static const GemmKernel kSquare = {12, 32, GemmBlock<Vec, 12, 2>};
+  if (cols <= 16) {
+    return &kNarrow;
+  } else if (rows <= 4) {
+    return &kShort;
+  }
+  return &kSquare;
+}
+
+DepthwiseConv2dRowKernel GetDepthwiseConv2dRowKernel(const int filter_h,
+                                                     const int filter_w,
+                                                     const int stride_w) {
+  if (filter_h == 3 && filter_w == 3) {
+    return stride_w == 1 ? DepthwiseConv2dRowBlock<Vec, 3, 3, 1> :
+           stride_w == 2 ? DepthwiseConv2dRowBlock<Vec, 3, 3, 2> : nullptr;
+  } else if (filter_h == 5 && filter_w == 5) {
+    return stride_w == 1 ? DepthwiseConv2dRowBlock<Vec, 5, 5, 1> :
+           stride_w == 2 ? DepthwiseConv2dRowBlock<Vec, 5, 5, 2> : nullptr;
+  }
+  return nullptr;
+}
+
+}  // namespace avx512
+}  // namespace x86
+}  // namespace ops
+}  // namespace mace
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif  // MACE_ENABLE_X86_KERNELS
@@ -0,0 +1,150 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_OPS_COMMON_X86_KERNELS_IMPL_H_
+#define MACE_OPS_COMMON_X86_KERNELS_IMPL_H_
+
+// Kernel templates shared by the per instruction set translation units, which
+// include this header after enabling their instruction set, so that the
+// templates are compiled for it. They are instantiated with vector traits of
+// internal linkage, which provide
+//   Type, kLanes, Zero(), Load(p), LoadEven(p), Broadcast(p), Fma(a, b, c)
+//   and Store(p, v).
+// Code in there must not call inline functions of other headers, whose
+// instantiation could otherwise be picked up by the rest of the library.
+
+#include "mace/core/types.h"
+#include "mace/ops/common/x86_kernels.h"
+
+namespace mace {
+namespace ops {
+namespace x86 {
+
+// The kernels of each instruction set, see x86_kernels.h.
+namespace avx2 {
+const GemmKernel *GetGemmKernel(const index_t rows, const index_t cols);
+DepthwiseConv2dRowKernel GetDepthwiseConv2dRowKernel(const int filter_h,
+                                                     const int filter_w,
+                                                     const int stride_w);
+}  // namespace avx2
+
+namespace avx512 {
+const GemmKernel *GetGemmKernel(const index_t rows, const index_t cols);
+DepthwiseConv2dRowKernel GetDepthwiseConv2dRowKernel(const int filter_h,
+                                                     const int filter_w,
+                                                     const int stride_w);
+}  // namespace avx512
+
+template<typename V, int MR, int NV>
+inline void GemmBlockStep(const float *lhs,
+                          const float *rhs,
+                          typename V::Type (*acc)[NV]) {
+  typename V::Type rhs_vec[NV];
+  for (int j = 0; j < NV; ++j) {
+    rhs_vec[j] = V::Load(rhs + j * V::kLanes);
+  }
+  for (int i = 0; i < MR; ++i) {
+    const typename V::Type lhs_vec = V::Broadcast(lhs + i);
+    for (int j = 0; j < NV; ++j) {
+      acc[i][j] = V::Fma(lhs_vec, rhs_vec[j], acc[i][j]);
+    }
+  }
+}
+
+// The MR x NV vector accumulators stay in registers for the whole depth,
+// which is unrolled by 4.
+template<typename V, int MR, int NV>
+void GemmBlock(const float *lhs_panel,
+               const float *rhs_panel,
+               const index_t depth,
+               float *tile) {
+  const int nr = NV * V::kLanes;
+  typename V::Type acc[MR][NV];
+  for (int i = 0; i < MR; ++i) {
+    for (int j = 0; j < NV; ++j) {
+      acc[i][j] = V::Zero();
+    }
+  }
+
+  index_t d = 0;
+  for (; d + 4 <= depth; d += 4) {
+    GemmBlockStep<V, MR, NV>(lhs_panel, rhs_panel, acc);
+    GemmBlockStep<V, MR, NV>(lhs_panel + MR, rhs_panel + nr, acc);
+    GemmBlockStep<V, MR, NV>(lhs_panel + 2 * MR, rhs_panel + 2 * nr,
+                             acc);
+    GemmBlockStep<V, MR, NV>(lhs_panel + 3 * MR, rhs_panel + 3 * nr,
+                             acc);
+    lhs_panel += 4 * MR;
+    rhs_panel += 4 * nr;
+  }
+  for (; d < depth; ++d) {
+    GemmBlockStep<V, MR, NV>(lhs_panel, rhs_panel, acc);
+    lhs_panel += MR;
+    rhs_panel += nr;
+  }
+
+  for (int i = 0; i < MR; ++i) {
+    for (int j = 0; j < NV; ++j) {
+      V::Store(tile + i * nr + j * V::kLanes, acc[i][j]);
+    }
+  }
+}
+
+// Vectorized over consecutive outputs of the row.
+template<typename V, int KH, int KW, int SW>
+void DepthwiseConv2dRowBlock(const float *input,
+                             const index_t in_width,
+                             const float *filter,
+                             const index_t count,
+                             float *output) {
+  typename V::Type filter_vec[KH * KW];
+  for (int k = 0; k < KH * KW; ++k) {
+    filter_vec[k] = V::Broadcast(filter + k);
+  }
+
+  // LoadEven reads one float past the last input of a vector of outputs,
+  // which is still an input of the next output.
+  const index_t vector_end = SW == 1 ? count : count - 1;
+  index_t n = 0;
+  for (; n + V::kLanes <= vector_end; n += V::kLanes) {
+    const float *in = input + n * SW;
+    typename V::Type acc = V::Zero();
+    for (int kh = 0; kh < KH; ++kh) {
+      for (int kw = 0; kw < KW; ++kw) {
+        const float *in_ptr = in + kh * in_width + kw;
+        const typename V::Type in_vec =
+            SW == 1 ? V::Load(in_ptr) : V::LoadEven(in_ptr);
+        acc = V::Fma(in_vec, filter_vec[kh * KW + kw], acc);
+      }
+    }
+    V::Store(output + n, acc);
+  }
+
+  for (; n < count; ++n) {
+    const float *in = input + n * SW;
+    float sum = 0;
+    for (int kh = 0; kh < KH; ++kh) {
+      for (int kw = 0; kw < KW; ++kw) {
+        sum += in[kh * in_width + kw] * filter[kh * KW + kw];
+      }
+    }
+    output[n] = sum;
+  }
+}
+
+}  // namespace x86
+}  // namespace ops
+}  // namespace mace
+
+#endif  // MACE_OPS_COMMON_X86_KERNELS_IMPL_H_
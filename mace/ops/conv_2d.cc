@@ -38,6 +38,7 @@
 
 #ifdef MACE_ENABLE_QUANTIZE
 #include "mace/ops/common/gemmlowp_util.h"
+#include "mace/ops/common/input_quantizer.h"
 #include "mace/ops/arm/q8/quantization_util.h"
 #include "mace/runtimes/cpu/cpu_runtime.h"
 #endif  // MACE_ENABLE_QUANTIZE
@@ -159,6 +160,14 @@ class Conv2dOp<RuntimeType::RT_CPU, T> : public ConvPool2dOpBase {
           tag = MACE_DELEGATOR_KEY_EX(Conv2d, RuntimeType::RT_CPU, T,
                                       kCpuImplType, K15x1S1);
         }
+      } else if (filter->dim(2) == 3 && filter->dim(3) == 3
+          && strides_[0] == 1 && strides_[1] == 1 && dilations_[0] == 1
+          && dilations_[1] == 1 && input->dim(1) >= 16
+          && filter->dim(0) >= 16) {
+        // The portable winograd, whose scalar transforms take more channels
+        // than NEON's to pay off. The other shapes take the reference conv.
+        tag = MACE_DELEGATOR_KEY_EX(Conv2d, RuntimeType::RT_CPU, T,
+                                    kCpuImplType, K3x3Winograd);
       }
       delegator::Conv2dParam param(strides_, dilations_,
                                    paddings_, padding_type_);
@@ -194,10 +203,16 @@ class Conv2dOp<RuntimeType::RT_CPU, uint8_t> : public ConvPool2dOpBase {
                                                    "NOOP"))),
         relux_max_limit_(Operation::GetOptionalArg<float>("max_limit", 0.0f)),
         activation_coefficient_(Operation::GetOptionalArg<float>(
-            "activation_coefficient", 0.0f)) {}
+            "activation_coefficient", 0.0f)),
+        input_quantizer_(*context->operator_def(),
+                         &context->runtime()->thread_pool()) {}
 
   MaceStatus Run(OpContext *context) override {
-    const Tensor *input = this->Input(INPUT);
+    const Tensor *input =
+        input_quantizer_.Quantize(context, INPUT, this->Input(INPUT));
+    if (input == nullptr) {
+      return MaceStatus::MACE_OUT_OF_RESOURCES;
+    }
     const Tensor *filter = this->Input(FILTER);
     const Tensor *bias = this->InputSize() >= 3 ? this->Input(BIAS) : nullptr;
     Tensor *output = this->Output(OUTPUT);
@@ -282,7 +297,9 @@ class Conv2dOp<RuntimeType::RT_CPU, uint8_t> : public ConvPool2dOpBase {
       std::vector<index_t> tensor_shape = {depth, columns};
       im2col = make_unique<Tensor>(runtime, DT_UINT8,
                                    input->memory_type(), tensor_shape);
-      runtime->AllocateBufferForTensor(im2col.get(), BufRentType::RENT_SCRATCH);
+      MACE_RETURN_IF_ERROR(
+          runtime->AllocateBufferForTensor(im2col.get(),
+                                           BufRentType::RENT_SCRATCH));
       uint8_t *im2col_data = im2col->mutable_data<uint8_t>();
       Im2col(context, input_data, input->shape(), filter_h, filter_w, stride_h,
              stride_w, static_cast<uint8_t>(input->zero_point()),
@@ -414,6 +431,7 @@ class Conv2dOp<RuntimeType::RT_CPU, uint8_t> : public ConvPool2dOpBase {
   const float relux_max_limit_;
   const float activation_coefficient_;
   std::vector<int32_t> bias_;
+  InputQuantizer input_quantizer_;
 
  private:
   MACE_OP_INPUT_TAGS(INPUT, FILTER, BIAS);
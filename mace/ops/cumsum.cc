@@ -13,9 +13,12 @@
 // limitations under the License.
 
 #include <functional>
+#include <numeric>
+#include <vector>
 
 #include "mace/core/ops/operator.h"
 #include "mace/core/registry/ops_registry.h"
+#include "mace/ops/common/scan.h"
 
 namespace mace {
 namespace ops {
@@ -31,7 +34,8 @@ class CumsumOp<RuntimeType::RT_CPU, T> : public Operation {
         axis_(Operation::GetOptionalArg<int>("axis", 0)),
         exclusive_(Operation::GetOptionalArg<bool>("exclusive", false)),
         reverse_(Operation::GetOptionalArg<bool>("reverse", false)),
-        checked_(false) {}
+        checked_(false),
+        scanner_(SCAN_SUM, exclusive_, reverse_) {}
 
   void Validate() {
     const int32_t input_dims = this->Input(0)->dim_size();
@@ -43,7 +47,6 @@ class CumsumOp<RuntimeType::RT_CPU, T> : public Operation {
   }
 
   MaceStatus Run(OpContext *context) override {
-    MACE_UNUSED(context);
     if (!checked_) {
       Validate();
       bool has_data_format = Operation::GetOptionalArg<int>(
@@ -62,8 +65,8 @@ class CumsumOp<RuntimeType::RT_CPU, T> : public Operation {
     Tensor *output = this->Output(0);
     MACE_RETURN_IF_ERROR(output->ResizeLike(input));
 
-    const float *input_ptr = input->data<float>();
-    float *output_ptr = output->mutable_data<float>();
+    const T *input_ptr = input->data<T>();
+    T *output_ptr = output->mutable_data<T>();
 
     const index_t outer_size = std::accumulate(input_shape.begin(),
                                                input_shape.begin() + axis_,
@@ -75,59 +78,8 @@ class CumsumOp<RuntimeType::RT_CPU, T> : public Operation {
                                                std::multiplies<index_t>());
     const index_t cum_size = input_shape[axis_];
 
-    if (!reverse_) {
-      for (index_t outer_idx = 0; outer_idx < outer_size; ++outer_idx) {
-        index_t start_idx = outer_idx * cum_size * inner_size;
-        for (index_t cum_idx = 0; cum_idx < cum_size; ++cum_idx) {
-          if (cum_idx == 0) {
-            if (exclusive_) {
-              std::memset(static_cast<void *>(output_ptr + start_idx),
-                          0,
-                          sizeof(T) * inner_size);
-            } else {
-              std::memcpy(output_ptr + start_idx,
-                          input_ptr + start_idx,
-                          sizeof(T) * inner_size);
-            }
-          } else {
-            index_t cur_idx = start_idx + cum_idx * inner_size;
-            index_t pre_idx = start_idx + (cum_idx - 1) * inner_size;
-            index_t input_idx = exclusive_ ? pre_idx : cur_idx;
-            for (index_t inner_idx = 0; inner_idx < inner_size; ++inner_idx) {
-              output_ptr[cur_idx + inner_idx] =
-                output_ptr[pre_idx + inner_idx] +
-                input_ptr[input_idx + inner_idx];
-            }
-          }
-        }
-      }
-    } else {
-      for (index_t outer_idx = outer_size - 1; outer_idx >= 0; --outer_idx) {
-        index_t start_idx = outer_idx * cum_size * inner_size;
-        for (index_t cum_idx = cum_size - 1; cum_idx >= 0; --cum_idx) {
-          index_t cur_idx = start_idx + cum_idx * inner_size;
-          if (cum_idx == cum_size - 1) {
-            if (exclusive_) {
-              std::memset(static_cast<void *>(output_ptr + cur_idx),
-                          0,
-                          sizeof(T) * inner_size);
-            } else {
-              std::memcpy(output_ptr + cur_idx,
-                          input_ptr + cur_idx,
-                          sizeof(T) * inner_size);
-            }
-          } else {
-            index_t pre_idx = start_idx + (cum_idx + 1) * inner_size;
-            index_t input_idx = exclusive_ ? pre_idx : cur_idx;
-            for (index_t inner_idx = 0; inner_idx < inner_size; ++inner_idx) {
-              output_ptr[cur_idx + inner_idx] =
-                output_ptr[pre_idx + inner_idx] +
-                input_ptr[input_idx + inner_idx];
-            }
-          }
-        }
-      }
-    }
+    scanner_.Compute(&context->runtime()->thread_pool(), input_ptr,
+                     outer_size, cum_size, inner_size, output_ptr);
 
     return MaceStatus::MACE_SUCCESS;
   }
@@ -137,6 +89,7 @@ class CumsumOp<RuntimeType::RT_CPU, T> : public Operation {
   bool exclusive_;
   bool reverse_;
   bool checked_;
+  Scanner scanner_;
 };
 
 void RegisterCumsum(OpRegistry *op_registry) {
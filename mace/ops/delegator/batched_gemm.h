@@ -0,0 +1,57 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_OPS_DELEGATOR_BATCHED_GEMM_H_
+#define MACE_OPS_DELEGATOR_BATCHED_GEMM_H_
+
+#include "mace/core/ops/op_context.h"
+#include "mace/core/ops/op_delegator.h"
+#include "mace/core/registry/op_delegator_registry.h"
+#include "mace/ops/common/matrix.h"
+
+namespace mace {
+namespace ops {
+namespace delegator {
+
+// Multiplies a batch of small matrices, packing the whole batch at once and
+// computing it in a single thread pool dispatch.
+class BatchedGemm : public OpDelegator {
+ public:
+  explicit BatchedGemm(const DelegatorParam &param) : OpDelegator(param) {}
+  virtual ~BatchedGemm() = default;
+
+  MACE_DEFINE_DELEGATOR_CREATOR(BatchedGemm)
+
+  // The batch strides are counted in elements, a stride of 0 broadcasts a
+  // single matrix to the whole batch. The output is always dense.
+  virtual MaceStatus Compute(const OpContext *context,
+                             const Tensor *lhs,
+                             const Tensor *rhs,
+                             const index_t batch,
+                             const index_t rows,
+                             const index_t cols,
+                             const index_t depth,
+                             const MatrixMajor lhs_major,
+                             const MatrixMajor rhs_major,
+                             const MatrixMajor output_major,
+                             const index_t lhs_batch_stride,
+                             const index_t rhs_batch_stride,
+                             Tensor *output) = 0;
+};
+
+}  // namespace delegator
+}  // namespace ops
+}  // namespace mace
+
+#endif  // MACE_OPS_DELEGATOR_BATCHED_GEMM_H_
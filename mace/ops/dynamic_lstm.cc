@@ -230,28 +230,40 @@ class DynamicLSTMOp<RuntimeType::RT_CPU, T> : public Operation {
 
     Tensor prev_out_buf(runtime, data_type, mem_type,
                         {out_buf_chunk, prev_out_dim_});
-    runtime->AllocateBufferForTensor(&prev_out_buf, BufRentType::RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(&prev_out_buf,
+                                         BufRentType::RENT_SCRATCH));
     T *prev_out_buf_data = prev_out_buf.mutable_data<T>();
 
     Tensor prev_cell_buf(runtime, data_type, mem_type,
                          {cell_buf_chunk, prev_cell_dim_});
-    runtime->AllocateBufferForTensor(&prev_cell_buf, BufRentType::RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(&prev_cell_buf,
+                                         BufRentType::RENT_SCRATCH));
     T *prev_cell_buf_data = prev_cell_buf.mutable_data<T>();
 
     Tensor affine_a_in(runtime, data_type, mem_type, {1, affine_a_in_dim});
-    runtime->AllocateBufferForTensor(&affine_a_in, BufRentType::RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(&affine_a_in,
+                                         BufRentType::RENT_SCRATCH));
     T *affine_a_in_data = affine_a_in.mutable_data<T>();
 
     Tensor affine_a_out(runtime, data_type, mem_type, {1, affine_a_out_dim});
-    runtime->AllocateBufferForTensor(&affine_a_out, BufRentType::RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(&affine_a_out,
+                                         BufRentType::RENT_SCRATCH));
     T *affine_a_out_data = affine_a_out.mutable_data<T>();
 
     Tensor affine_b_in(runtime, data_type, mem_type, {1, affine_b_in_dim});
-    runtime->AllocateBufferForTensor(&affine_b_in, BufRentType::RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(&affine_b_in,
+                                         BufRentType::RENT_SCRATCH));
     T *affine_b_in_data = affine_b_in.mutable_data<T>();
 
     Tensor affine_b_out(runtime, data_type, mem_type, {1, affine_b_out_dim});
-    runtime->AllocateBufferForTensor(&affine_b_out, BufRentType::RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(&affine_b_out,
+                                         BufRentType::RENT_SCRATCH));
     T *affine_b_out_data = affine_b_out.mutable_data<T>();
 
     Tensor *output = this->Output(OUTPUT);
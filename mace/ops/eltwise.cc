@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #ifdef MACE_ENABLE_QUANTIZE
+#include "mace/ops/common/input_quantizer.h"
 #include "mace/ops/delegator/eltwise.h"
 #endif  // MACE_ENABLE_QUANTIZE
 
@@ -975,7 +976,9 @@ class EltwiseOp : public Operation {
       if (scalar_tensor_ == nullptr) {
         scalar_tensor_.reset(new Tensor(
             runtime, input0->dtype(), MemoryType::CPU_BUFFER));
-        runtime->AllocateBufferForTensor(scalar_tensor_.get(), RENT_SCRATCH);
+        MACE_RETURN_IF_ERROR(
+            runtime->AllocateBufferForTensor(scalar_tensor_.get(),
+                                             RENT_SCRATCH));
       }
       auto scalar_data = scalar_tensor_->mutable_data<T>();
       scalar_data[0] = static_cast<T>(scalar_input_);
@@ -1162,14 +1165,20 @@ class EltwiseOp<RuntimeType::RT_CPU, uint8_t> : public Operation {
                 static_cast<ops::EltwiseType>(
                     Operation::GetOptionalArg<int>(
                         "type",
-                        static_cast<int>(ops::EltwiseType::NONE)))))) {}
+                        static_cast<int>(ops::EltwiseType::NONE)))))),
+        input_quantizer_(*context->operator_def(),
+                         &context->runtime()->thread_pool()) {}
 
   MaceStatus Run(OpContext *context) override {
-    MACE_UNUSED(context);
-    const Tensor *input0 = this->Input(0);
     MACE_CHECK(this->InputSize() == 2,
                "Quantized Elementwise don't support broadcast now.");
-    const Tensor *input1 = this->Input(1);
+    const Tensor *input0 = input_quantizer_.Quantize(context, 0,
+                                                     this->Input(0));
+    const Tensor *input1 = input_quantizer_.Quantize(context, 1,
+                                                     this->Input(1));
+    if (input0 == nullptr || input1 == nullptr) {
+      return MaceStatus::MACE_OUT_OF_RESOURCES;
+    }
     Tensor *output = this->Output(0);
     MACE_CHECK(type_ == SUM || type_ == SUB,
                "Quantized Elementwise only support SUM and SUB now.");
@@ -1187,6 +1196,7 @@ class EltwiseOp<RuntimeType::RT_CPU, uint8_t> : public Operation {
   float scalar_input_;
   int32_t scalar_input_index_;
   std::unique_ptr<delegator::Eltwise> eltwise_delegator_;
+  InputQuantizer input_quantizer_;
 };
 #endif  // MACE_ENABLE_QUANTIZE
 
@@ -91,7 +91,8 @@ class ExtractPoolingOp<RuntimeType::RT_CPU, T> : public Operation {
     Runtime *runtime = context->runtime();
     Tensor extract_out(runtime, DataTypeToEnum<T>::v(),
                        input->memory_type(), {1, output_dim});
-    runtime->AllocateBufferForTensor(&extract_out, RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(&extract_out, RENT_SCRATCH));
 
     extract_out.Clear();
     T *extract_out_data = extract_out.mutable_data<T>();
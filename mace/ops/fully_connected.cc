@@ -29,6 +29,10 @@
 #include "mace/runtimes/opencl/transform/buffer_transformer.h"
 #endif  // MACE_ENABLE_OPENCL
 
+#ifdef MACE_ENABLE_QUANTIZE
+#include "mace/ops/common/input_quantizer.h"
+#endif  // MACE_ENABLE_QUANTIZE
+
 #include "mace/runtimes/cpu/cpu_runtime.h"
 #include "mace/utils/memory.h"
 
@@ -131,10 +135,16 @@ class FullyConnectedOp<RuntimeType::RT_CPU, uint8_t>
             context->workspace(),
             MACE_DELEGATOR_KEY(Gemv, RuntimeType::RT_CPU,
                                uint8_t, kCpuImplType),
-            DelegatorParam())) {}
+            DelegatorParam())),
+        input_quantizer_(*context->operator_def(),
+                         &context->runtime()->thread_pool()) {}
 
   MaceStatus Run(OpContext *context) override {
-    const Tensor *input = this->Input(INPUT);
+    const Tensor *input =
+        input_quantizer_.Quantize(context, INPUT, this->Input(INPUT));
+    if (input == nullptr) {
+      return MaceStatus::MACE_OUT_OF_RESOURCES;
+    }
     const Tensor *weight = this->Input(WEIGHT);  // OIHW
     const Tensor *bias = this->InputSize() >= 3 ? this->Input(BIAS) : nullptr;
     Tensor *output = this->Output(OUTPUT);
@@ -175,6 +185,7 @@ class FullyConnectedOp<RuntimeType::RT_CPU, uint8_t>
 
  private:
   std::unique_ptr<delegator::Gemv> gemv_;
+  InputQuantizer input_quantizer_;
 };
 #endif  // MACE_ENABLE_QUANTIZE
 
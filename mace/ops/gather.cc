@@ -13,22 +13,81 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <vector>
 
 #include "mace/core/ops/operator.h"
 #include "mace/core/registry/ops_registry.h"
+#include "mace/ops/common/reduce_type.h"
 
 namespace mace {
 namespace ops {
 
+namespace {
+// Rows are fetched this many indices ahead of the one being copied, far
+// enough to hide a DRAM miss behind the copies of the rows in between.
+constexpr index_t kPrefetchDistance = 8;
+constexpr index_t kCacheLineBytes = 64;
+
+inline void PrefetchRow(const void *row, const index_t bytes) {
+#if defined(__GNUC__) || defined(__clang__)
+  const char *ptr = static_cast<const char *>(row);
+  for (index_t offset = 0; offset < bytes; offset += kCacheLineBytes) {
+    __builtin_prefetch(ptr + offset);
+  }
+#else
+  MACE_UNUSED(row);
+  MACE_UNUSED(bytes);
+#endif
+}
+
+// Reads one element of an embedding table as float. Tables may be kept in
+// fp16 or in uint8 with a scale and zero point, see
+// Workspace::LoadModelTensor.
+template<typename SrcT>
+struct TableReader {
+  static float Read(const SrcT value, const float scale,
+                    const int32_t zero_point) {
+    MACE_UNUSED(scale);
+    MACE_UNUSED(zero_point);
+    return static_cast<float>(value);
+  }
+};
+
+template<>
+struct TableReader<half> {
+  static float Read(const half value, const float scale,
+                    const int32_t zero_point) {
+    MACE_UNUSED(scale);
+    MACE_UNUSED(zero_point);
+    return half_float::half_cast<float>(value);
+  }
+};
+
+template<>
+struct TableReader<uint8_t> {
+  static float Read(const uint8_t value, const float scale,
+                    const int32_t zero_point) {
+    return scale * (static_cast<int32_t>(value) - zero_point);
+  }
+};
+}  // namespace
+
+// Gather rows of params along axis. With the combiner argument set to
+// ReduceType::SUM or ReduceType::MEAN the op works as an embedding bag:
+// the last dim of indices holds the ids of one bag, whose rows are pooled
+// into a single output row without materializing the gathered rows.
 template <RuntimeType D, class T>
 class GatherOp : public Operation {
  public:
   explicit GatherOp(OpConstructContext *context)
       : Operation(context),
-        axis_(Operation::GetOptionalArg<int>("axis", 0)) {}
+        axis_(Operation::GetOptionalArg<int>("axis", 0)),
+        combiner_(Operation::GetOptionalArg<int>("combiner", -1)) {}
 
   MaceStatus Run(OpContext *context) override {
-    MACE_UNUSED(context);
     const Tensor *params = this->Input(PARAMS);
     const Tensor *indices = this->Input(INDICES);
     Tensor *output = this->Output(OUTPUT);
@@ -38,47 +97,157 @@ class GatherOp : public Operation {
     }
     MACE_CHECK(axis_ >= 0 && axis_ < params->dim_size(),
                "axis is out of bound: ", axis_);
+    const bool pooled = combiner_ >= 0;
+    MACE_CHECK(!pooled || combiner_ == ReduceType::SUM ||
+        combiner_ == ReduceType::MEAN, "unsupported combiner: ", combiner_);
+    MACE_CHECK(!pooled || indices->dim_size() > 0,
+               "embedding bag needs indices of rank >= 1");
     output_shape.insert(output_shape.end(), params->shape().begin(),
                         params->shape().begin() + axis_);
     output_shape.insert(output_shape.end(), indices->shape().begin(),
-                        indices->shape().end());
+                        pooled ? indices->shape().end() - 1
+                               : indices->shape().end());
     output_shape.insert(output_shape.end(),
                         params->shape().begin() + (axis_ + 1),
                         params->shape().end());
     MACE_RETURN_IF_ERROR(output->Resize(output_shape));
 
     const int32_t *indices_data = indices->data<int32_t>();
-    const T *params_data = params->data<T>();
-    T *output_data = output->mutable_data<T>();
-
     const index_t axis_dim_size = params->dim(axis_);
-    const index_t lhs_size = std::accumulate(params->shape().begin(),
-                                       params->shape().begin() + axis_, 1,
-                                       std::multiplies<index_t>());
-    const index_t rhs_size =
-        std::accumulate(params->shape().begin() + (axis_ + 1),
-                        params->shape().end(), 1, std::multiplies<index_t>());
     const index_t index_size = indices->size();
+    for (index_t idx = 0; idx < index_size; ++idx) {
+      MACE_CHECK(indices_data[idx] >= 0 && indices_data[idx] < axis_dim_size,
+                 "idx out of bound: ", indices_data[idx]);
+    }
 
-    for (index_t l = 0; l < lhs_size; ++l) {
-      for (index_t idx = 0; idx < index_size; ++idx) {
-        MACE_ASSERT(indices_data[idx] < axis_dim_size, "idx out of bound: ",
-                    indices_data[idx]);
-        memcpy(
-            output_data + ((l * index_size) + idx) * rhs_size,
-            params_data + ((l * axis_dim_size) + indices_data[idx]) * rhs_size,
-            sizeof(T) * rhs_size);
+    const DataType table_type = params->dtype();
+    if (table_type == DataTypeToEnum<T>::value) {
+      output->SetScale(params->scale());
+      output->SetZeroPoint(params->zero_point());
+      if (!pooled) {
+        CopyRows(context, params, indices, output);
+        return MaceStatus::MACE_SUCCESS;
       }
     }
 
-    output->SetScale(params->scale());
-    output->SetZeroPoint(params->zero_point());
+    MACE_CHECK(DataTypeToEnum<T>::value != DT_UINT8,
+               "uint8 Gather only supports uint8 tables without combiner");
+    switch (table_type) {
+      case DT_HALF:
+        ConvertRows<half>(context, params, indices, output);
+        break;
+      case DT_UINT8:
+        ConvertRows<uint8_t>(context, params, indices, output);
+        break;
+      default:
+        MACE_CHECK(table_type == DataTypeToEnum<T>::value,
+                   "unsupported table data type: ", table_type);
+        ConvertRows<T>(context, params, indices, output);
+        break;
+    }
 
     return MaceStatus::MACE_SUCCESS;
   }
 
  private:
+  void GetLoopSizes(const Tensor *params, index_t *lhs_size,
+                    index_t *rhs_size) const {
+    *lhs_size = std::accumulate(params->shape().begin(),
+                                params->shape().begin() + axis_, 1,
+                                std::multiplies<index_t>());
+    *rhs_size = std::accumulate(params->shape().begin() + (axis_ + 1),
+                                params->shape().end(), 1,
+                                std::multiplies<index_t>());
+  }
+
+  // Plain gather of a table stored in T, parallel over the indices.
+  void CopyRows(OpContext *context, const Tensor *params,
+                const Tensor *indices, Tensor *output) {
+    index_t lhs_size = 0;
+    index_t rhs_size = 0;
+    GetLoopSizes(params, &lhs_size, &rhs_size);
+    const index_t axis_dim_size = params->dim(axis_);
+    const index_t index_size = indices->size();
+    const int32_t *indices_data = indices->data<int32_t>();
+    const T *params_data = params->data<T>();
+    T *output_data = output->mutable_data<T>();
+    const index_t row_bytes = rhs_size * sizeof(T);
+
+    utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+    thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                              index_t start1, index_t end1, index_t step1) {
+      for (index_t l = start0; l < end0; l += step0) {
+        const T *params_base = params_data + l * axis_dim_size * rhs_size;
+        T *output_base = output_data + l * index_size * rhs_size;
+        for (index_t idx = start1; idx < end1; idx += step1) {
+          if (idx + kPrefetchDistance < end1) {
+            PrefetchRow(params_base +
+                indices_data[idx + kPrefetchDistance] * rhs_size, row_bytes);
+          }
+          memcpy(output_base + idx * rhs_size,
+                 params_base + indices_data[idx] * rhs_size, row_bytes);
+        }
+      }
+    }, 0, lhs_size, 1, 0, index_size, 1);
+  }
+
+  // Gather from a table stored in SrcT, dequantizing every row read, and
+  // pool the rows of each bag when a combiner is set.
+  template<typename SrcT>
+  void ConvertRows(OpContext *context, const Tensor *params,
+                   const Tensor *indices, Tensor *output) {
+    index_t lhs_size = 0;
+    index_t rhs_size = 0;
+    GetLoopSizes(params, &lhs_size, &rhs_size);
+    const index_t axis_dim_size = params->dim(axis_);
+    const bool pooled = combiner_ >= 0;
+    const index_t bag_size =
+        pooled ? indices->dim(indices->dim_size() - 1) : 1;
+    const index_t bag_count = indices->size() / std::max<index_t>(bag_size, 1);
+    const float bag_scale = combiner_ == ReduceType::MEAN && bag_size > 0 ?
+                            1.f / bag_size : 1.f;
+    const int32_t *indices_data = indices->data<int32_t>();
+    const SrcT *params_data = params->data<SrcT>();
+    T *output_data = output->mutable_data<T>();
+    const float scale = params->scale();
+    const int32_t zero_point = params->zero_point();
+    const index_t row_bytes = rhs_size * sizeof(SrcT);
+
+    utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+    thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                              index_t start1, index_t end1, index_t step1) {
+      std::vector<float> acc(rhs_size);
+      float *acc_data = acc.data();
+      for (index_t l = start0; l < end0; l += step0) {
+        const SrcT *params_base = params_data + l * axis_dim_size * rhs_size;
+        T *output_base = output_data + l * bag_count * rhs_size;
+        const index_t index_end = end1 * bag_size;
+        for (index_t bag = start1; bag < end1; bag += step1) {
+          std::fill_n(acc_data, rhs_size, 0.f);
+          for (index_t i = 0; i < bag_size; ++i) {
+            const index_t idx = bag * bag_size + i;
+            if (idx + kPrefetchDistance < index_end) {
+              PrefetchRow(params_base +
+                  indices_data[idx + kPrefetchDistance] * rhs_size,
+                          row_bytes);
+            }
+            const SrcT *row = params_base + indices_data[idx] * rhs_size;
+            for (index_t j = 0; j < rhs_size; ++j) {
+              acc_data[j] += TableReader<SrcT>::Read(row[j], scale,
+                                                     zero_point);
+            }
+          }
+          T *out_row = output_base + bag * rhs_size;
+          for (index_t j = 0; j < rhs_size; ++j) {
+            out_row[j] = acc_data[j] * bag_scale;
+          }
+        }
+      }
+    }, 0, lhs_size, 1, 0, bag_count, 1);
+  }
+
   int axis_;
+  int combiner_;
   MACE_OP_INPUT_TAGS(PARAMS, INDICES);
   MACE_OP_OUTPUT_TAGS(OUTPUT);
 };
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cmath>
 #include <memory>
 #include <string>
 #include <vector>
@@ -19,6 +20,7 @@
 #include "mace/core/ops/operator.h"
 #include "mace/core/registry/ops_registry.h"
 #include "mace/ops/activation.h"
+#include "mace/ops/common/normalization.h"
 #include "mace/ops/delegator/activation.h"
 #include "mace/utils/memory.h"
 
@@ -42,7 +44,6 @@ class GroupNormOp<RuntimeType::RT_CPU, T> : public Operation {
         group_num_(Operation::GetOptionalArg<int>("group_num", 32)) {}
 
   MaceStatus Run(OpContext *context) override {
-    MACE_UNUSED(context);
     const Tensor *input = Input(INPUT);
     Tensor *output = Output(OUTPUT);
     MACE_CHECK(input->dim_size() == 4, "input must be 4-dimensional. ",
@@ -64,59 +65,13 @@ class GroupNormOp<RuntimeType::RT_CPU, T> : public Operation {
     const auto inner_loop = group_size * height * width;
     utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
 
-    auto *runtime = context->runtime();
-    MemInfo mem_info(input->memory_type(),
-                     DataType::DT_FLOAT, {outer_loop * 2});
-    auto scratch_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
-    float *mean_ptr = scratch_buffer->mutable_data<float>();
-    float *variance_ptr = mean_ptr + outer_loop;
-
-    // compute EX
-    thread_pool.Compute1D([=](index_t start, index_t end, index_t step) {
-      for (index_t i = start; i < end; i += step) {
-        const auto offset = inner_loop * i;
-        mean_ptr[i] = std::accumulate(input_data + offset,
-                                      input_data + offset + inner_loop,
-                                      static_cast<T>(0.0f));
-        mean_ptr[i] /= inner_loop;
-      }
-    }, 0, outer_loop, 1);
-
-    // compute (X - EX)^2
-    thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
-                              index_t start1, index_t end1, index_t step1) {
-      for (index_t i = start0; i < end0; i += step0) {
-        const auto offset = i * inner_loop;
-        for (index_t j = start1; j < end1; j += step1) {
-          const auto idx = offset + j;
-          const auto x_ex = input_data[idx] - mean_ptr[i];
-          output_data[idx] = x_ex * x_ex;
-        }
-      }
-    }, 0, outer_loop, 1, 0, inner_loop, 1);
-
-    // compute (E((X - EX)^2) + eps_)^0.5
-    thread_pool.Compute1D([=](index_t start, index_t end, index_t step) {
-      for (index_t i = start; i < end; i += step) {
-        auto output_data_base = output_data + inner_loop * i;
-        variance_ptr[i] = std::accumulate(output_data_base,
-                                          output_data_base + inner_loop,
-                                          static_cast<T>(0.0f));
-        variance_ptr[i] = std::pow(variance_ptr[i] / inner_loop + eps_, 0.5f);
-      }
-    }, 0, outer_loop, 1);
-
-    // compute (X - EX) / ((E((X - EX)^2) + eps_)^0.5)
-    thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
-                              index_t start1, index_t end1, index_t step1) {
-      for (index_t i = start0; i < end0; i += step0) {
-        const auto offset = i * inner_loop;
-        for (index_t j = start1; j < end1; j += step1) {
-          output_data[offset + j] =
-              (input_data[offset + j] - mean_ptr[i]) / variance_ptr[i];
-        }
-      }
-    }, 0, outer_loop, 1, 0, inner_loop, 1);
+    // (X - EX) / ((E((X - EX)^2) + eps_)^0.5)
+    const float eps = eps_;
+    common::normalization::NormalizeRows(
+        &thread_pool, input_data, outer_loop, inner_loop,
+        [eps](float variance) -> float {
+          return 1.f / std::sqrt(variance + eps);
+        }, nullptr, nullptr, output_data);
 
     return MaceStatus::MACE_SUCCESS;
   }
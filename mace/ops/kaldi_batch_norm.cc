@@ -117,11 +117,13 @@ class KaldiBatchNormOp<RuntimeType::RT_CPU, T> : public Operation {
       auto mem_type = input->memory_type();
 
       Tensor mean(runtime, data_type, mem_type, {block_dim_});
-      runtime->AllocateBufferForTensor(&mean, RENT_SCRATCH);
+      MACE_RETURN_IF_ERROR(
+          runtime->AllocateBufferForTensor(&mean, RENT_SCRATCH));
       T *mean_data = mean.mutable_data<T>();
 
       Tensor var(runtime, data_type, mem_type, {block_dim_});
-      runtime->AllocateBufferForTensor(&var, RENT_SCRATCH);
+      MACE_RETURN_IF_ERROR(
+          runtime->AllocateBufferForTensor(&var, RENT_SCRATCH));
       T *var_data = var.mutable_data<T>();
 
       float var_scale = 1.0f / (target_rms_ * target_rms_);
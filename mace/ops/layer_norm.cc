@@ -0,0 +1,117 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <vector>
+
+#include "mace/core/ops/operator.h"
+#include "mace/core/registry/ops_registry.h"
+#include "mace/ops/common/normalization.h"
+
+namespace mace {
+namespace ops {
+
+// Layer Normalization:
+//   output = (X - EX) / (E((X - EX)^2) + epsilon)^0.5 * gamma + beta
+// The statistics are taken over the dims [axis, rank), gamma and beta are
+// optional and hold one value per normalized element. The axis counts the
+// dims of the input as laid out, 4D inputs with a data format are rejected:
+// their axis would count the NHWC dims of a tensor run as NCHW.
+template<RuntimeType D, class T>
+class LayerNormOp;
+
+template<class T>
+class LayerNormOp<RuntimeType::RT_CPU, T> : public Operation {
+ public:
+  explicit LayerNormOp(OpConstructContext *context)
+      : Operation(context),
+        axis_(Operation::GetOptionalArg<int>("axis", -1)),
+        eps_(Operation::GetOptionalArg<float>("epsilon",
+                                              static_cast<float>(1e-5))),
+        has_data_format_(Operation::GetOptionalArg<int>(
+            "has_data_format", 0) == 1) {}
+
+  MaceStatus Run(OpContext *context) override {
+    const Tensor *input = this->Input(INPUT);
+    const Tensor *gamma = this->InputSize() > GAMMA ? this->Input(GAMMA)
+                                                    : nullptr;
+    const Tensor *beta = this->InputSize() > BETA ? this->Input(BETA)
+                                                  : nullptr;
+    Tensor *output = this->Output(OUTPUT);
+
+    const int rank = static_cast<int>(input->dim_size());
+    MACE_CHECK(!has_data_format_ || rank != 4,
+               "LayerNorm does not support 4D inputs with a data format");
+    const int axis = axis_ < 0 ? axis_ + rank : axis_;
+    MACE_CHECK(axis >= 0 && axis < rank, "axis ", axis_,
+               " is out of range for input rank ", rank);
+    index_t inner_loop = 1;
+    for (int i = axis; i < rank; ++i) {
+      inner_loop *= input->dim(i);
+    }
+    const index_t outer_loop = inner_loop == 0 ? 0 : input->size() / inner_loop;
+    if (gamma != nullptr) {
+      MACE_CHECK(gamma->size() == inner_loop, "gamma size ", gamma->size(),
+                 " should be ", inner_loop);
+    }
+    if (beta != nullptr) {
+      MACE_CHECK(beta->size() == inner_loop, "beta size ", beta->size(),
+                 " should be ", inner_loop);
+    }
+    MACE_RETURN_IF_ERROR(output->ResizeLike(input));
+
+    // the affine parameters are read once per element, keep them in float
+    std::vector<float> gamma_data;
+    std::vector<float> beta_data;
+    if (gamma != nullptr) {
+      const T *gamma_ptr = gamma->data<T>();
+      gamma_data.assign(gamma_ptr, gamma_ptr + inner_loop);
+    }
+    if (beta != nullptr) {
+      const T *beta_ptr = beta->data<T>();
+      beta_data.assign(beta_ptr, beta_ptr + inner_loop);
+    }
+
+    const float eps = eps_;
+    utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+    common::normalization::NormalizeRows(
+        &thread_pool, input->data<T>(), outer_loop, inner_loop,
+        [eps](float variance) -> float {
+          return 1.f / std::sqrt(variance + eps);
+        },
+        gamma == nullptr ? nullptr : gamma_data.data(),
+        beta == nullptr ? nullptr : beta_data.data(),
+        output->mutable_data<T>());
+
+    return MaceStatus::MACE_SUCCESS;
+  }
+
+ private:
+  const int axis_;
+  const float eps_;
+  const bool has_data_format_;
+
+  MACE_OP_INPUT_TAGS(INPUT, GAMMA, BETA);
+  MACE_OP_OUTPUT_TAGS(OUTPUT);
+};
+
+void RegisterLayerNorm(OpRegistry *op_registry) {
+  MACE_REGISTER_OP(op_registry, "LayerNorm", LayerNormOp,
+                   RuntimeType::RT_CPU, float);
+  MACE_REGISTER_BF16_OP(op_registry, "LayerNorm", LayerNormOp,
+                        RuntimeType::RT_CPU);
+}
+
+}  // namespace ops
+}  // namespace mace
@@ -86,6 +86,9 @@ class LpNormOp<RuntimeType::RT_CPU, T> : public Operation {
     auto *runtime = context->runtime();
     MemInfo mem_info(input->memory_type(), DataType::DT_FLOAT, {outer_loop});
     auto norm_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
+    if (norm_buffer->memory<void>() == nullptr) {
+      return MaceStatus::MACE_OUT_OF_RESOURCES;
+    }
     float *norm_ptr = norm_buffer->mutable_data<float>();
     thread_pool.Compute1D([=](index_t start, index_t end, index_t step) {
       for (index_t i = start; i < end; i += step) {
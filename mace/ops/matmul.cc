@@ -22,6 +22,7 @@
 #include "mace/core/ops/operator.h"
 #include "mace/core/registry/ops_registry.h"
 #include "mace/core/tensor.h"
+#include "mace/ops/delegator/batched_gemm.h"
 #include "mace/ops/delegator/gemm.h"
 #include "mace/ops/delegator/gemv.h"
 #include "mace/utils/math.h"
@@ -102,6 +103,11 @@ class MatMulOp<RT_CPU, T> : public MatMulOpBase {
             context->workspace(),
             MACE_DELEGATOR_KEY(Gemm, RuntimeType::RT_CPU, T, kCpuImplType),
             delegator::GemmParam())),
+        batched_gemm_(delegator::BatchedGemm::Create(
+            context->workspace(),
+            MACE_DELEGATOR_KEY(BatchedGemm, RuntimeType::RT_CPU, T,
+                               kCpuImplType),
+            DelegatorParam())),
         gemv_(delegator::Gemv::Create(
             context->workspace(),
             MACE_DELEGATOR_KEY(Gemv, RuntimeType::RT_CPU, T, kCpuImplType),
@@ -178,20 +184,38 @@ class MatMulOp<RT_CPU, T> : public MatMulOpBase {
                             rhs_batched,
                             C);
     } else {
-      MaceStatus ret = gemm_->Compute(context,
-                                      lhs,
-                                      rhs,
-                                      batch,
-                                      lhs_rows,
-                                      lhs_cols,
-                                      rhs_rows,
-                                      rhs_cols,
-                                      transpose_a_,
-                                      transpose_b_,
-                                      false,
-                                      lhs_batched,
-                                      rhs_batched,
-                                      C);
+      MaceStatus ret = MaceStatus::MACE_SUCCESS;
+      if (batch > 1) {
+        // pack and dispatch the whole batch at once
+        ret = batched_gemm_->Compute(context,
+                                     lhs,
+                                     rhs,
+                                     batch,
+                                     rows,
+                                     cols,
+                                     depth,
+                                     transpose_a_ ? ColMajor : RowMajor,
+                                     transpose_b_ ? ColMajor : RowMajor,
+                                     RowMajor,
+                                     lhs_batched ? rows * depth : 0,
+                                     rhs_batched ? depth * cols : 0,
+                                     C);
+      } else {
+        ret = gemm_->Compute(context,
+                             lhs,
+                             rhs,
+                             batch,
+                             lhs_rows,
+                             lhs_cols,
+                             rhs_rows,
+                             rhs_cols,
+                             transpose_a_,
+                             transpose_b_,
+                             false,
+                             lhs_batched,
+                             rhs_batched,
+                             C);
+      }
       if (bias != nullptr) {
         MACE_CHECK(bias->dim_size() == 1 && bias->dim(0) == cols,
                    "bias' dim should be <= 2.");
@@ -216,6 +240,7 @@ class MatMulOp<RT_CPU, T> : public MatMulOpBase {
 
  private:
   std::unique_ptr<delegator::Gemm> gemm_;
+  std::unique_ptr<delegator::BatchedGemm> batched_gemm_;
   std::unique_ptr<delegator::Gemv> gemv_;
 };
 
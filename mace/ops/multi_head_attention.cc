@@ -0,0 +1,238 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "mace/core/ops/operator.h"
+#include "mace/core/registry/ops_registry.h"
+
+namespace mace {
+namespace ops {
+
+namespace {
+// Query rows and key rows processed per tile. With head_dim = 64 the
+// working set of a tile (Q, K and V blocks, scores and the accumulator)
+// stays below 64KB so it can live in L1/L2 during the whole key sweep.
+constexpr index_t kBlockQ = 32;
+constexpr index_t kBlockK = 64;
+}  // namespace
+
+// Fused scaled dot-product attention:
+//   output = softmax(scale * Q * K^T + mask) * V
+// Q: [batch, heads, seq_q, head_dim]
+// K: [batch, heads, seq_k, head_dim]
+// V: [batch, heads, seq_k, head_dim]
+// mask (optional, additive): [seq_q, seq_k] or [mb, mh, mq, seq_k] where
+//   mb, mh and mq are either 1 or batch, heads and seq_q respectively.
+// causal: query row i only attends to key rows <= i.
+// The score matrix is never materialized: key blocks are swept with an
+// online softmax (running max and running sum per query row) so that only
+// a [kBlockQ, kBlockK] tile of scores is alive at any time.
+template<RuntimeType D, class T>
+class MultiHeadAttentionOp;
+
+template<class T>
+class MultiHeadAttentionOp<RuntimeType::RT_CPU, T> : public Operation {
+ public:
+  explicit MultiHeadAttentionOp(OpConstructContext *context)
+      : Operation(context),
+        scale_(Operation::GetOptionalArg<float>("scale", 0.f)),
+        causal_(Operation::GetOptionalArg<bool>("causal", false)) {}
+
+  MaceStatus Run(OpContext *context) override {
+    const Tensor *query = this->Input(QUERY);
+    const Tensor *key = this->Input(KEY);
+    const Tensor *value = this->Input(VALUE);
+    const Tensor *mask = this->InputSize() > MASK ? this->Input(MASK) : nullptr;
+    Tensor *output = this->Output(OUTPUT);
+
+    MACE_CHECK(query->dim_size() == 4 && key->dim_size() == 4 &&
+        value->dim_size() == 4, "MultiHeadAttention only supports 4D inputs");
+    const index_t batch = query->dim(0);
+    const index_t heads = query->dim(1);
+    const index_t seq_q = query->dim(2);
+    const index_t head_dim = query->dim(3);
+    const index_t seq_k = key->dim(2);
+    MACE_CHECK(key->dim(0) == batch && key->dim(1) == heads &&
+        key->dim(3) == head_dim, "query and key shapes mismatch");
+    MACE_CHECK(value->dim(0) == batch && value->dim(1) == heads &&
+        value->dim(2) == seq_k && value->dim(3) == head_dim,
+               "key and value shapes mismatch");
+
+    index_t mask_batch_stride = 0;
+    index_t mask_head_stride = 0;
+    index_t mask_row_stride = 0;
+    if (mask != nullptr) {
+      const index_t mask_rank = mask->dim_size();
+      MACE_CHECK(mask_rank == 2 || mask_rank == 4,
+                 "mask should be 2D or 4D, but got ", mask_rank);
+      MACE_CHECK(mask->dim(mask_rank - 1) == seq_k, "mask last dim ",
+                 mask->dim(mask_rank - 1), " should be ", seq_k);
+      const index_t mask_q = mask->dim(mask_rank - 2);
+      MACE_CHECK(mask_q == 1 || mask_q == seq_q, "invalid mask rows");
+      mask_row_stride = mask_q == 1 ? 0 : seq_k;
+      if (mask_rank == 4) {
+        const index_t mask_b = mask->dim(0);
+        const index_t mask_h = mask->dim(1);
+        MACE_CHECK((mask_b == 1 || mask_b == batch) &&
+            (mask_h == 1 || mask_h == heads), "mask can not be broadcast");
+        mask_head_stride = mask_h == 1 ? 0 : mask_q * seq_k;
+        mask_batch_stride = mask_b == 1 ? 0 : mask_h * mask_q * seq_k;
+      }
+    }
+
+    MACE_RETURN_IF_ERROR(output->ResizeLike(query));
+
+    const float scale = scale_ != 0.f ?
+                        scale_ : 1.f / std::sqrt(static_cast<float>(head_dim));
+    const bool causal = causal_;
+    const T *q_data = query->data<T>();
+    const T *k_data = key->data<T>();
+    const T *v_data = value->data<T>();
+    const T *mask_data = mask == nullptr ? nullptr : mask->data<T>();
+    T *out_data = output->mutable_data<T>();
+
+    const index_t q_head_size = seq_q * head_dim;
+    const index_t kv_head_size = seq_k * head_dim;
+
+    utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+    thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                              index_t start1, index_t end1, index_t step1) {
+      std::vector<float> scores(kBlockQ * kBlockK);
+      std::vector<float> acc(kBlockQ * head_dim);
+      std::vector<float> row_max(kBlockQ);
+      std::vector<float> row_sum(kBlockQ);
+      float *s_ptr = scores.data();
+      float *acc_ptr = acc.data();
+      float *m_ptr = row_max.data();
+      float *l_ptr = row_sum.data();
+
+      for (index_t bh = start0; bh < end0; bh += step0) {
+        const index_t b = bh / heads;
+        const index_t h = bh % heads;
+        const T *q_head = q_data + bh * q_head_size;
+        const T *k_head = k_data + bh * kv_head_size;
+        const T *v_head = v_data + bh * kv_head_size;
+        T *out_head = out_data + bh * q_head_size;
+        const T *mask_head = mask_data == nullptr ? nullptr :
+            mask_data + b * mask_batch_stride + h * mask_head_stride;
+
+        for (index_t q0 = start1; q0 < end1; q0 += step1) {
+          const index_t q_len = std::min(kBlockQ, seq_q - q0);
+          std::fill_n(acc_ptr, q_len * head_dim, 0.f);
+          std::fill_n(m_ptr, q_len, std::numeric_limits<float>::lowest());
+          std::fill_n(l_ptr, q_len, 0.f);
+          const index_t k_end = causal ? std::min(seq_k, q0 + q_len) : seq_k;
+
+          for (index_t k0 = 0; k0 < k_end; k0 += kBlockK) {
+            const index_t k_len = std::min(kBlockK, k_end - k0);
+
+            // S = scale * Q_blk * K_blk^T + mask
+            for (index_t i = 0; i < q_len; ++i) {
+              const T *q_row = q_head + (q0 + i) * head_dim;
+              float *s_row = s_ptr + i * kBlockK;
+              for (index_t j = 0; j < k_len; ++j) {
+                const T *k_row = k_head + (k0 + j) * head_dim;
+                float dot = 0.f;
+                for (index_t d = 0; d < head_dim; ++d) {
+                  dot += static_cast<float>(q_row[d]) *
+                      static_cast<float>(k_row[d]);
+                }
+                s_row[j] = dot * scale;
+              }
+              if (mask_head != nullptr) {
+                const T *mask_row = mask_head + (q0 + i) * mask_row_stride + k0;
+                for (index_t j = 0; j < k_len; ++j) {
+                  s_row[j] += static_cast<float>(mask_row[j]);
+                }
+              }
+              if (causal) {
+                for (index_t j = std::max<index_t>(q0 + i + 1 - k0, 0);
+                     j < k_len; ++j) {
+                  s_row[j] = std::numeric_limits<float>::lowest();
+                }
+              }
+            }
+
+            // online softmax, then acc = acc * correction + P * V_blk
+            for (index_t i = 0; i < q_len; ++i) {
+              float *s_row = s_ptr + i * kBlockK;
+              float block_max = *std::max_element(s_row, s_row + k_len);
+              // keys all masked with -inf add nothing, and would turn the
+              // running max into -inf and the exponents into NaN
+              if (block_max == -std::numeric_limits<float>::infinity()) {
+                continue;
+              }
+              const float new_max = std::max(m_ptr[i], block_max);
+              const float correction = std::exp(m_ptr[i] - new_max);
+              float block_sum = 0.f;
+              for (index_t j = 0; j < k_len; ++j) {
+                s_row[j] = std::exp(s_row[j] - new_max);
+                block_sum += s_row[j];
+              }
+              l_ptr[i] = l_ptr[i] * correction + block_sum;
+              m_ptr[i] = new_max;
+
+              float *acc_row = acc_ptr + i * head_dim;
+              if (correction != 1.f) {
+                for (index_t d = 0; d < head_dim; ++d) {
+                  acc_row[d] *= correction;
+                }
+              }
+              for (index_t j = 0; j < k_len; ++j) {
+                const float p = s_row[j];
+                const T *v_row = v_head + (k0 + j) * head_dim;
+                for (index_t d = 0; d < head_dim; ++d) {
+                  acc_row[d] += p * static_cast<float>(v_row[d]);
+                }
+              }
+            }
+          }  // k0
+
+          for (index_t i = 0; i < q_len; ++i) {
+            // a row with every key masked outputs zeros
+            const float inv_sum = l_ptr[i] > 0.f ? 1.f / l_ptr[i] : 0.f;
+            const float *acc_row = acc_ptr + i * head_dim;
+            T *out_row = out_head + (q0 + i) * head_dim;
+            for (index_t d = 0; d < head_dim; ++d) {
+              out_row[d] = acc_row[d] * inv_sum;
+            }
+          }
+        }  // q0
+      }  // bh
+    }, 0, batch * heads, 1, 0, seq_q, kBlockQ);
+
+    return MaceStatus::MACE_SUCCESS;
+  }
+
+ private:
+  float scale_;
+  bool causal_;
+
+  MACE_OP_INPUT_TAGS(QUERY, KEY, VALUE, MASK);
+  MACE_OP_OUTPUT_TAGS(OUTPUT);
+};
+
+void RegisterMultiHeadAttention(OpRegistry *op_registry) {
+  MACE_REGISTER_OP(op_registry, "MultiHeadAttention", MultiHeadAttentionOp,
+                   RuntimeType::RT_CPU, float);
+  MACE_REGISTER_BF16_OP(op_registry, "MultiHeadAttention",
+                        MultiHeadAttentionOp, RuntimeType::RT_CPU);
+}
+
+}  // namespace ops
+}  // namespace mace
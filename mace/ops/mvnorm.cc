@@ -13,11 +13,13 @@
 // limitations under the License.
 
 
+#include <cmath>
 #include <functional>
 #include <memory>
 
 #include "mace/core/ops/operator.h"
 #include "mace/core/registry/ops_registry.h"
+#include "mace/ops/common/normalization.h"
 
 #ifdef MACE_ENABLE_OPENCL
 #include "mace/ops/opencl/image/mvnorm.h"
@@ -42,7 +44,6 @@ class MVNormOp<RuntimeType::RT_CPU, T> : public Operation {
         eps_(Operation::GetOptionalArg<float>("epsilon", 1e-9)) {}
 
   MaceStatus Run(OpContext *context) override {
-    MACE_UNUSED(context);
     const Tensor *input = this->Input(0);
     Tensor *output = this->Output(0);
     MACE_CHECK(input->data_format() == DataFormat::NCHW,
@@ -59,68 +60,15 @@ class MVNormOp<RuntimeType::RT_CPU, T> : public Operation {
     const auto inner_loop = input_size / outer_loop;
     utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
 
-    auto *runtime = context->runtime();
-    MemInfo mem_info(input->memory_type(), DataType::DT_FLOAT, {outer_loop});
-    auto mean_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
-    auto *mean_ptr = mean_buffer->mutable_data<float>();
-
-    // compute EX
-    thread_pool.Compute1D([=](index_t start, index_t end, index_t step) {
-      for (index_t i = start; i < end; i += step) {
-        const auto offset = inner_loop * i;
-        mean_ptr[i] = std::accumulate(input_data + offset,
-                                      input_data + offset + inner_loop,
-                                      static_cast<T>(0.0f));
-        mean_ptr[i] /= inner_loop;
-      }
-    }, 0, outer_loop, 1);
-
-    // compute (X - EX)
-    thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
-                              index_t start1, index_t end1, index_t step1) {
-      for (index_t i = start0; i < end0; i += step0) {
-        const auto offset = i * inner_loop;
-        for (index_t j = start1; j < end1; j += step1) {
-          output_data[offset + j] = input_data[offset + j] - mean_ptr[i];
-        }
-      }
-    }, 0, outer_loop, 1, 0, inner_loop, 1);
-
-    if (normalize_variance_) {
-      // compute (X - EX)^2
-      thread_pool.Compute1D([=](index_t start, index_t end, index_t step) {
-        for (index_t i = start; i < end; i += step) {
-          output_data[i] = output_data[i] * output_data[i];
-        }
-      }, 0, input_size, 1);
-
-      auto *runtime = context->runtime();
-      MemInfo mem_info(input->memory_type(), DataType::DT_FLOAT, {outer_loop});
-      auto mean_v_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
-      float *mean_v_ptr = mean_v_buffer->mutable_data<float>();
-      // compute E((X - EX)^2)^0.5 + eps_
-      thread_pool.Compute1D([=](index_t start, index_t end, index_t step) {
-        for (index_t i = start; i < end; i += step) {
-          auto output_data_base = output_data + inner_loop * i;
-          mean_v_ptr[i] = std::accumulate(output_data_base,
-                                          output_data_base + inner_loop,
-                                          static_cast<T>(0.0f));
-          mean_v_ptr[i] = std::pow(mean_v_ptr[i] / inner_loop, 0.5f) + eps_;
-        }
-      }, 0, outer_loop, 1);
-
-      // compute (X - EX) / (E((X - EX)^2)^0.5 + eps_)
-      thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
-                                index_t start1, index_t end1, index_t step1) {
-        for (index_t i = start0; i < end0; i += step0) {
-          const auto offset = i * inner_loop;
-          for (index_t j = start1; j < end1; j += step1) {
-            output_data[offset + j] =
-                (input_data[offset + j] - mean_ptr[i]) / mean_v_ptr[i];
-          }
-        }
-      }, 0, outer_loop, 1, 0, inner_loop, 1);
-    }
+    // (X - EX) / (E((X - EX)^2)^0.5 + eps_), or X - EX without
+    // normalize_variance
+    const bool normalize_variance = normalize_variance_;
+    const float eps = eps_;
+    common::normalization::NormalizeRows(
+        &thread_pool, input_data, outer_loop, inner_loop,
+        [normalize_variance, eps](float variance) -> float {
+          return normalize_variance ? 1.f / (std::sqrt(variance) + eps) : 1.f;
+        }, nullptr, nullptr, output_data);
 
     return MaceStatus::MACE_SUCCESS;
   }
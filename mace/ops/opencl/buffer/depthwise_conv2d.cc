@@ -219,7 +219,8 @@ MaceStatus DepthwiseConv2dKernel::Compute(
     auto *runtime = context->runtime();
     padded_input.reset(new Tensor(
         runtime, input->dtype(), output->memory_type(), {padded_input_size}));
-    runtime->AllocateBufferForTensor(padded_input.get(), RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(padded_input.get(), RENT_SCRATCH));
     padded_input->Resize(padded_input_shape);
     PadInput(context, &kernels_[0], input, pad_top, pad_left,
              input_changed, padded_input.get(), &pad_future);
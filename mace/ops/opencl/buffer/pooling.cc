@@ -80,7 +80,8 @@ MaceStatus PoolingKernel::Compute(
     auto *runtime = context->runtime();
     padded_input.reset(new Tensor(
         runtime, input->dtype(), output->memory_type(), {padded_input_size}));
-    runtime->AllocateBufferForTensor(padded_input.get(), RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(padded_input.get(), RENT_SCRATCH));
 
     padded_input->Resize(padded_input_shape);
     PadInput(context, &kernels_[0], input, 0, 0,
@@ -95,10 +95,16 @@ MaceStatus MVNormKernel::DoCompute(
   MemInfo mem_info(input->memory_type(), input->dtype(),
                    MemInfo::IndexT(mean_image_shape));
   auto mace_mean_img_buf = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
+  if (mace_mean_img_buf->memory<void>() == nullptr) {
+    return MaceStatus::MACE_OUT_OF_RESOURCES;
+  }
   cl::Image *mean_image = mace_mean_img_buf->mutable_memory<cl::Image>();
 
   if (normalize_variance_) {
     auto mace_mean_sqr_buf = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
+    if (mace_mean_sqr_buf->memory<void>() == nullptr) {
+      return MaceStatus::MACE_OUT_OF_RESOURCES;
+    }
     cl::Image *mean_image_sqr = mace_mean_sqr_buf->mutable_memory<cl::Image>();
     // compute the EX
     MACE_RETURN_IF_ERROR(ExecuteMeanValueKernel(
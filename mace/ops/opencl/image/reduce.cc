@@ -28,6 +28,7 @@ namespace image {
 namespace {
 const index_t TILE_SIZE = 16;
 
+// Returns nullptr if the memory budget refuses the image.
 cl::Image *GetScratchImage(OpContext *context, MemoryType mem_type,
                            DataType dtype, const std::vector<index_t> &shape) {
   std::vector<size_t> image_shape;
@@ -132,6 +133,9 @@ MaceStatus ReduceKernel::Compute(
         {{batch, out_height, out_width, channels}};
     cl::Image *inter_image = GetScratchImage(context, input->memory_type(),
                                              input->dtype(), inter_shape);
+    if (inter_image == nullptr) {
+      return MaceStatus::MACE_OUT_OF_RESOURCES;
+    }
 
     result = GraduallyComputeReduce(context, batch, channel_blocks, in_height,
                                     in_width, out_height, out_width,
@@ -149,6 +153,9 @@ MaceStatus ReduceKernel::Compute(
           {{batch, out_height, out_width, channels}};
       cl::Image *inter2_image = GetScratchImage(context, input->memory_type(),
                                                 input->dtype(), inter2_shape);
+      if (inter2_image == nullptr) {
+        return MaceStatus::MACE_OUT_OF_RESOURCES;
+      }
 
       while (out_height > 1 || out_width > 1) {
         result = GraduallyComputeReduce(context, batch, channel_blocks,
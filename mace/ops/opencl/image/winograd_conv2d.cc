@@ -270,7 +270,8 @@ extern MaceStatus WinogradConv2dK3x3S1(OpContext *context,
       make_unique<Tensor>(runtime, input->dtype(), input->memory_type(),
                           t_input_shape, false, "",
                           BufferContentType::IN_OUT_HEIGHT);
-  runtime->AllocateBufferForTensor(transformed_input.get(), RENT_SCRATCH);
+  MACE_RETURN_IF_ERROR(
+      runtime->AllocateBufferForTensor(transformed_input.get(), RENT_SCRATCH));
 
   MACE_RETURN_IF_ERROR(WinogradInputTransform(
       context, kernels[0], input, paddings,
@@ -286,7 +287,8 @@ extern MaceStatus WinogradConv2dK3x3S1(OpContext *context,
   std::unique_ptr<Tensor> mm_output = make_unique<Tensor>(
       runtime, input->dtype(), input->memory_type(), mm_output_shape,
       false, "", BufferContentType::IN_OUT_HEIGHT);
-  runtime->AllocateBufferForTensor(mm_output.get(), RENT_SCRATCH);
+  MACE_RETURN_IF_ERROR(
+      runtime->AllocateBufferForTensor(mm_output.get(), RENT_SCRATCH));
 
   const index_t height_blocks = RoundUpDiv4(mm_output_shape[1]);
   const index_t width_blocks = RoundUpDiv4(mm_output_shape[2]);
@@ -0,0 +1,146 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/ops/common/x86_gemm.h"
+#include "mace/ops/delegator/batched_gemm.h"
+
+namespace mace {
+namespace ops {
+namespace ref {
+
+namespace {
+// Computes the batch with the x86 vector kernels, returns false if there are
+// none for T and the cpu.
+template<typename T>
+bool ComputeWithX86Kernels(const OpContext *, const Tensor *, const Tensor *,
+                           const index_t, const index_t, const index_t,
+                           const index_t, const MatrixMajor, const MatrixMajor,
+                           const MatrixMajor, const index_t, const index_t,
+                           Tensor *) {
+  return false;
+}
+
+template<>
+bool ComputeWithX86Kernels<float>(const OpContext *context,
+                                  const Tensor *lhs,
+                                  const Tensor *rhs,
+                                  const index_t batch,
+                                  const index_t rows,
+                                  const index_t cols,
+                                  const index_t depth,
+                                  const MatrixMajor lhs_major,
+                                  const MatrixMajor rhs_major,
+                                  const MatrixMajor output_major,
+                                  const index_t lhs_batch_stride,
+                                  const index_t rhs_batch_stride,
+                                  Tensor *output) {
+  return x86::ComputeGemm(context, lhs, rhs, batch, rows, cols, depth,
+                          lhs_major, rhs_major, output_major,
+                          lhs_batch_stride, rhs_batch_stride, output);
+}
+}  // namespace
+
+template<typename T>
+class BatchedGemm : public delegator::BatchedGemm {
+ public:
+  explicit BatchedGemm(const DelegatorParam &param)
+      : delegator::BatchedGemm(param) {}
+  ~BatchedGemm() {}
+
+  MaceStatus Compute(const OpContext *context,
+                     const Tensor *lhs,
+                     const Tensor *rhs,
+                     const index_t batch,
+                     const index_t rows,
+                     const index_t cols,
+                     const index_t depth,
+                     const MatrixMajor lhs_major,
+                     const MatrixMajor rhs_major,
+                     const MatrixMajor output_major,
+                     const index_t lhs_batch_stride,
+                     const index_t rhs_batch_stride,
+                     Tensor *output) override;
+};
+
+template<typename T>
+MaceStatus BatchedGemm<T>::Compute(const OpContext *context,
+                                   const Tensor *lhs,
+                                   const Tensor *rhs,
+                                   const index_t batch,
+                                   const index_t rows,
+                                   const index_t cols,
+                                   const index_t depth,
+                                   const MatrixMajor lhs_major,
+                                   const MatrixMajor rhs_major,
+                                   const MatrixMajor output_major,
+                                   const index_t lhs_batch_stride,
+                                   const index_t rhs_batch_stride,
+                                   Tensor *output) {
+  MACE_CHECK(output->size() == batch * rows * cols,
+             "Need resize output tensor before call gemm.");
+  if (ComputeWithX86Kernels<T>(context, lhs, rhs, batch, rows, cols, depth,
+                               lhs_major, rhs_major, output_major,
+                               lhs_batch_stride, rhs_batch_stride, output)) {
+    return MaceStatus::MACE_SUCCESS;
+  }
+
+  const T *lhs_data = lhs->data<T>();
+  const T *rhs_data = rhs->data<T>();
+  T *output_data = output->mutable_data<T>();
+
+  utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+  thread_pool.Compute3D([=](index_t start0, index_t end0, index_t step0,
+                            index_t start1, index_t end1, index_t step1,
+                            index_t start2, index_t end2, index_t step2) {
+    for (index_t b = start0; b < end0; b += step0) {
+      MatrixMap<const T> lhs_matrix(lhs_data + b * lhs_batch_stride,
+                                    lhs_major, rows, depth);
+      MatrixMap<const T> rhs_matrix(rhs_data + b * rhs_batch_stride,
+                                    rhs_major, depth, cols);
+      MatrixMap<T> output_matrix(output_data + b * rows * cols,
+                                 output_major, rows, cols);
+      for (index_t r = start1; r < end1; r += step1) {
+        for (index_t c = start2; c < end2; c += step2) {
+          float sum = 0;
+          for (index_t d = 0; d < depth; ++d) {
+            sum += static_cast<float>(lhs_matrix(r, d)) *
+                static_cast<float>(rhs_matrix(d, c));
+          }  // d
+          *output_matrix.data(r, c) = sum;
+        }  // c
+      }  // r
+    }  // b
+  }, 0, batch, 1, 0, rows, 1, 0, cols, 1);
+
+  return MaceStatus::MACE_SUCCESS;
+}
+
+void RegisterBatchedGemmDelegator(OpDelegatorRegistry *registry) {
+  MACE_REGISTER_DELEGATOR(
+      registry, BatchedGemm<float>, DelegatorParam,
+      MACE_DELEGATOR_KEY(BatchedGemm, RuntimeType::RT_CPU, float,
+                         ImplType::REF));
+  MACE_REGISTER_BF16_DELEGATOR(
+      registry, BatchedGemm<BFloat16>, DelegatorParam,
+      MACE_DELEGATOR_KEY(BatchedGemm, RuntimeType::RT_CPU, BFloat16,
+                         ImplType::REF));
+  MACE_REGISTER_FP16_DELEGATOR(
+      registry, BatchedGemm<float16_t>, DelegatorParam,
+      MACE_DELEGATOR_KEY(BatchedGemm, RuntimeType::RT_CPU, float16_t,
+                         ImplType::REF));
+}
+
+}  // namespace ref
+}  // namespace ops
+}  // namespace mace
@@ -0,0 +1,491 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "mace/ops/delegator/conv_2d.h"
+#include "mace/ops/delegator/gemm.h"
+#include "mace/utils/math.h"
+
+namespace mace {
+namespace ops {
+namespace ref {
+
+namespace {
+
+// Y = A^T [(G g G^T) * (B^T d B)] A of F(m x m, 3 x 3), with the tile
+// d of (m + 2) x (m + 2) inputs and the 3 x 3 filter g.
+struct WinogradMatrices {
+  int out_tile_size;
+  int in_tile_size;
+  const float *bt;  // in_tile_size x in_tile_size
+  const float *g;   // in_tile_size x 3
+  const float *at;  // out_tile_size x in_tile_size
+};
+
+const float kBt2[] = {
+    1, 0, -1, 0,
+    0, 1, 1, 0,
+    0, -1, 1, 0,
+    0, 1, 0, -1,
+};
+const float kG2[] = {
+    1, 0, 0,
+    0.5f, 0.5f, 0.5f,
+    0.5f, -0.5f, 0.5f,
+    0, 0, 1,
+};
+const float kAt2[] = {
+    1, 1, 1, 0,
+    0, 1, -1, -1,
+};
+
+const float kBt4[] = {
+    4, 0, -5, 0, 1, 0,
+    0, -4, -4, 1, 1, 0,
+    0, 4, -4, -1, 1, 0,
+    0, -2, -1, 2, 1, 0,
+    0, 2, -1, -2, 1, 0,
+    0, 4, 0, -5, 0, 1,
+};
+const float kG4[] = {
+    1.f / 4, 0, 0,
+    -1.f / 6, -1.f / 6, -1.f / 6,
+    -1.f / 6, 1.f / 6, -1.f / 6,
+    1.f / 24, 1.f / 12, 1.f / 6,
+    1.f / 24, -1.f / 12, 1.f / 6,
+    0, 0, 1,
+};
+const float kAt4[] = {
+    1, 1, 1, 1, 1, 0,
+    0, 1, -1, 2, -2, 0,
+    0, 1, 1, 4, 4, 0,
+    0, 1, -1, 8, -8, 1,
+};
+
+const float kBt6[] = {
+    1, 0, -5.25f, 0, 5.25f, 0, -1, 0,
+    0, 1, 1, -4.25f, -4.25f, 1, 1, 0,
+    0, -1, 1, 4.25f, -4.25f, -1, 1, 0,
+    0, 0.5f, 0.25f, -2.5f, -1.25f, 2, 1, 0,
+    0, -0.5f, 0.25f, 2.5f, -1.25f, -2, 1, 0,
+    0, 2, 4, -2.5f, -5, 0.5f, 1, 0,
+    0, -2, 4, 2.5f, -5, -0.5f, 1, 0,
+    0, -1, 0, 5.25f, 0, -5.25f, 0, 1,
+};
+const float kG6[] = {
+    1, 0, 0,
+    -2.f / 9, -2.f / 9, -2.f / 9,
+    -2.f / 9, 2.f / 9, -2.f / 9,
+    1.f / 90, 1.f / 45, 2.f / 45,
+    1.f / 90, -1.f / 45, 2.f / 45,
+    1.f / 45, 1.f / 90, 1.f / 180,
+    1.f / 45, -1.f / 90, 1.f / 180,
+    0, 0, 1,
+};
+const float kAt6[] = {
+    1, 1, 1, 1, 1, 32, 32, 0,
+    0, 1, -1, 2, -2, 16, -16, 0,
+    0, 1, 1, 4, 4, 8, 8, 0,
+    0, 1, -1, 8, -8, 4, -4, 0,
+    0, 1, 1, 16, 16, 2, 2, 0,
+    0, 1, -1, 32, -32, 1, -1, 1,
+};
+
+const WinogradMatrices kWinograd2 = {2, 4, kBt2, kG2, kAt2};
+const WinogradMatrices kWinograd4 = {4, 6, kBt4, kG4, kAt4};
+const WinogradMatrices kWinograd6 = {6, 8, kBt6, kG6, kAt6};
+
+const int kMaxInTileSize = 8;
+
+// out = lhs * rhs^T, with lhs of rows x depth and rhs of cols x depth
+void MultiplyTransposed(const float *lhs, const float *rhs, const int rows,
+                        const int cols, const int depth, float *out) {
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      float sum = 0;
+      for (int k = 0; k < depth; ++k) {
+        sum += lhs[i * depth + k] * rhs[j * depth + k];
+      }
+      out[i * cols + j] = sum;
+    }
+  }
+}
+
+// out = lhs * rhs, with lhs of rows x depth and rhs of depth x cols
+void Multiply(const float *lhs, const float *rhs, const int rows,
+              const int cols, const int depth, float *out) {
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      float sum = 0;
+      for (int k = 0; k < depth; ++k) {
+        sum += lhs[i * depth + k] * rhs[k * cols + j];
+      }
+      out[i * cols + j] = sum;
+    }
+  }
+}
+
+}  // namespace
+
+// Portable Winograd convolution for 3x3 filters of stride 1, which runs on
+// any cpu and data type. The transforms are done in float, the products of
+// all tile positions are one batched gemm, and the transformed tensors are
+// stored in T.
+template<typename T>
+class Conv2dK3x3Winograd : public delegator::Conv2d {
+ public:
+  explicit Conv2dK3x3Winograd(const delegator::Conv2dParam &param)
+      : delegator::Conv2d(param),
+        transformed_filter_(nullptr),
+        out_tile_size_(0) {}
+  ~Conv2dK3x3Winograd() {}
+
+  MaceStatus Compute(
+      const OpContext *context,
+      const Tensor *input,
+      const Tensor *filter,
+      Tensor *output) override;
+
+ private:
+  // OIHW => TOI, with T the in_tile_size^2 tile positions
+  void TransformFilter(const OpContext *context,
+                       const WinogradMatrices &matrices,
+                       const T *filter,
+                       const index_t out_channels,
+                       const index_t in_channels,
+                       T *output);
+
+  // NCHW => TC(NP), with P the tile count of an image
+  void TransformInput(const OpContext *context,
+                      const WinogradMatrices &matrices,
+                      const T *input,
+                      const index_t batch,
+                      const index_t in_channels,
+                      const index_t in_height,
+                      const index_t in_width,
+                      const index_t pad_top,
+                      const index_t pad_left,
+                      const index_t tile_height_count,
+                      const index_t tile_width_count,
+                      T *output);
+
+  // TO(NP) => NOHW
+  void TransformOutput(const OpContext *context,
+                       const WinogradMatrices &matrices,
+                       const T *input,
+                       const index_t batch,
+                       const index_t out_channels,
+                       const index_t out_height,
+                       const index_t out_width,
+                       const index_t tile_height_count,
+                       const index_t tile_width_count,
+                       T *output);
+
+  std::unique_ptr<delegator::Gemm> gemm_;
+  std::unique_ptr<Tensor> transformed_filter_;
+  index_t out_tile_size_;
+};
+
+template<typename T>
+MaceStatus Conv2dK3x3Winograd<T>::Compute(const OpContext *context,
+                                          const Tensor *input,
+                                          const Tensor *filter,
+                                          Tensor *output) {
+  const std::vector<index_t> in_shape = input->shape();
+  const std::vector<index_t> filter_shape = filter->shape();
+  MACE_CHECK(in_shape[1] == filter_shape[1]);
+  MACE_CHECK(filter_shape[2] == 3 && filter_shape[3] == 3 &&
+                 strides_[0] == 1 && strides_[1] == 1 &&
+                 dilations_[0] == 1 && dilations_[1] == 1,
+             "Winograd only supports 3x3 filters of stride 1 and dilation 1");
+  std::vector<index_t> out_shape(4);
+
+  std::vector<int> paddings(2);
+  if (paddings_.empty()) {
+    CalcNCHWPaddingAndOutputSize(input->shape().data(),
+                                 filter->shape().data(),
+                                 dilations_.data(),
+                                 strides_.data(),
+                                 padding_type_,
+                                 out_shape.data(),
+                                 paddings.data());
+  } else {
+    paddings = paddings_;
+    CalcNCHWOutputSize(input->shape().data(),
+                       filter->shape().data(),
+                       paddings_.data(),
+                       dilations_.data(),
+                       strides_.data(),
+                       RoundType::FLOOR,
+                       out_shape.data());
+  }
+  MACE_RETURN_IF_ERROR(output->Resize(out_shape));
+
+  const index_t batch = in_shape[0];
+  const index_t in_channels = in_shape[1];
+  const index_t out_channels = out_shape[1];
+  const index_t out_height = out_shape[2];
+  const index_t out_width = out_shape[3];
+
+  // Larger tiles take fewer multiplications but amplify rounding errors,
+  // which the storage of half types can not afford.
+  const WinogradMatrices *matrices = &kWinograd4;
+  if (out_height <= 8 && out_width <= 8) {
+    matrices = &kWinograd2;
+  } else if (sizeof(T) == sizeof(float) && out_height > 16 &&
+      out_width > 16) {
+    matrices = &kWinograd6;
+  }
+  const index_t out_tile_size = matrices->out_tile_size;
+  const index_t tile_area = matrices->in_tile_size * matrices->in_tile_size;
+  const index_t tile_height_count = RoundUpDiv(out_height, out_tile_size);
+  const index_t tile_width_count = RoundUpDiv(out_width, out_tile_size);
+  const index_t tile_count = batch * tile_height_count * tile_width_count;
+
+  Runtime *runtime = context->runtime();
+  const MemoryType mem_type = MemoryType::CPU_BUFFER;
+  if (!filter->is_weight() || out_tile_size != out_tile_size_) {
+    out_tile_size_ = out_tile_size;
+    if (transformed_filter_ != nullptr &&
+        transformed_filter_->memory<void>() != nullptr) {
+      // give the previous filter back to the pool for reuse
+      runtime->ReleaseBufferForTensor(transformed_filter_.get(), RENT_PRIVATE);
+    }
+    transformed_filter_.reset(new Tensor(
+        runtime, DataTypeToEnum<T>::v(), mem_type,
+        {tile_area, out_channels, in_channels}));
+    MACE_RETURN_IF_ERROR(runtime->AllocateBufferForTensor(
+        transformed_filter_.get(), RENT_PRIVATE));
+    TransformFilter(context, *matrices, filter->data<T>(), out_channels,
+                    in_channels, transformed_filter_->mutable_data<T>());
+  }
+
+  Tensor transformed_in(runtime, DataTypeToEnum<T>::v(), mem_type,
+                        {tile_area, in_channels, tile_count});
+  MACE_RETURN_IF_ERROR(
+      runtime->AllocateBufferForTensor(&transformed_in, RENT_SCRATCH));
+  Tensor transformed_out(runtime, DataTypeToEnum<T>::v(), mem_type,
+                         {tile_area, out_channels, tile_count});
+  MACE_RETURN_IF_ERROR(
+      runtime->AllocateBufferForTensor(&transformed_out, RENT_SCRATCH));
+
+  TransformInput(context, *matrices, input->data<T>(), batch, in_channels,
+                 in_shape[2], in_shape[3], paddings[0] >> 1, paddings[1] >> 1,
+                 tile_height_count, tile_width_count,
+                 transformed_in.mutable_data<T>());
+
+  if (gemm_ == nullptr) {
+    gemm_ = delegator::Gemm::Create(
+        context->workspace(),
+        MACE_DELEGATOR_KEY(Gemm, RuntimeType::RT_CPU, T, kCpuImplType),
+        delegator::GemmParam());
+  }
+  MACE_RETURN_IF_ERROR(gemm_->Compute(context,
+                                      transformed_filter_.get(),
+                                      &transformed_in,
+                                      tile_area,
+                                      out_channels,
+                                      tile_count,
+                                      in_channels,
+                                      MatrixMajor::RowMajor,
+                                      MatrixMajor::RowMajor,
+                                      MatrixMajor::RowMajor,
+                                      true,
+                                      true,
+                                      &transformed_out));
+
+  TransformOutput(context, *matrices, transformed_out.data<T>(), batch,
+                  out_channels, out_height, out_width, tile_height_count,
+                  tile_width_count, output->mutable_data<T>());
+
+  return MaceStatus::MACE_SUCCESS;
+}
+
+template<typename T>
+void Conv2dK3x3Winograd<T>::TransformFilter(const OpContext *context,
+                                            const WinogradMatrices &matrices,
+                                            const T *filter,
+                                            const index_t out_channels,
+                                            const index_t in_channels,
+                                            T *output) {
+  const int tile_size = matrices.in_tile_size;
+  const index_t stride = out_channels * in_channels;
+
+  utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+  thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                            index_t start1, index_t end1, index_t step1) {
+    float g[9];
+    float gg[kMaxInTileSize * 3];
+    float u[kMaxInTileSize * kMaxInTileSize];
+    for (index_t m = start0; m < end0; m += step0) {
+      for (index_t c = start1; c < end1; c += step1) {
+        const T *filter_ptr = filter + (m * in_channels + c) * 9;
+        for (int k = 0; k < 9; ++k) {
+          g[k] = static_cast<float>(filter_ptr[k]);
+        }
+        // G g G^T
+        Multiply(matrices.g, g, tile_size, 3, 3, gg);
+        MultiplyTransposed(gg, matrices.g, tile_size, tile_size, 3, u);
+        T *output_ptr = output + m * in_channels + c;
+        for (int t = 0; t < tile_size * tile_size; ++t) {
+          output_ptr[t * stride] = static_cast<T>(u[t]);
+        }
+      }  // c
+    }  // m
+  }, 0, out_channels, 1, 0, in_channels, 1);
+}
+
+template<typename T>
+void Conv2dK3x3Winograd<T>::TransformInput(const OpContext *context,
+                                           const WinogradMatrices &matrices,
+                                           const T *input,
+                                           const index_t batch,
+                                           const index_t in_channels,
+                                           const index_t in_height,
+                                           const index_t in_width,
+                                           const index_t pad_top,
+                                           const index_t pad_left,
+                                           const index_t tile_height_count,
+                                           const index_t tile_width_count,
+                                           T *output) {
+  const int tile_size = matrices.in_tile_size;
+  const int out_tile_size = matrices.out_tile_size;
+  const index_t image_tile_count = tile_height_count * tile_width_count;
+  const index_t tile_count = batch * image_tile_count;
+  const index_t stride = in_channels * tile_count;
+
+  utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+  thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                            index_t start1, index_t end1, index_t step1) {
+    float d[kMaxInTileSize * kMaxInTileSize];
+    float btd[kMaxInTileSize * kMaxInTileSize];
+    float v[kMaxInTileSize * kMaxInTileSize];
+    for (index_t bc = start0; bc < end0; bc += step0) {
+      const index_t b = bc / in_channels;
+      const index_t c = bc % in_channels;
+      const T *input_ptr = input + bc * in_height * in_width;
+      for (index_t th = start1; th < end1; th += step1) {
+        for (index_t tw = 0; tw < tile_width_count; ++tw) {
+          // the tile with the padding as zeros
+          const index_t h_begin = th * out_tile_size - pad_top;
+          const index_t w_begin = tw * out_tile_size - pad_left;
+          for (int i = 0; i < tile_size; ++i) {
+            const index_t h = h_begin + i;
+            for (int j = 0; j < tile_size; ++j) {
+              const index_t w = w_begin + j;
+              d[i * tile_size + j] =
+                  h >= 0 && h < in_height && w >= 0 && w < in_width ?
+                  static_cast<float>(input_ptr[h * in_width + w]) : 0.f;
+            }
+          }
+          // B^T d B
+          Multiply(matrices.bt, d, tile_size, tile_size, tile_size, btd);
+          MultiplyTransposed(btd, matrices.bt, tile_size, tile_size,
+                             tile_size, v);
+          T *output_ptr = output + c * tile_count + b * image_tile_count +
+              th * tile_width_count + tw;
+          for (int t = 0; t < tile_size * tile_size; ++t) {
+            output_ptr[t * stride] = static_cast<T>(v[t]);
+          }
+        }  // tw
+      }  // th
+    }  // bc
+  }, 0, batch * in_channels, 1, 0, tile_height_count, 1);
+}
+
+template<typename T>
+void Conv2dK3x3Winograd<T>::TransformOutput(const OpContext *context,
+                                            const WinogradMatrices &matrices,
+                                            const T *input,
+                                            const index_t batch,
+                                            const index_t out_channels,
+                                            const index_t out_height,
+                                            const index_t out_width,
+                                            const index_t tile_height_count,
+                                            const index_t tile_width_count,
+                                            T *output) {
+  const int tile_size = matrices.in_tile_size;
+  const int out_tile_size = matrices.out_tile_size;
+  const index_t image_tile_count = tile_height_count * tile_width_count;
+  const index_t tile_count = batch * image_tile_count;
+  const index_t stride = out_channels * tile_count;
+
+  utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+  thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                            index_t start1, index_t end1, index_t step1) {
+    float m[kMaxInTileSize * kMaxInTileSize];
+    float atm[kMaxInTileSize * kMaxInTileSize];
+    float y[kMaxInTileSize * kMaxInTileSize];
+    for (index_t bo = start0; bo < end0; bo += step0) {
+      const index_t b = bo / out_channels;
+      const index_t o = bo % out_channels;
+      T *output_ptr = output + bo * out_height * out_width;
+      for (index_t th = start1; th < end1; th += step1) {
+        for (index_t tw = 0; tw < tile_width_count; ++tw) {
+          const T *input_ptr = input + o * tile_count + b * image_tile_count +
+              th * tile_width_count + tw;
+          for (int t = 0; t < tile_size * tile_size; ++t) {
+            m[t] = static_cast<float>(input_ptr[t * stride]);
+          }
+          // A^T m A
+          Multiply(matrices.at, m, out_tile_size, tile_size, tile_size, atm);
+          MultiplyTransposed(atm, matrices.at, out_tile_size, out_tile_size,
+                             tile_size, y);
+          // the last tiles may stick out of the output
+          const index_t h_begin = th * out_tile_size;
+          const index_t w_begin = tw * out_tile_size;
+          const index_t h_count = std::min<index_t>(out_tile_size,
+                                                    out_height - h_begin);
+          const index_t w_count = std::min<index_t>(out_tile_size,
+                                                    out_width - w_begin);
+          for (index_t i = 0; i < h_count; ++i) {
+            for (index_t j = 0; j < w_count; ++j) {
+              output_ptr[(h_begin + i) * out_width + w_begin + j] =
+                  static_cast<T>(y[i * out_tile_size + j]);
+            }
+          }
+        }  // tw
+      }  // th
+    }  // bo
+  }, 0, batch * out_channels, 1, 0, tile_height_count, 1);
+}
+
+void RegisterConv2dK3x3WinogradDelegator(OpDelegatorRegistry *registry) {
+  MACE_REGISTER_DELEGATOR(
+      registry, Conv2dK3x3Winograd<float>, delegator::Conv2dParam,
+      MACE_DELEGATOR_KEY_EX(Conv2d, RuntimeType::RT_CPU,
+                            float, ImplType::REF, K3x3Winograd));
+  MACE_REGISTER_BF16_DELEGATOR(
+      registry, Conv2dK3x3Winograd<BFloat16>, delegator::Conv2dParam,
+      MACE_DELEGATOR_KEY_EX(Conv2d, RuntimeType::RT_CPU,
+                            BFloat16, ImplType::REF, K3x3Winograd));
+  MACE_REGISTER_FP16_DELEGATOR(
+      registry, Conv2dK3x3Winograd<float16_t>, delegator::Conv2dParam,
+      MACE_DELEGATOR_KEY_EX(Conv2d, RuntimeType::RT_CPU,
+                            float16_t, ImplType::REF, K3x3Winograd));
+#ifdef MACE_ENABLE_NEON
+  // NEON has a Winograd of its own for float and bfloat16 only
+  MACE_REGISTER_FP16_DELEGATOR(
+      registry, Conv2dK3x3Winograd<float16_t>, delegator::Conv2dParam,
+      MACE_DELEGATOR_KEY_EX(Conv2d, RuntimeType::RT_CPU,
+                            float16_t, ImplType::NEON, K3x3Winograd));
+#endif  // MACE_ENABLE_NEON
+}
+
+}  // namespace ref
+}  // namespace ops
+}  // namespace mace
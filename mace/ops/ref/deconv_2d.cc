@@ -82,7 +82,8 @@ MaceStatus Deconv2d<T>::Compute(const OpContext *context,
     padded_output = make_unique<Tensor>(
         runtime, DataTypeToEnum<T>::v(),
         output->memory_type(), padded_out_shape);
-    runtime->AllocateBufferForTensor(padded_output.get(), RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        runtime->AllocateBufferForTensor(padded_output.get(), RENT_SCRATCH));
   }
   Tensor *out_tensor = output;
   if (padded_output != nullptr) {
@@ -12,14 +12,42 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <vector>
 
+#include "mace/ops/common/x86_kernels.h"
 #include "mace/ops/delegator/depthwise_conv_2d.h"
+#include "mace/utils/math.h"
 
 namespace mace {
 namespace ops {
 namespace ref {
 
+namespace {
+
+// The x86 vector kernel of T, filter and stride, nullptr if there is none.
+template<typename T>
+x86::DepthwiseConv2dRowKernel GetRowKernel(const index_t *,
+                                           const std::vector<int> &,
+                                           const std::vector<int> &) {
+  return nullptr;
+}
+
+template<>
+x86::DepthwiseConv2dRowKernel GetRowKernel<float>(
+    const index_t *filter_shape,
+    const std::vector<int> &strides,
+    const std::vector<int> &dilations) {
+  if (dilations[0] != 1 || dilations[1] != 1) {
+    return nullptr;
+  }
+  return x86::GetDepthwiseConv2dRowKernel(
+      x86::DetectIsa(), static_cast<int>(filter_shape[2]),
+      static_cast<int>(filter_shape[3]), strides[1]);
+}
+
+}  // namespace
+
 template<typename T>
 class DepthwiseConv2d : public delegator::DepthwiseConv2d {
  public:
@@ -79,6 +107,16 @@ MaceStatus DepthwiseConv2d<T>::Compute(const OpContext *context,
   auto filter_data = filter->data<T>();
   auto output_data = output->mutable_data<T>();
 
+  // The row kernel takes the outputs in [w_begin, w_end) of the rows whose
+  // filter window is inside the input, the loops below do the rest.
+  const x86::DepthwiseConv2dRowKernel row_kernel =
+      GetRowKernel<T>(filter_shape.data(), strides_, dilations_);
+  const index_t w_begin = RoundUpDiv(pad_left,
+                                     static_cast<index_t>(strides_[1]));
+  const index_t last_w_space = in_shape[3] + pad_left - filter_shape[3];
+  const index_t w_end = last_w_space < 0 ? 0 :
+                        std::min(out_shape[3], last_w_space / strides_[1] + 1);
+
   for (index_t b = 0; b < in_shape[0]; b++) {
     for (index_t m = 0; m < out_shape[1]; ++m) {
       const index_t c = m / multiplier;
@@ -93,15 +131,33 @@ MaceStatus DepthwiseConv2d<T>::Compute(const OpContext *context,
       T *out_ptr_base =
           output_data + b * out_batch_size + m * out_image_size;
 
+      const T *in_ptr_base =
+          input_data + b * in_batch_size + c * in_image_size;
+      const T *filter_base =
+          filter_data + multi_index * in_channels * filter_size
+              + c * filter_size;
+
       for (index_t h = 0; h < out_height; ++h) {
+        const index_t ih_begin = -pad_top + h * strides_[0];
+        const bool row_inside = row_kernel != nullptr && ih_begin >= 0 &&
+            ih_begin + filter_shape[2] <= in_height;
         for (index_t w = 0; w < out_width; ++w) {
-          float sum = 0;
+          if (row_inside && w == w_begin && w_begin < w_end) {
+            // row_kernel is only there for float
+            row_kernel(reinterpret_cast<const float *>(
+                           in_ptr_base + ih_begin * in_width +
+                               w_begin * strides_[1] - pad_left),
+                       in_width,
+                       reinterpret_cast<const float *>(filter_base),
+                       w_end - w_begin,
+                       reinterpret_cast<float *>(
+                           out_ptr_base + h * out_width + w_begin));
+            w = w_end - 1;
+            continue;
+          }
 
-          const T *in_ptr_base =
-              input_data + b * in_batch_size + c * in_image_size;
-          const T *filter_ptr =
-              filter_data + multi_index * in_channels * filter_size
-                  + c * filter_size;
+          float sum = 0;
+          const T *filter_ptr = filter_base;
 
           for (index_t kh = 0; kh < filter_shape[2]; ++kh) {
             for (index_t kw = 0; kw < filter_shape[3]; ++kw) {
@@ -12,12 +12,53 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+
+#include "mace/ops/common/gemm_split.h"
+#include "mace/ops/common/x86_gemm.h"
 #include "mace/ops/delegator/gemm.h"
 
 namespace mace {
 namespace ops {
 namespace ref {
 
+namespace {
+// The shortest depth slice worth a partial output.
+const index_t kMinDepthSliceSize = 256;
+
+// Computes the gemm with the x86 vector kernels, returns false if there are
+// none for T and the cpu.
+template<typename T>
+bool ComputeWithX86Kernels(const OpContext *, const Tensor *, const Tensor *,
+                           const index_t, const index_t, const index_t,
+                           const index_t, const MatrixMajor, const MatrixMajor,
+                           const MatrixMajor, const bool, const bool,
+                           Tensor *) {
+  return false;
+}
+
+template<>
+bool ComputeWithX86Kernels<float>(const OpContext *context,
+                                  const Tensor *lhs,
+                                  const Tensor *rhs,
+                                  const index_t batch,
+                                  const index_t rows,
+                                  const index_t cols,
+                                  const index_t depth,
+                                  const MatrixMajor lhs_major,
+                                  const MatrixMajor rhs_major,
+                                  const MatrixMajor output_major,
+                                  const bool lhs_batched,
+                                  const bool rhs_batched,
+                                  Tensor *output) {
+  return x86::ComputeGemm(context, lhs, rhs, batch, rows, cols, depth,
+                          lhs_major, rhs_major, output_major,
+                          lhs_batched ? rows * depth : 0,
+                          rhs_batched ? depth * cols : 0, output);
+}
+
+}  // namespace
+
 template<typename T>
 class Gemm : public delegator::Gemm {
  public:
@@ -68,10 +109,33 @@ MaceStatus Gemm<T>::Compute(const OpContext *context,
                             const bool lhs_batched,
                             const bool rhs_batched,
                             Tensor *output) {
-  MACE_UNUSED(context);
+  utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+  const index_t output_size = rows * cols;
+  index_t slice_count = GemmDepthSliceCount(
+      output_size, depth, kMinDepthSliceSize, thread_pool.thread_count());
+  if (slice_count == 1 &&
+      ComputeWithX86Kernels<T>(context, lhs, rhs, batch, rows, cols, depth,
+                               lhs_major, rhs_major, output_major,
+                               lhs_batched, rhs_batched, output)) {
+    return MaceStatus::MACE_SUCCESS;
+  }
+
   const T *lhs_data = lhs->data<T>();
   const T *rhs_data = rhs->data<T>();
   T *output_data = output->mutable_data<T>();
+  std::unique_ptr<Buffer> partial_buffer;
+  float *partial_data = nullptr;
+  if (slice_count > 1) {
+    MemInfo mem_info(output->memory_type(), DataType::DT_FLOAT,
+                     {slice_count * output_size});
+    partial_buffer =
+        context->runtime()->ObtainBuffer(mem_info, RENT_SCRATCH);
+    partial_data = partial_buffer->mutable_data<float>();
+    // without room for the partial outputs, the depth is not split
+    if (partial_data == nullptr) {
+      slice_count = 1;
+    }
+  }
 
   for (index_t b = 0; b < batch; ++b) {
     MatrixMap<const T>
@@ -89,17 +153,55 @@ MaceStatus Gemm<T>::Compute(const OpContext *context,
     MatrixMap<T>
         output_matrix(output_data + b * rows * cols, output_major, rows, cols);
 
-    for (index_t r = 0; r < rows; ++r) {
-      for (index_t c = 0; c < cols; ++c) {
+    auto dot = [&lhs_matrix, &rhs_matrix](const index_t r, const index_t c,
+                                          const index_t depth_begin,
+                                          const index_t depth_end) {
+      float sum = 0;
+      for (index_t d = depth_begin; d < depth_end; ++d) {
+        sum += static_cast<float>(lhs_matrix(r, d)) *
+            static_cast<float>(rhs_matrix(d, c));
+      }  // d
+      return sum;
+    };
+
+    if (slice_count == 1) {
+      thread_pool.Compute2D([=, &dot, &output_matrix](
+          index_t start0, index_t end0, index_t step0,
+          index_t start1, index_t end1, index_t step1) {
+        for (index_t r = start0; r < end0; r += step0) {
+          for (index_t c = start1; c < end1; c += step1) {
+            *output_matrix.data(r, c) = dot(r, c, 0, depth);
+          }  // c
+        }  // r
+      }, 0, rows, 1, 0, cols, 1);
+      continue;
+    }
+
+    // split-k: each depth slice sums into its own partial output
+    thread_pool.Compute2D([=, &dot](
+        index_t start0, index_t end0, index_t step0,
+        index_t start1, index_t end1, index_t step1) {
+      for (index_t s = start0; s < end0; s += step0) {
+        const index_t depth_begin = depth * s / slice_count;
+        const index_t depth_end = depth * (s + 1) / slice_count;
+        float *partial = partial_data + s * output_size;
+        for (index_t i = start1; i < end1; i += step1) {
+          partial[i] = dot(i / cols, i % cols, depth_begin, depth_end);
+        }  // i
+      }  // s
+    }, 0, slice_count, 1, 0, output_size, 1);
+
+    thread_pool.Compute1D([=, &output_matrix](index_t start,
+                                              index_t end,
+                                              index_t step) {
+      for (index_t i = start; i < end; i += step) {
         float sum = 0;
-        for (index_t d = 0; d < depth; ++d) {
-          sum += static_cast<float>(lhs_matrix(r, d)) *
-              static_cast<float>(rhs_matrix(d, c));
-        }  // d
-
-        *output_matrix.data(r, c) = sum;
-      }  // c
-    }  // r
+        for (index_t s = 0; s < slice_count; ++s) {
+          sum += partial_data[s * output_size + i];
+        }  // s
+        *output_matrix.data(i / cols, i % cols) = sum;
+      }  // i
+    }, 0, output_size, 1);
   }   // b
 
   return MaceStatus::MACE_SUCCESS;
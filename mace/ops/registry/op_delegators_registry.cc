@@ -19,8 +19,10 @@ namespace ops {
 
 namespace ref {
 extern void RegisterActivationDelegator(OpDelegatorRegistry *registry);
+extern void RegisterBatchedGemmDelegator(OpDelegatorRegistry *registry);
 extern void RegisterBiasAddDelegator(OpDelegatorRegistry *registry);
 extern void RegisterConv2dDelegator(OpDelegatorRegistry *registry);
+extern void RegisterConv2dK3x3WinogradDelegator(OpDelegatorRegistry *registry);
 extern void RegisterDeconv2dDelegator(OpDelegatorRegistry *registry);
 extern void RegisterDepthwiseConv2dDelegator(OpDelegatorRegistry *registry);
 extern void RegisterDepthwiseDeconv2dDelegator(OpDelegatorRegistry *registry);
@@ -67,6 +69,7 @@ extern void RegisterDepthwiseDeconv2dGeneralDelegator(
 extern void RegisterGroupDeconv2dGeneralDelegator(
     OpDelegatorRegistry *registry);
 
+extern void RegisterBatchedGemmDelegator(OpDelegatorRegistry *registry);
 extern void RegisterGemmDelegator(OpDelegatorRegistry *registry);
 extern void RegisterGemvDelegator(OpDelegatorRegistry *registry);
 #ifdef MACE_ENABLE_FP16
@@ -86,8 +89,10 @@ extern void RegisterGemvDelegator(OpDelegatorRegistry *registry);
 
 void RegisterAllOpDelegators(OpDelegatorRegistry *registry) {
   ref::RegisterActivationDelegator(registry);
+  ref::RegisterBatchedGemmDelegator(registry);
   ref::RegisterBiasAddDelegator(registry);
   ref::RegisterConv2dDelegator(registry);
+  ref::RegisterConv2dK3x3WinogradDelegator(registry);
   ref::RegisterDeconv2dDelegator(registry);
   ref::RegisterDepthwiseConv2dDelegator(registry);
   ref::RegisterDepthwiseDeconv2dDelegator(registry);
@@ -124,6 +129,7 @@ void RegisterAllOpDelegators(OpDelegatorRegistry *registry) {
   arm::RegisterDepthwiseDeconv2dGeneralDelegator(registry);
   arm::RegisterGroupDeconv2dGeneralDelegator(registry);
 
+  arm::RegisterBatchedGemmDelegator(registry);
   arm::RegisterGemmDelegator(registry);
   arm::RegisterGemvDelegator(registry);
 #ifdef MACE_ENABLE_FP16
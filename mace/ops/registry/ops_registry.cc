@@ -46,10 +46,12 @@ extern void RegisterIdentity(OpRegistry *op_registry);
 extern void RegisterIfDefined(OpRegistry *op_registry);
 extern void RegisterInferConv2dShape(OpRegistry *op_registry);
 extern void RegisterKaldiBatchNorm(OpRegistry *op_registry);
+extern void RegisterLayerNorm(OpRegistry *op_registry);
 extern void RegisterLocalResponseNorm(OpRegistry *op_registry);
 extern void RegisterLpNorm(OpRegistry *op_registry);
 extern void RegisterLSTMNonlinear(OpRegistry *op_registry);
 extern void RegisterMatMul(OpRegistry *op_registry);
+extern void RegisterMultiHeadAttention(OpRegistry *op_registry);
 extern void RegisterMVNorm(OpRegistry *op_registry);
 extern void RegisterNonlocalReshape(OpRegistry *op_registry);
 extern void RegisterOneHot(OpRegistry *op_registry);
@@ -83,6 +85,7 @@ extern void RegisterSubsample(OpRegistry *op_registry);
 extern void RegisterSumGroup(OpRegistry *op_registry);
 extern void RegisterTargetRMSNorm(OpRegistry *op_registry);
 extern void RegisterTile(OpRegistry *op_registry);
+extern void RegisterTopK(OpRegistry *op_registry);
 extern void RegisterTranspose(OpRegistry *op_registry);
 extern void RegisterUnstack(OpRegistry *op_registry);
 extern void RegisterUnsqueeze(OpRegistry *op_registry);
@@ -128,10 +131,12 @@ void RegisterAllOps(OpRegistry *registry) {
   ops::RegisterIfDefined(registry);
   ops::RegisterInferConv2dShape(registry);
   ops::RegisterKaldiBatchNorm(registry);
+  ops::RegisterLayerNorm(registry);
   ops::RegisterLocalResponseNorm(registry);
   ops::RegisterLpNorm(registry);
   ops::RegisterLSTMNonlinear(registry);
   ops::RegisterMatMul(registry);
+  ops::RegisterMultiHeadAttention(registry);
   ops::RegisterMVNorm(registry);
   ops::RegisterNonlocalReshape(registry);
   ops::RegisterOneHot(registry);
@@ -165,6 +170,7 @@ void RegisterAllOps(OpRegistry *registry) {
   ops::RegisterSumGroup(registry);
   ops::RegisterTargetRMSNorm(registry);
   ops::RegisterTile(registry);
+  ops::RegisterTopK(registry);
   ops::RegisterTranspose(registry);
   ops::RegisterUnstack(registry);
   ops::RegisterUnsqueeze(registry);
@@ -111,6 +111,9 @@ class SelectOp<RuntimeType::RT_CPU, T> : public Operation {
       const index_t bytes = condition_rank * sizeof(index_t);
       MemInfo mem_info(output->memory_type(), DataType::DT_UINT8, {bytes});
       auto div_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
+      if (div_buffer->memory<void>() == nullptr) {
+        return MaceStatus::MACE_OUT_OF_RESOURCES;
+      }
       index_t *div_ptr = div_buffer->mutable_data<index_t>();
       div_ptr[condition_rank - 1] = 1;
       for (index_t dim = condition_rank - 1; dim > 0; --dim) {
@@ -84,6 +84,9 @@ class SoftmaxOp<RuntimeType::RT_CPU, T> : public Operation {
     auto *runtime = context->runtime();
     MemInfo mem_info(input->memory_type(), DataType::DT_FLOAT, {hw_size});
     auto cache_buffer = runtime->ObtainBuffer(mem_info, RENT_SCRATCH);
+    if (cache_buffer->memory<void>() == nullptr) {
+      return MaceStatus::MACE_OUT_OF_RESOURCES;
+    }
 
     utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
     float std_lowest = std::numeric_limits<float>::lowest();
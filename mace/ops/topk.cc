@@ -0,0 +1,233 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+#include "mace/core/ops/operator.h"
+#include "mace/core/registry/ops_registry.h"
+
+namespace mace {
+namespace ops {
+
+namespace {
+// Rows longer than this are split into chunks selected in parallel, the
+// candidates of the chunks are merged at last.
+const index_t kChunkSize = 4096;
+
+struct Candidate {
+  float value;
+  int32_t index;
+};
+
+// Whether `a` comes before `b` in the top k, the lower index wins a tie.
+struct CandidateOrder {
+  explicit CandidateOrder(const bool largest) : largest(largest) {}
+
+  bool operator()(const Candidate &a, const Candidate &b) const {
+    if (a.value != b.value) {
+      return largest ? a.value > b.value : a.value < b.value;
+    }
+    return a.index < b.index;
+  }
+
+  const bool largest;
+};
+
+// Selects the top k of the elements [begin, end) of a row with `stride`,
+// appended to `candidates` in no particular order.
+template <typename T>
+void SelectTopK(const T *row, const index_t stride, const index_t begin,
+                const index_t end, const index_t k,
+                const CandidateOrder &order,
+                std::vector<Candidate> *candidates) {
+  const index_t count = std::min(k, end - begin);
+  if (count == 0) {
+    return;
+  }
+  const size_t offset = candidates->size();
+  auto first = [candidates, offset]() {
+    return candidates->begin() + offset;
+  };
+  if (count * 8 < end - begin) {
+    // a heap of the k best, the worst of them on top
+    for (index_t i = begin; i < end; ++i) {
+      const Candidate candidate = {static_cast<float>(row[i * stride]),
+                                   static_cast<int32_t>(i)};
+      if (static_cast<index_t>(candidates->size() - offset) < count) {
+        candidates->push_back(candidate);
+        std::push_heap(first(), candidates->end(), order);
+      } else if (order(candidate, candidates->at(offset))) {
+        std::pop_heap(first(), candidates->end(), order);
+        candidates->back() = candidate;
+        std::push_heap(first(), candidates->end(), order);
+      }
+    }
+  } else {
+    for (index_t i = begin; i < end; ++i) {
+      candidates->push_back({static_cast<float>(row[i * stride]),
+                             static_cast<int32_t>(i)});
+    }
+    std::nth_element(first(), first() + (count - 1), candidates->end(),
+                     order);
+    candidates->resize(offset + count);
+  }
+}
+}  // namespace
+
+template <RuntimeType D, class T>
+class TopKOp;
+
+template <class T>
+class TopKOp<RuntimeType::RT_CPU, T> : public Operation {
+ public:
+  explicit TopKOp(OpConstructContext *context)
+      : Operation(context),
+        k_(Operation::GetOptionalArg<int>("k", 1)),
+        axis_(Operation::GetOptionalArg<int>("axis", -1)),
+        largest_(Operation::GetOptionalArg<int>("largest", 1) != 0),
+        sorted_(Operation::GetOptionalArg<int>("sorted", 1) != 0) {}
+
+  MaceStatus Run(OpContext *context) override {
+    const Tensor *input = this->Input(INPUT);
+    Tensor *values = this->Output(VALUES);
+    Tensor *indices = this->Output(INDICES);
+    MACE_CHECK(indices->dtype() == DT_INT32,
+               "TopK indices should be int32");
+
+    const int rank = input->dim_size();
+    MACE_CHECK(rank > 0, "TopK input should not be a scalar");
+    const int axis = axis_ < 0 ? axis_ + rank : axis_;
+    MACE_CHECK(axis >= 0 && axis < rank, "Invalid TopK axis: ", axis_);
+    index_t k = k_;
+    if (this->InputSize() > K) {
+      const Tensor *k_tensor = this->Input(K);
+      MACE_CHECK(k_tensor->size() == 1 && k_tensor->dtype() == DT_INT32,
+                 "TopK k should be an int32 scalar");
+      k = k_tensor->data<int32_t>()[0];
+    }
+    const auto &input_shape = input->shape();
+    const index_t axis_size = input_shape[axis];
+    MACE_CHECK(k >= 0 && k <= axis_size, "TopK k ", k,
+               " is out of the range [0, ", axis_size, "]");
+
+    std::vector<index_t> output_shape(input_shape);
+    output_shape[axis] = k;
+    MACE_RETURN_IF_ERROR(values->Resize(output_shape));
+    MACE_RETURN_IF_ERROR(indices->Resize(output_shape));
+
+    const index_t outer_size = std::accumulate(input_shape.begin(),
+                                               input_shape.begin() + axis,
+                                               static_cast<index_t>(1),
+                                               std::multiplies<index_t>());
+    const index_t inner_size = std::accumulate(input_shape.begin() + axis + 1,
+                                               input_shape.end(),
+                                               static_cast<index_t>(1),
+                                               std::multiplies<index_t>());
+    const index_t row_count = outer_size * inner_size;
+    if (k == 0 || row_count == 0) {
+      return MaceStatus::MACE_SUCCESS;
+    }
+
+    const T *input_data = input->data<T>();
+    T *values_data = values->mutable_data<T>();
+    int32_t *indices_data = indices->mutable_data<int32_t>();
+    const CandidateOrder order(largest_);
+    const bool sorted = sorted_;
+    // Row r is the axis of outer r / inner_size at inner r % inner_size.
+    auto row_data = [=](const index_t r) {
+      return input_data + (r / inner_size) * axis_size * inner_size +
+          r % inner_size;
+    };
+    auto write_row = [=](const index_t r,
+                         std::vector<Candidate> *candidates) {
+      if (sorted) {
+        std::sort(candidates->begin(), candidates->end(), order);
+      }
+      const index_t base = (r / inner_size) * k * inner_size + r % inner_size;
+      for (index_t j = 0; j < k; ++j) {
+        values_data[base + j * inner_size] = (*candidates)[j].value;
+        indices_data[base + j * inner_size] = (*candidates)[j].index;
+      }
+    };
+
+    utils::ThreadPool &thread_pool = context->runtime()->thread_pool();
+    const index_t chunk_count = (axis_size + kChunkSize - 1) / kChunkSize;
+    if (chunk_count <= 1 || k * 4 > kChunkSize) {
+      thread_pool.Compute1D([=](index_t start, index_t end, index_t step) {
+        std::vector<Candidate> candidates;
+        for (index_t r = start; r < end; r += step) {
+          candidates.clear();
+          SelectTopK(row_data(r), inner_size, 0, axis_size, k, order,
+                     &candidates);
+          write_row(r, &candidates);
+        }
+      }, 0, row_count, 1);
+      return MaceStatus::MACE_SUCCESS;
+    }
+
+    // Each chunk keeps its top k, the top k of the row is among them.
+    std::vector<std::vector<Candidate>> chunk_candidates(
+        row_count * chunk_count);
+    auto *chunk_candidates_data = chunk_candidates.data();
+    thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                              index_t start1, index_t end1, index_t step1) {
+      for (index_t r = start0; r < end0; r += step0) {
+        for (index_t c = start1; c < end1; c += step1) {
+          auto *candidates = chunk_candidates_data + r * chunk_count + c;
+          candidates->reserve(k);
+          SelectTopK(row_data(r), inner_size, c * kChunkSize,
+                     std::min(axis_size, (c + 1) * kChunkSize), k, order,
+                     candidates);
+        }
+      }
+    }, 0, row_count, 1, 0, chunk_count, 1);
+
+    thread_pool.Compute1D([=](index_t start, index_t end, index_t step) {
+      std::vector<Candidate> candidates;
+      for (index_t r = start; r < end; r += step) {
+        candidates.clear();
+        for (index_t c = 0; c < chunk_count; ++c) {
+          const auto &chunk = chunk_candidates_data[r * chunk_count + c];
+          candidates.insert(candidates.end(), chunk.begin(), chunk.end());
+        }
+        std::nth_element(candidates.begin(), candidates.begin() + (k - 1),
+                         candidates.end(), order);
+        candidates.resize(k);
+        write_row(r, &candidates);
+      }
+    }, 0, row_count, 1);
+
+    return MaceStatus::MACE_SUCCESS;
+  }
+
+ private:
+  const int k_;
+  const int axis_;
+  const bool largest_;
+  const bool sorted_;
+
+  MACE_OP_INPUT_TAGS(INPUT, K);
+  MACE_OP_OUTPUT_TAGS(VALUES, INDICES);
+};
+
+void RegisterTopK(OpRegistry *op_registry) {
+  MACE_REGISTER_OP(op_registry, "TopK", TopKOp, RuntimeType::RT_CPU, float);
+  MACE_REGISTER_BF16_OP(op_registry, "TopK", TopKOp, RuntimeType::RT_CPU);
+}
+
+}  // namespace ops
+}  // namespace mace
@@ -19,6 +19,13 @@
 
 namespace mace {
 
+namespace {
+// the images are allocated with 4 (RGBA) channels
+index_t ImageBytes(const MemInfo &info) {
+  return 4 * info.bytes();
+}
+}  // namespace
+
 OpenclImageManager::OpenclImageManager(Allocator *allocator)
     : MemoryManager(allocator) {}
 
@@ -27,7 +34,8 @@ OpenclImageManager::~OpenclImageManager() {}
 void *OpenclImageManager::ObtainMemory(const MemInfo &info,
                                        const BufRentType rent_type) {
   if (shared_pools_.count(rent_type) == 0) {
-    shared_pools_.emplace(rent_type, make_unique<ImagePool>(allocator_));
+    shared_pools_.emplace(rent_type,
+                          make_unique<ImagePool>(this, rent_type));
   }
 
   return shared_pools_.at(rent_type)->ObtainMemory(info);
@@ -62,8 +70,18 @@ void OpenclImageManager::ReleaseAllMemory(const BufRentType rent_type,
   }
 }
 
-OpenclImageManager::ImagePool::ImagePool(Allocator *allocator)
-    : allocator_(allocator) {}
+void OpenclImageManager::TrimMemory() {
+  for (auto rent_type : {RENT_PRIVATE, RENT_SCRATCH}) {
+    if (shared_pools_.count(rent_type) > 0) {
+      shared_pools_.at(rent_type)->ClearFreeMemory();
+    }
+  }
+}
+
+OpenclImageManager::ImagePool::ImagePool(OpenclImageManager *manager,
+                                         BufRentType rent_type)
+    : manager_(manager), rent_type_(rent_type),
+      allocator_(manager->allocator_) {}
 
 OpenclImageManager::ImagePool::~ImagePool() {
   ClearMemory();
@@ -76,15 +94,21 @@ void OpenclImageManager::ImagePool::ClearMemory() {
             << ", width: " << iter->second->dims[0]
             << ", height: " << iter->second->dims[1];
     allocator_->Delete(iter->second->mutable_memory<void>());
+    manager_->OnMemoryDeleted(rent_type_, ImageBytes(*iter->second));
   }
   mem_used_blocks_.clear();
 
+  ClearFreeMemory();
+}
+
+void OpenclImageManager::ImagePool::ClearFreeMemory() {
   for (BlockList::iterator iter = mem_free_blocks_.begin();
        iter != mem_free_blocks_.end(); ++iter) {
     VLOG(2) << "Finally release free image, size: " << iter->first
             << ", width: " << iter->second->dims[0]
             << ", height: " << iter->second->dims[1];
     allocator_->Delete(iter->second->mutable_memory<void>());
+    manager_->OnMemoryDeleted(rent_type_, ImageBytes(*iter->second));
   }
   mem_free_blocks_.clear();
 }
@@ -106,6 +130,9 @@ void *OpenclImageManager::ImagePool::ObtainMemory(const MemInfo &info) {
   if (iter == mem_free_blocks_.end()) {
     VLOG(3) << "OpenclImageManager::MemoryPool::ObtainMemory New memory: "
             << MakeString(info.dims);
+    if (!manager_->AcquireMemory(rent_type_, ImageBytes(info))) {
+      return nullptr;
+    }
     MACE_CHECK_SUCCESS(allocator_->New(info, &ptr));
     mem_used_blocks_.emplace(static_cast<index_t>(size),
                              std::make_shared<Buffer>(info, ptr));
@@ -38,17 +38,21 @@ class OpenclImageManager : public MemoryManager {
   std::vector<index_t> GetMemoryRealSize(const void *ptr) override;
   void ReleaseAllMemory(const BufRentType rent_type, bool del_buf) override;
 
+ protected:
+  void TrimMemory() override;
+
  private:
   typedef std::multimap<index_t, std::shared_ptr<Buffer>> BlockList;
   class ImagePool {
    public:
-    explicit ImagePool(Allocator *allocator);
+    ImagePool(OpenclImageManager *manager, BufRentType rent_type);
     ~ImagePool();
 
     void *ObtainMemory(const MemInfo &info);
     void ReleaseMemory(void *ptr);
     std::vector<index_t> GetMemoryRealSize(const void *ptr);
     void ReleaseAllMemory(bool del_buf);
+    void ClearFreeMemory();
 
    private:
     void ClearMemory();
@@ -56,6 +60,8 @@ class OpenclImageManager : public MemoryManager {
    private:
     BlockList mem_used_blocks_;
     BlockList mem_free_blocks_;
+    OpenclImageManager *manager_;
+    BufRentType rent_type_;
     Allocator *allocator_;
   };
 
@@ -72,7 +72,8 @@ MaceStatus OpenCLBufferTransformer::Transform(
           make_unique<Tensor>(runtime, input->dtype(), GPU_BUFFER,
                               input->shape(), false, tensor_name, type);
       Tensor *internal_tensor = inter_tensor.get();
-      runtime->AllocateBufferForTensor(internal_tensor, RENT_SCRATCH);
+      MACE_RETURN_IF_ERROR(
+          runtime->AllocateBufferForTensor(internal_tensor, RENT_SCRATCH));
       {
         const uint8_t *input_ptr = input->data<uint8_t>();
         // No need to finish the opencl command queue to write to the tensor
@@ -91,7 +92,9 @@ MaceStatus OpenCLBufferTransformer::Transform(
     auto tensor_name = InternalTransformedName(input->name());
     Tensor internal_tensor(opencl_runtime, dt, GPU_BUFFER,
                            input->shape(), false, tensor_name, type);
-    opencl_runtime->AllocateBufferForTensor(&internal_tensor, RENT_SCRATCH);
+    MACE_RETURN_IF_ERROR(
+        opencl_runtime->AllocateBufferForTensor(&internal_tensor,
+                                                RENT_SCRATCH));
     MACE_RETURN_IF_ERROR(kernel_->Compute(
         context, input, type, wino_blk_size, &internal_tensor));
     // 2. convert the internal GPU Buffer to output.
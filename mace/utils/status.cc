@@ -49,6 +49,10 @@ class MaceStatus::Impl {
         return "Unsupported";
       case MACE_RUNTIME_ERROR:
         return "Runtime error";
+      case MACE_CANCELLED:
+        return "Cancelled";
+      case MACE_DEADLINE_EXCEEDED:
+        return "Deadline exceeded";
       default:
         std::ostringstream os;
         os << code_;
@@ -30,6 +30,10 @@ constexpr int kTileCountPerThread = 2;
 constexpr int kMaxCostUsingSingleThread = 100;
 constexpr int kMinCpuCoresForPerformance = 3;
 constexpr int kMaxCpuCoresForPerformance = 5;
+constexpr int kMaxChunkCountPerTile = 4;
+constexpr int64_t kMinCapacityMeasureMicros = 100;
+constexpr float kMinCapacity = 0.05f;
+constexpr double kCapacityUpdateRate = 0.25;
 
 namespace {
 
@@ -141,13 +145,25 @@ ThreadPool::ThreadPool(const int thread_count_hint,
                        const CPUAffinityPolicy policy)
     : event_(kThreadPoolNone),
       count_down_latch_(kThreadPoolSpinWaitTime) {
-  int thread_count = thread_count_hint;
-
   if (port::Env::Default()->GetCPUMaxFreq(&cpu_max_freqs_)
       != MaceStatus::MACE_SUCCESS) {
     LOG(ERROR) << "Fail to get cpu max frequencies";
   }
+  Setup(thread_count_hint, policy);
+}
+
+ThreadPool::ThreadPool(const int thread_count_hint,
+                       const CPUAffinityPolicy policy,
+                       const std::vector<float> &cpu_max_freqs)
+    : event_(kThreadPoolNone),
+      count_down_latch_(kThreadPoolSpinWaitTime),
+      cpu_max_freqs_(cpu_max_freqs) {
+  Setup(thread_count_hint, policy);
+}
 
+void ThreadPool::Setup(const int thread_count_hint,
+                       const CPUAffinityPolicy policy) {
+  int thread_count = thread_count_hint;
   std::vector<size_t> cores_to_use;
   GetCPUCoresToUse(cpu_max_freqs_, policy, &thread_count, &cores_to_use);
   MACE_CHECK(thread_count > 0);
@@ -165,17 +181,21 @@ ThreadPool::ThreadPool(const int thread_count_hint,
     default_tile_count_ = thread_count * kTileCountPerThread;
   }
   MACE_CHECK(default_tile_count_ > 0, "default tile count should > 0");
+  min_chunk_ = 1;
 
   threads_ = std::vector<std::thread>(static_cast<size_t>(thread_count));
   thread_infos_ = std::vector<ThreadInfo>(static_cast<size_t>(thread_count));
   for (auto &thread_info : thread_infos_) {
     thread_info.cpu_cores = cores_to_use;
+    thread_info.capacity = 1.f;
+    thread_info.done = 0;
+    thread_info.busy_micros = 0;
   }
 }
 
 ThreadPool::~ThreadPool() {
   // Clear affinity of main thread
-  if (!cpu_max_freqs_.empty()) {
+  if (!thread_infos_.empty() && !thread_infos_[0].cpu_cores.empty()) {
     std::vector<size_t> cores(cpu_max_freqs_.size());
     for (size_t i = 0; i < cores.size(); ++i) {
       cores[i] = i;
@@ -201,22 +221,40 @@ void ThreadPool::Init() {
 
 void ThreadPool::Run(const std::function<void(const int64_t)> &func,
                      const int64_t iterations) {
+  RunRange([&func](const int64_t start, const int64_t end) {
+    for (int64_t i = start; i < end; ++i) {
+      func(i);
+    }
+  }, iterations, 1);
+}
+
+void ThreadPool::RunRange(const std::function<void(const int64_t,
+                                                   const int64_t)> &func,
+                          const int64_t iterations,
+                          const int64_t min_chunk) {
   const size_t thread_count = threads_.size();
-  const int64_t iters_per_thread = iterations / thread_count;
-  const int64_t remainder = iterations % thread_count;
-  int64_t iters_offset = 0;
 
   std::unique_lock<std::mutex> run_lock(run_mutex_);
 
+  // size the ranges after the capacities of the threads
+  double total_capacity = 0;
+  for (size_t i = 0; i < thread_count; ++i) {
+    total_capacity += thread_infos_[i].capacity;
+  }
+  double capacity_offset = 0;
+  int64_t iters_offset = 0;
   for (size_t i = 0; i < thread_count; ++i) {
-    int64_t range_len =
-        iters_per_thread + (static_cast<int64_t>(i) < remainder);
+    capacity_offset += thread_infos_[i].capacity;
+    const int64_t iters_end = i + 1 == thread_count ? iterations :
+        std::min(iterations, static_cast<int64_t>(
+            iterations * capacity_offset / total_capacity + 0.5));
     thread_infos_[i].range_start = iters_offset;
-    thread_infos_[i].range_len = range_len;
-    thread_infos_[i].range_end = iters_offset + range_len;
+    thread_infos_[i].range_len = iters_end - iters_offset;
+    thread_infos_[i].range_end = iters_end;
     thread_infos_[i].func = reinterpret_cast<uintptr_t>(&func);
-    iters_offset = thread_infos_[i].range_end;
+    iters_offset = iters_end;
   }
+  min_chunk_ = std::max(min_chunk, static_cast<int64_t>(1));
 
   count_down_latch_.Reset(static_cast<int>(thread_count - 1));
   {
@@ -228,6 +266,40 @@ void ThreadPool::Run(const std::function<void(const int64_t)> &func,
 
   ThreadRun(0);
   count_down_latch_.Wait();
+
+  UpdateCapacities();
+}
+
+// Guided self-scheduling: half of what is left at a time, so the chunks
+// shrink toward the end of a range and leave little to wait for.
+int64_t ThreadPool::GuidedChunk(const int64_t range_len) const {
+  return std::min(range_len, std::max(min_chunk_, (range_len + 1) / 2));
+}
+
+void ThreadPool::UpdateCapacities() {
+  // only compare runs long enough to time, with every thread busy
+  double total_rate = 0;
+  for (const auto &thread_info : thread_infos_) {
+    if (thread_info.done == 0 ||
+        thread_info.busy_micros < kMinCapacityMeasureMicros) {
+      return;
+    }
+    total_rate += static_cast<double>(thread_info.done) /
+        thread_info.busy_micros;
+  }
+  const double mean_rate = total_rate / thread_infos_.size();
+  float total_capacity = 0;
+  for (auto &thread_info : thread_infos_) {
+    const double rate = static_cast<double>(thread_info.done) /
+        thread_info.busy_micros / mean_rate;
+    thread_info.capacity = std::max(kMinCapacity, static_cast<float>(
+        (1 - kCapacityUpdateRate) * thread_info.capacity +
+            kCapacityUpdateRate * rate));
+    total_capacity += thread_info.capacity;
+  }
+  for (auto &thread_info : thread_infos_) {
+    thread_info.capacity *= thread_infos_.size() / total_capacity;
+  }
 }
 
 void ThreadPool::Destroy() {
@@ -298,36 +370,47 @@ void ThreadPool::ThreadLoop(size_t tid) {
 
 void ThreadPool::ThreadRun(size_t tid) {
   ThreadInfo &thread_info = thread_infos_[tid];
+  const int64_t start_micros = NowMicros();
+  int64_t done = 0;
   uintptr_t func_ptr = thread_info.func;
-  const std::function<void(int64_t)> *func =
-      reinterpret_cast<const std::function<void(int64_t)> *>(func_ptr);
-  // do own work
+  const std::function<void(int64_t, int64_t)> *func =
+      reinterpret_cast<const std::function<void(int64_t, int64_t)> *>(
+          func_ptr);
+  // do own work from the head
   int64_t range_len;
   while ((range_len = thread_info.range_len) > 0) {
+    const int64_t chunk = GuidedChunk(range_len);
     if (thread_info.range_len.compare_exchange_strong(range_len,
-                                                      range_len - 1)) {
-      func->operator()(thread_info.range_start++);
+                                                      range_len - chunk)) {
+      const int64_t head = thread_info.range_start.fetch_add(chunk);
+      func->operator()(head, head + chunk);
+      done += chunk;
     }
   }
 
-  // steal other threads' work
+  // steal other threads' work from the tail
   size_t thread_count = threads_.size();
   for (size_t t = (tid + 1) % thread_count; t != tid;
        t = (t + 1) % thread_count) {
     ThreadInfo &other_thread_info = thread_infos_[t];
     uintptr_t other_func_ptr = other_thread_info.func;
-    const std::function<void(int64_t)> *other_func =
-        reinterpret_cast<const std::function<void(int64_t)> *>(
+    const std::function<void(int64_t, int64_t)> *other_func =
+        reinterpret_cast<const std::function<void(int64_t, int64_t)> *>(
             other_func_ptr);
     while ((range_len = other_thread_info.range_len) > 0) {
+      const int64_t chunk = GuidedChunk(range_len);
       if (other_thread_info.range_len.compare_exchange_strong(range_len,
                                                               range_len
-                                                                  - 1)) {
-        int64_t tail = other_thread_info.range_end--;
-        other_func->operator()(tail - 1);
+                                                                  - chunk)) {
+        const int64_t tail = other_thread_info.range_end.fetch_sub(chunk);
+        other_func->operator()(tail - chunk, tail);
+        done += chunk;
       }
     }
   }
+
+  thread_info.done = done;
+  thread_info.busy_micros = NowMicros() - start_micros;
 }
 
 void ThreadPool::Compute1D(const std::function<void(int64_t,
@@ -350,7 +433,12 @@ void ThreadPool::Compute1D(const std::function<void(int64_t,
   }
 
   if (tile_size == 0) {
-    tile_size = std::max(static_cast<int64_t>(1), items / default_tile_count_);
+    // guided chunks of the items, no shorter than a few per thread
+    RunRange([=, &func](const int64_t chunk_start, const int64_t chunk_end) {
+      func(start + chunk_start * step,
+           std::min(end, start + chunk_end * step), step);
+    }, items, items / (default_tile_count_ * kMaxChunkCountPerTile));
+    return;
   }
 
   const int64_t step_tile_size = step * tile_size;
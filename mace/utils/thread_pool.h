@@ -38,10 +38,22 @@ class ThreadPool {
  public:
   ThreadPool(const int thread_count,
              const CPUAffinityPolicy affinity_policy);
+  // Uses the given max frequencies instead of the ones of the device, e.g.
+  // to simulate the cores of another CPU.
+  ThreadPool(const int thread_count,
+             const CPUAffinityPolicy affinity_policy,
+             const std::vector<float> &cpu_max_freqs);
   ~ThreadPool();
 
   void Init();
 
+  // The number of threads tasks are spread over, the calling one included.
+  int thread_count() const { return static_cast<int>(threads_.size()); }
+
+  // The relative throughput of thread `tid` measured over the past runs,
+  // the mean of all threads is 1. Thread 0 is the calling thread.
+  float capacity(const int tid) const { return thread_infos_[tid].capacity; }
+
   void Run(const std::function<void(const int64_t)> &func,
            const int64_t iterations);
 
@@ -94,9 +106,18 @@ class ThreadPool {
                  int cost_per_item = -1);
 
  private:
+  void Setup(const int thread_count_hint, const CPUAffinityPolicy policy);
   void Destroy();
   void ThreadLoop(size_t tid);
   void ThreadRun(size_t tid);
+  // Runs func over sub-ranges of [0, iterations) no shorter than min_chunk
+  // unless at the end.
+  void RunRange(const std::function<void(const int64_t,
+                                         const int64_t)> &func,
+                const int64_t iterations,
+                const int64_t min_chunk);
+  int64_t GuidedChunk(const int64_t range_len) const;
+  void UpdateCapacities();
 
   std::atomic<int> event_;
   CountDownLatch count_down_latch_;
@@ -111,12 +132,18 @@ class ThreadPool {
     std::atomic<int64_t> range_len;
     uintptr_t func;
     std::vector<size_t> cpu_cores;
+    // relative throughput, sizes the initial range of a run
+    float capacity;
+    // iterations done and time taken in the last run
+    int64_t done;
+    int64_t busy_micros;
   };
   std::vector<ThreadInfo> thread_infos_;
   std::vector<std::thread> threads_;
   std::vector<float> cpu_max_freqs_;
 
   int64_t default_tile_count_;
+  int64_t min_chunk_;
 };
 
 }  // namespace utils
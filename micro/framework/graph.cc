@@ -20,10 +20,96 @@
 #include "micro/framework/operator.h"
 #include "micro/include/public/micro.h"
 #include "micro/model/net_def.h"
+#include "micro/model/operator_def.h"
+#include "micro/model/output_shape.h"
+#include "micro/port/api.h"
 
 namespace micro {
 namespace framework {
 
+namespace {
+// The longest chain of row buffered ops, the converter keeps to it too
+const uint32_t kMaxRowChainSize = 8;
+
+// The rows [first_row, first_row + row_count) of an op output, kept in a
+// buffer of capacity rows
+struct RowWindow {
+  framework::Operator *op;
+  uint8_t *data;
+  int32_t capacity;
+  int32_t row_size;
+  int32_t first_row;
+  int32_t row_count;
+  int64_t cycles;
+};
+
+int32_t GetRowBufferArg(const framework::Operator *op, const uint32_t idx) {
+  uint32_t size = 0;
+  const int32_t *row_buffer =
+      op->GetRepeatArgByName<int32_t>("row_buffer", &size);
+  return (row_buffer != NULL && idx < size) ? row_buffer[idx] : -1;
+}
+
+void ReportOpStats(MaceMicroEngineConfig *engine_config,
+                   const uint32_t op_idx, framework::Operator *op,
+                   const int64_t cycles) {
+  const model::OperatorDef *op_def = engine_config->net_def_->op(op_idx);
+  MaceMicroOpStats op_stats;
+  op_stats.op_idx_ = op_idx;
+  op_stats.op_type_ = op_def->type();
+  op_stats.op_name_ = op_def->name();
+  op_stats.cycles_ = cycles;
+  op->GetCost(&op_stats.macs_, &op_stats.bytes_);
+  engine_config->op_profiler_(&op_stats, engine_config->op_profiler_data_);
+}
+
+// Computes the next row of windows[idx], after computing the rows of
+// windows[idx - 1] it reads. The first op reads its own input tensor.
+MaceStatus RunNextRow(RowWindow *windows, const uint32_t idx,
+                      const bool profile) {
+  RowWindow *window = windows + idx;
+  const int32_t row = window->first_row + window->row_count;
+  int32_t input_begin = 0;
+  int32_t input_end = 0;
+  MACE_RETURN_IF_ERROR(
+      window->op->GetInputRows(row, row + 1, &input_begin, &input_end));
+
+  const void *input = NULL;
+  int32_t input_row = 0;
+  if (idx > 0) {
+    RowWindow *input_window = windows + idx - 1;
+    while (input_window->first_row + input_window->row_count < input_end) {
+      MACE_RETURN_IF_ERROR(RunNextRow(windows, idx - 1, profile));
+    }
+    MACE_ASSERT(input_window->first_row <= input_begin);
+    input = input_window->data;
+    input_row = input_window->first_row;
+  }
+
+  const int64_t start_cycles = profile ? port::api::NowCycles() : 0;
+  if (window->row_count == window->capacity) {
+    // Drops the oldest row, the rows move down so copy them forward
+    uint8_t *dst = window->data;
+    const uint8_t *src = window->data + window->row_size;
+    const int32_t bytes = (window->row_count - 1) * window->row_size;
+    for (int32_t i = 0; i < bytes; ++i) {
+      dst[i] = src[i];
+    }
+    ++window->first_row;
+    --window->row_count;
+  }
+
+  MACE_RETURN_IF_ERROR(window->op->RunRows(
+      input, input_row, window->data, window->first_row, row, row + 1));
+  ++window->row_count;
+  if (profile) {
+    window->cycles += port::api::NowCycles() - start_cycles;
+  }
+
+  return MACE_SUCCESS;
+}
+}  // namespace
+
 MACE_DEFINE_PTR_ARRAY_FUNC(Graph, OpContext, op_context, op_contexts_)
 MACE_DEFINE_PTR_ARRAY_FUNC(Graph, uint32_t, input_op_idx, input_op_idxs_);
 MACE_DEFINE_PTR_ARRAY_FUNC(Graph, OpIOInfo, output_info, output_infos_);
@@ -71,7 +157,72 @@ MaceStatus Graph::Run(MaceMicroEngineConfig *engine_config) {
   uint32_t op_size = engine_config->net_def_->op_size();
   for (uint32_t i = 0; i < op_size; ++i) {
     OpContext *op_ctx = const_cast<OpContext *>(op_context(i));
-    MACE_RETURN_IF_ERROR(op_ctx->Run(engine_config));
+    framework::Operator *op = engine_config->op_array_[op_ctx->op_idx()];
+    if (GetRowBufferArg(op, 0) > 0) {
+      // The ops keeping a window of output rows and the one after them
+      uint32_t last_op = i + 1;
+      while (last_op < op_size && GetRowBufferArg(
+          engine_config->op_array_[op_context(last_op)->op_idx()], 0) > 0) {
+        ++last_op;
+      }
+      MACE_RETURN_IF_ERROR(RunRowChain(engine_config, i, last_op));
+      i = last_op;
+      continue;
+    }
+    if (engine_config->op_profiler_ != NULL) {
+      const int64_t start_cycles = port::api::NowCycles();
+      MACE_RETURN_IF_ERROR(op_ctx->Run(engine_config));
+      ReportOpStats(engine_config, i, op,
+                    port::api::NowCycles() - start_cycles);
+    } else {
+      MACE_RETURN_IF_ERROR(op_ctx->Run(engine_config));
+    }
+  }
+
+  return MACE_SUCCESS;
+}
+
+// Runs the ops [first_op, last_op] row by row. Each op but the last one
+// keeps only the "row_buffer" rows of its output that the next op reads,
+// so the converter plans these rows instead of the whole feature maps.
+MaceStatus Graph::RunRowChain(MaceMicroEngineConfig *engine_config,
+                              const uint32_t first_op,
+                              const uint32_t last_op) {
+  MACE_ASSERT(last_op < engine_config->net_def_->op_size());
+  const uint32_t chain_size = last_op - first_op + 1;
+  MACE_ASSERT(chain_size <= kMaxRowChainSize);
+
+  RowWindow windows[kMaxRowChainSize];
+  for (uint32_t i = 0; i < chain_size; ++i) {
+    const uint32_t op_i = first_op + i;
+    const model::OperatorDef *op_def = engine_config->net_def_->op(op_i);
+    RowWindow *window = windows + i;
+    window->op = engine_config->op_array_[op_context(op_i)->op_idx()];
+    window->data = engine_config->tensor_mem_ + op_def->mem_offset(0);
+    window->capacity = GetRowBufferArg(window->op, 0);
+    window->row_size = GetRowBufferArg(window->op, 2);
+    window->first_row = 0;
+    window->row_count = 0;
+    window->cycles = 0;
+    MACE_ASSERT(window->row_size > 0);
+  }
+
+  // The last op writes its whole output
+  RowWindow *last_window = windows + chain_size - 1;
+  const int32_t height =
+      engine_config->net_def_->op(last_op)->output_shape(0)->dim()[1];
+  MACE_ASSERT(last_window->capacity == 0);
+  last_window->capacity = height;
+  const bool profile = engine_config->op_profiler_ != NULL;
+  while (last_window->row_count < height) {
+    MACE_RETURN_IF_ERROR(RunNextRow(windows, chain_size - 1, profile));
+  }
+
+  if (profile) {
+    for (uint32_t i = 0; i < chain_size; ++i) {
+      ReportOpStats(engine_config, first_op + i, windows[i].op,
+                    windows[i].cycles);
+    }
   }
 
   return MACE_SUCCESS;
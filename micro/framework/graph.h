@@ -51,6 +51,10 @@ class Graph : public Serialize {
                              const int32_t **output_dims,
                              uint32_t *output_dim_size);
 
+ private:
+  MaceStatus RunRowChain(MaceMicroEngineConfig *engine_config,
+                         const uint32_t first_op, const uint32_t last_op);
+
  protected:
   SerialArray<OpContext> op_contexts_;
   SerialArray<SerialUint32> input_op_idxs_;
@@ -69,6 +69,14 @@ MaceStatus MaceMicroEngine::GetOpOutputData(const uint32_t op_def_idx,
                                                  output_dims, output_dim_size);
 }
 
+MaceStatus MaceMicroEngine::SetOpProfiler(MaceMicroOpProfiler op_profiler,
+                                          void *user_data) {
+  engine_config_->op_profiler_ = op_profiler;
+  engine_config_->op_profiler_data_ = user_data;
+
+  return MACE_SUCCESS;
+}
+
 MaceMicroEngine::MaceMicroEngine(const MaceMicroEngine &) {
   MACE_NOT_IMPLEMENTED;
 }
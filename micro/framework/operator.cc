@@ -18,6 +18,7 @@
 #include "micro/framework/op_context.h"
 #include "micro/include/port/define.h"
 #include "micro/include/public/micro.h"
+#include "micro/include/utils/macros.h"
 #include "micro/model/const_tensor.h"
 #include "micro/model/input_output_info.h"
 #include "micro/model/net_def.h"
@@ -29,6 +30,21 @@ namespace framework {
 namespace {
 const uint16_t kIdxConstTensor = 0xffff;
 const uint16_t kIdxModelInput = 0xfffe;
+
+int64_t GetDataTypeBytes(const DataType data_type) {
+  switch (data_type) {
+    case DT_FLOAT:
+    case DT_INT32:
+      return 4;
+    case DT_HALF:
+    case DT_FLOAT16:
+    case DT_BFLOAT16:
+      return 2;
+    default:
+      // DT_UINT8 and the DT_INT8 of the quantized models
+      return 1;
+  }
+}
 }  // namespace
 
 Operator::~Operator() {}
@@ -54,6 +70,30 @@ MaceStatus Operator::Run() {
   return MACE_SUCCESS;
 }
 
+MaceStatus Operator::RunRows(const void *input, int32_t input_row,
+                             void *output, int32_t output_row,
+                             const int32_t row_begin, const int32_t row_end) {
+  MACE_UNUSED(input);
+  MACE_UNUSED(input_row);
+  MACE_UNUSED(output);
+  MACE_UNUSED(output_row);
+  MACE_UNUSED(row_begin);
+  MACE_UNUSED(row_end);
+  MACE_NOT_IMPLEMENTED;
+  return MACE_UNSUPPORTED;
+}
+
+MaceStatus Operator::GetInputRows(const int32_t row_begin,
+                                  const int32_t row_end,
+                                  int32_t *input_begin, int32_t *input_end) {
+  MACE_UNUSED(row_begin);
+  MACE_UNUSED(row_end);
+  MACE_UNUSED(input_begin);
+  MACE_UNUSED(input_end);
+  MACE_NOT_IMPLEMENTED;
+  return MACE_UNSUPPORTED;
+}
+
 MaceStatus Operator::OnInit() {
   return MACE_SUCCESS;
 }
@@ -292,5 +332,62 @@ MACE_DEFINE_GET_ARRAY_ARG_BY_NAME_FUNC(int32_t, ints)
 MACE_DEFINE_GET_ARRAY_ARG_BY_NAME_FUNC(float, floats)
 MACE_DEFINE_GET_ARRAY_ARG_BY_NAME_FUNC(uint8_t, s)
 
+void Operator::GetCost(int64_t *macs, int64_t *bytes) {
+  *bytes = 0;
+  const uint32_t input_size = GetInputSize();
+  for (uint32_t i = 0; i < input_size; ++i) {
+    const OpIOInfo *input_info = op_context_->input_info(i);
+    const uint32_t op_def_idx = input_info->op_def_idx_;
+    DataType data_type = DT_FLOAT;
+    if (kIdxConstTensor == op_def_idx) {
+      data_type = engine_config_->net_def_->tensor(
+          input_info->output_idx_)->data_type();
+    } else if (kIdxModelInput != op_def_idx) {
+      const model::OperatorDef *op_def =
+          engine_config_->net_def_->op(op_def_idx);
+      if (input_info->output_idx_ < op_def->output_type_size()) {
+        data_type = op_def->output_type(input_info->output_idx_);
+      }
+    }
+    *bytes += GetDataTypeBytes(data_type) * base::GetShapeSize(
+        GetInputShapeDimSize(i), GetInputShapeDims(i));
+  }
+  const uint32_t output_size = GetOutputSize();
+  for (uint32_t i = 0; i < output_size; ++i) {
+    const int64_t data_type_bytes = i < op_def_->output_type_size() ?
+        GetDataTypeBytes(GetOutputDataType(i)) : sizeof(mifloat);
+    *bytes += data_type_bytes * base::GetShapeSize(
+        GetOutputShapeDimSize(i), GetOutputShapeDims(i));
+  }
+
+  // Counts like StatMACs in mace/utils/statistics.cc, the other ops take
+  // one per output element
+  *macs = output_size > 0 ? base::GetShapeSize(
+      GetOutputShapeDimSize(0), GetOutputShapeDims(0)) : 0;
+  const char *type = op_def_->type();
+  if (base::strcmp(type, "Conv2D") == 0) {
+    const int32_t *filter_dims = GetInputShapeDims(1);
+    *macs *= filter_dims[1] * filter_dims[2] * filter_dims[3];
+  } else if (base::strcmp(type, "DepthwiseConv2d") == 0) {
+    const int32_t *filter_dims = GetInputShapeDims(1);
+    *macs *= filter_dims[1] * filter_dims[2];
+  } else if (base::strcmp(type, "FullyConnected") == 0) {
+    *macs *= base::GetShapeSize(GetInputShapeDimSize(1) - 1,
+                                GetInputShapeDims(1) + 1);
+  } else if (base::strcmp(type, "MatMul") == 0) {
+    const uint32_t dim_size = GetInputShapeDimSize(0);
+    const int32_t *input_dims = GetInputShapeDims(0);
+    *macs *= GetArgByName("transpose_a", false) ?
+        input_dims[dim_size - 2] : input_dims[dim_size - 1];
+  } else if (base::strcmp(type, "Pooling") == 0) {
+    uint32_t kernel_size = 0;
+    const int32_t *kernels =
+        GetRepeatArgByName<int32_t>("kernels", &kernel_size);
+    if (kernels != NULL && kernel_size >= 2) {
+      *macs *= kernels[0] * kernels[1];
+    }
+  }
+}
+
 }  // namespace framework
 }  // namespace micro
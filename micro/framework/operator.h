@@ -63,6 +63,23 @@ class Operator {
   virtual MaceStatus OnInit();
   virtual MaceStatus Run();
 
+  // Row buffered execution of the NHWC ops, see Graph::RunRowChain.
+  // RunRows computes the output rows [row_begin, row_end), reading from
+  // |input| which holds the input rows from |input_row| on and writing to
+  // |output| which holds the output rows from |output_row| on. A NULL
+  // buffer stands for the op's own tensor.
+  virtual MaceStatus RunRows(const void *input, int32_t input_row,
+                             void *output, int32_t output_row,
+                             const int32_t row_begin, const int32_t row_end);
+  // The input rows [*input_begin, *input_end) read by RunRows
+  virtual MaceStatus GetInputRows(const int32_t row_begin,
+                                  const int32_t row_end,
+                                  int32_t *input_begin, int32_t *input_end);
+
+  // Estimates the multiply-accumulates and the bytes of the input and
+  // output tensors of one run from the shapes, for profiling
+  void GetCost(int64_t *macs, int64_t *bytes);
+
   template<typename T>
   T GetArgByName(const char *name, T default_value) const;
 
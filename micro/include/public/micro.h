@@ -63,6 +63,20 @@ class Graph;
 class Operator;
 }  // namespace framework
 
+// The cost of one op run. The cycles come from port::api::NowCycles, the
+// macs and bytes are estimated from the shapes of the op.
+struct MaceMicroOpStats {
+  uint32_t op_idx_;
+  const char *op_type_;
+  const char *op_name_;
+  int64_t cycles_;
+  int64_t macs_;
+  int64_t bytes_;
+};
+
+typedef void (*MaceMicroOpProfiler)(const MaceMicroOpStats *op_stats,
+                                    void *user_data);
+
 struct MaceMicroEngineConfig {
   model::NetDef *net_def_;
   const uint8_t *model_data_;
@@ -73,6 +87,8 @@ struct MaceMicroEngineConfig {
   const int32_t **input_shapes_;
   uint8_t *scratch_buffer_;
   uint32_t scratch_buffer_size_;
+  MaceMicroOpProfiler op_profiler_;
+  void *op_profiler_data_;
 };
 
 class MaceMicroEngine {
@@ -95,6 +111,10 @@ class MaceMicroEngine {
                              const int32_t **output_dims,
                              uint32_t *output_dim_size);
 
+  // Calls |op_profiler| after each op of Run, NULL to stop profiling
+  MaceStatus SetOpProfiler(MaceMicroOpProfiler op_profiler,
+                           void *user_data);
+
  private:
   MaceMicroEngineConfig *engine_config_;
 
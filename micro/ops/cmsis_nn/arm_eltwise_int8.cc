@@ -19,7 +19,7 @@
 #include "micro/base/logging.h"
 #include "micro/base/types.h"
 #include "micro/base/utils.h"
-#include "micro/ops/cmsis_nn/utilities.h"
+#include "micro/ops/utils/requantize.h"
 
 namespace micro {
 namespace ops {
@@ -24,7 +24,7 @@
 #include "micro/model/argument.h"
 #include "micro/model/const_tensor.h"
 #include "micro/model/net_def.h"
-#include "micro/ops/cmsis_nn/utilities.h"
+#include "micro/ops/utils/requantize.h"
 
 namespace micro {
 namespace ops {
@@ -20,7 +20,7 @@
 #include "micro/base/utils.h"
 #include "micro/framework/scratch_buffer.h"
 #include "micro/include/utils/macros.h"
-#include "micro/ops/cmsis_nn/utilities.h"
+#include "micro/ops/utils/requantize.h"
 
 namespace micro {
 namespace ops {
@@ -20,7 +20,7 @@
 #include "micro/base/utils.h"
 #include "micro/framework/op_context.h"
 #include "micro/model/net_def.h"
-#include "micro/ops/cmsis_nn/utilities.h"
+#include "micro/ops/utils/requantize.h"
 
 namespace micro {
 namespace ops {
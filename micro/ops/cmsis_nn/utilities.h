@@ -1,24 +0,0 @@
-// Copyright 2020 The MACE Authors. All Rights Reserved.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-//     http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-
-#ifndef MICRO_OPS_CMSIS_NN_UTILITIES_H_
-#define MICRO_OPS_CMSIS_NN_UTILITIES_H_
-
-#include "micro/base/types.h"
-
-void QuantizeMultiplier(double double_multiplier,
-                        int32_t *quantized_multiplier,
-                        int32_t *shift);
-
-#endif  // MICRO_OPS_CMSIS_NN_UTILITIES_H_
@@ -12,7 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "micro/ops/cmsis_nn/dequantize.h"
+#include "micro/ops/dequantize.h"
 
 #include "micro/base/logging.h"
 #include "micro/base/utils.h"
@@ -12,8 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#ifndef MICRO_OPS_CMSIS_NN_DEQUANTIZE_H_
-#define MICRO_OPS_CMSIS_NN_DEQUANTIZE_H_
+#ifndef MICRO_OPS_DEQUANTIZE_H_
+#define MICRO_OPS_DEQUANTIZE_H_
 
 #include "micro/framework/operator.h"
 
@@ -39,4 +39,4 @@ class DequantizeOp : public framework::Operator {
 }  // namespace ops
 }  // namespace micro
 
-#endif  // MICRO_OPS_CMSIS_NN_DEQUANTIZE_H_
+#endif  // MICRO_OPS_DEQUANTIZE_H_
@@ -0,0 +1,163 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "micro/ops/matmul_int8.h"
+
+#include "micro/base/logging.h"
+#include "micro/framework/op_context.h"
+#include "micro/model/argument.h"
+#include "micro/model/net_def.h"
+#include "micro/ops/utils/packed_weights.h"
+#include "micro/ops/utils/requantize.h"
+
+namespace micro {
+namespace ops {
+
+MaceStatus MatMulInt8Op::OnInit() {
+  transpose_a_ = GetArgByName("transpose_a", false);
+  transpose_b_ = GetArgByName("transpose_b", false);
+  weight_bits_ = GetArgByName("weight_bits", static_cast<int32_t>(8));
+  MACE_ASSERT1(weight_bits_ == 8 || weight_bits_ == 4 || weight_bits_ == 2,
+               "The weight bits should be 8, 4 or 2");
+  input_a_ = GetInputData<int8_t>(INPUT_A);
+  input_b_ = GetInputData<int8_t>(INPUT_B);
+  output_ = GetOutputData<int8_t>(OUTPUT);
+
+  if (GetInputSize() >= 3) {
+    bias_ = GetInputData<int32_t>(BIAS);
+    bias_dim_size_ = GetInputShapeDimSize(BIAS);
+    bias_dims_ = GetInputShapeDims(BIAS);
+  } else {
+    bias_ = NULL;
+    bias_dim_size_ = 0;
+    bias_dims_ = NULL;
+  }
+
+  input_a_dim_size_ = GetInputShapeDimSize(INPUT_A);
+  input_b_dim_size_ = GetInputShapeDimSize(INPUT_B);
+
+  input_a_dims_ = GetInputShapeDims(INPUT_A);
+  input_b_dims_ = GetInputShapeDims(INPUT_B);
+
+  return MACE_SUCCESS;
+}
+
+MaceStatus MatMulInt8Op::Run() {
+  MACE_ASSERT(input_a_dim_size_ == 2);
+  MACE_ASSERT(input_b_dim_size_ == 2);
+
+  MACE_ASSERT(transpose_b_);
+  MACE_ASSERT(!transpose_a_);
+
+  const int32_t rows = input_a_dims_[0];
+  const int32_t cols = input_b_dims_[0];
+  const int32_t depth = input_b_dims_[1];
+  MACE_ASSERT1(input_a_dims_[1] == depth,
+               "the number of A's column must be equal to B's row ");
+
+  if (bias_ != NULL) {
+    MACE_ASSERT(bias_dim_size_ == 1);
+    MACE_ASSERT(bias_dims_[0] == cols);
+  }
+
+  int32_t output_dims[2] = {rows, cols};
+  MACE_RETURN_IF_ERROR(ResizeOutputShape(OUTPUT, 2, output_dims));
+
+  QuantizeInfo input_quantize_info_a = GetInputQuantizeInfo(INPUT_A);
+  QuantizeInfo input_quantize_info_b = GetInputQuantizeInfo(INPUT_B);
+  QuantizeInfo output_quantize_info = GetOutputQuantizeInfo(OUTPUT);
+
+  double double_multiplier = input_quantize_info_a.scale *
+                             input_quantize_info_b.scale /
+                             output_quantize_info.scale;
+  int32_t multiplier;
+  int32_t shift;
+  QuantizeMultiplier(double_multiplier, &multiplier, &shift);
+  // B is symmetric, arm_nn_vec_mat_mult_t_s8 does not add its offset either
+  const int32_t lhs_offset = -input_quantize_info_a.zero;
+  const int32_t output_offset = output_quantize_info.zero;
+
+  if (weight_bits_ == 4) {
+    ComputePacked<4>(rows, cols, depth, multiplier, shift, lhs_offset,
+                     output_offset);
+    return MACE_SUCCESS;
+  } else if (weight_bits_ == 2) {
+    ComputePacked<2>(rows, cols, depth, multiplier, shift, lhs_offset,
+                     output_offset);
+    return MACE_SUCCESS;
+  }
+
+  for (int32_t r = 0; r < rows; ++r) {
+    const int8_t *lhs = input_a_ + r * depth;
+    int8_t *output = output_ + r * cols;
+    int32_t c = 0;
+    // Four rhs rows share every lhs load
+    for (; c + 3 < cols; c += 4) {
+      const int8_t *rhs0 = input_b_ + c * depth;
+      const int8_t *rhs1 = rhs0 + depth;
+      const int8_t *rhs2 = rhs1 + depth;
+      const int8_t *rhs3 = rhs2 + depth;
+      int32_t sum0 = bias_ != NULL ? bias_[c] : 0;
+      int32_t sum1 = bias_ != NULL ? bias_[c + 1] : 0;
+      int32_t sum2 = bias_ != NULL ? bias_[c + 2] : 0;
+      int32_t sum3 = bias_ != NULL ? bias_[c + 3] : 0;
+      for (int32_t d = 0; d < depth; ++d) {
+        const int32_t lhs_value = lhs[d] + lhs_offset;
+        sum0 += lhs_value * rhs0[d];
+        sum1 += lhs_value * rhs1[d];
+        sum2 += lhs_value * rhs2[d];
+        sum3 += lhs_value * rhs3[d];
+      }
+      output[c] = RequantizeInt8(sum0, multiplier, shift, output_offset);
+      output[c + 1] = RequantizeInt8(sum1, multiplier, shift, output_offset);
+      output[c + 2] = RequantizeInt8(sum2, multiplier, shift, output_offset);
+      output[c + 3] = RequantizeInt8(sum3, multiplier, shift, output_offset);
+    }
+    for (; c < cols; ++c) {
+      const int8_t *rhs0 = input_b_ + c * depth;
+      int32_t sum0 = bias_ != NULL ? bias_[c] : 0;
+      for (int32_t d = 0; d < depth; ++d) {
+        sum0 += (lhs[d] + lhs_offset) * rhs0[d];
+      }
+      output[c] = RequantizeInt8(sum0, multiplier, shift, output_offset);
+    }
+  }
+
+  return MACE_SUCCESS;
+}
+
+// The rows of B are packed, see PackedDot
+template<int32_t kBits>
+void MatMulInt8Op::ComputePacked(const int32_t rows, const int32_t cols,
+                                 const int32_t depth,
+                                 const int32_t multiplier,
+                                 const int32_t shift,
+                                 const int32_t lhs_offset,
+                                 const int32_t output_offset) {
+  const uint8_t *rhs = reinterpret_cast<const uint8_t *>(input_b_);
+  const int32_t rhs_row_bytes = GetPackedRowBytes(depth, kBits);
+  for (int32_t r = 0; r < rows; ++r) {
+    const int8_t *lhs = input_a_ + r * depth;
+    int8_t *output = output_ + r * cols;
+    for (int32_t c = 0; c < cols; ++c) {
+      int32_t sum = bias_ != NULL ? bias_[c] : 0;
+      sum += PackedDot<kBits>(lhs, lhs_offset, rhs + c * rhs_row_bytes, 0,
+                              depth);
+      output[c] = RequantizeInt8(sum, multiplier, shift, output_offset);
+    }
+  }
+}
+
+}  // namespace ops
+}  // namespace micro
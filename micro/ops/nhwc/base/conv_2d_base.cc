@@ -15,10 +15,8 @@
 #include "micro/ops/nhwc/base/conv_2d_base.h"
 
 #include "micro/base/logging.h"
-#include "micro/base/utils.h"
 #include "micro/include/utils/macros.h"
 #include "micro/model/operator_def.h"
-#include "micro/ops/utils/crumb_utils.h"
 
 namespace micro {
 namespace ops {
@@ -56,18 +54,79 @@ MaceStatus Conv2dBase::Run() {
   InitPaddingAndOutputSize(input_dims_, filter_dims_, FLOOR, output_dims);
   ResizeOutputShape(0, 4, output_dims);
 
+  // Compute adds the bias and applies the activation on each output tile
   MACE_RETURN_IF_ERROR(Compute(output_dims));
 
-  if (bias_ != NULL) {
-    MACE_RETURN_IF_ERROR(crumb::ComputeBias(
-        output_, output_dims, input_dim_size_, bias_, bias_dims_[0], output_));
-  }
-  MACE_RETURN_IF_ERROR(activation_.Compute(
-      output_, base::GetShapeSize(input_dim_size_, output_dims), output_));
+  return MACE_SUCCESS;
+}
+
+MaceStatus Conv2dBase::GetInputRows(const int32_t row_begin,
+                                    const int32_t row_end,
+                                    int32_t *input_begin,
+                                    int32_t *input_end) {
+  int32_t output_dims[4] = {0};
+  InitPaddingAndOutputSize(input_dims_, filter_dims_, FLOOR, output_dims);
+  int32_t pad_top = 0;
+  CalcInputRows(input_dims_[1], filter_dims_[1], row_begin, row_end,
+                input_begin, input_end, &pad_top);
 
   return MACE_SUCCESS;
 }
 
+MaceStatus Conv2dBase::RunRows(const void *input, int32_t input_row,
+                               void *output, int32_t output_row,
+                               const int32_t row_begin, const int32_t row_end) {
+  MACE_ASSERT(input_dims_[0] == 1);
+  MACE_ASSERT(input_row_size_ > 0 && output_row_size_ > 0);
+  if (input == NULL) {
+    input = input_;
+    input_row = 0;
+  }
+  if (output == NULL) {
+    output = output_;
+    output_row = 0;
+  }
+
+  int32_t output_dims[4] = {0};
+  InitPaddingAndOutputSize(input_dims_, filter_dims_, FLOOR, output_dims);
+  int32_t input_begin = 0;
+  int32_t input_end = 0;
+  int32_t pad_top = 0;
+  CalcInputRows(input_dims_[1], filter_dims_[1], row_begin, row_end,
+                &input_begin, &input_end, &pad_top);
+
+  // Compute takes the rows as whole tensors with their own top padding
+  const int32_t *op_output_dims = GetOutputShapeDims(OUTPUT);
+  const int32_t rows_input_dims[4] = {
+      1, input_end - input_begin, input_dims_[2], input_dims_[3]
+  };
+  int32_t rows_output_dims[4] = {
+      1, row_end - row_begin, op_output_dims[2], op_output_dims[3]
+  };
+
+  const mifloat *op_input = input_;
+  const int32_t *op_input_dims = input_dims_;
+  mifloat *op_output = output_;
+  const int32_t padding_size = padding_sizes_[0];
+  input_ = reinterpret_cast<const mifloat *>(
+      static_cast<const uint8_t *>(input) +
+          (input_begin - input_row) * input_row_size_);
+  input_dims_ = rows_input_dims;
+  output_ = reinterpret_cast<mifloat *>(
+      static_cast<uint8_t *>(output) +
+          (row_begin - output_row) * output_row_size_);
+  padding_sizes_[0] = pad_top * 2;
+
+  MaceStatus status = Compute(rows_output_dims);
+
+  input_ = op_input;
+  input_dims_ = op_input_dims;
+  output_ = op_output;
+  padding_sizes_[0] = padding_size;
+
+  return status;
+}
+
 MaceStatus Conv2dBase::Compute(int32_t (&output_dims)[4]) {
   MACE_NOT_IMPLEMENTED;
   MACE_UNUSED(output_dims);
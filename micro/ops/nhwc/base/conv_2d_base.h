@@ -25,6 +25,12 @@ class Conv2dBase : public FilterOpBase {
  public:
   virtual MaceStatus OnInit();
   virtual MaceStatus Run();
+  virtual MaceStatus RunRows(const void *input, int32_t input_row,
+                             void *output, int32_t output_row,
+                             const int32_t row_begin, const int32_t row_end);
+  virtual MaceStatus GetInputRows(const int32_t row_begin,
+                                  const int32_t row_end,
+                                  int32_t *input_begin, int32_t *input_end);
 
  protected:
   virtual MaceStatus Compute(int32_t (&output_dims)[4]);
@@ -15,9 +15,7 @@
 #include "micro/ops/nhwc/base/depthwise_conv_2d_base.h"
 
 #include "micro/base/logging.h"
-#include "micro/base/utils.h"
 #include "micro/model/operator_def.h"
-#include "micro/ops/utils/crumb_utils.h"
 
 namespace micro {
 namespace ops {
@@ -28,15 +26,9 @@ MaceStatus DepthwiseConv2dBase::Run() {
   output_dims[3] *= input_dims_[3];
   ResizeOutputShape(0, 4, output_dims);
 
+  // Compute adds the bias and applies the activation on each output tile
   MACE_RETURN_IF_ERROR(Compute(output_dims));
 
-  if (bias_ != NULL) {
-    MACE_RETURN_IF_ERROR(crumb::ComputeBias(
-        output_, output_dims, input_dim_size_, bias_, bias_dims_[0], output_));
-  }
-  MACE_RETURN_IF_ERROR(activation_.Compute(
-      output_, base::GetShapeSize(input_dim_size_, output_dims), output_));
-
   return MACE_SUCCESS;
 }
 
@@ -41,9 +41,34 @@ MaceStatus FilterOpBase::OnInitBase() {
     base::memcpy(padding_sizes_, padding_sizes, 2 * sizeof(int32_t));
   }
 
+  // {window rows, input row bytes, output row bytes}
+  const int32_t *row_buffer = GetRepeatArgByName<int32_t>("row_buffer");
+  if (row_buffer == NULL) {
+    input_row_size_ = output_row_size_ = 0;
+  } else {
+    input_row_size_ = row_buffer[1];
+    output_row_size_ = row_buffer[2];
+  }
+
   return MACE_SUCCESS;
 }
 
+void FilterOpBase::CalcInputRows(const int32_t input_height,
+                                 const int32_t kernel_height,
+                                 const int32_t row_begin,
+                                 const int32_t row_end,
+                                 int32_t *input_begin, int32_t *input_end,
+                                 int32_t *pad_top) {
+  MACE_ASSERT(row_begin < row_end);
+  const int32_t k_extent_height = (kernel_height - 1) * dilations_[0] + 1;
+  const int32_t begin = row_begin * strides_[0] - (padding_sizes_[0] >> 1);
+  const int32_t end = (row_end - 1) * strides_[0] -
+      (padding_sizes_[0] >> 1) + k_extent_height;
+  *input_begin = base::clamp<int32_t>(begin, 0, input_height);
+  *input_end = base::clamp<int32_t>(end, *input_begin, input_height);
+  *pad_top = *input_begin - begin;
+}
+
 void FilterOpBase::InitPaddingAndOutputSize(const int32_t *input_dims,
                                             const int32_t *filter_dims,
                                             const RoundType round_type,
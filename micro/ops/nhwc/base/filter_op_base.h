@@ -42,6 +42,13 @@ class FilterOpBase : public framework::Operator {
                                 const int32_t *filter_dims,
                                 const RoundType round_type,
                                 int32_t *output_dims);
+  // The input rows [*input_begin, *input_end) read by the output rows
+  // [row_begin, row_end) and the top padding left above them, for
+  // RunRows. The padding must have been initialized.
+  void CalcInputRows(const int32_t input_height, const int32_t kernel_height,
+                     const int32_t row_begin, const int32_t row_end,
+                     int32_t *input_begin, int32_t *input_end,
+                     int32_t *pad_top);
 
  private:
   void CalcPaddingAndOutputSize(const int32_t *input_dims,
@@ -57,6 +64,10 @@ class FilterOpBase : public framework::Operator {
   const int32_t *strides_;
   int32_t padding_sizes_[2];
   int32_t dilations_[2];
+  // The bytes of an input and an output row, from the "row_buffer"
+  // argument of the row buffered ops
+  int32_t input_row_size_;
+  int32_t output_row_size_;
 };
 
 }  // namespace ops
@@ -65,6 +65,78 @@ MaceStatus PoolingBase::Run() {
   return MACE_SUCCESS;
 }
 
+MaceStatus PoolingBase::GetInputRows(const int32_t row_begin,
+                                     const int32_t row_end,
+                                     int32_t *input_begin,
+                                     int32_t *input_end) {
+  int32_t output_dims[4] = {0};
+  InitPaddingAndOutputSize(input_dims_, filter_dims_, round_type_, output_dims);
+  int32_t pad_top = 0;
+  CalcInputRows(input_dims_[1], kernel_[0], row_begin, row_end,
+                input_begin, input_end, &pad_top);
+
+  return MACE_SUCCESS;
+}
+
+MaceStatus PoolingBase::RunRows(const void *input, int32_t input_row,
+                                void *output, int32_t output_row,
+                                const int32_t row_begin,
+                                const int32_t row_end) {
+  MACE_ASSERT(input_dims_[0] == 1);
+  MACE_ASSERT(input_row_size_ > 0 && output_row_size_ > 0);
+  if (input == NULL) {
+    input = input_;
+    input_row = 0;
+  }
+  if (output == NULL) {
+    output = output_;
+    output_row = 0;
+  }
+
+  int32_t output_dims[4] = {0};
+  InitPaddingAndOutputSize(input_dims_, filter_dims_, round_type_, output_dims);
+  int32_t input_begin = 0;
+  int32_t input_end = 0;
+  int32_t pad_top = 0;
+  CalcInputRows(input_dims_[1], kernel_[0], row_begin, row_end,
+                &input_begin, &input_end, &pad_top);
+
+  // The pooling takes the rows as whole tensors with their own top padding
+  const int32_t rows_input_dims[4] = {
+      1, input_end - input_begin, input_dims_[2], input_dims_[3]
+  };
+  const int32_t rows_output_dims[4] = {
+      1, row_end - row_begin, output_dims_[2], output_dims_[3]
+  };
+
+  const int32_t *op_input_dims = input_dims_;
+  mifloat *op_output = output_;
+  const int32_t *op_output_dims = output_dims_;
+  const mifloat *rows_input = reinterpret_cast<const mifloat *>(
+      static_cast<const uint8_t *>(input) +
+          (input_begin - input_row) * input_row_size_);
+  input_dims_ = rows_input_dims;
+  output_ = reinterpret_cast<mifloat *>(
+      static_cast<uint8_t *>(output) +
+          (row_begin - output_row) * output_row_size_);
+  output_dims_ = rows_output_dims;
+
+  int32_t pad_hw[2] = {pad_top, padding_sizes_[1] / 2};
+  if (pooling_type_ == MAX) {
+    MaxPooling(rows_input, kernel_, strides_, dilations_, pad_hw);
+  } else if (pooling_type_ == AVG) {
+    AvgPooling(rows_input, kernel_, strides_, dilations_, pad_hw);
+  } else {
+    MACE_NOT_IMPLEMENTED;
+  }
+
+  input_dims_ = op_input_dims;
+  output_ = op_output;
+  output_dims_ = op_output_dims;
+
+  return MACE_SUCCESS;
+}
+
 void PoolingBase::MaxPooling(const mifloat *input,
                              const int32_t *filter_hw,
                              const int32_t *stride_hw,
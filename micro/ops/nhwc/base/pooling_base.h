@@ -30,6 +30,11 @@ class PoolingBase : public FilterOpBase {
  public:
   MaceStatus OnInit();
   MaceStatus Run();
+  MaceStatus RunRows(const void *input, int32_t input_row,
+                     void *output, int32_t output_row,
+                     const int32_t row_begin, const int32_t row_end);
+  MaceStatus GetInputRows(const int32_t row_begin, const int32_t row_end,
+                          int32_t *input_begin, int32_t *input_end);
 
  protected:
   virtual void MaxPooling(const mifloat *input, const int32_t *filter_hw,
@@ -165,6 +165,8 @@ MaceStatus Conv2dC3S4Op::Compute(int32_t (&output_dims)[4]) {
         }
       }
     }  // filter batch, output channel
+    MACE_RETURN_IF_ERROR(activation_.Compute(
+        output_ + width_base[0], bias_, 4, channel, output_ + width_base[0]));
   }  // output size
 
   return MACE_SUCCESS;
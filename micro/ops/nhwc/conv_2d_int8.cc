@@ -0,0 +1,238 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "micro/ops/nhwc/conv_2d_int8.h"
+
+#include "micro/base/logging.h"
+#include "micro/framework/op_context.h"
+#include "micro/model/const_tensor.h"
+#include "micro/model/net_def.h"
+#include "micro/ops/utils/packed_weights.h"
+#include "micro/ops/utils/requantize.h"
+
+namespace micro {
+namespace ops {
+
+MaceStatus Conv2dInt8Op::OnInit() {
+  weight_bits_ = GetArgByName("weight_bits", static_cast<int32_t>(8));
+  MACE_ASSERT1(weight_bits_ == 8 || weight_bits_ == 4 || weight_bits_ == 2,
+               "The weight bits should be 8, 4 or 2");
+
+  return Conv2dBase::OnInit();
+}
+
+MaceStatus Conv2dInt8Op::Compute(int32_t (&output_dims)[4]) {
+  if (weight_bits_ == 4) {
+    return ComputePacked<4>(output_dims);
+  } else if (weight_bits_ == 2) {
+    return ComputePacked<2>(output_dims);
+  }
+
+  const int32_t batch = output_dims[0];
+  const int32_t height = output_dims[1];
+  const int32_t width = output_dims[2];
+  const int32_t channel = output_dims[3];
+  const int32_t k_height = filter_dims_[1];
+  const int32_t k_width = filter_dims_[2];
+  const int32_t k_channel = filter_dims_[3];
+  MACE_ASSERT(filter_dims_[0] == channel && input_dims_[3] == k_channel);
+  const int32_t in_height = input_dims_[1];
+  const int32_t in_width = input_dims_[2];
+  const int32_t k_batch_size = k_height * k_width * k_channel;
+
+  QuantizeInfo input_quantize_info = GetInputQuantizeInfo(INPUT);
+  QuantizeInfo filter_quantize_info = GetInputQuantizeInfo(FILTER);
+  QuantizeInfo output_quantize_info = GetOutputQuantizeInfo(OUTPUT);
+
+  double double_multiplier = input_quantize_info.scale *
+                             filter_quantize_info.scale /
+                             output_quantize_info.scale;
+  int32_t multiplier;
+  int32_t shift;
+  QuantizeMultiplier(double_multiplier, &multiplier, &shift);
+  // The filter is symmetric, CMSIS-NN does not take its zero point either
+  const int32_t input_offset = -input_quantize_info.zero;
+  const int32_t output_offset = output_quantize_info.zero;
+
+  const int8_t *input = reinterpret_cast<const int8_t *>(input_);
+  const int8_t *filter = reinterpret_cast<const int8_t *>(filter_);
+  const int32_t *bias = reinterpret_cast<const int32_t *>(bias_);
+  int8_t *output = reinterpret_cast<int8_t *>(output_);
+
+  const int32_t pad_top = padding_sizes_[0] >> 1;
+  const int32_t pad_left = padding_sizes_[1] >> 1;
+
+  for (int32_t b = 0; b < batch; ++b) {
+    const int8_t *in_batch = input + b * in_height * in_width * k_channel;
+    for (int32_t h = 0; h < height; ++h) {
+      const int32_t in_h = h * strides_[0] - pad_top;
+      for (int32_t w = 0; w < width; ++w) {
+        const int32_t in_w = w * strides_[1] - pad_left;
+        int8_t *out_ptr = output + ((b * height + h) * width + w) * channel;
+        int32_t kb = 0;
+        // Four output channels share every input load
+        for (; kb + 3 < channel; kb += 4) {
+          const int8_t *filter0 = filter + kb * k_batch_size;
+          const int8_t *filter1 = filter0 + k_batch_size;
+          const int8_t *filter2 = filter1 + k_batch_size;
+          const int8_t *filter3 = filter2 + k_batch_size;
+          int32_t sum0 = bias != NULL ? bias[kb] : 0;
+          int32_t sum1 = bias != NULL ? bias[kb + 1] : 0;
+          int32_t sum2 = bias != NULL ? bias[kb + 2] : 0;
+          int32_t sum3 = bias != NULL ? bias[kb + 3] : 0;
+          for (int32_t kh = 0; kh < k_height; ++kh) {
+            const int32_t in_h_idx = in_h + kh * dilations_[0];
+            if (in_h_idx < 0 || in_h_idx >= in_height) {
+              continue;
+            }
+            for (int32_t kw = 0; kw < k_width; ++kw) {
+              const int32_t in_w_idx = in_w + kw * dilations_[1];
+              if (in_w_idx < 0 || in_w_idx >= in_width) {
+                continue;
+              }
+              const int8_t *in_ptr =
+                  in_batch + (in_h_idx * in_width + in_w_idx) * k_channel;
+              const int32_t k_offset = (kh * k_width + kw) * k_channel;
+              for (int32_t kc = 0; kc < k_channel; ++kc) {
+                const int32_t in_value = in_ptr[kc] + input_offset;
+                sum0 += in_value * filter0[k_offset + kc];
+                sum1 += in_value * filter1[k_offset + kc];
+                sum2 += in_value * filter2[k_offset + kc];
+                sum3 += in_value * filter3[k_offset + kc];
+              }  // filter channel
+            }  // filter width
+          }  // filter height
+          out_ptr[kb] = RequantizeInt8(sum0, multiplier, shift, output_offset);
+          out_ptr[kb + 1] =
+              RequantizeInt8(sum1, multiplier, shift, output_offset);
+          out_ptr[kb + 2] =
+              RequantizeInt8(sum2, multiplier, shift, output_offset);
+          out_ptr[kb + 3] =
+              RequantizeInt8(sum3, multiplier, shift, output_offset);
+        }
+        for (; kb < channel; ++kb) {
+          const int8_t *filter0 = filter + kb * k_batch_size;
+          int32_t sum0 = bias != NULL ? bias[kb] : 0;
+          for (int32_t kh = 0; kh < k_height; ++kh) {
+            const int32_t in_h_idx = in_h + kh * dilations_[0];
+            if (in_h_idx < 0 || in_h_idx >= in_height) {
+              continue;
+            }
+            for (int32_t kw = 0; kw < k_width; ++kw) {
+              const int32_t in_w_idx = in_w + kw * dilations_[1];
+              if (in_w_idx < 0 || in_w_idx >= in_width) {
+                continue;
+              }
+              const int8_t *in_ptr =
+                  in_batch + (in_h_idx * in_width + in_w_idx) * k_channel;
+              const int32_t k_offset = (kh * k_width + kw) * k_channel;
+              for (int32_t kc = 0; kc < k_channel; ++kc) {
+                sum0 += (in_ptr[kc] + input_offset) * filter0[k_offset + kc];
+              }  // filter channel
+            }  // filter width
+          }  // filter height
+          out_ptr[kb] = RequantizeInt8(sum0, multiplier, shift, output_offset);
+        }  // output channel
+      }  // output width
+    }  // output height
+  }  // output batch
+
+  return MACE_SUCCESS;
+}
+
+// Unpacks each weight row in registers while summing it, see PackedDot
+template<int32_t kBits>
+MaceStatus Conv2dInt8Op::ComputePacked(int32_t (&output_dims)[4]) {
+  const int32_t batch = output_dims[0];
+  const int32_t height = output_dims[1];
+  const int32_t width = output_dims[2];
+  const int32_t channel = output_dims[3];
+  const int32_t k_height = filter_dims_[1];
+  const int32_t k_width = filter_dims_[2];
+  const int32_t k_channel = filter_dims_[3];
+  MACE_ASSERT(filter_dims_[0] == channel && input_dims_[3] == k_channel);
+  const int32_t in_height = input_dims_[1];
+  const int32_t in_width = input_dims_[2];
+  const int32_t k_row_bytes =
+      GetPackedRowBytes(k_height * k_width * k_channel, kBits);
+
+  QuantizeInfo input_quantize_info = GetInputQuantizeInfo(INPUT);
+  QuantizeInfo filter_quantize_info = GetInputQuantizeInfo(FILTER);
+  QuantizeInfo output_quantize_info = GetOutputQuantizeInfo(OUTPUT);
+
+  double double_multiplier = input_quantize_info.scale *
+                             filter_quantize_info.scale /
+                             output_quantize_info.scale;
+  int32_t multiplier;
+  int32_t shift;
+  QuantizeMultiplier(double_multiplier, &multiplier, &shift);
+  const int32_t input_offset = -input_quantize_info.zero;
+  const int32_t output_offset = output_quantize_info.zero;
+
+  const int8_t *input = reinterpret_cast<const int8_t *>(input_);
+  const uint8_t *filter = reinterpret_cast<const uint8_t *>(filter_);
+  const int32_t *bias = reinterpret_cast<const int32_t *>(bias_);
+  int8_t *output = reinterpret_cast<int8_t *>(output_);
+
+  const int32_t pad_top = padding_sizes_[0] >> 1;
+  const int32_t pad_left = padding_sizes_[1] >> 1;
+
+  for (int32_t b = 0; b < batch; ++b) {
+    const int8_t *in_batch = input + b * in_height * in_width * k_channel;
+    for (int32_t h = 0; h < height; ++h) {
+      const int32_t in_h = h * strides_[0] - pad_top;
+      for (int32_t w = 0; w < width; ++w) {
+        const int32_t in_w = w * strides_[1] - pad_left;
+        int8_t *out_ptr = output + ((b * height + h) * width + w) * channel;
+        for (int32_t kb = 0; kb < channel; ++kb) {
+          const uint8_t *filter_row = filter + kb * k_row_bytes;
+          int32_t sum = bias != NULL ? bias[kb] : 0;
+          for (int32_t kh = 0; kh < k_height; ++kh) {
+            const int32_t in_h_idx = in_h + kh * dilations_[0];
+            if (in_h_idx < 0 || in_h_idx >= in_height) {
+              continue;
+            }
+            for (int32_t kw = 0; kw < k_width; ++kw) {
+              const int32_t in_w_idx = in_w + kw * dilations_[1];
+              if (in_w_idx < 0 || in_w_idx >= in_width) {
+                continue;
+              }
+              const int8_t *in_ptr =
+                  in_batch + (in_h_idx * in_width + in_w_idx) * k_channel;
+              sum += PackedDot<kBits>(in_ptr, input_offset, filter_row,
+                                      (kh * k_width + kw) * k_channel,
+                                      k_channel);
+            }  // filter width
+          }  // filter height
+          out_ptr[kb] = RequantizeInt8(sum, multiplier, shift, output_offset);
+        }  // output channel
+      }  // output width
+    }  // output height
+  }  // output batch
+
+  return MACE_SUCCESS;
+}
+
+MaceStatus Conv2dInt8Op::Run() {
+  int32_t output_dims[4] = {0};
+  InitPaddingAndOutputSize(input_dims_, filter_dims_, FLOOR, output_dims);
+  ResizeOutputShape(0, 4, output_dims);
+
+  MACE_RETURN_IF_ERROR(Compute(output_dims));
+
+  return MACE_SUCCESS;
+}
+
+}  // namespace ops
+}  // namespace micro
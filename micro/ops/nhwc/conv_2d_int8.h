@@ -0,0 +1,41 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MICRO_OPS_NHWC_CONV_2D_INT8_H_
+#define MICRO_OPS_NHWC_CONV_2D_INT8_H_
+
+#include "micro/ops/nhwc/base/conv_2d_base.h"
+
+namespace micro {
+namespace ops {
+
+// Computes the same bytes as ArmConv2dInt8Op without CMSIS-NN.
+class Conv2dInt8Op : public Conv2dBase {
+ public:
+  virtual MaceStatus OnInit();
+  virtual MaceStatus Run();
+
+ private:
+  MaceStatus Compute(int32_t (&output_dims)[4]);
+  template<int32_t kBits>
+  MaceStatus ComputePacked(int32_t (&output_dims)[4]);
+
+  int32_t weight_bits_;
+};
+
+}  // namespace ops
+}  // namespace micro
+
+
+#endif  // MICRO_OPS_NHWC_CONV_2D_INT8_H_
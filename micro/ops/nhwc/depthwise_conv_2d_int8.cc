@@ -0,0 +1,139 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "micro/ops/nhwc/depthwise_conv_2d_int8.h"
+
+#include "micro/base/logging.h"
+#include "micro/framework/op_context.h"
+#include "micro/model/const_tensor.h"
+#include "micro/model/net_def.h"
+#include "micro/ops/utils/requantize.h"
+
+namespace micro {
+namespace ops {
+
+MaceStatus DepthwiseConv2dInt8Op::Compute(int32_t (&output_dims)[4]) {
+  const int32_t batch = output_dims[0];
+  const int32_t height = output_dims[1];
+  const int32_t width = output_dims[2];
+  const int32_t channel = output_dims[3];
+  const int32_t k_height = filter_dims_[1];
+  const int32_t k_width = filter_dims_[2];
+  MACE_ASSERT(filter_dims_[0] == 1);
+  MACE_ASSERT(input_dims_[3] == filter_dims_[3] && channel == filter_dims_[3]);
+  const int32_t in_height = input_dims_[1];
+  const int32_t in_width = input_dims_[2];
+
+  QuantizeInfo input_quantize_info = GetInputQuantizeInfo(INPUT);
+  QuantizeInfo filter_quantize_info = GetInputQuantizeInfo(FILTER);
+  QuantizeInfo output_quantize_info = GetOutputQuantizeInfo(OUTPUT);
+
+  double double_multiplier = input_quantize_info.scale *
+                             filter_quantize_info.scale /
+                             output_quantize_info.scale;
+  int32_t multiplier;
+  int32_t shift;
+  QuantizeMultiplier(double_multiplier, &multiplier, &shift);
+  const int32_t input_offset = -input_quantize_info.zero;
+  const int32_t output_offset = output_quantize_info.zero;
+
+  const int8_t *input = reinterpret_cast<const int8_t *>(input_);
+  const int8_t *filter = reinterpret_cast<const int8_t *>(filter_);
+  const int32_t *bias = reinterpret_cast<const int32_t *>(bias_);
+  int8_t *output = reinterpret_cast<int8_t *>(output_);
+
+  const int32_t pad_top = padding_sizes_[0] >> 1;
+  const int32_t pad_left = padding_sizes_[1] >> 1;
+
+  for (int32_t b = 0; b < batch; ++b) {
+    const int8_t *in_batch = input + b * in_height * in_width * channel;
+    for (int32_t h = 0; h < height; ++h) {
+      const int32_t in_h = h * strides_[0] - pad_top;
+      for (int32_t w = 0; w < width; ++w) {
+        const int32_t in_w = w * strides_[1] - pad_left;
+        int8_t *out_ptr = output + ((b * height + h) * width + w) * channel;
+        int32_t c = 0;
+        for (; c + 3 < channel; c += 4) {
+          int32_t sum0 = bias != NULL ? bias[c] : 0;
+          int32_t sum1 = bias != NULL ? bias[c + 1] : 0;
+          int32_t sum2 = bias != NULL ? bias[c + 2] : 0;
+          int32_t sum3 = bias != NULL ? bias[c + 3] : 0;
+          for (int32_t kh = 0; kh < k_height; ++kh) {
+            const int32_t in_h_idx = in_h + kh * dilations_[0];
+            if (in_h_idx < 0 || in_h_idx >= in_height) {
+              continue;
+            }
+            for (int32_t kw = 0; kw < k_width; ++kw) {
+              const int32_t in_w_idx = in_w + kw * dilations_[1];
+              if (in_w_idx < 0 || in_w_idx >= in_width) {
+                continue;
+              }
+              const int8_t *in_ptr =
+                  in_batch + (in_h_idx * in_width + in_w_idx) * channel + c;
+              const int8_t *k_ptr =
+                  filter + (kh * k_width + kw) * channel + c;
+              sum0 += (in_ptr[0] + input_offset) * k_ptr[0];
+              sum1 += (in_ptr[1] + input_offset) * k_ptr[1];
+              sum2 += (in_ptr[2] + input_offset) * k_ptr[2];
+              sum3 += (in_ptr[3] + input_offset) * k_ptr[3];
+            }  // filter width
+          }  // filter height
+          out_ptr[c] = RequantizeInt8(sum0, multiplier, shift, output_offset);
+          out_ptr[c + 1] =
+              RequantizeInt8(sum1, multiplier, shift, output_offset);
+          out_ptr[c + 2] =
+              RequantizeInt8(sum2, multiplier, shift, output_offset);
+          out_ptr[c + 3] =
+              RequantizeInt8(sum3, multiplier, shift, output_offset);
+        }
+        for (; c < channel; ++c) {
+          int32_t sum0 = bias != NULL ? bias[c] : 0;
+          for (int32_t kh = 0; kh < k_height; ++kh) {
+            const int32_t in_h_idx = in_h + kh * dilations_[0];
+            if (in_h_idx < 0 || in_h_idx >= in_height) {
+              continue;
+            }
+            for (int32_t kw = 0; kw < k_width; ++kw) {
+              const int32_t in_w_idx = in_w + kw * dilations_[1];
+              if (in_w_idx < 0 || in_w_idx >= in_width) {
+                continue;
+              }
+              const int32_t in_idx =
+                  (in_h_idx * in_width + in_w_idx) * channel + c;
+              const int32_t k_idx = (kh * k_width + kw) * channel + c;
+              sum0 += (in_batch[in_idx] + input_offset) * filter[k_idx];
+            }  // filter width
+          }  // filter height
+          out_ptr[c] = RequantizeInt8(sum0, multiplier, shift, output_offset);
+        }  // channel
+      }  // output width
+    }  // output height
+  }  // output batch
+
+  return MACE_SUCCESS;
+}
+
+MaceStatus DepthwiseConv2dInt8Op::Run() {
+  int32_t output_dims[4] = {0};
+  InitPaddingAndOutputSize(input_dims_, filter_dims_, FLOOR, output_dims);
+  output_dims[3] *= input_dims_[3];
+  ResizeOutputShape(0, 4, output_dims);
+
+  MACE_RETURN_IF_ERROR(Compute(output_dims));
+
+  return MACE_SUCCESS;
+}
+
+}  // namespace ops
+}  // namespace micro
@@ -152,6 +152,8 @@ MaceStatus DepthwiseConv2dKB1S4Op::Compute(int32_t (&output_dims)[4]) {
         output_[out_base + c_offset] = output[kc_offset + i];
       }
     }
+    MACE_RETURN_IF_ERROR(activation_.Compute(
+        output_ + width_base[0], bias_, 4, channel, output_ + width_base[0]));
   }  // output size
 
   return MACE_SUCCESS;
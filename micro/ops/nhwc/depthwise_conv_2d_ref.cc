@@ -69,6 +69,8 @@ MaceStatus DepthwiseConv2dRefOp::Compute(int32_t (&output_dims)[4]) {
           }  // filter height
           output_[o_idx] = output;
         }  // filter batch, output channel
+        MACE_RETURN_IF_ERROR(activation_.Compute(
+            output_ + width_base, bias_, 1, channel, output_ + width_base));
       }  // output width
     }  // output height
   }  // output batch
@@ -0,0 +1,173 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "micro/ops/nhwc/pooling_int8.h"
+
+#include "micro/base/logging.h"
+#include "micro/base/utils.h"
+#include "micro/include/utils/macros.h"
+
+namespace micro {
+namespace ops {
+
+namespace {
+// CMSIS-NN divides with the midpoint rounded away from zero
+int8_t DivideRound(const int32_t sum, const int32_t count) {
+  const int32_t half_count = count / 2;
+  const int32_t result =
+      (sum > 0 ? sum + half_count : sum - half_count) / count;
+  return static_cast<int8_t>(base::clamp<int32_t>(result, -128, 127));
+}
+}  // namespace
+
+// Like arm_max_pool_s8 and arm_avgpool_s8, the window is clipped to the
+// input and the dilation is not taken.
+void PoolingInt8Op::MaxPooling(const mifloat *input,
+                               const int32_t *filter_hw,
+                               const int32_t *stride_hw,
+                               const int32_t *dilation_hw,
+                               const int32_t *pad_hw) {
+  MACE_UNUSED(dilation_hw);
+  const int32_t batch = output_dims_[0];
+  const int32_t out_height = output_dims_[1];
+  const int32_t out_width = output_dims_[2];
+  const int32_t channels = input_dims_[3];
+  const int32_t in_height = input_dims_[1];
+  const int32_t in_width = input_dims_[2];
+
+  const int8_t *input_data = reinterpret_cast<const int8_t *>(input);
+  int8_t *output_data = reinterpret_cast<int8_t *>(output_);
+  for (int32_t b = 0; b < batch; ++b) {
+    const int8_t *in_batch = input_data + b * in_height * in_width * channels;
+    for (int32_t h = 0; h < out_height; ++h) {
+      const int32_t inh_addr = h * stride_hw[0] - pad_hw[0];
+      const int32_t fh_begin = base::max<int32_t>(0, -inh_addr);
+      const int32_t fh_end =
+          base::min<int32_t>(filter_hw[0], in_height - inh_addr);
+      for (int32_t w = 0; w < out_width; ++w) {
+        const int32_t inw_addr = w * stride_hw[1] - pad_hw[1];
+        const int32_t fw_begin = base::max<int32_t>(0, -inw_addr);
+        const int32_t fw_end =
+            base::min<int32_t>(filter_hw[1], in_width - inw_addr);
+        int8_t *out_ptr =
+            output_data + ((b * out_height + h) * out_width + w) * channels;
+        int32_t c = 0;
+        for (; c + 3 < channels; c += 4) {
+          int8_t max0 = -128;
+          int8_t max1 = -128;
+          int8_t max2 = -128;
+          int8_t max3 = -128;
+          for (int32_t fh = fh_begin; fh < fh_end; ++fh) {
+            const int8_t *in_row =
+                in_batch + ((inh_addr + fh) * in_width + inw_addr) * channels;
+            for (int32_t fw = fw_begin; fw < fw_end; ++fw) {
+              const int8_t *in_ptr = in_row + fw * channels + c;
+              max0 = base::max(max0, in_ptr[0]);
+              max1 = base::max(max1, in_ptr[1]);
+              max2 = base::max(max2, in_ptr[2]);
+              max3 = base::max(max3, in_ptr[3]);
+            }
+          }
+          out_ptr[c] = max0;
+          out_ptr[c + 1] = max1;
+          out_ptr[c + 2] = max2;
+          out_ptr[c + 3] = max3;
+        }
+        for (; c < channels; ++c) {
+          int8_t max0 = -128;
+          for (int32_t fh = fh_begin; fh < fh_end; ++fh) {
+            const int8_t *in_row =
+                in_batch + ((inh_addr + fh) * in_width + inw_addr) * channels;
+            for (int32_t fw = fw_begin; fw < fw_end; ++fw) {
+              max0 = base::max(max0, in_row[fw * channels + c]);
+            }
+          }
+          out_ptr[c] = max0;
+        }
+      }
+    }
+  }
+}
+
+void PoolingInt8Op::AvgPooling(const mifloat *input,
+                               const int32_t *filter_hw,
+                               const int32_t *stride_hw,
+                               const int32_t *dilation_hw,
+                               const int32_t *pad_hw) {
+  MACE_UNUSED(dilation_hw);
+  const int32_t batch = output_dims_[0];
+  const int32_t out_height = output_dims_[1];
+  const int32_t out_width = output_dims_[2];
+  const int32_t channels = input_dims_[3];
+  const int32_t in_height = input_dims_[1];
+  const int32_t in_width = input_dims_[2];
+
+  const int8_t *input_data = reinterpret_cast<const int8_t *>(input);
+  int8_t *output_data = reinterpret_cast<int8_t *>(output_);
+  for (int32_t b = 0; b < batch; ++b) {
+    const int8_t *in_batch = input_data + b * in_height * in_width * channels;
+    for (int32_t h = 0; h < out_height; ++h) {
+      const int32_t inh_addr = h * stride_hw[0] - pad_hw[0];
+      const int32_t fh_begin = base::max<int32_t>(0, -inh_addr);
+      const int32_t fh_end =
+          base::min<int32_t>(filter_hw[0], in_height - inh_addr);
+      for (int32_t w = 0; w < out_width; ++w) {
+        const int32_t inw_addr = w * stride_hw[1] - pad_hw[1];
+        const int32_t fw_begin = base::max<int32_t>(0, -inw_addr);
+        const int32_t fw_end =
+            base::min<int32_t>(filter_hw[1], in_width - inw_addr);
+        const int32_t count = base::max<int32_t>(
+            (fh_end - fh_begin) * (fw_end - fw_begin), 1);
+        int8_t *out_ptr =
+            output_data + ((b * out_height + h) * out_width + w) * channels;
+        int32_t c = 0;
+        for (; c + 3 < channels; c += 4) {
+          int32_t sum0 = 0;
+          int32_t sum1 = 0;
+          int32_t sum2 = 0;
+          int32_t sum3 = 0;
+          for (int32_t fh = fh_begin; fh < fh_end; ++fh) {
+            const int8_t *in_row =
+                in_batch + ((inh_addr + fh) * in_width + inw_addr) * channels;
+            for (int32_t fw = fw_begin; fw < fw_end; ++fw) {
+              const int8_t *in_ptr = in_row + fw * channels + c;
+              sum0 += in_ptr[0];
+              sum1 += in_ptr[1];
+              sum2 += in_ptr[2];
+              sum3 += in_ptr[3];
+            }
+          }
+          out_ptr[c] = DivideRound(sum0, count);
+          out_ptr[c + 1] = DivideRound(sum1, count);
+          out_ptr[c + 2] = DivideRound(sum2, count);
+          out_ptr[c + 3] = DivideRound(sum3, count);
+        }
+        for (; c < channels; ++c) {
+          int32_t sum0 = 0;
+          for (int32_t fh = fh_begin; fh < fh_end; ++fh) {
+            const int8_t *in_row =
+                in_batch + ((inh_addr + fh) * in_width + inw_addr) * channels;
+            for (int32_t fw = fw_begin; fw < fw_end; ++fw) {
+              sum0 += in_row[fw * channels + c];
+            }
+          }
+          out_ptr[c] = DivideRound(sum0, count);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace ops
+}  // namespace micro
@@ -12,7 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "micro/ops/cmsis_nn/quantize.h"
+#include "micro/ops/quantize.h"
 
 #include <cmath>
 #include "micro/base/logging.h"
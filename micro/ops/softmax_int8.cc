@@ -0,0 +1,171 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "micro/ops/softmax_int8.h"
+
+#include "micro/base/logging.h"
+#include "micro/base/utils.h"
+#include "micro/framework/op_context.h"
+#include "micro/model/net_def.h"
+#include "micro/ops/utils/requantize.h"
+
+namespace micro {
+namespace ops {
+
+namespace {
+// The exp(x) on x <= 0 of arm_nn_exp_on_negative_values, x in Q5.26
+int32_t ExpOnNegativeValues(const int32_t value) {
+  const int32_t value_mod_minus_quarter =
+      (value & ((1 << 24) - 1)) - (1 << 24);
+  const int32_t remainder = value_mod_minus_quarter - value;
+  const int32_t x = static_cast<int32_t>(
+      static_cast<uint32_t>(value_mod_minus_quarter) << 5) + (1 << 28);
+  const int32_t x2 = DoublingHighMult(x, x);
+
+  int32_t result = 1895147668 + DoublingHighMult(
+      1895147668, x + DivideByPowerOfTwo(
+          DoublingHighMult(
+              DivideByPowerOfTwo(DoublingHighMult(x2, x2), 2) +
+                  DoublingHighMult(x2, x), 715827883) + x2, 1));
+
+  static const int32_t kMultipliers[7] = {
+      1672461947, 1302514674, 790015084, 290630308, 39332535, 720401, 242
+  };
+  for (int32_t i = 0; i < 7; ++i) {
+    if (remainder & (1 << (24 + i))) {
+      result = DoublingHighMult(result, kMultipliers[i]);
+    }
+  }
+  return value == 0 ? 0x7fffffff : result;
+}
+
+// The 1 / (1 + x) on x in [0, 1) of arm_nn_one_over_one_plus_x_for_x_in_0_1
+int32_t OneOverOnePlusX(const int32_t value) {
+  const int64_t sum = static_cast<int64_t>(value) + 0x7fffffff;
+  const int32_t half_denominator =
+      static_cast<int32_t>((sum + (sum >= 0 ? 1 : -1)) / 2);
+  int32_t x = 1515870810 + DoublingHighMult(half_denominator, -1010580540);
+
+  const int32_t one = 1 << 29;
+  for (int32_t i = 0; i < 3; ++i) {
+    x += MultByPowerOfTwo(
+        DoublingHighMult(x, one - DoublingHighMult(half_denominator, x)), 2);
+  }
+  return MultByPowerOfTwo(x, 1);
+}
+
+int32_t CountLeadingZeros(const uint32_t value) {
+  int32_t count = 0;
+  while (count < 32 && (value & (0x80000000u >> count)) == 0) {
+    ++count;
+  }
+  return count;
+}
+}  // namespace
+
+MaceStatus SoftmaxInt8Op::OnInit() {
+  data_format_ = static_cast<DataFormat>(
+      GetArgByName("data_format", static_cast<int32_t>(NHWC)));
+  input_ = GetInputData<mifloat>(INPUT);
+  input_dims_ = GetInputShapeDims(INPUT);
+  input_dim_size_ = GetInputShapeDimSize(INPUT);
+  MACE_ASSERT(input_dim_size_ >= 1);
+
+  output_ = GetOutputData<mifloat>(OUTPUT);
+
+  bool use_log = GetArgByName("use_log", false);
+  MACE_ASSERT1(!use_log, "The argument \"use_log\" is unsupported");
+
+  return MACE_SUCCESS;
+}
+
+MaceStatus SoftmaxInt8Op::Run() {
+  MACE_RETURN_IF_ERROR(ResizeOutputShape(OUTPUT, input_dim_size_, input_dims_));
+  // TODO(ZhangZhimin): Workarounds for AUTO data format
+  if (NHWC == data_format_ || AUTO == data_format_) {  // NHWC
+    return RunForNHWC();
+  } else {
+    MACE_NOT_IMPLEMENTED;
+    return MACE_UNSUPPORTED;
+  }
+}
+
+// The steps and constants of arm_softmax_s8, accumulating in Q19.12
+MaceStatus SoftmaxInt8Op::RunForNHWC() {
+  const int32_t class_size = input_dims_[input_dim_size_ - 1];
+  const int32_t num_rows =
+      base::GetShapeSize(input_dim_size_, input_dims_) / class_size;
+
+  const int8_t *input_data = reinterpret_cast<const int8_t *>(input_);
+  int8_t *output_data = reinterpret_cast<int8_t *>(output_);
+
+  QuantizeInfo input_quantize_info = GetInputQuantizeInfo(INPUT);
+
+  int kInputDeltaIntBits = 5;
+  int32_t scale_q = static_cast<int32_t>(
+      base::min(static_cast<double>(input_quantize_info.scale) *
+                    (1 << (31 - kInputDeltaIntBits)),
+                (1ll << 31) - 1.0));
+  int32_t mult;
+  int32_t shift;
+  QuantizeMultiplier(scale_q, &mult, &shift);
+  const int32_t diff_min = -128;
+  const int32_t kAccumBits = 12;
+  const uint32_t mask = 1u << shift;
+
+  for (int32_t r = 0; r < num_rows; ++r) {
+    const int8_t *input = input_data + r * class_size;
+    int8_t *output = output_data + r * class_size;
+    int8_t max = input[0];
+    for (int32_t c = 1; c < class_size; ++c) {
+      max = base::max(max, input[c]);
+    }
+
+    int32_t sum = 0;
+    for (int32_t c = 0; c < class_size; ++c) {
+      const int32_t diff = input[c] - max;
+      if (diff >= diff_min) {
+        const int32_t scaled_diff = DoublingHighMult(
+            static_cast<int32_t>(static_cast<uint32_t>(diff) * mask), mult);
+        sum += DivideByPowerOfTwo(ExpOnNegativeValues(scaled_diff),
+                                  kAccumBits);
+      }
+    }
+
+    const int32_t headroom = CountLeadingZeros(static_cast<uint32_t>(sum));
+    const int32_t bits_over_unit = kAccumBits - headroom + 23;
+    const int32_t shifted_scale = OneOverOnePlusX(static_cast<int32_t>(
+        (static_cast<uint32_t>(sum) << headroom) - 0x80000000u));
+
+    for (int32_t c = 0; c < class_size; ++c) {
+      const int32_t diff = input[c] - max;
+      if (diff >= diff_min) {
+        const int32_t scaled_diff = DoublingHighMult(
+            static_cast<int32_t>(static_cast<uint32_t>(diff) * mask), mult);
+        const int32_t result = DivideByPowerOfTwo(
+            DoublingHighMult(shifted_scale, ExpOnNegativeValues(scaled_diff)),
+            bits_over_unit) - 128;
+        output[c] = static_cast<int8_t>(
+            base::clamp<int32_t>(result, -128, 127));
+      } else {
+        output[c] = -128;
+      }
+    }
+  }
+
+  return MACE_SUCCESS;
+}
+
+}  // namespace ops
+}  // namespace micro
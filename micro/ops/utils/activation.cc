@@ -100,6 +100,25 @@ MaceStatus Activation::Compute(const mifloat *input_ptr,
   return MACE_SUCCESS;
 }
 
+MaceStatus Activation::Compute(const mifloat *input_ptr,
+                               const mifloat *bias_ptr,
+                               const int32_t outer_size, const int32_t channel,
+                               mifloat *output_ptr) {
+  const int32_t size = outer_size * channel;
+  if (bias_ptr != NULL) {
+    for (int32_t i = 0; i < outer_size; ++i) {
+      const int32_t outer_base = i * channel;
+      for (int32_t c = 0; c < channel; ++c) {
+        const int32_t idx = outer_base + c;
+        output_ptr[idx] = input_ptr[idx] + bias_ptr[c];
+      }
+    }
+    input_ptr = output_ptr;
+  }
+
+  return Compute(input_ptr, size, output_ptr);
+}
+
 ActivationType Activation::StringToActivationType(const char *type) {
   if (base::strcmp(type, "RELU") == 0) {
     return RELU;
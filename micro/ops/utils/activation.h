@@ -47,6 +47,12 @@ class Activation {
                   const float activation_coefficient);
   MaceStatus Compute(const mifloat *input_ptr,
                      const int32_t size, mifloat *output_ptr);
+  // Adds the per channel |bias_ptr| (if not NULL) to |outer_size| rows of
+  // |channel| values before the activation, so filter ops can finish each
+  // output tile while it is still hot instead of sweeping the whole output.
+  MaceStatus Compute(const mifloat *input_ptr, const mifloat *bias_ptr,
+                     const int32_t outer_size, const int32_t channel,
+                     mifloat *output_ptr);
   ActivationType GetActivationType();
 
  private:
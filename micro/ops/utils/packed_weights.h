@@ -0,0 +1,67 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MICRO_OPS_UTILS_PACKED_WEIGHTS_H_
+#define MICRO_OPS_UTILS_PACKED_WEIGHTS_H_
+
+#include "micro/base/types.h"
+
+namespace micro {
+namespace ops {
+
+// The int8 ops take weights of 4 or 2 bits by the "weight_bits" argument.
+// Each weight row, the values of one output channel, is packed on its own
+// into GetPackedRowBytes bytes, the first value in the lowest bits of the
+// first byte. The values are two's complement.
+inline int32_t GetPackedRowBytes(const int32_t size, const int32_t bits) {
+  return (size * bits + 7) / 8;
+}
+
+template<int32_t kBits>
+inline int32_t UnpackWeight(const uint8_t byte, const int32_t idx) {
+  return static_cast<int8_t>(
+      static_cast<uint8_t>(byte << (8 - kBits * (idx + 1)))) >> (8 - kBits);
+}
+
+// Sums (input[i] + input_offset) * row[begin + i] for i in [0, size),
+// unpacking a byte of weights at a time
+template<int32_t kBits>
+int32_t PackedDot(const int8_t *input, const int32_t input_offset,
+                  const uint8_t *row, const int32_t begin,
+                  const int32_t size) {
+  const int32_t kValuesPerByte = 8 / kBits;
+  int32_t sum = 0;
+  int32_t i = 0;
+  for (; i < size && (begin + i) % kValuesPerByte != 0; ++i) {
+    const int32_t idx = begin + i;
+    sum += (input[i] + input_offset) * UnpackWeight<kBits>(
+        row[idx / kValuesPerByte], idx % kValuesPerByte);
+  }
+  const uint8_t *bytes = row + (begin + i) / kValuesPerByte;
+  for (; i + kValuesPerByte <= size; i += kValuesPerByte) {
+    const uint8_t byte = *bytes++;
+    for (int32_t j = 0; j < kValuesPerByte; ++j) {
+      sum += (input[i + j] + input_offset) * UnpackWeight<kBits>(byte, j);
+    }
+  }
+  for (int32_t j = 0; i < size; ++i, ++j) {
+    sum += (input[i] + input_offset) * UnpackWeight<kBits>(*bytes, j);
+  }
+  return sum;
+}
+
+}  // namespace ops
+}  // namespace micro
+
+#endif  // MICRO_OPS_UTILS_PACKED_WEIGHTS_H_
@@ -12,10 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "micro/ops/cmsis_nn/utilities.h"
+#include "micro/ops/utils/requantize.h"
 
 #include <math.h>
 
+namespace micro {
+namespace ops {
+
 void QuantizeMultiplier(double double_multiplier,
                         int32_t *quantized_multiplier,
                         int32_t *shift) {
@@ -38,3 +41,6 @@ void QuantizeMultiplier(double double_multiplier,
   }
   *quantized_multiplier = static_cast<int32_t>(q_fixed);
 }
+
+}  // namespace ops
+}  // namespace micro
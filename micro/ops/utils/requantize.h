@@ -0,0 +1,92 @@
+// Copyright 2020 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MICRO_OPS_UTILS_REQUANTIZE_H_
+#define MICRO_OPS_UTILS_REQUANTIZE_H_
+
+#include "micro/base/types.h"
+#include "micro/base/utils.h"
+
+namespace micro {
+namespace ops {
+
+void QuantizeMultiplier(double double_multiplier,
+                        int32_t *quantized_multiplier,
+                        int32_t *shift);
+
+// The fixed point helpers below follow CMSIS-NN (arm_nnsupportfunctions.h)
+// bit by bit, so the portable int8 ops produce the same bytes as the
+// arm_*_s8 kernels. The shifts wrap like the Cortex-M ones do.
+
+// Rounded high half of 2 * m1 * m2, saturating the only overflow case.
+inline int32_t DoublingHighMult(const int32_t m1, const int32_t m2) {
+  if (m1 == m2 && m1 == static_cast<int32_t>(0x80000000u)) {
+    return 0x7fffffff;
+  }
+  int64_t mult = ((m1 < 0) ^ (m2 < 0)) ? 1 - (1 << 30) : (1 << 30);
+  mult += static_cast<int64_t>(m1) * m2;
+  return static_cast<int32_t>(mult / (1ll << 31));
+}
+
+// Divides by 2^exponent, rounding the midpoint away from zero.
+inline int32_t DivideByPowerOfTwo(const int32_t dividend,
+                                  const int32_t exponent) {
+  const int32_t remainder_mask =
+      static_cast<int32_t>((1u << exponent) - 1u);
+  const int32_t remainder = remainder_mask & dividend;
+  int32_t result = dividend >> exponent;
+  int32_t threshold = remainder_mask >> 1;
+  if (result < 0) {
+    ++threshold;
+  }
+  if (remainder > threshold) {
+    ++result;
+  }
+  return result;
+}
+
+// Multiplies by 2^exponent, saturating to the int32 range.
+inline int32_t MultByPowerOfTwo(const int32_t value, const int32_t exponent) {
+  const int32_t threshold =
+      static_cast<int32_t>((1u << (31 - exponent)) - 1u);
+  if (value > threshold) {
+    return 0x7fffffff;
+  }
+  if (value < -threshold) {
+    return static_cast<int32_t>(0x80000000u);
+  }
+  return static_cast<int32_t>(static_cast<uint32_t>(value) << exponent);
+}
+
+// Scales an accumulator by the multiplier and shift of QuantizeMultiplier.
+inline int32_t Requantize(const int32_t value, const int32_t multiplier,
+                          const int32_t shift) {
+  const int32_t left_shift = shift > 0 ? shift : 0;
+  const int32_t right_shift = shift > 0 ? 0 : -shift;
+  const int32_t shifted =
+      static_cast<int32_t>(static_cast<uint32_t>(value) << left_shift);
+  return DivideByPowerOfTwo(DoublingHighMult(shifted, multiplier),
+                            right_shift);
+}
+
+inline int8_t RequantizeInt8(const int32_t value, const int32_t multiplier,
+                             const int32_t shift, const int32_t zero_point) {
+  const int32_t result = Requantize(value, multiplier, shift) + zero_point;
+  return static_cast<int8_t>(base::clamp<int32_t>(result, -128, 127));
+}
+
+}  // namespace ops
+}  // namespace micro
+
+#endif  // MICRO_OPS_UTILS_REQUANTIZE_H_
@@ -67,7 +67,8 @@ MaceStatus DepthwiseConv2dXtensaOp::Compute(int32_t (&output_dims)[4]) {
 
   MACE_ASSERT(re == 0);
 
-  return MACE_SUCCESS;
+  // nnlib has already added the bias
+  return activation_.Compute(output_, height * width * channel, output_);
 }
 
 }  // namespace ops
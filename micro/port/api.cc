@@ -23,6 +23,7 @@
 #include <HAP_farf.h>
 #else
 #include <sys/time.h>
+#include <time.h>
 #endif
 
 namespace micro {
@@ -51,6 +52,42 @@ int64_t NowMicros() {
 #endif
 }
 
+int64_t NowCycles() {
+#ifdef MACE_ENABLE_HEXAGON
+  return static_cast<int64_t>(HAP_perf_get_pcycles());
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) \
+    || defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_8_1M_MAIN__)
+  // The DWT cycle counter, it is enabled on the first call and extended
+  // to 64 bits, so it should be read at least once every 2^32 cycles
+  volatile uint32_t *demcr = reinterpret_cast<volatile uint32_t *>(0xE000EDFC);
+  volatile uint32_t *dwt_ctrl =
+      reinterpret_cast<volatile uint32_t *>(0xE0001000);
+  volatile uint32_t *dwt_cyccnt =
+      reinterpret_cast<volatile uint32_t *>(0xE0001004);
+  static uint32_t last_cycles = 0;
+  static int64_t high_cycles = 0;
+  if ((*dwt_ctrl & 1u) == 0) {
+    *demcr |= 0x01000000u;
+    *dwt_cyccnt = 0;
+    *dwt_ctrl |= 1u;
+    last_cycles = 0;
+  }
+  const uint32_t cycles = *dwt_cyccnt;
+  if (cycles < last_cycles) {
+    high_cycles += static_cast<int64_t>(1) << 32;
+  }
+  last_cycles = cycles;
+  return high_cycles + cycles;
+#elif __linux__
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+  // you should rewrite this file in the platform source file.
+  return -1;
+#endif
+}
+
 void Abort() {
   // you should rewrite this file in the platform source file.
   abort();
@@ -23,6 +23,9 @@ namespace api {
 
 void DebugLog(const char *str);
 int64_t NowMicros();
+// A fine grained timer for profiling the ops: the core cycles on Cortex-M
+// and Hexagon, the nanoseconds on Linux and -1 when there is none.
+int64_t NowCycles();
 void Abort();
 
 }  // api
@@ -16,6 +16,7 @@
 #include "micro/ops/gtest_utils.h"
 #include "micro/ops/matmul.h"
 #include "micro/ops/cmsis_nn/arm_mat_mul_int8.h"
+#include "micro/ops/matmul_int8.h"
 #include "micro/ops/substitute_op.h"
 #include "micro/ops/test_utils.h"
 #include "micro/ops/test_quantize_utils.h"
@@ -96,8 +97,6 @@ TEST_F(MatMulOpTest, SimpleCPU) {
   Simple2();
 }
 
-#ifdef MACE_MICRO_ENABLE_CMSIS
-
 namespace {
 
 void TestMatMulQuantInt8(int32_t lhs_rows, int32_t lhs_cols, int32_t rhs_cols) {
@@ -143,7 +142,7 @@ void TestMatMulQuantInt8(int32_t lhs_rows, int32_t lhs_cols, int32_t rhs_cols) {
   AdjustRangeInt8(expect_output, output_size, &output_quant_info.scale,
                   &output_quant_info.zero);
 
-  ArmMatMulInt8Op matmul_op_int8;
+  MatMulInt8Op matmul_op_int8;
   framework::SubstituteOp substitude_op_int8;
   substitude_op_int8.AddInput(input0_int8, input0_dims, 2, input_quant_info0)
       .AddInput(input1_int8, input1_dims, 2, input_quant_info1)
@@ -162,6 +161,23 @@ void TestMatMulQuantInt8(int32_t lhs_rows, int32_t lhs_cols, int32_t rhs_cols) {
   ExpectTensorSimilar(expect_output, expect_output_dims, expect_output_dim_size,
                       output, output_dims, output_dim_size, 0.1);
 
+#ifdef MACE_MICRO_ENABLE_CMSIS
+  if (lhs_rows == 1) {
+    // The CMSIS-NN op must produce the same bytes
+    int8_t *portable_output_int8 = new int8_t[output_size];
+    base::memcpy(portable_output_int8, output_int8, output_size);
+    ArmMatMulInt8Op arm_matmul_op_int8;
+    arm_matmul_op_int8.Init(
+        NULL, reinterpret_cast<framework::OpContext *>(&substitude_op_int8),
+        NULL);
+    arm_matmul_op_int8.Run();
+    ExpectTensorNear<int8_t>(portable_output_int8, output_dims,
+                             output_dim_size, output_int8, output_dims,
+                             output_dim_size);
+    delete[] portable_output_int8;
+  }
+#endif
+
   delete[] input0;
   delete[] input1;
   delete[] expect_output;
@@ -173,16 +189,97 @@ void TestMatMulQuantInt8(int32_t lhs_rows, int32_t lhs_cols, int32_t rhs_cols) {
   delete[] output_dims;
 }
 
+void TestMatMulPackedWeightsInt8(const int32_t weight_bits,
+                                 const int32_t lhs_rows,
+                                 const int32_t lhs_cols,
+                                 const int32_t rhs_cols) {
+  const uint32_t input0_size = lhs_rows * lhs_cols;
+  const uint32_t input1_size = lhs_cols * rhs_cols;
+  const uint32_t output_size = lhs_rows * rhs_cols;
+  float *input0 = new float[input0_size];
+  float *input1 = new float[input1_size];
+  FillNormalRandomInput(input0, input0_size);
+  FillNormalRandomInput(input1, input1_size);
+
+  int8_t *input0_int8 = new int8_t[input0_size];
+  int8_t *input1_int8 = new int8_t[input1_size];
+  uint8_t *input1_packed = new uint8_t[input1_size];
+  QuantizeInfo input_quant_info0;
+  QuantizeInfo input_quant_info1;
+  AutoQuantizeInt8(input0, input0_size, input0_int8, &input_quant_info0.scale,
+                   &input_quant_info0.zero);
+  AutoQuantizeInt8Symmetric(input1, input1_size, input1_int8,
+                            &input_quant_info1.scale);
+  PackWeightsInt8(input1_int8, rhs_cols, lhs_cols, weight_bits,
+                  &input_quant_info1.scale, input1_packed);
+  const QuantizeInfo output_quant_info = {0.1f, -2};
+
+  const int32_t input0_dims[2] = {lhs_rows, lhs_cols};
+  const int32_t input1_dims[2] = {rhs_cols, lhs_cols};
+
+  // The same weights unpacked give the expected bytes
+  const uint32_t MAX_OUTPUT_NUM = 10;
+  int8_t *expect_output = new int8_t[output_size];
+  int32_t *expect_output_dims = new int32_t[MAX_OUTPUT_NUM];
+  MatMulInt8Op matmul_op;
+  framework::SubstituteOp substitude_op;
+  substitude_op.AddInput(input0_int8, input0_dims, 2, input_quant_info0)
+      .AddInput(input1_int8, input1_dims, 2, input_quant_info1)
+      .AddArg("transpose_a", false)
+      .AddArg("transpose_b", true)
+      .AddOutput(expect_output, expect_output_dims, MAX_OUTPUT_NUM,
+                 output_quant_info);
+  matmul_op.Init(NULL, reinterpret_cast<framework::OpContext *>(&substitude_op),
+                 NULL);
+  matmul_op.Run();
+
+  int8_t *output = new int8_t[output_size];
+  int32_t *output_dims = new int32_t[MAX_OUTPUT_NUM];
+  MatMulInt8Op packed_matmul_op;
+  framework::SubstituteOp packed_substitude_op;
+  packed_substitude_op
+      .AddInput(input0_int8, input0_dims, 2, input_quant_info0)
+      .AddInput(input1_packed, input1_dims, 2, input_quant_info1)
+      .AddArg("transpose_a", false)
+      .AddArg("transpose_b", true)
+      .AddArg("weight_bits", weight_bits)
+      .AddOutput(output, output_dims, MAX_OUTPUT_NUM, output_quant_info);
+  packed_matmul_op.Init(
+      NULL, reinterpret_cast<framework::OpContext *>(&packed_substitude_op),
+      NULL);
+  packed_matmul_op.Run();
+
+  ExpectTensorNear<int8_t>(output, output_dims,
+                           packed_substitude_op.GetOutputShapeDimSize(0),
+                           expect_output, expect_output_dims,
+                           substitude_op.GetOutputShapeDimSize(0), 0, 0);
+
+  delete[] input0;
+  delete[] input1;
+  delete[] input0_int8;
+  delete[] input1_int8;
+  delete[] input1_packed;
+  delete[] expect_output;
+  delete[] expect_output_dims;
+  delete[] output;
+  delete[] output_dims;
+}
+
 }  // namespace
 
 TEST_F(MatMulOpTest, QuantInt8) {
   TestMatMulQuantInt8(1, 8, 4);
   TestMatMulQuantInt8(1, 1001, 63);
-  // WARNING(ZhangZhimin): Batch inputs is unsupported
-  // TestMatMulQuantInt8(3, 100, 100);
+  // More than one lhs row is unsupported by CMSIS-NN
+  TestMatMulQuantInt8(3, 100, 100);
 }
 
-#endif
+TEST_F(MatMulOpTest, PackedWeightsInt8) {
+  TestMatMulPackedWeightsInt8(4, 1, 8, 4);
+  TestMatMulPackedWeightsInt8(4, 3, 101, 17);
+  TestMatMulPackedWeightsInt8(2, 1, 1001, 63);
+  TestMatMulPackedWeightsInt8(2, 2, 7, 5);
+}
 
 }  // namespace test
 }  // namespace ops
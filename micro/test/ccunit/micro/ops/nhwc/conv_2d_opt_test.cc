@@ -17,6 +17,7 @@
 #include "micro/ops/nhwc/conv_2d_c2_s4.h"
 #include "micro/ops/nhwc/conv_2d_c3_s4.h"
 #include "micro/ops/nhwc/conv_2d_c4_s4.h"
+#include "micro/ops/nhwc/conv_2d_ref.h"
 #include "micro/ops/substitute_op.h"
 #include "micro/ops/test_utils.h"
 
@@ -76,6 +77,58 @@ void TestNHWCMulti3x3SAME() {
   ExpectTensorNear<float>(output, output_dims, 4, expect, expect_dims, 4, 1e-5);
 }
 
+void TestFusedNHWCMulti3x3SAME() {
+  float input[18] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+  int32_t input_dims[4] = {1, 3, 3, 2};
+  float filter[72] = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+                      1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+                      1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+                      1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+                      1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+                      1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+                      1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+                      1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+  int32_t filter_dims[4] = {4, 3, 3, 2};
+  float bias[4] = {0.1f, -10.0f, 0.1f, -10.0f};
+  int32_t bias_dims[1] = {4};
+
+  // The last tile overlaps the previous one, the bias must be added once
+  float output[36] = {0};
+  int32_t output_dims[4] = {0};
+  float expect[36] = {8.1f, 0.0f, 8.1f, 0.0f,
+                      10.0f, 2.0f, 10.0f, 2.0f,
+                      8.1f, 0.0f, 8.1f, 0.0f,
+                      10.0f, 2.0f, 10.0f, 2.0f,
+                      10.0f, 8.0f, 10.0f, 8.0f,
+                      10.0f, 2.0f, 10.0f, 2.0f,
+                      8.1f, 0.0f, 8.1f, 0.0f,
+                      10.0f, 2.0f, 10.0f, 2.0f,
+                      8.1f, 0.0f, 8.1f, 0.0f};
+  int32_t expect_dims[4] = {1, 3, 3, 4};
+
+  const int32_t strides[] = {1, 1};
+  const int32_t dilations[] = {1, 1};
+  const char activation[] = "RELUX";
+
+  Conv2dC4S4Op conv_2d_op;
+  framework::SubstituteOp substitude_op;
+  substitude_op.AddInput(input, input_dims, 4)
+      .AddInput(filter, filter_dims, 4)
+      .AddInput(bias, bias_dims, 1)
+      .AddRepeatArg("strides", strides, sizeof(strides) / sizeof(int32_t))
+      .AddArg("padding", Padding::SAME)
+      .AddRepeatArg("dilations", dilations, sizeof(dilations) / sizeof(int32_t))
+      .AddRepeatArg("activation", activation, sizeof(activation))
+      .AddArg("max_limit", 10.0f)
+      .AddOutput(output, output_dims, 4);
+
+  conv_2d_op.Init(NULL, reinterpret_cast<framework::OpContext *>(
+      &substitude_op), NULL);
+  conv_2d_op.Run();
+
+  ExpectTensorNear<float>(output, output_dims, 4, expect, expect_dims, 4, 1e-5);
+}
+
 void TestNHWCMulti3x3NeqStride() {
   float input[18] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
   int32_t input_dims[4] = {1, 3, 3, 2};
@@ -240,12 +293,101 @@ void TestConv1x1() {
   ExpectTensorNear<float>(output, output_dims, 4, expect, expect_dims, 4, 1e-5);
 }
 
+// Runs the op row by row, reading each row's input rows from a window the
+// way Graph::RunRowChain does, and compares the rows with a whole run
+template<typename OP>
+void TestRunRows(const int32_t stride, const int32_t dilation,
+                 const Padding padding) {
+  const int32_t kInHeight = 9;
+  const int32_t kInWidth = 8;
+  const int32_t kInChannel = 3;
+  const int32_t kOutChannel = 4;
+  float input[kInHeight * kInWidth * kInChannel] = {0};
+  int32_t input_dims[4] = {1, kInHeight, kInWidth, kInChannel};
+  FillNormalRandomInput(input, kInHeight * kInWidth * kInChannel);
+  float filter[kOutChannel * 3 * 3 * kInChannel] = {0};
+  int32_t filter_dims[4] = {kOutChannel, 3, 3, kInChannel};
+  FillNormalRandomInput(filter, kOutChannel * 3 * 3 * kInChannel);
+  float bias[kOutChannel] = {0.1f, -0.2f, 0.3f, -0.4f};
+  int32_t bias_dims[1] = {kOutChannel};
+  const char activation[] = "RELU";
+
+  const int32_t strides[] = {stride, stride};
+  const int32_t dilations[] = {dilation, dilation};
+
+  float expect[kInHeight * kInWidth * kOutChannel] = {0};
+  int32_t expect_dims[4] = {0};
+  OP conv_2d_op;
+  framework::SubstituteOp substitude_op;
+  substitude_op.AddInput(input, input_dims, 4)
+      .AddInput(filter, filter_dims, 4)
+      .AddInput(bias, bias_dims, 1)
+      .AddRepeatArg("strides", strides, sizeof(strides) / sizeof(int32_t))
+      .AddArg("padding", padding)
+      .AddRepeatArg("dilations", dilations, sizeof(dilations) / sizeof(int32_t))
+      .AddRepeatArg("activation", activation, sizeof(activation))
+      .AddOutput(expect, expect_dims, 4);
+  conv_2d_op.Init(NULL, reinterpret_cast<framework::OpContext *>(
+      &substitude_op), NULL);
+  conv_2d_op.Run();
+
+  const int32_t input_row_size = kInWidth * kInChannel * sizeof(float);
+  const int32_t row_buffer[3] = {
+      0, input_row_size, expect_dims[2] * kOutChannel *
+          static_cast<int32_t>(sizeof(float))
+  };
+  float output[kInHeight * kInWidth * kOutChannel] = {0};
+  int32_t output_dims[4] = {0};
+  base::memcpy(output_dims, expect_dims, sizeof(output_dims));
+  OP rows_op;
+  framework::SubstituteOp rows_substitude_op;
+  rows_substitude_op.AddInput(input, input_dims, 4)
+      .AddInput(filter, filter_dims, 4)
+      .AddInput(bias, bias_dims, 1)
+      .AddRepeatArg("strides", strides, sizeof(strides) / sizeof(int32_t))
+      .AddArg("padding", padding)
+      .AddRepeatArg("dilations", dilations, sizeof(dilations) / sizeof(int32_t))
+      .AddRepeatArg("activation", activation, sizeof(activation))
+      .AddRepeatArg("row_buffer", row_buffer, 3)
+      .AddOutput(output, output_dims, 4);
+  rows_op.Init(NULL, reinterpret_cast<framework::OpContext *>(
+      &rows_substitude_op), NULL);
+
+  float window[5 * kInWidth * kInChannel] = {0};
+  for (int32_t row = 0; row < expect_dims[1]; ++row) {
+    int32_t input_begin = 0;
+    int32_t input_end = 0;
+    rows_op.GetInputRows(row, row + 1, &input_begin, &input_end);
+    ASSERT_LE(input_end - input_begin, 5);
+    if (input_end > input_begin) {
+      base::memcpy(window, input + input_begin * kInWidth * kInChannel,
+                   (input_end - input_begin) * input_row_size);
+    }
+    rows_op.RunRows(window, input_begin, NULL, 0, row, row + 1);
+  }
+
+  ExpectTensorNear<float>(output, output_dims, 4, expect, expect_dims, 4, 1e-5);
+}
+
 }  // namespace
 
 TEST_F(Conv2dOptOpTest, TestConv2dMultiSAME) {
   TestNHWCMulti3x3SAME();
 }
 
+TEST_F(Conv2dOptOpTest, FusedMultiSAME) {
+  TestFusedNHWCMulti3x3SAME();
+}
+
+TEST_F(Conv2dOptOpTest, RunRows) {
+  TestRunRows<Conv2dRefOp>(1, 1, Padding::SAME);
+  TestRunRows<Conv2dRefOp>(2, 1, Padding::SAME);
+  TestRunRows<Conv2dRefOp>(1, 2, Padding::VALID);
+  TestRunRows<Conv2dC4S4Op>(1, 1, Padding::SAME);
+  TestRunRows<Conv2dC4S4Op>(2, 1, Padding::SAME);
+  TestRunRows<Conv2dC4S4Op>(1, 2, Padding::SAME);
+}
+
 TEST_F(Conv2dOptOpTest, CPUStride2) {
   TestNHWCCombined3x3();
 }
@@ -16,6 +16,7 @@
 #include "micro/ops/gtest_utils.h"
 #include "micro/ops/nhwc/conv_2d_ref.h"
 #include "micro/ops/cmsis_nn/arm_conv_2d_int8.h"
+#include "micro/ops/nhwc/conv_2d_int8.h"
 #include "micro/ops/substitute_op.h"
 #include "micro/ops/test_utils.h"
 #include "micro/ops/test_quantize_utils.h"
@@ -317,8 +318,6 @@ TEST_F(Conv2dOpTest, CPUConv1x1) {
   TestConv1x1();
 }
 
-#ifdef MACE_MICRO_ENABLE_CMSIS
-
 namespace {
 
 void TestConv2dQuantInt8(const int32_t batch,
@@ -392,7 +391,7 @@ void TestConv2dQuantInt8(const int32_t batch,
   float bias_scale = input_quant_info0.scale * input_quant_info1.scale;
   QuantizeWithScaleAndZeropoint(bias, bias_size, bias_scale, 0, bias_int32);
 
-  ArmConv2dInt8Op conv2d_op_int8;
+  Conv2dInt8Op conv2d_op_int8;
   framework::SubstituteOp substitude_op_int8;
   substitude_op_int8.AddInput(input0_int8, input0_dims, 4, input_quant_info0)
       .AddInput(input1_int8, input1_dims, 4, input_quant_info1)
@@ -414,6 +413,23 @@ void TestConv2dQuantInt8(const int32_t batch,
   ExpectTensorSimilar(expect_output, expect_output_dims, expect_output_dim_size,
                       output, output_dims, output_dim_size, 0.1);
 
+#ifdef MACE_MICRO_ENABLE_CMSIS
+  if (batch == 1 && dilation_height == 1 && dilation_width == 1) {
+    // The CMSIS-NN op must produce the same bytes
+    int8_t *portable_output_int8 = new int8_t[output_size];
+    base::memcpy(portable_output_int8, output_int8, output_size);
+    ArmConv2dInt8Op arm_conv2d_op_int8;
+    arm_conv2d_op_int8.Init(
+        NULL, reinterpret_cast<framework::OpContext *>(&substitude_op_int8),
+        NULL);
+    arm_conv2d_op_int8.Run();
+    ExpectTensorNear<int8_t>(portable_output_int8, output_dims,
+                             output_dim_size, output_int8, output_dims,
+                             output_dim_size);
+    delete[] portable_output_int8;
+  }
+#endif
+
   delete[] input0;
   delete[] input1;
   delete[] bias;
@@ -427,6 +443,105 @@ void TestConv2dQuantInt8(const int32_t batch,
   delete[] output_dims;
 }
 
+void TestConv2dPackedWeightsInt8(const int32_t weight_bits,
+                                 const int32_t out_channels,
+                                 const int32_t in_channels,
+                                 const int32_t in_height,
+                                 const int32_t in_width,
+                                 const int32_t kernel_height,
+                                 const int32_t kernel_width,
+                                 enum Padding padding_type,
+                                 const int32_t stride) {
+  const uint32_t input0_size = in_height * in_width * in_channels;
+  const int32_t k_batch_size = kernel_height * kernel_width * in_channels;
+  const uint32_t input1_size = out_channels * k_batch_size;
+  const uint32_t max_output_size = out_channels *
+      (in_height + kernel_height) * (in_width + kernel_width);
+  float *input0 = new float[input0_size];
+  float *input1 = new float[input1_size];
+  float *bias = new float[out_channels];
+  FillNormalRandomInput(input0, input0_size);
+  FillNormalRandomInput(input1, input1_size);
+  FillNormalRandomInput(bias, out_channels);
+
+  int8_t *input0_int8 = new int8_t[input0_size];
+  int8_t *input1_int8 = new int8_t[input1_size];
+  uint8_t *input1_packed = new uint8_t[input1_size];
+  int32_t *bias_int32 = new int32_t[out_channels];
+  QuantizeInfo input_quant_info0;
+  QuantizeInfo input_quant_info1;
+  AutoQuantizeInt8(input0, input0_size, input0_int8, &input_quant_info0.scale,
+                   &input_quant_info0.zero);
+  AutoQuantizeInt8Symmetric(input1, input1_size, input1_int8,
+                            &input_quant_info1.scale);
+  PackWeightsInt8(input1_int8, out_channels, k_batch_size, weight_bits,
+                  &input_quant_info1.scale, input1_packed);
+  QuantizeWithScaleAndZeropoint(
+      bias, out_channels, input_quant_info0.scale * input_quant_info1.scale,
+      0, bias_int32);
+  const QuantizeInfo output_quant_info = {0.05f, 3};
+
+  const int32_t input0_dims[4] = {1, in_height, in_width, in_channels};
+  const int32_t input1_dims[4] = {out_channels, kernel_height, kernel_width,
+                                  in_channels};
+  const int32_t bias_dims[1] = {out_channels};
+  const int32_t strides[2] = {stride, stride};
+  const int32_t dilations[2] = {1, 1};
+
+  // The same weights unpacked give the expected bytes
+  const uint32_t MAX_OUTPUT_NUM = 10;
+  int8_t *expect_output = new int8_t[max_output_size];
+  int32_t *expect_output_dims = new int32_t[MAX_OUTPUT_NUM];
+  Conv2dInt8Op conv2d_op;
+  framework::SubstituteOp substitude_op;
+  substitude_op.AddInput(input0_int8, input0_dims, 4, input_quant_info0)
+      .AddInput(input1_int8, input1_dims, 4, input_quant_info1)
+      .AddInput(bias_int32, bias_dims, 1)
+      .AddArg("padding", padding_type)
+      .AddRepeatArg("strides", strides, 2)
+      .AddRepeatArg("dilations", dilations, 2)
+      .AddOutput(expect_output, expect_output_dims, MAX_OUTPUT_NUM,
+                 output_quant_info);
+  conv2d_op.Init(NULL, reinterpret_cast<framework::OpContext *>(&substitude_op),
+                 NULL);
+  conv2d_op.Run();
+
+  int8_t *output = new int8_t[max_output_size];
+  int32_t *output_dims = new int32_t[MAX_OUTPUT_NUM];
+  Conv2dInt8Op packed_conv2d_op;
+  framework::SubstituteOp packed_substitude_op;
+  packed_substitude_op
+      .AddInput(input0_int8, input0_dims, 4, input_quant_info0)
+      .AddInput(input1_packed, input1_dims, 4, input_quant_info1)
+      .AddInput(bias_int32, bias_dims, 1)
+      .AddArg("padding", padding_type)
+      .AddArg("weight_bits", weight_bits)
+      .AddRepeatArg("strides", strides, 2)
+      .AddRepeatArg("dilations", dilations, 2)
+      .AddOutput(output, output_dims, MAX_OUTPUT_NUM, output_quant_info);
+  packed_conv2d_op.Init(
+      NULL, reinterpret_cast<framework::OpContext *>(&packed_substitude_op),
+      NULL);
+  packed_conv2d_op.Run();
+
+  ExpectTensorNear<int8_t>(output, output_dims,
+                           packed_substitude_op.GetOutputShapeDimSize(0),
+                           expect_output, expect_output_dims,
+                           substitude_op.GetOutputShapeDimSize(0), 0, 0);
+
+  delete[] input0;
+  delete[] input1;
+  delete[] bias;
+  delete[] input0_int8;
+  delete[] input1_int8;
+  delete[] input1_packed;
+  delete[] bias_int32;
+  delete[] expect_output;
+  delete[] expect_output_dims;
+  delete[] output;
+  delete[] output_dims;
+}
+
 }  // namespace
 
 TEST_F(Conv2dOpTest, QuantInt8) {
@@ -441,16 +556,23 @@ TEST_F(Conv2dOpTest, QuantInt8) {
   TestConv2dQuantInt8(1, 2, 1, 1000, 1000, 4, 3, FULL, 2, 1, 1, 1);
   TestConv2dQuantInt8(1, 128, 1, 1000, 1000, 4, 3, FULL, 2, 3, 1, 1);
 
-  // dilations is unsupported
-  // TestConv2dQuantInt8(1, 128, 64, 32, 32, 3, 3, SAME, 1, 1, 2, 2);
-  // TestConv2dQuantInt8(1, 128, 64, 32, 32, 3, 3, SAME, 1, 1, 2, 1);
+  // dilations are unsupported by CMSIS-NN
+  TestConv2dQuantInt8(1, 128, 64, 32, 32, 3, 3, SAME, 1, 1, 2, 2);
+  TestConv2dQuantInt8(1, 128, 64, 32, 32, 3, 3, SAME, 1, 1, 2, 1);
 
   // batch must be 1
   // TestConv2dQuantInt8(2, 128, 64, 32, 32, 3, 3, SAME, 1, 1, 1, 1);
   // TestConv2dQuantInt8(4, 128, 64, 32, 32, 3, 3, SAME, 1, 1, 1, 1);
 }
 
-#endif
+TEST_F(Conv2dOpTest, PackedWeightsInt8) {
+  TestConv2dPackedWeightsInt8(4, 16, 8, 12, 12, 3, 3, SAME, 1);
+  TestConv2dPackedWeightsInt8(4, 5, 3, 13, 11, 3, 3, VALID, 2);
+  TestConv2dPackedWeightsInt8(4, 7, 1, 9, 9, 5, 5, SAME, 1);
+  TestConv2dPackedWeightsInt8(2, 16, 8, 12, 12, 3, 3, SAME, 1);
+  TestConv2dPackedWeightsInt8(2, 5, 3, 13, 11, 3, 3, VALID, 2);
+  TestConv2dPackedWeightsInt8(2, 3, 7, 10, 10, 1, 1, SAME, 1);
+}
 
 }  // namespace test
 }  // namespace ops
@@ -224,6 +224,45 @@ void MultiKB5ValidTest() {
   ExpectTensorNear<float>(output, output_dims, 4, expect, expect_dims, 4, 1e-5);
 }
 
+void FusedMultiKB2SameTest() {
+  float input[9] = {1, 1, 1, 1, 1, 1, 1, 1, 1};
+  int32_t input_dims[4] = {1, 3, 3, 1};
+  float filter[18] = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+                      1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+  int32_t filter_dims[4] = {2, 3, 3, 1};
+  float bias[2] = {-5.0f, 0.5f};
+  int32_t bias_dims[1] = {2};
+
+  // The last tile overlaps the previous one, the bias must be added once
+  float output[18] = {0};
+  int32_t output_dims[4] = {0};
+  float expect[18] = {0.0f, 4.5f, 1.0f, 6.5f, 0.0f, 4.5f,
+                      1.0f, 6.5f, 4.0f, 9.5f, 1.0f, 6.5f,
+                      0.0f, 4.5f, 1.0f, 6.5f, 0.0f, 4.5f};
+  int32_t expect_dims[4] = {1, 3, 3, 2};
+
+  const int32_t strides[] = {1, 1};
+  const int32_t dilations[] = {1, 1};
+  const char activation[] = "RELU";
+
+  DepthwiseConv2dKB2S4Op depthwise_conv_2d_op;
+  framework::SubstituteOp substitude_op;
+  substitude_op.AddInput(input, input_dims, 4)
+      .AddInput(filter, filter_dims, 4)
+      .AddInput(bias, bias_dims, 1)
+      .AddRepeatArg("strides", strides, sizeof(strides) / sizeof(int32_t))
+      .AddArg("padding", Padding::SAME)
+      .AddRepeatArg("dilations", dilations, sizeof(dilations) / sizeof(int32_t))
+      .AddRepeatArg("activation", activation, sizeof(activation))
+      .AddOutput(output, output_dims, 4);
+
+  depthwise_conv_2d_op.Init(NULL, reinterpret_cast<framework::OpContext *>(
+      &substitude_op), NULL);
+  depthwise_conv_2d_op.Run();
+
+  ExpectTensorNear<float>(output, output_dims, 4, expect, expect_dims, 4, 1e-5);
+}
+
 }  // namespace
 
 TEST_F(DepthwiseConv2dOptOpTest, MultiKB1CPU) {
@@ -246,6 +285,10 @@ TEST_F(DepthwiseConv2dOptOpTest, MultiKB5CPU) {
   MultiKB5ValidTest();
 }
 
+TEST_F(DepthwiseConv2dOptOpTest, FusedMultiKB2CPU) {
+  FusedMultiKB2SameTest();
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace micro
@@ -16,6 +16,7 @@
 #include "micro/ops/gtest_utils.h"
 #include "micro/ops/nhwc/depthwise_conv_2d_ref.h"
 #include "micro/ops/cmsis_nn/arm_depthwise_conv_2d_int8.h"
+#include "micro/ops/nhwc/depthwise_conv_2d_int8.h"
 #include "micro/ops/substitute_op.h"
 #include "micro/ops/test_utils.h"
 #include "micro/ops/test_quantize_utils.h"
@@ -109,8 +110,6 @@ TEST_F(DepthwiseConv2dOpTest, MuiltiC2CPU) {
   MultiC2ValidTest();
 }
 
-#ifdef MACE_MICRO_ENABLE_CMSIS
-
 namespace {
 
 void TestDepthwiseConv2dQuantInt8(const int32_t batch,
@@ -184,7 +183,7 @@ void TestDepthwiseConv2dQuantInt8(const int32_t batch,
   float bias_scale = input_quant_info0.scale * input_quant_info1.scale;
   QuantizeWithScaleAndZeropoint(bias, bias_size, bias_scale, 0, bias_int32);
 
-  ArmDepthwiseConv2dInt8Op depthwise_conv2d_op_int8;
+  DepthwiseConv2dInt8Op depthwise_conv2d_op_int8;
   framework::SubstituteOp substitude_op_int8;
   substitude_op_int8.AddInput(input0_int8, input0_dims, 4, input_quant_info0)
       .AddInput(input1_int8, input1_dims, 4, input_quant_info1)
@@ -206,6 +205,23 @@ void TestDepthwiseConv2dQuantInt8(const int32_t batch,
   ExpectTensorSimilar(expect_output, expect_output_dims, expect_output_dim_size,
                       output, output_dims, output_dim_size, 0.1);
 
+#ifdef MACE_MICRO_ENABLE_CMSIS
+  if (batch == 1 && dilation_height == 1 && dilation_width == 1) {
+    // The CMSIS-NN op must produce the same bytes
+    int8_t *portable_output_int8 = new int8_t[output_size];
+    base::memcpy(portable_output_int8, output_int8, output_size);
+    ArmDepthwiseConv2dInt8Op arm_depthwise_conv2d_op_int8;
+    arm_depthwise_conv2d_op_int8.Init(
+        NULL, reinterpret_cast<framework::OpContext *>(&substitude_op_int8),
+        NULL);
+    arm_depthwise_conv2d_op_int8.Run();
+    ExpectTensorNear<int8_t>(portable_output_int8, output_dims,
+                             output_dim_size, output_int8, output_dims,
+                             output_dim_size);
+    delete[] portable_output_int8;
+  }
+#endif
+
   delete[] input0;
   delete[] input1;
   delete[] bias;
@@ -234,10 +250,10 @@ TEST_F(DepthwiseConv2dOpTest, QuantInt8) {
   TestDepthwiseConv2dQuantInt8(1, 1, 3, 1000, 1000, 4, 3, FULL, 2, 1, 1, 1);
   TestDepthwiseConv2dQuantInt8(1, 1, 3, 1000, 1000, 4, 3, FULL, 2, 3, 1, 1);
 
-  // dilations is unsupported
-  // TestDepthwiseConv2dQuantInt8(1, 1, 3, 1000, 1000, 3, 3, VALID, 1, 1, 2, 2);
-  // TestDepthwiseConv2dQuantInt8(1, 1, 3, 1000, 1000, 4, 3, FULL, 1, 1, 3, 5);
-  // TestDepthwiseConv2dQuantInt8(1, 1, 3, 1000, 1000, 4, 3, FULL, 1, 3, 3, 1);
+  // dilations are unsupported by CMSIS-NN
+  TestDepthwiseConv2dQuantInt8(1, 1, 3, 1000, 1000, 3, 3, VALID, 1, 1, 2, 2);
+  TestDepthwiseConv2dQuantInt8(1, 1, 3, 1000, 1000, 4, 3, FULL, 1, 1, 3, 5);
+  TestDepthwiseConv2dQuantInt8(1, 1, 3, 1000, 1000, 4, 3, FULL, 1, 3, 3, 1);
 
   // batch must be 1
   // TestDepthwiseConv2dQuantInt8(3, 1, 128, 56, 56, 3, 3, SAME, 2, 2);
@@ -247,8 +263,6 @@ TEST_F(DepthwiseConv2dOpTest, QuantInt8) {
   // TestDepthwiseConv2dQuantInt8(1, 2, 1024, 7, 7, 3, 3, SAME, 2, 2);
 }
 
-#endif
-
 }  // namespace test
 }  // namespace ops
 }  // namespace micro
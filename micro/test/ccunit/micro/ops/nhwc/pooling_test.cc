@@ -17,6 +17,7 @@
 #include "micro/ops/nhwc/pooling_ref.h"
 #include "micro/ops/nhwc/pooling_s4.h"
 #include "micro/ops/cmsis_nn/arm_pooling_int8.h"
+#include "micro/ops/nhwc/pooling_int8.h"
 #include "micro/ops/substitute_op.h"
 #include "micro/ops/test_quantize_utils.h"
 #include "micro/ops/test_utils.h"
@@ -183,6 +184,74 @@ void TestPoolingOpSameAvg() {
   ExpectTensorNear<float>(output, output_dims, 4, expect, expect_dims, 4, 1e-5);
 }
 
+// Runs the op row by row, reading each row's input rows from a window the
+// way Graph::RunRowChain does, and compares the rows with a whole run
+template<typename OP>
+void TestRunRows(const PoolingType pooling_type, const int32_t stride,
+                 const Padding padding) {
+  const int32_t kInHeight = 9;
+  const int32_t kInWidth = 8;
+  const int32_t kChannel = 3;
+  float input[kInHeight * kInWidth * kChannel] = {0};
+  int32_t input_dims[4] = {1, kInHeight, kInWidth, kChannel};
+  FillNormalRandomInput(input, kInHeight * kInWidth * kChannel);
+
+  const int32_t strides[] = {stride, stride};
+  const int32_t dilations[] = {1, 1};
+  const int32_t kernels[] = {3, 3};
+
+  float expect[kInHeight * kInWidth * kChannel] = {0};
+  int32_t expect_dims[4] = {0};
+  OP pooling_op;
+  framework::SubstituteOp substitude_op;
+  substitude_op.AddInput(input, input_dims, 4)
+      .AddRepeatArg("strides", strides, sizeof(strides) / sizeof(int32_t))
+      .AddRepeatArg("kernels", kernels, sizeof(kernels) / sizeof(int32_t))
+      .AddArg("padding", padding)
+      .AddArg("pooling_type", pooling_type)
+      .AddRepeatArg("dilations", dilations, sizeof(dilations) / sizeof(int32_t))
+      .AddOutput(expect, expect_dims, 4);
+  pooling_op.Init(NULL, reinterpret_cast<framework::OpContext *>(
+      &substitude_op), NULL);
+  pooling_op.Run();
+
+  const int32_t input_row_size = kInWidth * kChannel * sizeof(float);
+  const int32_t row_buffer[3] = {
+      0, input_row_size, expect_dims[2] * kChannel *
+          static_cast<int32_t>(sizeof(float))
+  };
+  float output[kInHeight * kInWidth * kChannel] = {0};
+  int32_t output_dims[4] = {0};
+  base::memcpy(output_dims, expect_dims, sizeof(output_dims));
+  OP rows_op;
+  framework::SubstituteOp rows_substitude_op;
+  rows_substitude_op.AddInput(input, input_dims, 4)
+      .AddRepeatArg("strides", strides, sizeof(strides) / sizeof(int32_t))
+      .AddRepeatArg("kernels", kernels, sizeof(kernels) / sizeof(int32_t))
+      .AddArg("padding", padding)
+      .AddArg("pooling_type", pooling_type)
+      .AddRepeatArg("dilations", dilations, sizeof(dilations) / sizeof(int32_t))
+      .AddRepeatArg("row_buffer", row_buffer, 3)
+      .AddOutput(output, output_dims, 4);
+  rows_op.Init(NULL, reinterpret_cast<framework::OpContext *>(
+      &rows_substitude_op), NULL);
+
+  float window[3 * kInWidth * kChannel] = {0};
+  for (int32_t row = 0; row < expect_dims[1]; ++row) {
+    int32_t input_begin = 0;
+    int32_t input_end = 0;
+    rows_op.GetInputRows(row, row + 1, &input_begin, &input_end);
+    ASSERT_LE(input_end - input_begin, 3);
+    if (input_end > input_begin) {
+      base::memcpy(window, input + input_begin * kInWidth * kChannel,
+                   (input_end - input_begin) * input_row_size);
+    }
+    rows_op.RunRows(window, input_begin, NULL, 0, row, row + 1);
+  }
+
+  ExpectTensorNear<float>(output, output_dims, 4, expect, expect_dims, 4, 1e-5);
+}
+
 }  // namespace
 
 TEST_F(PoolingOpTest, TestPoolingValidMax) {
@@ -205,7 +274,12 @@ TEST_F(PoolingOpTest, TestPoolingOpSameAvg) {
   TestPoolingOpSameAvg();
 }
 
-#ifdef MACE_MICRO_ENABLE_CMSIS
+TEST_F(PoolingOpTest, RunRows) {
+  TestRunRows<PoolingRefOp>(PoolingType::MAX, 1, Padding::SAME);
+  TestRunRows<PoolingRefOp>(PoolingType::AVG, 2, Padding::SAME);
+  TestRunRows<PoolingS4Op>(PoolingType::MAX, 2, Padding::SAME);
+  TestRunRows<PoolingS4Op>(PoolingType::AVG, 1, Padding::VALID);
+}
 
 namespace {
 
@@ -251,7 +325,7 @@ void TestPoolingQuantInt8(const int32_t *input_dims,
                &input_quant_info.zero);
   QuantizeInfo output_quant_info = input_quant_info;
 
-  ArmPoolingInt8Op pooling_op_int8;
+  PoolingInt8Op pooling_op_int8;
   framework::SubstituteOp substitude_op_int8;
   substitude_op_int8
       .AddInput(input_int8, input_dims, input_dim_size, input_quant_info)
@@ -275,6 +349,23 @@ void TestPoolingQuantInt8(const int32_t *input_dims,
   ExpectTensorSimilar(expect_output, expect_output_dims, expect_output_dim_size,
                       output, output_dims, output_dim_size, 0.1);
 
+#ifdef MACE_MICRO_ENABLE_CMSIS
+  if (input_dims[0] == 1) {
+    // The CMSIS-NN op must produce the same bytes
+    int8_t *portable_output_int8 = new int8_t[output_size];
+    base::memcpy(portable_output_int8, output_int8, output_size);
+    ArmPoolingInt8Op arm_pooling_op_int8;
+    arm_pooling_op_int8.Init(
+        NULL, reinterpret_cast<framework::OpContext *>(&substitude_op_int8),
+        NULL);
+    arm_pooling_op_int8.Run();
+    ExpectTensorNear<int8_t>(portable_output_int8, output_dims,
+                             output_dim_size, output_int8, output_dims,
+                             output_dim_size);
+    delete[] portable_output_int8;
+  }
+#endif
+
   delete[] input;
   delete[] expect_output;
   delete[] expect_output_dims;
@@ -307,17 +398,17 @@ TEST_F(PoolingOpTest, Quant) {
   const int32_t strides2[2] = {1, 2};
   TestPoolingQuantInt8(input_dims2, 4, kernels2, strides2, Padding::SAME,
                        PoolingType::MAX);
-  // WARNING(ZhangZhimin): Batch inputs is unsupported
-  // const int32_t input_dims3[4] = {3,15,15,128};
-  // const int32_t kernels3[2] = {4, 4};
-  // const int32_t strides3[2] = {4, 4};
-  // TestPoolingQuantInt8(input_dims3, 4, kernels3, strides3, Padding::SAME,
-  //                      PoolingType::AVG);
-  // const int32_t input_dims4[4] = {3,15,15,128};
-  // const int32_t kernels4[2] = {4, 4};
-  // const int32_t strides4[2] = {4, 4};
-  // TestPoolingQuantInt8(input_dims4, 4, kernels4, strides4, Padding::SAME,
-  //                      PoolingType::MAX);
+  // Batch inputs are unsupported by CMSIS-NN
+  const int32_t input_dims3[4] = {3, 15, 15, 128};
+  const int32_t kernels3[2] = {4, 4};
+  const int32_t strides3[2] = {4, 4};
+  TestPoolingQuantInt8(input_dims3, 4, kernels3, strides3, Padding::SAME,
+                       PoolingType::AVG);
+  const int32_t input_dims4[4] = {3, 15, 15, 128};
+  const int32_t kernels4[2] = {4, 4};
+  const int32_t strides4[2] = {4, 4};
+  TestPoolingQuantInt8(input_dims4, 4, kernels4, strides4, Padding::SAME,
+                       PoolingType::MAX);
   const int32_t input_dims5[4] = {1, 31, 31, 127};
   const int32_t kernels5[2] = {2, 2};
   const int32_t strides5[2] = {3, 3};
@@ -330,9 +421,6 @@ TEST_F(PoolingOpTest, Quant) {
                        PoolingType::MAX);
 }
 
-#endif
-
-
 }  // namespace test
 }  // namespace ops
 }  // namespace micro
@@ -16,6 +16,7 @@
 #include "micro/ops/softmax.h"
 #include "micro/ops/gtest_utils.h"
 #include "micro/ops/cmsis_nn/arm_softmax_int8.h"
+#include "micro/ops/softmax_int8.h"
 #include "micro/ops/substitute_op.h"
 #include "micro/ops/test_quantize_utils.h"
 #include "micro/ops/test_utils.h"
@@ -61,8 +62,6 @@ void Simple(bool use_log = false) {
 TEST_F(SoftmaxOpTest, CPUSimple) { Simple(); }
 TEST_F(SoftmaxOpTest, CPUSimpleUseLog) { Simple(true); }
 
-#ifdef MACE_MICRO_ENABLE_CMSIS
-
 namespace {
 
 void TestSoftmaxQuantInt8(const int32_t *input_dims,
@@ -94,7 +93,7 @@ void TestSoftmaxQuantInt8(const int32_t *input_dims,
                &input_quant_info.zero);
   QuantizeInfo output_quant_info = {1.0f / 255.0f, -128};
 
-  ArmSoftmaxInt8Op softmax_op_int8;
+  SoftmaxInt8Op softmax_op_int8;
   framework::SubstituteOp substitude_op_int8;
   substitude_op_int8
       .AddInput(input_int8, input_dims, input_dim_size, input_quant_info)
@@ -112,6 +111,21 @@ void TestSoftmaxQuantInt8(const int32_t *input_dims,
   ExpectTensorSimilar(expect_output, expect_output_dims, expect_output_dim_size,
                       output, output_dims, output_dim_size, 0.1);
 
+#ifdef MACE_MICRO_ENABLE_CMSIS
+  // The CMSIS-NN op must produce the same bytes
+  int8_t *portable_output_int8 = new int8_t[shape_size];
+  base::memcpy(portable_output_int8, output_int8, shape_size);
+  ArmSoftmaxInt8Op arm_softmax_op_int8;
+  arm_softmax_op_int8.Init(
+      NULL, reinterpret_cast<framework::OpContext *>(&substitude_op_int8),
+      NULL);
+  arm_softmax_op_int8.Run();
+  ExpectTensorNear<int8_t>(portable_output_int8, output_dims,
+                           output_dim_size, output_int8, output_dims,
+                           output_dim_size);
+  delete[] portable_output_int8;
+#endif
+
   delete[] input;
   delete[] expect_output;
   delete[] expect_output_dims;
@@ -132,8 +146,6 @@ TEST_F(SoftmaxOpTest, QuantInt8) {
   TestSoftmaxQuantInt8(input_dims2, 2);
 }
 
-#endif
-
 }  // namespace test
 }  // namespace ops
 }  // namespace micro
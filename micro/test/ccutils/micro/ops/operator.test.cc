@@ -39,6 +39,8 @@ MaceMicroEngineConfig kTmpMicroEngineConfig = {
     NULL,  // input_shapes_;
     kScratchBuffer,
     kScratchBufferSize,
+    NULL,  // op_profiler_;
+    NULL,  // op_profiler_data_;
 };
 
 MaceStatus Operator::Init(MaceMicroEngineConfig *engine_config,
@@ -62,6 +64,36 @@ MaceStatus Operator::Run() {
   return MACE_SUCCESS;
 }
 
+MaceStatus Operator::RunRows(const void *input, int32_t input_row,
+                             void *output, int32_t output_row,
+                             const int32_t row_begin, const int32_t row_end) {
+  MACE_UNUSED(input);
+  MACE_UNUSED(input_row);
+  MACE_UNUSED(output);
+  MACE_UNUSED(output_row);
+  MACE_UNUSED(row_begin);
+  MACE_UNUSED(row_end);
+  MACE_NOT_IMPLEMENTED;
+  return MACE_UNSUPPORTED;
+}
+
+MaceStatus Operator::GetInputRows(const int32_t row_begin,
+                                  const int32_t row_end,
+                                  int32_t *input_begin, int32_t *input_end) {
+  MACE_UNUSED(row_begin);
+  MACE_UNUSED(row_end);
+  MACE_UNUSED(input_begin);
+  MACE_UNUSED(input_end);
+  MACE_NOT_IMPLEMENTED;
+  return MACE_UNSUPPORTED;
+}
+
+void Operator::GetCost(int64_t *macs, int64_t *bytes) {
+  MACE_UNUSED(macs);
+  MACE_UNUSED(bytes);
+  MACE_NOT_IMPLEMENTED;
+}
+
 const model::Argument *Operator::GetArgByName(const char *name) const {
   MACE_UNUSED(name);
   MACE_ASSERT1(false, "Thsi method should not be invoked.");
@@ -17,7 +17,10 @@
 
 #include <math.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include <algorithm>
 #include <limits>
 
 #include "micro/base/logging.h"
@@ -122,6 +125,40 @@ inline void Dequantize(const int8_t *input,
   }
 }
 
+// Requantizes the symmetric int8 weights to |bits| and packs each of the
+// |rows| rows into |packed| like the micro converter, see packed_weights.h.
+// The requantized values are written back to |weights|.
+inline void PackWeightsInt8(int8_t *weights,
+                            const int32_t rows,
+                            const int32_t cols,
+                            const int32_t bits,
+                            float *scale,
+                            uint8_t *packed) {
+  const int32_t size = rows * cols;
+  const int32_t max_value = (1 << (bits - 1)) - 1;
+  int32_t max_abs = 0;
+  for (int32_t i = 0; i < size; ++i) {
+    max_abs = std::max<int32_t>(max_abs, std::abs(weights[i]));
+  }
+  const float ratio =
+      max_abs > 0 ? static_cast<float>(max_value) / max_abs : 1.0f;
+  *scale /= ratio;
+
+  const int32_t row_bytes = (cols * bits + 7) / 8;
+  memset(packed, 0, rows * row_bytes);
+  for (int32_t r = 0; r < rows; ++r) {
+    for (int32_t c = 0; c < cols; ++c) {
+      const int32_t idx = r * cols + c;
+      const int32_t value = std::min(max_value, std::max(-max_value,
+          static_cast<int32_t>(roundf(weights[idx] * ratio))));
+      weights[idx] = static_cast<int8_t>(value);
+      const int32_t bit = c * bits;
+      packed[r * row_bytes + bit / 8] |= static_cast<uint8_t>(
+          (value & ((1 << bits) - 1)) << (bit % 8));
+    }
+  }
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace micro
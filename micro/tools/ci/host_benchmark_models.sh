@@ -0,0 +1,27 @@
+#! /bin/bash
+
+# Runs the pretrained models on the host and prints the cost of each op,
+# the hifi4 models need the xtensa toolchain and are left out.
+# usage: micro/tools/ci/host_benchmark_models.sh [round]
+
+ROUND=${1:-10}
+
+benchmark_model() {
+  CONF_FILE=$1
+  MODEL_NAME=$2
+  python3 tools/python/convert.py --config=${CONF_FILE} --enable_micro || exit -1
+  python3 tools/python/run_micro.py --config ${CONF_FILE} --build --benchmark \
+    --model_name ${MODEL_NAME} --round=${ROUND} || exit -1
+  git clean -xdf micro/codegen
+}
+
+benchmark_model micro/pretrained_models/har-cnn/har-cnn.yml har_cnn
+benchmark_model micro/pretrained_models/har-cnn/har-cnn-bf16.yml har_cnn
+benchmark_model micro/pretrained_models/keras/mnist/mnist.yml mnist
+benchmark_model micro/pretrained_models/keras/mnist/mnist-int8.yml mnist_int8
+benchmark_model micro/pretrained_models/keras/har/har.yml har
+# benchmark_model micro/pretrained_models/keras/har/har-int8.yml har_int8
+benchmark_model micro/pretrained_models/tensorflow/kws/kws-tc_resnet8.yml \
+  kws_tc_resnet8
+benchmark_model micro/pretrained_models/tensorflow/kws/kws-tc_resnet8-bf16.yml \
+  kws_tc_resnet8_bf16
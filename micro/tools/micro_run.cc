@@ -28,12 +28,15 @@
 #include <string.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <numeric>
+#include <string>
+#include <vector>
 
 #include "gflags/gflags.h"
 #include "micro/base/logging.h"
@@ -121,7 +124,69 @@ DEFINE_string(output_dir, "output", "output directory name");
 DEFINE_int32(round, 1, "round");
 DEFINE_int32(restart_round, 1, "restart round");
 DEFINE_int32(malloc_check_cycle, -1, "malloc debug check cycle, -1 to disable");
-DEFINE_bool(benchmark, false, "enable benchmark op");
+DEFINE_bool(benchmark, false, "profile each op and print its cost");
+
+struct OpProfile {
+  std::string type;
+  std::string name;
+  int64_t cycles;
+  int64_t macs;
+  int64_t bytes;
+  int32_t runs;
+};
+
+void ProfileOp(const MaceMicroOpStats *op_stats, void *user_data) {
+  std::vector<OpProfile> *op_profiles =
+      static_cast<std::vector<OpProfile> *>(user_data);
+  if (op_profiles->size() <= op_stats->op_idx_) {
+    op_profiles->resize(op_stats->op_idx_ + 1, OpProfile{"", "", 0, 0, 0, 0});
+  }
+  OpProfile *op_profile = &(*op_profiles)[op_stats->op_idx_];
+  op_profile->type = op_stats->op_type_;
+  op_profile->name = op_stats->op_name_;
+  op_profile->cycles += op_stats->cycles_;
+  op_profile->macs = op_stats->macs_;
+  op_profile->bytes = op_stats->bytes_;
+  ++op_profile->runs;
+}
+
+// The cycles are nanoseconds on Linux, see port::api::NowCycles
+void PrintOpProfiles(const std::vector<OpProfile> &op_profiles) {
+  int64_t total_cycles = 0;
+  int64_t total_macs = 0;
+  for (size_t i = 0; i < op_profiles.size(); ++i) {
+    if (op_profiles[i].runs > 0) {
+      total_cycles += op_profiles[i].cycles / op_profiles[i].runs;
+      total_macs += op_profiles[i].macs;
+    }
+  }
+
+  printf("==================================================================="
+         "=====================\n");
+  printf("%4s %-18s %-24s %12s %7s %11s %9s %9s\n", "idx", "type", "name",
+         "cycles", "percent", "macs", "bytes", "macs/cyc");
+  printf("==================================================================="
+         "=====================\n");
+  for (size_t i = 0; i < op_profiles.size(); ++i) {
+    const OpProfile &op_profile = op_profiles[i];
+    if (op_profile.runs == 0) {
+      continue;
+    }
+    const int64_t cycles = op_profile.cycles / op_profile.runs;
+    printf("%4d %-18.18s %-24.24s %12lld %6.2f%% %11lld %9lld %9.3f\n",
+           static_cast<int>(i), op_profile.type.c_str(),
+           op_profile.name.c_str(), static_cast<long long>(cycles),
+           total_cycles > 0 ? 100.0 * cycles / total_cycles : 0.0,
+           static_cast<long long>(op_profile.macs),
+           static_cast<long long>(op_profile.bytes),
+           cycles > 0 ? static_cast<double>(op_profile.macs) / cycles : 0.0);
+  }
+  printf("%4s %-18s %-24s %12lld %6.2f%% %11lld %9s %9.3f\n", "", "total", "",
+         static_cast<long long>(total_cycles), 100.0,
+         static_cast<long long>(total_macs), "",
+         total_cycles > 0 ?
+             static_cast<double>(total_macs) / total_cycles : 0.0);
+}
 
 void GetOutputAndStoreToFile(MaceMicroEngine *micro_engine,
                              const std::vector<std::string> &output_names,
@@ -260,6 +325,18 @@ bool RunModel(const std::vector<std::string> &input_names,
       LOG(INFO) << "Average latency: "
                 << static_cast<float>(model_run_millis) << " ms";
     }
+
+    // Profiles in rounds of its own to keep the latencies above clean
+    std::vector<OpProfile> op_profiles;
+    if (FLAGS_benchmark) {
+      LOG(INFO) << "Profile ops";
+      micro_engine->SetOpProfiler(ProfileOp, &op_profiles);
+      for (int i = 0; i < std::max(FLAGS_round, 1); ++i) {
+        status = micro_engine->Run();
+        MACE_ASSERT(status == MACE_SUCCESS);
+      }
+      micro_engine->SetOpProfiler(NULL, NULL);
+    }
     GetOutputAndStoreToFile(micro_engine, output_names,
                             FLAGS_output_file + "_", "");
 
@@ -269,6 +346,9 @@ bool RunModel(const std::vector<std::string> &input_names,
     printf("=============================================\n");
     printf("time %11.3f %11.3f %11.3f\n",
            init_millis, warmup_millis, model_run_millis);
+    if (FLAGS_benchmark) {
+      PrintOpProfiles(op_profiles);
+    }
   }
 
   return true;
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
 
@@ -31,6 +32,9 @@ static int64_t bytes_processed;
 static int64_t macs_processed = 0;
 static int64_t accum_time = 0;
 static int64_t start_time = 0;
+// the samples beyond are dropped to bound the memory
+static const size_t kMaxLatencySamples = 1 << 20;
+static std::vector<int64_t> latency_samples;
 
 Benchmark::Benchmark(const char *name, void (*benchmark_func)(int))
     : name_(name), benchmark_func_(benchmark_func) {
@@ -74,6 +78,17 @@ void Benchmark::Run(const char *pattern) {
     float gmacs = (macs_processed * 1e-9) / seconds;
     printf("%-*s %10.0f %10d %10.2f %10.2f\n", width, b->name_.c_str(),
            seconds * 1e9 / iters, iters, mbps, gmacs);
+    if (!latency_samples.empty()) {
+      std::sort(latency_samples.begin(), latency_samples.end());
+      auto percentile = [](const double p) {
+        return latency_samples[static_cast<size_t>(
+            p * (latency_samples.size() - 1))];
+      };
+      printf("%-*s p50 %" PRId64 " p90 %" PRId64 " p99 %" PRId64
+             " p99.9 %" PRId64 " max %" PRId64 " (ns)\n", width, "",
+             percentile(0.5), percentile(0.9), percentile(0.99),
+             percentile(0.999), latency_samples.back());
+    }
   }
 }
 
@@ -90,6 +105,7 @@ void Benchmark::Run(int *run_count, double *run_seconds) {
   while (true) {
     bytes_processed = -1;
     macs_processed = 0;
+    latency_samples.clear();
     RestartTiming();
     (*benchmark_func_)(iters);
     StopTiming();
@@ -109,6 +125,11 @@ void Benchmark::Run(int *run_count, double *run_seconds) {
 
 void BytesProcessed(int64_t n) { bytes_processed = n; }
 void MacsProcessed(int64_t n) { macs_processed = n; }
+void LatencySample(int64_t nanos) {
+  if (latency_samples.size() < kMaxLatencySamples) {
+    latency_samples.push_back(nanos);
+  }
+}
 void RestartTiming() {
   accum_time = 0;
   start_time = NowMicros();
@@ -43,6 +43,9 @@ class Benchmark {
 
 void BytesProcessed(int64_t);
 void MacsProcessed(int64_t);
+// Records the latency of one operation in nanoseconds, the percentiles of
+// the samples are printed below the line of the benchmark.
+void LatencySample(int64_t);
 void RestartTiming();
 void StartTiming();
 void StopTiming();
@@ -0,0 +1,81 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/benchmark_utils/test_benchmark.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+namespace {
+template <RuntimeType D, typename T>
+void ArgMax(int iters, int batch, int height, int width, int argmin) {
+  mace::testing::StopTiming();
+
+  OpsTestNet net;
+  if (D == RuntimeType::RT_CPU) {
+    net.AddRandomInput<D, T>("Input", {batch, height, width});
+    net.AddInputFromArray<D, int32_t>("Axis", {}, {-1});
+  } else {
+    MACE_NOT_IMPLEMENTED;
+  }
+
+  OpDefBuilder("ArgMax", "ArgMaxBM")
+    .Input("Input")
+    .Input("Axis")
+    .Output("Output")
+    .AddIntArg("keepdims", 0)
+    .AddIntArg("argmin", argmin)
+    .AddIntArg("T", static_cast<int>(DataTypeToEnum<T>::value))
+    .OutputType({DT_INT32})
+    .Finalize(net.NewOperatorDef());
+
+  // Warm-up
+  net.Setup(D);
+  for (int i = 0; i < 5; ++i) {
+    net.Run();
+  }
+  net.Sync();
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.Run();
+  }
+  net.Sync();
+}
+}  // namespace
+
+#define MACE_BM_ARGMAX_MACRO(N, H, W, MIN, TYPE, DEVICE)                   \
+  static void MACE_BM_ARGMAX_##N##_##H##_##W##_##MIN##_##TYPE##_##DEVICE(  \
+      int iters) {                                                         \
+    const int64_t tot = static_cast<int64_t>(iters) * N * H * W;           \
+    mace::testing::BytesProcessed(tot *(sizeof(TYPE)));                    \
+    ArgMax<DEVICE, TYPE>(iters, N, H, W, MIN);                             \
+  }                                                                        \
+  MACE_BENCHMARK(MACE_BM_ARGMAX_##N##_##H##_##W##_##MIN##_##TYPE##_##DEVICE)
+
+#define MACE_BM_ARGMAX(N, H, W)                      \
+  MACE_BM_ARGMAX_MACRO(N, H, W, 0, float, RT_CPU);   \
+  MACE_BM_ARGMAX_MACRO(N, H, W, 1, float, RT_CPU)
+
+MACE_BM_ARGMAX(1, 1, 1000);
+MACE_BM_ARGMAX(1, 1, 50000);
+MACE_BM_ARGMAX(32, 1, 50000);
+MACE_BM_ARGMAX(1, 128, 1000);
+MACE_BM_ARGMAX(1, 1024, 64);
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
@@ -23,7 +23,8 @@ class CumsumOpTest : public OpsTestBase {};
 
 namespace {
 template <RuntimeType D, typename T>
-void Cumsum(int iters, int batch, int channels, int height, int width) {
+void Cumsum(int iters, int batch, int channels, int height, int width,
+            int axis) {
   mace::testing::StopTiming();
 
   // Construct graph
@@ -39,7 +40,7 @@ void Cumsum(int iters, int batch, int channels, int height, int width) {
   OpDefBuilder("Cumsum", "CumsumTest")
     .Input("Input")
     .Output("Output")
-    .AddIntArg("axis", 0)
+    .AddIntArg("axis", axis)
     .AddIntArg("exclusive", 0)
     .AddIntArg("reverse", 0)
     .AddIntArg("T", static_cast<int>(DataTypeToEnum<T>::value))
@@ -60,17 +61,23 @@ void Cumsum(int iters, int batch, int channels, int height, int width) {
 }
 }  // namespace
 
-#define MACE_BM_CUMSUM_MACRO(N, C, H, W, TYPE, DEVICE)                  \
-  static void MACE_BM_CUMSUM_##N##_##C##_##H##_##W##_##TYPE##_##DEVICE( \
-      int iters) {                                                        \
-    const int64_t tot = static_cast<int64_t>(iters) * N * C * H * W;      \
-    mace::testing::BytesProcessed(tot *(sizeof(TYPE)));                   \
-    Cumsum<DEVICE, TYPE>(iters, N, C, H, W);                             \
-  }                                                                       \
-  MACE_BENCHMARK(MACE_BM_CUMSUM_##N##_##C##_##H##_##W##_##TYPE##_##DEVICE)
+#define MACE_BM_CUMSUM_MACRO(N, C, H, W, A, TYPE, DEVICE)                   \
+  static void                                                                \
+      MACE_BM_CUMSUM_##N##_##C##_##H##_##W##_##A##_##TYPE##_##DEVICE(        \
+          int iters) {                                                       \
+    const int64_t tot = static_cast<int64_t>(iters) * N * C * H * W;         \
+    mace::testing::BytesProcessed(tot *(sizeof(TYPE)));                      \
+    Cumsum<DEVICE, TYPE>(iters, N, C, H, W, A);                              \
+  }                                                                          \
+  MACE_BENCHMARK(                                                            \
+      MACE_BM_CUMSUM_##N##_##C##_##H##_##W##_##A##_##TYPE##_##DEVICE)
 
 #define MACE_BM_CUMSUM(N, C, H, W)                 \
-  MACE_BM_CUMSUM_MACRO(N, C, H, W, float, RT_CPU);
+  MACE_BM_CUMSUM_MACRO(N, C, H, W, 0, float, RT_CPU);
+
+// Scans along the contiguous last axis, e.g. of sequence models.
+#define MACE_BM_CUMSUM_LAST_AXIS(N, C, H, W)       \
+  MACE_BM_CUMSUM_MACRO(N, C, H, W, 3, float, RT_CPU);
 
 MACE_BM_CUMSUM(1, 1, 512, 512);
 MACE_BM_CUMSUM(1, 3, 128, 128);
@@ -86,6 +93,11 @@ MACE_BM_CUMSUM(1, 1024, 7, 7);
 MACE_BM_CUMSUM(32, 1, 256, 256);
 MACE_BM_CUMSUM(32, 3, 256, 256);
 
+MACE_BM_CUMSUM_LAST_AXIS(1, 1, 1, 50000);
+MACE_BM_CUMSUM_LAST_AXIS(8, 1, 1, 50000);
+MACE_BM_CUMSUM_LAST_AXIS(32, 1, 1, 50000);
+MACE_BM_CUMSUM_LAST_AXIS(1, 64, 128, 128);
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
@@ -13,8 +13,10 @@
 // limitations under the License.
 
 #include <string>
+#include <vector>
 
 #include "mace/benchmark_utils/test_benchmark.h"
+#include "mace/ops/common/reduce_type.h"
 #include "mace/ops/ops_test_util.h"
 
 namespace mace {
@@ -79,6 +81,68 @@ void GatherBenchmark(int iters,
 MACE_BM_GATHER(1, 7, 48165, 256);
 MACE_BM_GATHER(1, 20, 48165, 256);
 MACE_BM_GATHER(1, 100, 48165, 256);
+MACE_BM_GATHER(1, 4096, 100000, 512);
+
+namespace {
+template <RuntimeType D, typename T>
+void EmbeddingBagBenchmark(int iters,
+                           index_t bag_count,
+                           index_t bag_size,
+                           index_t vocab_len,
+                           index_t embedding_len) {
+  mace::testing::StopTiming();
+  static unsigned int seed = time(NULL);
+
+  OpsTestNet net;
+  std::vector<int32_t> index(bag_count * bag_size);
+  for (size_t i = 0; i < index.size(); ++i) {
+    index[i] = rand_r(&seed) % vocab_len;
+  }
+  net.AddInputFromArray<D, int32_t>("Indices", {bag_count, bag_size}, index);
+  net.AddRandomInput<D, T>("Params", {vocab_len, embedding_len}, true);
+
+  OpDefBuilder("Gather", "EmbeddingBagTest")
+      .Input("Params")
+      .Input("Indices")
+      .AddIntArg("axis", 0)
+      .AddIntArg("combiner", ReduceType::SUM)
+      .AddIntArg("T", static_cast<int>(DT_FLOAT))
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+
+  // Warm-up
+  net.Setup(D);
+  for (int i = 0; i < 2; ++i) {
+    net.Run();
+  }
+  net.Sync();
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.Run();
+  }
+  net.Sync();
+}
+}  // namespace
+
+#define MACE_BM_EMBEDDING_BAG_MACRO(N, BAG, VOC, EMBED, TYPE, DEVICE)      \
+  static void                                                              \
+      MACE_BM_EMBEDDING_BAG##_##N##_##BAG##_##VOC##_##EMBED##_##TYPE##_##  \
+          DEVICE(int iters) {                                              \
+    const int64_t tot = static_cast<int64_t>(iters) * N * BAG * EMBED;     \
+    mace::testing::BytesProcessed(tot *(sizeof(TYPE)));                    \
+    EmbeddingBagBenchmark<DEVICE, TYPE>(iters, N, BAG, VOC, EMBED);        \
+  }                                                                        \
+  MACE_BENCHMARK(                                                          \
+      MACE_BM_EMBEDDING_BAG##_##N##_##BAG##_##VOC##_##EMBED##_##TYPE##_##  \
+          DEVICE)
+
+#define MACE_BM_EMBEDDING_BAG(N, BAG, VOCAB, EMBEDDING)                  \
+  MACE_BM_EMBEDDING_BAG_MACRO(N, BAG, VOCAB, EMBEDDING, float, RT_CPU);  \
+  MACE_BM_EMBEDDING_BAG_MACRO(N, BAG, VOCAB, EMBEDDING, half, RT_CPU);
+
+MACE_BM_EMBEDDING_BAG(64, 32, 100000, 128);
+MACE_BM_EMBEDDING_BAG(256, 16, 100000, 64);
 
 }  // namespace test
 }  // namespace ops
@@ -0,0 +1,76 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "mace/benchmark_utils/test_benchmark.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+namespace {
+template <RuntimeType D, typename T>
+void LayerNormBenchmark(int iters, int n, int s, int c) {
+  mace::testing::StopTiming();
+
+  OpsTestNet net;
+  // Add input data
+  net.AddRandomInput<D, T>("Input", {n, s, c});
+  net.AddRandomInput<D, T>("Gamma", {c}, true);
+  net.AddRandomInput<D, T>("Beta", {c}, true);
+
+  OpDefBuilder("LayerNorm", "LayerNormBM")
+      .Input("Input")
+      .Input("Gamma")
+      .Input("Beta")
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+
+  // Warm-up
+  net.Setup(D);
+  for (int i = 0; i < 5; ++i) {
+    net.Run();
+  }
+  net.Sync();
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.Run();
+  }
+  net.Sync();
+}
+}  // namespace
+
+#define MACE_BM_LAYER_NORM_MACRO(N, S, C, TYPE, DEVICE)                  \
+  static void MACE_BM_LAYER_NORM_##N##_##S##_##C##_##TYPE##_##DEVICE(    \
+      int iters) {                                                       \
+    const int64_t tot = static_cast<int64_t>(iters) * N * S * C;         \
+    mace::testing::BytesProcessed(tot *(sizeof(TYPE)));                  \
+    LayerNormBenchmark<DEVICE, TYPE>(iters, N, S, C);                    \
+  }                                                                      \
+  MACE_BENCHMARK(MACE_BM_LAYER_NORM_##N##_##S##_##C##_##TYPE##_##DEVICE)
+
+#define MACE_BM_LAYER_NORM(N, S, C)                   \
+  MACE_BM_LAYER_NORM_MACRO(N, S, C, float, RT_CPU);
+
+MACE_BM_LAYER_NORM(1, 128, 768);
+MACE_BM_LAYER_NORM(1, 384, 1024);
+MACE_BM_LAYER_NORM(8, 64, 512);
+MACE_BM_LAYER_NORM(1, 1, 65536);
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
@@ -421,6 +421,14 @@ MACE_BM_MATMUL_OP(16, 128, 128, 49);
 MACE_BM_MATMUL_OP(16, 49, 128, 128);
 MACE_BM_MATMUL_OP(16, 128, 128, 961);
 MACE_BM_MATMUL_OP(16, 128, 128, 3969);
+// tall-skinny
+MACE_BM_MATMUL_OP(1, 4, 4096, 1024);
+MACE_BM_MATMUL_OP(1, 8, 4096, 1024);
+MACE_BM_MATMUL_OP(1, 8, 4096, 16);
+MACE_BM_MATMUL_OP(1, 4, 8192, 8);
+// attention heads
+MACE_BM_MATMUL_OP(12, 64, 64, 64);
+MACE_BM_MATMUL_OP(32, 16, 64, 16);
 
 MACE_BM_MATMUL_TRANPOSE(16, 32, 128, 49);
 MACE_BM_MATMUL_TRANPOSE(16, 32, 128, 961);
@@ -0,0 +1,83 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/benchmark_utils/test_benchmark.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+namespace {
+template <RuntimeType D, typename T>
+void MultiHeadAttention(int iters, int batch, int heads,
+                        int seq, int head_dim) {
+  mace::testing::StopTiming();
+
+  OpsTestNet net;
+
+  // Add input data
+  if (D == RuntimeType::RT_CPU) {
+    net.AddRandomInput<D, T>("Query", {batch, heads, seq, head_dim});
+    net.AddRandomInput<D, T>("Key", {batch, heads, seq, head_dim});
+    net.AddRandomInput<D, T>("Value", {batch, heads, seq, head_dim});
+  } else {
+    MACE_NOT_IMPLEMENTED;
+  }
+
+  OpDefBuilder("MultiHeadAttention", "MultiHeadAttentionBM")
+      .Input("Query")
+      .Input("Key")
+      .Input("Value")
+      .Output("Output")
+      .AddIntArg("T", static_cast<int>(DataTypeToEnum<T>::value))
+      .Finalize(net.NewOperatorDef());
+
+  // Warm-up
+  net.Setup(D);
+  for (int i = 0; i < 5; ++i) {
+    net.Run();
+  }
+  net.Sync();
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.Run();
+  }
+  net.Sync();
+}
+}  // namespace
+
+#define MACE_BM_MHA_MACRO(N, H, S, D, TYPE, DEVICE)                        \
+  static void MACE_BM_MHA_##N##_##H##_##S##_##D##_##TYPE##_##DEVICE(       \
+      int iters) {                                                         \
+    const int64_t macs = static_cast<int64_t>(iters) * N * H * S * S * D * 2; \
+    mace::testing::MacsProcessed(macs);                                    \
+    mace::testing::BytesProcessed(                                         \
+        static_cast<int64_t>(iters) * N * H * S * D * 4 * sizeof(TYPE));   \
+    MultiHeadAttention<DEVICE, TYPE>(iters, N, H, S, D);                   \
+  }                                                                        \
+  MACE_BENCHMARK(MACE_BM_MHA_##N##_##H##_##S##_##D##_##TYPE##_##DEVICE)
+
+#define MACE_BM_MHA(N, H, S, D)                 \
+  MACE_BM_MHA_MACRO(N, H, S, D, float, RT_CPU);
+
+MACE_BM_MHA(1, 12, 128, 64);
+MACE_BM_MHA(1, 12, 512, 64);
+MACE_BM_MHA(1, 16, 1024, 64);
+MACE_BM_MHA(4, 8, 256, 32);
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
@@ -15,7 +15,10 @@
 // OpenMP and Mace thread pool should be benchmarked separately.
 
 #include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cmath>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
 #include "mace/core/types.h"
@@ -97,6 +100,122 @@ void ThreadPoolBenchmark2D(int iters, int size0, int size1) {
   }
 }
 
+// The benchmarks below time every dispatch for the latency percentiles, and
+// burn `cost` loop iterations per item to emulate kernels of varying size.
+
+int64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Burn(const int64_t cost) {
+  for (int64_t i = 0; i < cost; ++i) {
+    MACE_EMPTY_STATEMENT
+  }
+}
+
+void ThreadPoolDispatchBenchmark(int iters, int threads, int idle_micros) {
+  mace::testing::StopTiming();
+  utils::ThreadPool thread_pool(threads, CPUAffinityPolicy::AFFINITY_NONE);
+  thread_pool.Init();
+  const index_t tiles = thread_pool.thread_count();
+  mace::testing::StartTiming();
+
+  while (iters--) {
+    if (idle_micros > 0) {
+      // The gap stays timed to bound the iteration count, so only the
+      // percentiles tell the dispatch latency after an idle period.
+      std::this_thread::sleep_for(std::chrono::microseconds(idle_micros));
+    }
+    const int64_t start = NowNanos();
+    // one empty tile per thread
+    thread_pool.Compute1D([](index_t, index_t, index_t) {}, 0, tiles, 1, 1);
+    mace::testing::LatencySample(NowNanos() - start);
+  }
+}
+
+void ThreadPoolScalingBenchmark(int iters, int threads, int dims,
+                                int64_t items, int64_t cost) {
+  mace::testing::StopTiming();
+  utils::ThreadPool thread_pool(threads, CPUAffinityPolicy::AFFINITY_NONE);
+  thread_pool.Init();
+  // split the items evenly over the dims
+  const index_t size = dims == 1 ? items : dims == 2 ?
+      static_cast<index_t>(std::sqrt(items)) :
+      static_cast<index_t>(std::cbrt(items));
+  mace::testing::StartTiming();
+
+  while (iters--) {
+    const int64_t start = NowNanos();
+    if (dims == 1) {
+      thread_pool.Compute1D([=](index_t start0, index_t end0, index_t step0) {
+        for (index_t i = start0; i < end0; i += step0) {
+          Burn(cost);
+        }
+      }, 0, size, 1);
+    } else if (dims == 2) {
+      thread_pool.Compute2D([=](index_t start0, index_t end0, index_t step0,
+                                index_t start1, index_t end1, index_t step1) {
+        for (index_t i = start0; i < end0; i += step0) {
+          for (index_t j = start1; j < end1; j += step1) {
+            Burn(cost);
+          }
+        }
+      }, 0, size, 1, 0, size, 1);
+    } else {
+      thread_pool.Compute3D([=](index_t start0, index_t end0, index_t step0,
+                                index_t start1, index_t end1, index_t step1,
+                                index_t start2, index_t end2, index_t step2) {
+        for (index_t i = start0; i < end0; i += step0) {
+          for (index_t j = start1; j < end1; j += step1) {
+            for (index_t k = start2; k < end2; k += step2) {
+              Burn(cost);
+            }
+          }
+        }
+      }, 0, size, 1, 0, size, 1, 0, size, 1);
+    }
+    mace::testing::LatencySample(NowNanos() - start);
+  }
+}
+
+// Several engines, each on its own thread, dispatching to one pool.
+void ThreadPoolSharedBenchmark(int iters, int threads, int engines) {
+  mace::testing::StopTiming();
+  utils::ThreadPool thread_pool(threads, CPUAffinityPolicy::AFFINITY_NONE);
+  thread_pool.Init();
+  const index_t items = thread_pool.thread_count() * 16;
+  const int engine_iters = std::max(iters / engines, 1);
+  std::vector<std::vector<int64_t>> latencies(engines);
+  std::vector<std::thread> engine_threads;
+  mace::testing::StartTiming();
+
+  for (int e = 0; e < engines; ++e) {
+    engine_threads.emplace_back([&, e]() {
+      for (int i = 0; i < engine_iters; ++i) {
+        const int64_t start = NowNanos();
+        thread_pool.Compute1D([](index_t start0, index_t end0,
+                                 index_t step0) {
+          for (index_t j = start0; j < end0; j += step0) {
+            Burn(1000);
+          }
+        }, 0, items, 1);
+        latencies[e].push_back(NowNanos() - start);
+      }
+    });
+  }
+  for (auto &engine_thread : engine_threads) {
+    engine_thread.join();
+  }
+
+  mace::testing::StopTiming();
+  for (const auto &engine_latencies : latencies) {
+    for (const int64_t latency : engine_latencies) {
+      mace::testing::LatencySample(latency);
+    }
+  }
+}
+
 }  // namespace
 
 #define MACE_BM_THREADPOOL_OPENMP_1D(SIZE)                               \
@@ -162,6 +281,58 @@ MACE_BM_THREADPOOL_MACE_2D(1, 256);
 MACE_BM_THREADPOOL_MACE_2D(1, 512);
 MACE_BM_THREADPOOL_MACE_2D(1, 1024);
 
+#define MACE_BM_THREADPOOL_DISPATCH(THREADS, IDLE)                          \
+  static void MACE_BM_THREADPOOL_DISPATCH_##THREADS##_##IDLE(int iters) {   \
+    ThreadPoolDispatchBenchmark(iters, THREADS, IDLE);                      \
+  }                                                                         \
+  MACE_BENCHMARK(MACE_BM_THREADPOOL_DISPATCH_##THREADS##_##IDLE)
+
+#define MACE_BM_THREADPOOL_SCALING(DIMS, THREADS, ITEMS, COST)              \
+  static void                                                               \
+  MACE_BM_THREADPOOL_SCALING_##DIMS##D_##THREADS##_##ITEMS##_##COST(        \
+      int iters) {                                                          \
+    mace::testing::MacsProcessed(static_cast<int64_t>(iters) * ITEMS);      \
+    ThreadPoolScalingBenchmark(iters, THREADS, DIMS, ITEMS, COST);          \
+  }                                                                         \
+  MACE_BENCHMARK(                                                           \
+      MACE_BM_THREADPOOL_SCALING_##DIMS##D_##THREADS##_##ITEMS##_##COST)
+
+#define MACE_BM_THREADPOOL_SHARED(THREADS, ENGINES)                         \
+  static void MACE_BM_THREADPOOL_SHARED_##THREADS##_##ENGINES(int iters) {  \
+    ThreadPoolSharedBenchmark(iters, THREADS, ENGINES);                     \
+  }                                                                         \
+  MACE_BENCHMARK(MACE_BM_THREADPOOL_SHARED_##THREADS##_##ENGINES)
+
+// empty tasks: back to back while the workers spin, then after idle gaps
+// inside and beyond the spin wait time
+MACE_BM_THREADPOOL_DISPATCH(1, 0);
+MACE_BM_THREADPOOL_DISPATCH(2, 0);
+MACE_BM_THREADPOOL_DISPATCH(4, 0);
+MACE_BM_THREADPOOL_DISPATCH(8, 0);
+MACE_BM_THREADPOOL_DISPATCH(4, 1000);
+MACE_BM_THREADPOOL_DISPATCH(4, 5000);
+MACE_BM_THREADPOOL_DISPATCH(4, 50000);
+
+#define MACE_BM_THREADPOOL_SCALING_THREADS(DIMS, ITEMS, COST)  \
+  MACE_BM_THREADPOOL_SCALING(DIMS, 1, ITEMS, COST);           \
+  MACE_BM_THREADPOOL_SCALING(DIMS, 2, ITEMS, COST);           \
+  MACE_BM_THREADPOOL_SCALING(DIMS, 4, ITEMS, COST);           \
+  MACE_BM_THREADPOOL_SCALING(DIMS, 8, ITEMS, COST)
+
+MACE_BM_THREADPOOL_SCALING_THREADS(1, 4096, 10);
+MACE_BM_THREADPOOL_SCALING_THREADS(1, 4096, 1000);
+MACE_BM_THREADPOOL_SCALING_THREADS(1, 64, 100000);
+MACE_BM_THREADPOOL_SCALING_THREADS(2, 4096, 10);
+MACE_BM_THREADPOOL_SCALING_THREADS(2, 4096, 1000);
+MACE_BM_THREADPOOL_SCALING_THREADS(2, 64, 100000);
+MACE_BM_THREADPOOL_SCALING_THREADS(3, 4096, 10);
+MACE_BM_THREADPOOL_SCALING_THREADS(3, 4096, 1000);
+MACE_BM_THREADPOOL_SCALING_THREADS(3, 64, 100000);
+
+MACE_BM_THREADPOOL_SHARED(4, 1);
+MACE_BM_THREADPOOL_SHARED(4, 2);
+MACE_BM_THREADPOOL_SHARED(4, 4);
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
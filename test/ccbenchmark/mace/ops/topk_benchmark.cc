@@ -0,0 +1,80 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/benchmark_utils/test_benchmark.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+namespace {
+template <RuntimeType D, typename T>
+void TopK(int iters, int batch, int length, int k) {
+  mace::testing::StopTiming();
+
+  OpsTestNet net;
+  if (D == RuntimeType::RT_CPU) {
+    net.AddRandomInput<D, T>("Input", {batch, length});
+  } else {
+    MACE_NOT_IMPLEMENTED;
+  }
+
+  OpDefBuilder("TopK", "TopKBM")
+    .Input("Input")
+    .Output("Values")
+    .Output("Indices")
+    .AddIntArg("k", k)
+    .AddIntArg("T", static_cast<int>(DataTypeToEnum<T>::value))
+    .OutputType({DataTypeToEnum<T>::value, DT_INT32})
+    .Finalize(net.NewOperatorDef());
+
+  // Warm-up
+  net.Setup(D);
+  for (int i = 0; i < 5; ++i) {
+    net.Run();
+  }
+  net.Sync();
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.Run();
+  }
+  net.Sync();
+}
+}  // namespace
+
+#define MACE_BM_TOPK_MACRO(N, L, K, TYPE, DEVICE)                   \
+  static void MACE_BM_TOPK_##N##_##L##_##K##_##TYPE##_##DEVICE(     \
+      int iters) {                                                  \
+    const int64_t tot = static_cast<int64_t>(iters) * N * L;        \
+    mace::testing::BytesProcessed(tot *(sizeof(TYPE)));             \
+    TopK<DEVICE, TYPE>(iters, N, L, K);                             \
+  }                                                                 \
+  MACE_BENCHMARK(MACE_BM_TOPK_##N##_##L##_##K##_##TYPE##_##DEVICE)
+
+#define MACE_BM_TOPK(N, L, K) \
+  MACE_BM_TOPK_MACRO(N, L, K, float, RT_CPU)
+
+MACE_BM_TOPK(1, 1000, 5);
+MACE_BM_TOPK(1, 50000, 1);
+MACE_BM_TOPK(1, 50000, 10);
+MACE_BM_TOPK(1, 50000, 500);
+MACE_BM_TOPK(32, 50000, 10);
+MACE_BM_TOPK(128, 1000, 100);
+MACE_BM_TOPK(1, 10000, 5000);
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
@@ -0,0 +1,189 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mace/core/net/calibration_observer.h"
+
+namespace mace {
+namespace {
+
+class CalibrationObserverTest : public ::testing::Test {
+};
+
+std::vector<float> Uniform(const float min, const float max,
+                           const size_t size) {
+  std::vector<float> data(size);
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = min + (max - min) * i / (size - 1);
+  }
+  return data;
+}
+
+// normal values and a few far outliers
+std::vector<float> NormalWithOutliers() {
+  std::mt19937 rng(7);
+  std::normal_distribution<float> normal(0.f, 1.f);
+  std::vector<float> data(100000);
+  for (auto &value : data) {
+    value = normal(rng);
+  }
+  data[10] = 60.f;
+  data[20] = -60.f;
+  return data;
+}
+
+TEST_F(CalibrationObserverTest, Rebin) {
+  CalibrationHistogram histogram;
+  std::vector<float> data = Uniform(0.f, 1.f, 1000);
+  histogram.Add(data.data(), data.size());
+  data = Uniform(-1.f, 3.f, 3000);
+  histogram.Add(data.data(), data.size());
+  EXPECT_EQ(-1.f, histogram.min());
+  EXPECT_EQ(3.f, histogram.max());
+  EXPECT_EQ(4000, histogram.total());
+
+  double total = 0;
+  double below_zero = 0;
+  const int zero_bin = CalibrationHistogram::kBins / 4;
+  for (int i = 0; i < CalibrationHistogram::kBins; ++i) {
+    total += histogram.counts()[i];
+    if (i < zero_bin) {
+      below_zero += histogram.counts()[i];
+    }
+  }
+  EXPECT_NEAR(4000, total, 1e-6);
+  // a quarter of the second batch
+  EXPECT_NEAR(750, below_zero, 2);
+
+  float min = 0.f;
+  float max = 0.f;
+  histogram.SelectRange(CALIBRATION_MINMAX, 100.f, 256, &min, &max);
+  EXPECT_EQ(-1.f, min);
+  EXPECT_EQ(3.f, max);
+}
+
+TEST_F(CalibrationObserverTest, ConstantTensor) {
+  CalibrationHistogram histogram;
+  std::vector<float> data(100, 2.f);
+  histogram.Add(data.data(), data.size());
+  histogram.Add(data.data(), data.size());
+  float min = 0.f;
+  float max = 0.f;
+  histogram.SelectRange(CALIBRATION_KL_DIVERGENCE, 100.f, 256, &min, &max);
+  EXPECT_EQ(2.f, min);
+  EXPECT_EQ(2.f, max);
+
+  data.assign(100, 4.f);
+  histogram.Add(data.data(), data.size());
+  histogram.SelectRange(CALIBRATION_MINMAX, 100.f, 256, &min, &max);
+  EXPECT_EQ(2.f, min);
+  EXPECT_EQ(4.f, max);
+  EXPECT_NEAR(200, histogram.counts()[0], 1e-6);
+  EXPECT_NEAR(100, histogram.counts()[CalibrationHistogram::kBins - 1],
+              1e-6);
+}
+
+TEST_F(CalibrationObserverTest, Percentile) {
+  CalibrationHistogram histogram;
+  std::vector<float> data = Uniform(0.f, 100.f, 100001);
+  histogram.Add(data.data(), data.size());
+  float min = 0.f;
+  float max = 0.f;
+  histogram.SelectRange(CALIBRATION_PERCENTILE, 99.f, 256, &min, &max);
+  EXPECT_NEAR(1.f, min, 0.1f);
+  EXPECT_NEAR(99.f, max, 0.1f);
+}
+
+TEST_F(CalibrationObserverTest, ClipOutliers) {
+  std::vector<float> data = NormalWithOutliers();
+  CalibrationHistogram histogram;
+  histogram.Add(data.data(), data.size());
+  float min = 0.f;
+  float max = 0.f;
+  histogram.SelectRange(CALIBRATION_KL_DIVERGENCE, 100.f, 256, &min, &max);
+  // the outliers are clipped, the bulk of the values is kept
+  EXPECT_LT(max, 30.f);
+  EXPECT_GT(max, 2.f);
+  EXPECT_GT(min, -30.f);
+  EXPECT_LT(min, -2.f);
+
+  // the error of the two outliers weighs against the rounding error of all
+  // the values, 0.128 * r^2 + 2 * (60 - r / 2)^2 is the lowest at r = 95.5
+  histogram.SelectRange(CALIBRATION_MSE, 100.f, 256, &min, &max);
+  EXPECT_NEAR(47.75f, max, 0.5f);
+  EXPECT_NEAR(-47.75f, min, 0.5f);
+}
+
+TEST_F(CalibrationObserverTest, Save) {
+  const std::string file_path = "calibration_observer_test.bin";
+  {
+    CalibrationObserver observer(file_path, CALIBRATION_MINMAX, 100.f);
+    std::vector<float> data = Uniform(-1.f, 2.f, 64);
+    observer.Observe("conv", data.data(), data.size());
+    data = Uniform(0.f, 5.f, 64);
+    observer.Observe("relu", data.data(), data.size());
+    float min = 0.f;
+    float max = 0.f;
+    EXPECT_TRUE(observer.GetRange("conv", &min, &max));
+    EXPECT_EQ(-1.f, min);
+    EXPECT_EQ(2.f, max);
+    EXPECT_FALSE(observer.GetRange("pool", &min, &max));
+  }
+
+  std::ifstream file(file_path, std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+  std::remove(file_path.c_str());
+  const char *ptr = bytes.data();
+  auto read_u32 = [&]() {
+    uint32_t value = 0;
+    memcpy(&value, ptr, sizeof(value));
+    ptr += sizeof(value);
+    return value;
+  };
+  auto read_float = [&]() {
+    float value = 0;
+    memcpy(&value, ptr, sizeof(value));
+    ptr += sizeof(value);
+    return value;
+  };
+  ASSERT_EQ(16u + 2 * (4 + 4 * 4) + 4 + 4, bytes.size());
+  EXPECT_EQ(0, memcmp(ptr, "MCAL", 4));
+  ptr += 4;
+  EXPECT_EQ(1u, read_u32());
+  EXPECT_EQ(static_cast<uint32_t>(CALIBRATION_MINMAX), read_u32());
+  EXPECT_EQ(2u, read_u32());
+  const std::vector<std::string> names = {"conv", "relu"};
+  const std::vector<float> ranges = {-1.f, 2.f, 0.f, 5.f};
+  for (int i = 0; i < 2; ++i) {
+    const uint32_t length = read_u32();
+    EXPECT_EQ(names[i], std::string(ptr, length));
+    ptr += length;
+    EXPECT_EQ(ranges[i * 2], read_float());
+    EXPECT_EQ(ranges[i * 2 + 1], read_float());
+    EXPECT_EQ(ranges[i * 2], read_float());
+    EXPECT_EQ(ranges[i * 2 + 1], read_float());
+  }
+}
+
+}  // namespace
+}  // namespace mace
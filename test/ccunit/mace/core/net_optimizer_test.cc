@@ -0,0 +1,120 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "mace/core/net_optimizer.h"
+#include "mace/core/proto/arg_helper.h"
+
+namespace mace {
+namespace {
+
+class NetOptimizerTest : public ::testing::Test {
+};
+
+OperatorDef *AddOp(NetDef *net_def, const std::string &type,
+                   const std::vector<std::string> &inputs,
+                   const std::string &output, const DataType data_type) {
+  OperatorDef *op_def = net_def->add_op();
+  op_def->set_name(output);
+  op_def->set_type(type);
+  op_def->set_device_type(static_cast<int>(RuntimeType::RT_CPU));
+  for (auto &input : inputs) {
+    op_def->add_input(input);
+  }
+  op_def->add_output(output);
+  SetProtoArg<int>(op_def, "T", static_cast<int>(data_type));
+  return op_def;
+}
+
+OperatorDef *AddQuantize(NetDef *net_def, const std::string &input,
+                         const std::string &output) {
+  OperatorDef *op_def = AddOp(net_def, "Quantize", {input}, output, DT_UINT8);
+  SetProtoArg<int>(op_def, "find_range_every_time", 1);
+  SetProtoArg<int>(op_def, "non_zero", 1);
+  return op_def;
+}
+
+TEST_F(NetOptimizerTest, FuseInputQuantize) {
+  NetDef net_def;
+  AddQuantize(&net_def, "input", "input_quantized");
+  AddOp(&net_def, "Conv2D", {"input_quantized", "filter"}, "conv", DT_UINT8);
+  AddOp(&net_def, "Dequantize", {"conv"}, "conv_float", DT_UINT8);
+  AddQuantize(&net_def, "conv_float", "conv_quantized");
+  auto *quantize = AddQuantize(&net_def, "input", "input_quantized_1");
+  quantize->add_quantize_info()->set_scale(0.5f);
+  quantize->mutable_quantize_info(0)->set_zero_point(3);
+  SetProtoArg<int>(quantize, "find_range_every_time", 0);
+  AddOp(&net_def, "Eltwise", {"conv_quantized", "input_quantized_1"},
+        "output", DT_UINT8);
+  net_def.add_output_info()->set_name("output");
+
+  NetOptimizer net_optimizer;
+  EXPECT_EQ(3, net_optimizer.FuseInputQuantize(&net_def));
+  ASSERT_EQ(3, net_def.op_size());
+  const OperatorDef &conv = net_def.op(0);
+  EXPECT_EQ("Conv2D", conv.type());
+  EXPECT_EQ("input", conv.input(0));
+  EXPECT_EQ(std::vector<int>({0}),
+            (ProtoArgHelper::GetRepeatedArgs<OperatorDef, int>(
+                conv, "fused_quantize_inputs")));
+  EXPECT_EQ(std::vector<int>({1}),
+            (ProtoArgHelper::GetRepeatedArgs<OperatorDef, int>(
+                conv, "fused_quantize_find_ranges")));
+
+  const OperatorDef &eltwise = net_def.op(2);
+  EXPECT_EQ("Eltwise", eltwise.type());
+  EXPECT_EQ("conv_float", eltwise.input(0));
+  EXPECT_EQ("input", eltwise.input(1));
+  EXPECT_EQ(std::vector<int>({0, 1}),
+            (ProtoArgHelper::GetRepeatedArgs<OperatorDef, int>(
+                eltwise, "fused_quantize_inputs")));
+  EXPECT_EQ(std::vector<float>({0.f, 0.5f}),
+            (ProtoArgHelper::GetRepeatedArgs<OperatorDef, float>(
+                eltwise, "fused_quantize_scales")));
+  EXPECT_EQ(std::vector<int>({0, 3}),
+            (ProtoArgHelper::GetRepeatedArgs<OperatorDef, int>(
+                eltwise, "fused_quantize_zero_points")));
+  EXPECT_EQ(std::vector<int>({1, 0}),
+            (ProtoArgHelper::GetRepeatedArgs<OperatorDef, int>(
+                eltwise, "fused_quantize_find_ranges")));
+  EXPECT_EQ(std::vector<int>({1, 1}),
+            (ProtoArgHelper::GetRepeatedArgs<OperatorDef, int>(
+                eltwise, "fused_quantize_non_zeros")));
+}
+
+TEST_F(NetOptimizerTest, KeepSharedQuantize) {
+  NetDef net_def;
+  AddQuantize(&net_def, "input", "input_quantized");
+  AddOp(&net_def, "Conv2D", {"input_quantized", "filter"}, "conv", DT_UINT8);
+  AddOp(&net_def, "Eltwise", {"input_quantized", "conv"}, "eltwise",
+        DT_UINT8);
+  // not a fusible op
+  AddQuantize(&net_def, "input", "pool_input");
+  AddOp(&net_def, "Pooling", {"pool_input"}, "pool", DT_UINT8);
+  // a net output
+  AddQuantize(&net_def, "input", "output");
+  net_def.add_output_info()->set_name("eltwise");
+  net_def.add_output_info()->set_name("pool");
+  net_def.add_output_info()->set_name("output");
+
+  NetOptimizer net_optimizer;
+  EXPECT_EQ(0, net_optimizer.FuseInputQuantize(&net_def));
+  EXPECT_EQ(6, net_def.op_size());
+}
+
+}  // namespace
+}  // namespace mace
@@ -0,0 +1,178 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <mutex>  // NOLINT(build/c++11)
+
+#include "mace/core/proto/arg_helper.h"
+#include "mace/libmace/mace_api_test.h"
+
+namespace mace {
+namespace test {
+
+class MaceAsyncAPITest : public ::testing::Test {};
+
+namespace {
+
+const std::vector<int64_t> kShape = {1, 16, 16, 8};
+const std::vector<int64_t> kFilterShape = {8, 8, 3, 3};
+
+// One 3x3 convolution on CPU, the engine keeps a pointer to `data`.
+std::shared_ptr<MaceEngine> CreateEngine(MultiNetDef *multi_net_def,
+                                         std::vector<float> *data) {
+  NetDef *net_def = multi_net_def->add_net_def();
+  ops::test::GenerateRandomRealTypeData<float>(kFilterShape, data);
+  AddTensor<float>("filter", kFilterShape, 0, data->size(), net_def);
+
+  InputOutputInfo *input_info = net_def->add_input_info();
+  input_info->set_data_format(static_cast<int>(DataFormat::NHWC));
+  input_info->set_name("input");
+  for (auto d : kShape) {
+    input_info->add_dims(static_cast<int>(d));
+  }
+  multi_net_def->add_input_tensor("input");
+  net_def->add_output_info()->set_name("output");
+  multi_net_def->add_output_tensor("output");
+  Conv3x3<float>("input", "filter", "output", kShape, net_def);
+  SetProtoArg(net_def, "runtime_type", static_cast<int>(RT_CPU));
+
+  MaceEngineConfig config;
+  auto engine = std::make_shared<MaceEngine>(config);
+  MaceStatus status = engine->Init(
+      multi_net_def, {"input"}, {"output"},
+      reinterpret_cast<unsigned char *>(data->data()),
+      data->size() * sizeof(float));
+  EXPECT_EQ(status, MaceStatus::MACE_SUCCESS);
+  return engine;
+}
+
+}  // namespace
+
+TEST_F(MaceAsyncAPITest, RunAsync) {
+  MultiNetDef multi_net_def;
+  std::vector<float> data;
+  auto engine = CreateEngine(&multi_net_def, &data);
+
+  const int run_num = 4;
+  std::vector<std::map<std::string, MaceTensor>> inputs(run_num);
+  std::vector<std::map<std::string, MaceTensor>> outputs(run_num);
+  std::vector<MaceRunHandle> handles;
+  std::atomic<int> callback_count(0);
+  for (int i = 0; i < run_num; ++i) {
+    GenerateInputs({"input"}, kShape, &inputs[i]);
+    GenerateOutputs({"output"}, kShape, &outputs[i]);
+    handles.push_back(engine->RunAsync(
+        inputs[i], &outputs[i], [&callback_count](const MaceStatus &status) {
+          EXPECT_EQ(status, MaceStatus::MACE_SUCCESS);
+          ++callback_count;
+        }));
+  }
+
+  for (int i = 0; i < run_num; ++i) {
+    EXPECT_TRUE(handles[i].Valid());
+    EXPECT_EQ(handles[i].Wait(), MaceStatus::MACE_SUCCESS);
+    EXPECT_TRUE(handles[i].IsDone());
+    CheckOutputs<RT_CPU, float>(multi_net_def.net_def(0), inputs[i],
+                                outputs[i], data);
+  }
+  EXPECT_EQ(callback_count, run_num);
+}
+
+TEST_F(MaceAsyncAPITest, CancelAndDeadline) {
+  MultiNetDef multi_net_def;
+  std::vector<float> data;
+  auto engine = CreateEngine(&multi_net_def, &data);
+
+  std::map<std::string, MaceTensor> inputs;
+  std::map<std::string, MaceTensor> outputs[3];
+  GenerateInputs({"input"}, kShape, &inputs);
+  for (auto &output : outputs) {
+    GenerateOutputs({"output"}, kShape, &output);
+  }
+
+  // the callback of the first run holds the executor until both of the
+  // following runs are queued and the second one is cancelled
+  std::mutex mutex;
+  std::condition_variable cond;
+  bool released = false;
+  auto blocker = engine->RunAsync(
+      inputs, &outputs[0], [&](const MaceStatus &status) {
+        EXPECT_EQ(status, MaceStatus::MACE_SUCCESS);
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&] { return released; });
+      });
+  MaceStatus cancelled_status;
+  auto cancelled = engine->RunAsync(
+      inputs, &outputs[1], [&](const MaceStatus &status) {
+        cancelled_status = status;
+      });
+  auto expired = engine->RunAsync(inputs, &outputs[2], nullptr, 0);
+  cancelled.Cancel();
+  EXPECT_FALSE(cancelled.WaitFor(1000));
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    released = true;
+  }
+  cond.notify_all();
+
+  EXPECT_EQ(blocker.Wait(), MaceStatus::MACE_SUCCESS);
+  EXPECT_EQ(cancelled.Wait(), MaceStatus::MACE_CANCELLED);
+  EXPECT_EQ(cancelled_status, MaceStatus::MACE_CANCELLED);
+  EXPECT_EQ(expired.Wait(), MaceStatus::MACE_DEADLINE_EXCEEDED);
+
+  // the engine is still usable after interrupted runs
+  EXPECT_EQ(engine->RunAsync(inputs, &outputs[1]).Wait(),
+            MaceStatus::MACE_SUCCESS);
+  EXPECT_EQ(engine->Run(inputs, &outputs[2]), MaceStatus::MACE_SUCCESS);
+}
+
+TEST_F(MaceAsyncAPITest, ReleaseEngineInCallback) {
+  MultiNetDef multi_net_def;
+  std::vector<float> data;
+  auto engine = CreateEngine(&multi_net_def, &data);
+
+  std::map<std::string, MaceTensor> inputs;
+  std::map<std::string, MaceTensor> outputs[2];
+  GenerateInputs({"input"}, kShape, &inputs);
+  for (auto &output : outputs) {
+    GenerateOutputs({"output"}, kShape, &output);
+  }
+
+  // the callback of the first run drops the last reference to the engine
+  // once the second run is queued, which is then dropped with the engine
+  std::mutex mutex;
+  std::condition_variable cond;
+  bool queued = false;
+  auto releaser = engine->RunAsync(
+      inputs, &outputs[0], [&](const MaceStatus &status) {
+        EXPECT_EQ(status, MaceStatus::MACE_SUCCESS);
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&] { return queued; });
+        engine.reset();
+      });
+  auto dropped = engine->RunAsync(inputs, &outputs[1]);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queued = true;
+  }
+  cond.notify_all();
+
+  EXPECT_EQ(releaser.Wait(), MaceStatus::MACE_SUCCESS);
+  EXPECT_EQ(dropped.Wait(), MaceStatus::MACE_CANCELLED);
+  EXPECT_EQ(engine, nullptr);
+}
+
+}  // namespace test
+}  // namespace mace
@@ -12,9 +12,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
 #include "mace/core/memory/memory_manager.h"
 #include "mace/core/proto/arg_helper.h"
 #include "mace/libmace/mace_api_test.h"
+#include "mace/ops/common/eltwise_type.h"
+#include "mace/ops/common/pooling_type.h"
 #ifdef MACE_ENABLE_OPENCL
 #include "mace/runtimes/opencl/opencl_runtime.h"
 #endif  // MACE_ENABLE_OPENCL
@@ -194,8 +202,571 @@ void MaceRun(const int in_out_size,
   CheckOutputs<D, T>(*net_def, inputs, outputs, data);
 }
 
+// Two heads on one input, only the requested head should be computed.
+void MacePartialRun() {
+  const std::vector<int64_t> shape = {1, 16, 16, 8};
+  const std::vector<int64_t> filter_shape = {8, 8, 3, 3};
+  std::shared_ptr<MultiNetDef> multi_net_def(new MultiNetDef());
+  NetDef *net_def = multi_net_def->add_net_def();
+
+  std::vector<float> data;
+  ops::test::GenerateRandomRealTypeData<float>(filter_shape, &data);
+  AddTensor<float>("filter", filter_shape, 0, data.size(), net_def);
+
+  InputOutputInfo *input_info = net_def->add_input_info();
+  input_info->set_data_format(static_cast<int>(DataFormat::NHWC));
+  input_info->set_name("input");
+  for (auto d : shape) {
+    input_info->add_dims(static_cast<int>(d));
+  }
+  multi_net_def->add_input_tensor("input");
+  const std::vector<std::string> output_names = {"output0", "output1"};
+  for (auto &output_name : output_names) {
+    net_def->add_output_info()->set_name(output_name);
+    multi_net_def->add_output_tensor(output_name);
+    Conv3x3<float>("input", "filter", output_name, shape, net_def);
+  }
+  SetProtoArg(net_def, "runtime_type", static_cast<int>(RT_CPU));
+
+  MaceEngineConfig config;
+  MaceEngine engine(config);
+  MaceStatus status = engine.Init(
+      multi_net_def.get(), {"input"}, output_names,
+      reinterpret_cast<unsigned char *>(data.data()),
+      data.size() * sizeof(float));
+  EXPECT_EQ(status, MaceStatus::MACE_SUCCESS);
+
+  std::map<std::string, mace::MaceTensor> inputs;
+  std::map<std::string, mace::MaceTensor> outputs;
+  GenerateInputs({"input"}, shape, &inputs);
+  GenerateOutputs(output_names, shape, &outputs);
+  RunMetadata full_metadata;
+  EXPECT_EQ(engine.Run(inputs, &outputs, &full_metadata),
+            MaceStatus::MACE_SUCCESS);
+
+  for (auto &output_name : output_names) {
+    std::map<std::string, mace::MaceTensor> partial_outputs;
+    GenerateOutputs({output_name}, shape, &partial_outputs);
+    RunMetadata partial_metadata;
+    EXPECT_EQ(engine.Run(inputs, &partial_outputs, &partial_metadata),
+              MaceStatus::MACE_SUCCESS);
+    EXPECT_LT(partial_metadata.op_stats.size(), full_metadata.op_stats.size());
+    CheckOutputs<RT_CPU, float>(*net_def, inputs, partial_outputs, data);
+  }
+}
+
+// The filter goes through a Relu at init, only the convolution is run.
+void MaceConstantFoldingRun() {
+  const std::vector<int64_t> shape = {1, 16, 16, 8};
+  const std::vector<int64_t> filter_shape = {8, 8, 3, 3};
+  std::shared_ptr<MultiNetDef> multi_net_def(new MultiNetDef());
+  NetDef *net_def = multi_net_def->add_net_def();
+
+  std::vector<float> data;
+  ops::test::GenerateRandomRealTypeData<float>(filter_shape, &data);
+  AddTensor<float>("filter", filter_shape, 0, data.size(), net_def);
+
+  InputOutputInfo *input_info = net_def->add_input_info();
+  input_info->set_data_format(static_cast<int>(DataFormat::NHWC));
+  input_info->set_name("input");
+  for (auto d : shape) {
+    input_info->add_dims(static_cast<int>(d));
+  }
+  multi_net_def->add_input_tensor("input");
+  net_def->add_output_info()->set_name("output");
+  multi_net_def->add_output_tensor("output");
+  Relu<float>("filter", "filter_relu", RT_CPU, net_def);
+  Conv3x3<float>("input", "filter_relu", "output", shape, net_def);
+  SetProtoArg(net_def, "runtime_type", static_cast<int>(RT_CPU));
+
+  MaceEngineConfig config;
+  MaceEngine engine(config);
+  MaceStatus status = engine.Init(
+      multi_net_def.get(), {"input"}, {"output"},
+      reinterpret_cast<unsigned char *>(data.data()),
+      data.size() * sizeof(float));
+  EXPECT_EQ(status, MaceStatus::MACE_SUCCESS);
+
+  std::map<std::string, mace::MaceTensor> inputs;
+  std::map<std::string, mace::MaceTensor> outputs;
+  GenerateInputs({"input"}, shape, &inputs);
+  GenerateOutputs({"output"}, shape, &outputs);
+  RunMetadata metadata;
+  EXPECT_EQ(engine.Run(inputs, &outputs, &metadata),
+            MaceStatus::MACE_SUCCESS);
+  for (auto &op_stats : metadata.op_stats) {
+    EXPECT_NE(op_stats.type, "Activation");
+  }
+
+  // reference: the same convolution on the rectified filter
+  std::vector<float> ref_data(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    ref_data[i] = std::max(data[i], 0.f);
+  }
+  NetDef ref_net_def(*net_def);
+  ref_net_def.clear_op();
+  Conv3x3<float>("input", "filter", "output", shape, &ref_net_def);
+  CheckOutputs<RT_CPU, float>(ref_net_def, inputs, outputs, ref_data);
+}
+
+std::shared_ptr<MaceEngine> CreateCpuEngine(MultiNetDef *multi_net_def,
+                                            std::vector<float> *data) {
+  NetDef *net_def = multi_net_def->mutable_net_def(0);
+  InputOutputInfo *input_info = net_def->add_input_info();
+  input_info->set_data_format(static_cast<int>(DataFormat::NHWC));
+  input_info->set_name("input");
+  for (auto d : {1, 16, 16, 8}) {
+    input_info->add_dims(d);
+  }
+  multi_net_def->add_input_tensor("input");
+  net_def->add_output_info()->set_name("output");
+  multi_net_def->add_output_tensor("output");
+  SetProtoArg(net_def, "runtime_type", static_cast<int>(RT_CPU));
+
+  MaceEngineConfig config;
+  auto engine = std::make_shared<MaceEngine>(config);
+  MaceStatus status = engine->Init(
+      multi_net_def, {"input"}, {"output"},
+      reinterpret_cast<unsigned char *>(data->data()),
+      data->size() * sizeof(float));
+  EXPECT_EQ(status, MaceStatus::MACE_SUCCESS);
+  return engine;
+}
+
+// output = relu(transpose^-1(transpose(conv))) + relu(conv'), where conv'
+// duplicates conv, and a Relu nobody reads; only one convolution, one Relu
+// and the sum are run.
+void MaceRedundantOpsRun() {
+  const std::vector<int64_t> shape = {1, 16, 16, 8};
+  const std::vector<int64_t> filter_shape = {8, 8, 3, 3};
+  std::vector<float> data;
+  ops::test::GenerateRandomRealTypeData<float>(filter_shape, &data);
+
+  MultiNetDef multi_net_def;
+  NetDef *net_def = multi_net_def.add_net_def();
+  AddTensor<float>("filter", filter_shape, 0, data.size(), net_def);
+  Conv3x3<float>("input", "filter", "conv_a", shape, net_def);
+  Conv3x3<float>("input", "filter", "conv_b", shape, net_def);
+  ops::test::OpDefBuilder("Transpose", "TransposeTest")
+      .Input("conv_a")
+      .Output("conv_a_nhwc")
+      .AddIntsArg("dims", {0, 2, 3, 1})
+      .AddIntArg("T", static_cast<int>(DT_FLOAT))
+      .AddIntArg("device", static_cast<int>(RT_CPU))
+      .Finalize(net_def->add_op());
+  ops::test::OpDefBuilder("Transpose", "TransposeTest")
+      .Input("conv_a_nhwc")
+      .Output("conv_a_nchw")
+      .AddIntsArg("dims", {0, 3, 1, 2})
+      .AddIntArg("T", static_cast<int>(DT_FLOAT))
+      .AddIntArg("device", static_cast<int>(RT_CPU))
+      .Finalize(net_def->add_op());
+  Relu<float>("conv_a_nchw", "relu_a", RT_CPU, net_def);
+  Relu<float>("conv_b", "relu_b", RT_CPU, net_def);
+  Relu<float>("input", "unused", RT_CPU, net_def);
+  ops::test::OpDefBuilder("Eltwise", "EltwiseTest")
+      .Input("relu_a")
+      .Input("relu_b")
+      .Output("output")
+      .AddIntArg("type", static_cast<int>(ops::EltwiseType::SUM))
+      .AddIntArg("T", static_cast<int>(DT_FLOAT))
+      .AddIntArg("device", static_cast<int>(RT_CPU))
+      .AddIntArg("data_format", static_cast<int>(DataFormat::AUTO))
+      .Finalize(net_def->add_op());
+  auto engine = CreateCpuEngine(&multi_net_def, &data);
+
+  MultiNetDef ref_multi_net_def;
+  NetDef *ref_net_def = ref_multi_net_def.add_net_def();
+  AddTensor<float>("filter", filter_shape, 0, data.size(), ref_net_def);
+  Conv3x3<float>("input", "filter", "output", shape, ref_net_def);
+  auto ref_engine = CreateCpuEngine(&ref_multi_net_def, &data);
+
+  std::map<std::string, mace::MaceTensor> inputs;
+  std::map<std::string, mace::MaceTensor> outputs;
+  std::map<std::string, mace::MaceTensor> ref_outputs;
+  GenerateInputs({"input"}, shape, &inputs);
+  GenerateOutputs({"output"}, shape, &outputs);
+  GenerateOutputs({"output"}, shape, &ref_outputs);
+  RunMetadata metadata;
+  EXPECT_EQ(engine->Run(inputs, &outputs, &metadata),
+            MaceStatus::MACE_SUCCESS);
+  EXPECT_EQ(ref_engine->Run(inputs, &ref_outputs), MaceStatus::MACE_SUCCESS);
+  EXPECT_EQ(metadata.op_stats.size(), 3u);
+
+  const float *output = outputs["output"].data().get();
+  const float *conv = ref_outputs["output"].data().get();
+  for (int i = 0; i < 16 * 16 * 8; ++i) {
+    EXPECT_NEAR(2 * std::max(conv[i], 0.f), output[i], 1e-5);
+  }
+}
+
+// output = conv(input0) + relu(input1)
+std::shared_ptr<MaceEngine> CreateTwoInputEngine(int cache_size,
+                                                 MultiNetDef *multi_net_def,
+                                                 std::vector<float> *data) {
+  const std::vector<int64_t> shape = {1, 16, 16, 8};
+  const std::vector<int64_t> filter_shape = {8, 8, 3, 3};
+  NetDef *net_def = multi_net_def->add_net_def();
+  AddTensor<float>("filter", filter_shape, 0, data->size(), net_def);
+  for (std::string input_name : {"input0", "input1"}) {
+    InputOutputInfo *input_info = net_def->add_input_info();
+    input_info->set_data_format(static_cast<int>(DataFormat::NHWC));
+    input_info->set_name(input_name);
+    for (auto d : shape) {
+      input_info->add_dims(static_cast<int>(d));
+    }
+    multi_net_def->add_input_tensor(input_name);
+  }
+  net_def->add_output_info()->set_name("output");
+  multi_net_def->add_output_tensor("output");
+  Conv3x3<float>("input0", "filter", "conv", shape, net_def);
+  Relu<float>("input1", "relu", RT_CPU, net_def);
+  ops::test::OpDefBuilder("Eltwise", "EltwiseTest")
+      .Input("conv")
+      .Input("relu")
+      .Output("output")
+      .AddIntArg("type", static_cast<int>(ops::EltwiseType::SUM))
+      .AddIntArg("T", static_cast<int>(DT_FLOAT))
+      .AddIntArg("device", static_cast<int>(RT_CPU))
+      .AddIntArg("data_format", static_cast<int>(DataFormat::AUTO))
+      .Finalize(net_def->add_op());
+  SetProtoArg(net_def, "runtime_type", static_cast<int>(RT_CPU));
+
+  MaceEngineConfig config;
+  EXPECT_EQ(config.SetResultCache(cache_size), MaceStatus::MACE_SUCCESS);
+  auto engine = std::make_shared<MaceEngine>(config);
+  MaceStatus status = engine->Init(
+      multi_net_def, {"input0", "input1"}, {"output"},
+      reinterpret_cast<unsigned char *>(data->data()),
+      data->size() * sizeof(float));
+  EXPECT_EQ(status, MaceStatus::MACE_SUCCESS);
+  return engine;
+}
+
+void MaceResultCacheRun() {
+  const std::vector<int64_t> shape = {1, 16, 16, 8};
+  std::vector<float> data;
+  ops::test::GenerateRandomRealTypeData<float>({8, 8, 3, 3}, &data);
+  MultiNetDef multi_net_def;
+  auto engine = CreateTwoInputEngine(1, &multi_net_def, &data);
+  MultiNetDef ref_multi_net_def;
+  auto ref_engine = CreateTwoInputEngine(0, &ref_multi_net_def, &data);
+
+  std::map<std::string, mace::MaceTensor> inputs;
+  std::map<std::string, mace::MaceTensor> new_inputs;
+  GenerateInputs({"input0", "input1"}, shape, &inputs);
+  GenerateInputs({"input1"}, shape, &new_inputs);
+  new_inputs.emplace("input0", inputs.at("input0"));
+  auto check_run = [&](const std::map<std::string, MaceTensor> &run_inputs,
+                       const size_t expected_op_count) {
+    std::map<std::string, mace::MaceTensor> outputs;
+    std::map<std::string, mace::MaceTensor> ref_outputs;
+    GenerateOutputs({"output"}, shape, &outputs);
+    GenerateOutputs({"output"}, shape, &ref_outputs);
+    RunMetadata metadata;
+    EXPECT_EQ(engine->Run(run_inputs, &outputs, &metadata),
+              MaceStatus::MACE_SUCCESS);
+    EXPECT_EQ(ref_engine->Run(run_inputs, &ref_outputs),
+              MaceStatus::MACE_SUCCESS);
+    EXPECT_EQ(metadata.op_stats.size(), expected_op_count);
+    const float *output = outputs["output"].data().get();
+    const float *expected = ref_outputs["output"].data().get();
+    for (int i = 0; i < 16 * 16 * 8; ++i) {
+      EXPECT_NEAR(expected[i], output[i], 1e-5);
+    }
+  };
+
+  check_run(inputs, 3);
+  // the same inputs hit the cache
+  check_run(inputs, 0);
+  // input0 did not change, the convolution is skipped
+  check_run(new_inputs, 2);
+  // the first run was evicted, only the Relu and the sum run again
+  check_run(inputs, 2);
+}
+
+void Pooling(const std::string &input_name, const std::string &output_name,
+             const PoolingType pooling_type, const int kernel,
+             const int stride, const Padding padding, NetDef *net_def) {
+  ops::test::OpDefBuilder("Pooling", "PoolingTest")
+      .Input(input_name)
+      .Output(output_name)
+      .AddIntArg("pooling_type", pooling_type)
+      .AddIntsArg("kernels", {kernel, kernel})
+      .AddIntsArg("strides", {stride, stride})
+      .AddIntArg("padding", padding)
+      .AddIntsArg("dilations", {1, 1})
+      .AddIntArg("T", static_cast<int>(DT_FLOAT))
+      .AddIntArg("device", static_cast<int>(RT_CPU))
+      .AddIntArg("data_format", static_cast<int>(DataFormat::AUTO))
+      .Finalize(net_def->add_op());
+}
+
+// conv -> relu -> 2x2 max pooling -> 3x3 average pooling -> conv
+MaceStatus InitFrameEngine(const MaceEngineConfig &config,
+                           MultiNetDef *multi_net_def,
+                           std::vector<float> *data,
+                           std::shared_ptr<MaceEngine> *engine) {
+  const std::vector<int64_t> shape = {1, 16, 16, 8};
+  const std::vector<int64_t> pooled_shape = {1, 8, 8, 8};
+  NetDef *net_def = multi_net_def->add_net_def();
+  AddTensor<float>("filter", {8, 8, 3, 3}, 0, data->size(), net_def);
+  InputOutputInfo *input_info = net_def->add_input_info();
+  input_info->set_data_format(static_cast<int>(DataFormat::NHWC));
+  input_info->set_name("input");
+  for (auto d : shape) {
+    input_info->add_dims(static_cast<int>(d));
+  }
+  multi_net_def->add_input_tensor("input");
+  net_def->add_output_info()->set_name("output");
+  multi_net_def->add_output_tensor("output");
+  Conv3x3<float>("input", "filter", "conv", shape, net_def);
+  Relu<float>("conv", "relu", RT_CPU, net_def);
+  Pooling("relu", "max_pool", PoolingType::MAX, 2, 2, Padding::VALID,
+          net_def);
+  Pooling("max_pool", "avg_pool", PoolingType::AVG, 3, 1, Padding::SAME,
+          net_def);
+  Conv3x3<float>("avg_pool", "filter", "output", pooled_shape, net_def);
+  // gives the memory planner the real sizes of the intermediate outputs
+  const std::vector<std::vector<int64_t>> op_output_shapes = {
+      shape, shape, pooled_shape, pooled_shape, pooled_shape};
+  for (int i = 1; i < 4; ++i) {
+    OutputShape *output_shape = net_def->mutable_op(i)->add_output_shape();
+    for (auto dim : op_output_shapes[i]) {
+      output_shape->add_dims(dim);
+    }
+  }
+  SetProtoArg(net_def, "runtime_type", static_cast<int>(RT_CPU));
+
+  *engine = std::make_shared<MaceEngine>(config);
+  return (*engine)->Init(
+      multi_net_def, {"input"}, {"output"},
+      reinterpret_cast<unsigned char *>(data->data()),
+      data->size() * sizeof(float));
+}
+
+std::shared_ptr<MaceEngine> CreateFrameEngine(bool incremental,
+                                              MultiNetDef *multi_net_def,
+                                              std::vector<float> *data) {
+  MaceEngineConfig config;
+  EXPECT_EQ(config.SetIncrementalRun(incremental), MaceStatus::MACE_SUCCESS);
+  std::shared_ptr<MaceEngine> engine;
+  EXPECT_EQ(InitFrameEngine(config, multi_net_def, data, &engine),
+            MaceStatus::MACE_SUCCESS);
+  return engine;
+}
+
+void MaceIncrementalRun() {
+  const std::vector<int64_t> shape = {1, 16, 16, 8};
+  const std::vector<int64_t> output_shape = {1, 8, 8, 8};
+  std::vector<float> data;
+  ops::test::GenerateRandomRealTypeData<float>({8, 8, 3, 3}, &data);
+  MultiNetDef multi_net_def;
+  auto engine = CreateFrameEngine(true, &multi_net_def, &data);
+  MultiNetDef ref_multi_net_def;
+  auto ref_engine = CreateFrameEngine(false, &ref_multi_net_def, &data);
+
+  std::map<std::string, mace::MaceTensor> inputs;
+  GenerateInputs({"input"}, shape, &inputs);
+  auto check_run = [&](const size_t expected_op_count) {
+    std::map<std::string, mace::MaceTensor> outputs;
+    std::map<std::string, mace::MaceTensor> ref_outputs;
+    GenerateOutputs({"output"}, output_shape, &outputs);
+    GenerateOutputs({"output"}, output_shape, &ref_outputs);
+    RunMetadata metadata;
+    EXPECT_EQ(engine->Run(inputs, &outputs, &metadata),
+              MaceStatus::MACE_SUCCESS);
+    EXPECT_EQ(ref_engine->Run(inputs, &ref_outputs),
+              MaceStatus::MACE_SUCCESS);
+    EXPECT_EQ(metadata.op_stats.size(), expected_op_count);
+    const float *output = outputs["output"].data().get();
+    const float *expected = ref_outputs["output"].data().get();
+    for (int i = 0; i < 8 * 8 * 8; ++i) {
+      EXPECT_NEAR(expected[i], output[i], 1e-4);
+    }
+  };
+  // changes all the channels of the NHWC pixel (h, w)
+  auto change_pixel = [&](const int h, const int w) {
+    float *input = inputs["input"].data().get();
+    for (int c = 0; c < 8; ++c) {
+      input[(h * 16 + w) * 8 + c] += 1.f;
+    }
+  };
+
+  check_run(5);
+  // nothing changed, nothing runs
+  check_run(0);
+  change_pixel(7, 9);
+  check_run(5);
+  // the average pooling reads its padding, it reruns fully
+  change_pixel(0, 0);
+  check_run(5);
+  change_pixel(12, 3);
+  change_pixel(13, 5);
+  check_run(5);
+  check_run(0);
+}
+
+void MaceMemoryBudgetRun() {
+  const std::vector<int64_t> shape = {1, 16, 16, 8};
+  const std::vector<int64_t> output_shape = {1, 8, 8, 8};
+  std::vector<float> data;
+  ops::test::GenerateRandomRealTypeData<float>({8, 8, 3, 3}, &data);
+
+  std::map<std::string, mace::MaceTensor> inputs;
+  GenerateInputs({"input"}, shape, &inputs);
+  MultiNetDef multi_net_def;
+  auto engine = CreateFrameEngine(false, &multi_net_def, &data);
+  std::map<std::string, mace::MaceTensor> outputs;
+  GenerateOutputs({"output"}, output_shape, &outputs);
+  EXPECT_EQ(engine->Run(inputs, &outputs), MaceStatus::MACE_SUCCESS);
+  MemoryUsage usage;
+  EXPECT_EQ(engine->GetMemoryUsage(&usage), MaceStatus::MACE_SUCCESS);
+  // the filter is sliced from the model data
+  EXPECT_EQ(usage.weights.current_bytes,
+            static_cast<int64_t>(data.size() * sizeof(float)));
+  EXPECT_GT(usage.activations.current_bytes, 0);
+  EXPECT_EQ(usage.total.current_bytes,
+            usage.private_buffers.current_bytes +
+                usage.activations.current_bytes +
+                usage.scratch.current_bytes);
+  EXPECT_GE(usage.total.peak_bytes, usage.total.current_bytes);
+  const int64_t planned_bytes = usage.total.peak_bytes;
+
+  // keeping all the outputs costs more than sharing the planned buffers
+  MultiNetDef incremental_multi_net_def;
+  auto incremental_engine =
+      CreateFrameEngine(true, &incremental_multi_net_def, &data);
+  MemoryUsage incremental_usage;
+  EXPECT_EQ(incremental_engine->GetMemoryUsage(&incremental_usage),
+            MaceStatus::MACE_SUCCESS);
+  EXPECT_GT(incremental_usage.total.current_bytes, planned_bytes);
+
+  // within the budget of the planned buffers the incremental run is given up
+  MaceEngineConfig config;
+  EXPECT_EQ(config.SetIncrementalRun(true), MaceStatus::MACE_SUCCESS);
+  EXPECT_EQ(config.SetMemoryBudget(planned_bytes), MaceStatus::MACE_SUCCESS);
+  MultiNetDef budget_multi_net_def;
+  std::shared_ptr<MaceEngine> budget_engine;
+  EXPECT_EQ(InitFrameEngine(config, &budget_multi_net_def, &data,
+                            &budget_engine),
+            MaceStatus::MACE_SUCCESS);
+  MemoryUsage budget_usage;
+  EXPECT_EQ(budget_engine->GetMemoryUsage(&budget_usage),
+            MaceStatus::MACE_SUCCESS);
+  EXPECT_LE(budget_usage.total.current_bytes, planned_bytes);
+
+  for (int i = 0; i < 2; ++i) {
+    std::map<std::string, mace::MaceTensor> outputs;
+    std::map<std::string, mace::MaceTensor> ref_outputs;
+    GenerateOutputs({"output"}, output_shape, &outputs);
+    GenerateOutputs({"output"}, output_shape, &ref_outputs);
+    RunMetadata metadata;
+    EXPECT_EQ(budget_engine->Run(inputs, &outputs, &metadata),
+              MaceStatus::MACE_SUCCESS);
+    EXPECT_EQ(engine->Run(inputs, &ref_outputs), MaceStatus::MACE_SUCCESS);
+    // every operator runs, even with unchanged inputs
+    EXPECT_EQ(metadata.op_stats.size(), 5u);
+    const float *output = outputs["output"].data().get();
+    const float *expected = ref_outputs["output"].data().get();
+    for (int j = 0; j < 8 * 8 * 8; ++j) {
+      EXPECT_NEAR(expected[j], output[j], 1e-4);
+    }
+  }
+
+  // a budget too small for the net fails Init cleanly
+  MaceEngineConfig small_config;
+  EXPECT_EQ(small_config.SetMemoryBudget(1024), MaceStatus::MACE_SUCCESS);
+  MultiNetDef small_multi_net_def;
+  std::shared_ptr<MaceEngine> small_engine;
+  EXPECT_EQ(InitFrameEngine(small_config, &small_multi_net_def, &data,
+                            &small_engine),
+            MaceStatus::MACE_OUT_OF_RESOURCES);
+  EXPECT_EQ(small_config.SetMemoryBudget(-1), MaceStatus::MACE_INVALID_ARGS);
+}
+
+void MaceCalibrationRun() {
+  const std::vector<int64_t> shape = {1, 16, 16, 8};
+  const std::vector<int64_t> output_shape = {1, 8, 8, 8};
+  const std::string file_path = "mace_api_test_calibration.bin";
+  std::vector<float> data;
+  ops::test::GenerateRandomRealTypeData<float>({8, 8, 3, 3}, &data);
+  setenv("MACE_CALIBRATION_FILE", file_path.c_str(), 1);
+  setenv("MACE_CALIBRATION_METHOD", "minmax", 1);
+  {
+    MultiNetDef multi_net_def;
+    auto engine = CreateFrameEngine(false, &multi_net_def, &data);
+    for (int i = 0; i < 3; ++i) {
+      std::map<std::string, mace::MaceTensor> inputs;
+      std::map<std::string, mace::MaceTensor> outputs;
+      GenerateInputs({"input"}, shape, &inputs);
+      GenerateOutputs({"output"}, output_shape, &outputs);
+      EXPECT_EQ(engine->Run(inputs, &outputs), MaceStatus::MACE_SUCCESS);
+    }
+  }
+  unsetenv("MACE_CALIBRATION_FILE");
+  unsetenv("MACE_CALIBRATION_METHOD");
+
+  // the ranges are saved when the engine is destroyed
+  std::ifstream file(file_path, std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+  std::remove(file_path.c_str());
+  ASSERT_GT(bytes.size(), 16u);
+  EXPECT_EQ(0, memcmp(bytes.data(), "MCAL", 4));
+  uint32_t count = 0;
+  memcpy(&count, bytes.data() + 12, sizeof(count));
+  std::map<std::string, std::pair<float, float>> ranges;
+  size_t offset = 16;
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t length = 0;
+    memcpy(&length, bytes.data() + offset, sizeof(length));
+    std::string name(bytes.data() + offset + 4, length);
+    offset += 4 + length;
+    float range[2];
+    memcpy(range, bytes.data() + offset, sizeof(range));
+    ranges[name] = std::make_pair(range[0], range[1]);
+    offset += 4 * sizeof(float);
+  }
+  EXPECT_EQ(bytes.size(), offset);
+  for (auto name : {"conv", "relu", "max_pool", "avg_pool", "output"}) {
+    ASSERT_EQ(1u, ranges.count(name)) << name;
+    EXPECT_LE(ranges[name].first, ranges[name].second) << name;
+  }
+  EXPECT_EQ(std::max(0.f, ranges["conv"].first), ranges["relu"].first);
+  EXPECT_EQ(std::max(0.f, ranges["conv"].second), ranges["relu"].second);
+}
+
 }  // namespace
 
+TEST_F(MaceAPITest, PartialOutputs) {
+  MacePartialRun();
+}
+
+TEST_F(MaceAPITest, ConstantFolding) {
+  MaceConstantFoldingRun();
+}
+
+TEST_F(MaceAPITest, RedundantOps) {
+  MaceRedundantOpsRun();
+}
+
+TEST_F(MaceAPITest, ResultCache) {
+  MaceResultCacheRun();
+}
+
+TEST_F(MaceAPITest, IncrementalRun) {
+  MaceIncrementalRun();
+}
+
+TEST_F(MaceAPITest, MemoryBudget) {
+  MaceMemoryBudgetRun();
+}
+
+TEST_F(MaceAPITest, Calibration) {
+  MaceCalibrationRun();
+}
+
 TEST_F(MaceAPITest, SingleInputOutput) {
   MaceRun<RT_CPU, float>(1,
                          {1, 32, 32, 16},
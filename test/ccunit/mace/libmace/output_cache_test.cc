@@ -0,0 +1,75 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mace/libmace/engines/output_cache.h"
+
+namespace mace {
+namespace test {
+
+class OutputCacheTest : public ::testing::Test {};
+
+namespace {
+
+MaceTensor CreateTensor(const std::vector<int64_t> &shape,
+                        const float value) {
+  int64_t size = 1;
+  for (auto dim : shape) {
+    size *= dim;
+  }
+  std::shared_ptr<float> data(new float[size],
+                              std::default_delete<float[]>());
+  std::fill_n(data.get(), size, value);
+  return MaceTensor(shape, data);
+}
+
+}  // namespace
+
+TEST_F(OutputCacheTest, HashHitComparesInputs) {
+  OutputCache cache(2);
+  std::map<std::string, MaceTensor> inputs = {
+      {"input", CreateTensor({1, 4}, 1.f)}};
+  std::map<std::string, MaceTensor> outputs = {
+      {"output", CreateTensor({1, 2}, 3.f)}};
+  uint64_t key = 0;
+  ASSERT_TRUE(cache.ComputeKey(inputs, outputs, &key));
+  cache.Insert(key, inputs, outputs);
+
+  std::map<std::string, MaceTensor> new_outputs = {
+      {"output", CreateTensor({1, 2}, 0.f)}};
+  // other inputs falling on the same key, as a hash collision would
+  std::map<std::string, MaceTensor> other_inputs = {
+      {"input", CreateTensor({1, 4}, 2.f)}};
+  EXPECT_FALSE(cache.Lookup(key, other_inputs, &new_outputs));
+  std::map<std::string, MaceTensor> reshaped_inputs = {
+      {"input", CreateTensor({2, 2}, 1.f)}};
+  EXPECT_FALSE(cache.Lookup(key, reshaped_inputs, &new_outputs));
+  std::map<std::string, MaceTensor> renamed_inputs = {
+      {"other", CreateTensor({1, 4}, 1.f)}};
+  EXPECT_FALSE(cache.Lookup(key, renamed_inputs, &new_outputs));
+  EXPECT_EQ(0.f, new_outputs.at("output").data().get()[0]);
+
+  EXPECT_TRUE(cache.Lookup(key, inputs, &new_outputs));
+  EXPECT_EQ(3.f, new_outputs.at("output").data().get()[0]);
+  EXPECT_EQ(3.f, new_outputs.at("output").data().get()[1]);
+}
+
+}  // namespace test
+}  // namespace mace
@@ -12,6 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
 #include "mace/ops/ops_test_util.h"
 
 namespace mace {
@@ -50,6 +57,58 @@ void ArgMaxTest(const std::vector<index_t> &input_shape,
   auto expected = net.CreateTensor<int32_t>(output_shape, output);
   ExpectTensorNear<int32_t>(*expected, *net.GetOutput("Output"), 1e-5);
 }
+
+// Checks against the pairs partial_sort selects: the last max or the
+// first min.
+void RandomTest(const std::vector<index_t> &shape, const int axis,
+                const bool argmin) {
+  OpsTestNet net;
+  const index_t size = std::accumulate(shape.begin(), shape.end(),
+                                       static_cast<index_t>(1),
+                                       std::multiplies<index_t>());
+  std::mt19937 rng(static_cast<unsigned int>(size));
+  // few distinct values for ties
+  std::uniform_int_distribution<int> uniform(-50, 50);
+  std::vector<float> input(size);
+  for (auto &value : input) {
+    value = static_cast<float>(uniform(rng));
+  }
+  net.AddInputFromArray<RuntimeType::RT_CPU, float>("Input", shape, input);
+  net.AddInputFromArray<RuntimeType::RT_CPU, int32_t>("axis", {}, {axis});
+  OpDefBuilder("ArgMax", "ArgMaxTest")
+      .Input("Input")
+      .Input("axis")
+      .Output("Output")
+      .AddIntArg("keepdims", 0)
+      .AddIntArg("argmin", argmin)
+      .OutputType({DT_INT32})
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(RuntimeType::RT_CPU);
+
+  const index_t axis_size = shape[axis];
+  const index_t inner_size = size / std::accumulate(
+      shape.begin(), shape.begin() + axis + 1, static_cast<index_t>(1),
+      std::multiplies<index_t>());
+  const index_t outer_size = size / axis_size / inner_size;
+  std::vector<index_t> output_shape(shape);
+  output_shape.erase(output_shape.begin() + axis);
+  std::vector<int32_t> output(outer_size * inner_size);
+  for (index_t o = 0; o < outer_size; ++o) {
+    for (index_t i = 0; i < inner_size; ++i) {
+      std::vector<std::pair<float, int>> pairs(axis_size);
+      for (index_t d = 0; d < axis_size; ++d) {
+        pairs[d] = std::make_pair(
+            input[(o * axis_size + d) * inner_size + i],
+            static_cast<int>(d));
+      }
+      output[o * inner_size + i] = argmin
+          ? std::min_element(pairs.begin(), pairs.end())->second
+          : std::max_element(pairs.begin(), pairs.end())->second;
+    }
+  }
+  auto expected = net.CreateTensor<int32_t>(output_shape, output);
+  ExpectTensorNear<int32_t>(*expected, *net.GetOutput("Output"), 0);
+}
 }  // namespace
 
 TEST_F(ArgMaxOpTest, Vector) {
@@ -67,6 +126,15 @@ TEST_F(ArgMaxOpTest, HighRank) {
       {1, 2, 2}, {2, 2, 2, 2});
 }
 
+TEST_F(ArgMaxOpTest, Random) {
+  for (const bool argmin : {false, true}) {
+    RandomTest({7}, 0, argmin);
+    RandomTest({3, 50001}, 1, argmin);
+    RandomTest({4, 33, 5}, 1, argmin);
+    RandomTest({2, 3, 4, 17}, 2, argmin);
+  }
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
@@ -15,8 +15,10 @@
 
 #include <gtest/gtest.h>
 
+#include "mace/core/memory/memory_manager.h"
 #include "mace/core/ops/op_context.h"
 #include "mace/core/tensor.h"
+#include "mace/ops/delegator/batched_gemm.h"
 #include "mace/ops/delegator/gemm.h"
 #include "mace/ops/ops_test_util.h"
 #include "mace/ops/testing/test_utils.h"
@@ -33,7 +35,9 @@ void TestGemmFloat32(const index_t batch,
                      const MatrixMajor rhs_major,
                      const MatrixMajor output_major,
                      const bool lhs_batched,
-                     const bool rhs_batched) {
+                     const bool rhs_batched,
+                     const double rel_err = 1e-5,
+                     const double abs_err = 1e-8) {
   auto *cpu_runtime = OpTestContext::Get()->GetRuntime(RuntimeType::RT_CPU);
   Tensor lhs(cpu_runtime, DataType::DT_FLOAT);
   Tensor rhs(cpu_runtime, DataType::DT_FLOAT);
@@ -92,7 +96,7 @@ void TestGemmFloat32(const index_t batch,
                     rhs_batched,
                     &expected_output);
 
-  ExpectTensorNear<float>(expected_output, output);
+  ExpectTensorNear<float>(expected_output, output, rel_err, abs_err);
 }
 
 TEST(ArmGemm, TestGemmFloat32) {
@@ -118,6 +122,88 @@ TEST(ArmGemm, TestGemmFloat32) {
   TestGemmFloat32(3, 47, 69, 37, RowMajor, RowMajor, RowMajor, false, true);
 
   TestGemmFloat32(16, 31, 61, 67, RowMajor, ColMajor, RowMajor, true, true);
+
+  // tall-skinny, split along depth with enough threads
+  TestGemmFloat32(1, 4, 9, 4099, RowMajor, RowMajor, RowMajor, true, true,
+                  1e-4, 1e-2);
+  TestGemmFloat32(1, 4, 9, 4099, ColMajor, ColMajor, ColMajor, true, true,
+                  1e-4, 1e-2);
+  TestGemmFloat32(2, 8, 16, 2050, RowMajor, ColMajor, RowMajor, true, false,
+                  1e-4, 1e-2);
+}
+
+// The memory budget refuses the packing buffers, the kernels multiply the
+// operands in place instead of failing.
+void TestGemmFloat32OverBudget(const index_t batch,
+                               const index_t rows,
+                               const index_t cols,
+                               const index_t depth,
+                               const MatrixMajor lhs_major,
+                               const MatrixMajor rhs_major,
+                               const MatrixMajor output_major) {
+  auto *cpu_runtime = OpTestContext::Get()->GetRuntime(RuntimeType::RT_CPU);
+  Tensor lhs(cpu_runtime, DataType::DT_FLOAT);
+  Tensor rhs(cpu_runtime, DataType::DT_FLOAT);
+  Tensor output(cpu_runtime, DataType::DT_FLOAT);
+  Tensor batched_output(cpu_runtime, DataType::DT_FLOAT);
+  Tensor expected_output(cpu_runtime, DataType::DT_FLOAT);
+  lhs.Resize({batch, rows, depth});
+  rhs.Resize({batch, depth, cols});
+  output.Resize({batch, rows, cols});
+  batched_output.Resize({batch, rows, cols});
+  expected_output.Resize({batch, rows, cols});
+  GenerateRandomRealTypeData<float>(lhs.shape(), lhs.mutable_data<float>());
+  GenerateRandomRealTypeData<float>(rhs.shape(), rhs.mutable_data<float>());
+
+  OpsTestNet net;
+  OpContext context(net.ws(), cpu_runtime);
+  std::unique_ptr<delegator::Gemm> gemm_ref = delegator::Gemm::Create(
+      context.workspace(),
+      MACE_DELEGATOR_KEY(Gemm, RuntimeType::RT_CPU, float, ImplType::REF),
+      delegator::GemmParam());
+  EXPECT_EQ(gemm_ref->Compute(&context, &lhs, &rhs, batch, rows, cols, depth,
+                              lhs_major, rhs_major, output_major, true, true,
+                              &expected_output),
+            MaceStatus::MACE_SUCCESS);
+
+  std::unique_ptr<delegator::Gemm> gemm = delegator::Gemm::Create(
+      context.workspace(),
+      MACE_DELEGATOR_KEY(Gemm, RuntimeType::RT_CPU, float, ImplType::NEON),
+      delegator::GemmParam());
+  std::unique_ptr<delegator::BatchedGemm> batched_gemm =
+      delegator::BatchedGemm::Create(
+          context.workspace(),
+          MACE_DELEGATOR_KEY(BatchedGemm, RuntimeType::RT_CPU, float,
+                             ImplType::NEON),
+          DelegatorParam());
+
+  // a budget holding no more than the tensors refuses every scratch buffer
+  cpu_runtime->ReleaseAllBuffer(RENT_SCRATCH, true);
+  index_t held_bytes = 0;
+  for (auto *memory_manager : cpu_runtime->GetMemoryManagers()) {
+    held_bytes += memory_manager->GetMemoryCounter().current;
+  }
+  cpu_runtime->SetMemoryBudget(std::make_shared<MemoryBudget>(held_bytes));
+  EXPECT_EQ(gemm->Compute(&context, &lhs, &rhs, batch, rows, cols, depth,
+                          lhs_major, rhs_major, output_major, true, true,
+                          &output),
+            MaceStatus::MACE_SUCCESS);
+  EXPECT_EQ(batched_gemm->Compute(&context, &lhs, &rhs, batch, rows, cols,
+                                  depth, lhs_major, rhs_major, output_major,
+                                  rows * depth, depth * cols,
+                                  &batched_output),
+            MaceStatus::MACE_SUCCESS);
+  cpu_runtime->SetMemoryBudget(nullptr);
+
+  ExpectTensorNear<float>(expected_output, output, 1e-4, 1e-3);
+  ExpectTensorNear<float>(expected_output, batched_output, 1e-4, 1e-3);
+}
+
+TEST(ArmGemm, TestGemmFloat32OverBudget) {
+  TestGemmFloat32OverBudget(1, 47, 69, 37, RowMajor, RowMajor, RowMajor);
+  TestGemmFloat32OverBudget(3, 47, 69, 37, ColMajor, RowMajor, ColMajor);
+  // tall-skinny, which would split the depth
+  TestGemmFloat32OverBudget(1, 4, 9, 4099, RowMajor, ColMajor, RowMajor);
 }
 
 }  // namespace test
@@ -0,0 +1,120 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "mace/ops/delegator/batched_gemm.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+class BatchedGemmTest : public OpsTestBase {};
+
+namespace {
+// A stride larger than the matrix size picks matrices apart in the batch,
+// a stride of 0 broadcasts the first one.
+void TestBatchedGemm(const index_t batch,
+                     const index_t rows,
+                     const index_t cols,
+                     const index_t depth,
+                     const MatrixMajor lhs_major,
+                     const MatrixMajor rhs_major,
+                     const MatrixMajor output_major,
+                     const index_t lhs_batch_stride,
+                     const index_t rhs_batch_stride) {
+  OpsTestNet net;
+  const index_t lhs_size =
+      std::max(lhs_batch_stride * (batch - 1), static_cast<index_t>(0)) +
+          rows * depth;
+  const index_t rhs_size =
+      std::max(rhs_batch_stride * (batch - 1), static_cast<index_t>(0)) +
+          depth * cols;
+  net.AddRandomInput<RuntimeType::RT_CPU, float>("Lhs", {lhs_size});
+  net.AddRandomInput<RuntimeType::RT_CPU, float>("Rhs", {rhs_size});
+  const Tensor *lhs = net.GetTensor("Lhs");
+  const Tensor *rhs = net.GetTensor("Rhs");
+
+  auto *cpu_runtime = OpTestContext::Get()->GetRuntime(RuntimeType::RT_CPU);
+  OpContext context(net.ws(), cpu_runtime);
+  Tensor output(cpu_runtime, DataType::DT_FLOAT);
+  output.Resize({batch, rows, cols});
+  std::unique_ptr<delegator::BatchedGemm> batched_gemm =
+      delegator::BatchedGemm::Create(
+          context.workspace(),
+          MACE_DELEGATOR_KEY(BatchedGemm, RuntimeType::RT_CPU, float,
+                             kCpuImplType),
+          DelegatorParam());
+  batched_gemm->Compute(&context, lhs, rhs, batch, rows, cols, depth,
+                        lhs_major, rhs_major, output_major,
+                        lhs_batch_stride, rhs_batch_stride, &output);
+
+  std::vector<float> expected(batch * rows * cols);
+  const float *lhs_data = lhs->data<float>();
+  const float *rhs_data = rhs->data<float>();
+  for (index_t b = 0; b < batch; ++b) {
+    MatrixMap<const float> lhs_matrix(lhs_data + b * lhs_batch_stride,
+                                      lhs_major, rows, depth);
+    MatrixMap<const float> rhs_matrix(rhs_data + b * rhs_batch_stride,
+                                      rhs_major, depth, cols);
+    MatrixMap<float> output_matrix(expected.data() + b * rows * cols,
+                                   output_major, rows, cols);
+    for (index_t r = 0; r < rows; ++r) {
+      for (index_t c = 0; c < cols; ++c) {
+        float sum = 0;
+        for (index_t d = 0; d < depth; ++d) {
+          sum += lhs_matrix(r, d) * rhs_matrix(d, c);
+        }
+        *output_matrix.data(r, c) = sum;
+      }
+    }
+  }
+  auto expected_output =
+      net.CreateTensor<float>({batch, rows, cols}, expected);
+  ExpectTensorNear<float>(*expected_output, output, 1e-5, 1e-4);
+}
+}  // namespace
+
+TEST_F(BatchedGemmTest, Dense) {
+  TestBatchedGemm(1, 3, 5, 7, RowMajor, RowMajor, RowMajor, 21, 35);
+  TestBatchedGemm(16, 64, 64, 64, RowMajor, RowMajor, RowMajor,
+                  64 * 64, 64 * 64);
+  TestBatchedGemm(5, 17, 33, 9, ColMajor, RowMajor, RowMajor,
+                  17 * 9, 9 * 33);
+  TestBatchedGemm(5, 17, 33, 9, RowMajor, ColMajor, ColMajor,
+                  17 * 9, 9 * 33);
+  TestBatchedGemm(3, 47, 69, 37, ColMajor, ColMajor, RowMajor,
+                  47 * 37, 37 * 69);
+}
+
+TEST_F(BatchedGemmTest, Broadcast) {
+  TestBatchedGemm(8, 31, 10, 13, RowMajor, RowMajor, RowMajor, 0, 13 * 10);
+  TestBatchedGemm(8, 31, 10, 13, RowMajor, ColMajor, RowMajor, 31 * 13, 0);
+  TestBatchedGemm(4, 9, 9, 9, ColMajor, RowMajor, RowMajor, 0, 0);
+}
+
+TEST_F(BatchedGemmTest, Strided) {
+  // every other matrix
+  TestBatchedGemm(6, 12, 20, 16, RowMajor, RowMajor, RowMajor,
+                  2 * 12 * 16, 2 * 16 * 20);
+  TestBatchedGemm(6, 12, 20, 16, RowMajor, ColMajor, RowMajor,
+                  12 * 16 + 5, 0);
+}
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
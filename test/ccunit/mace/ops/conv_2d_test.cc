@@ -12,10 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <memory>
 #include <vector>
 
 #include "mace/ops/common/conv_pool_2d_util.h"
+#include "mace/ops/delegator/conv_2d.h"
 #include "mace/ops/ops_test_util.h"
 
 namespace mace {
@@ -506,6 +510,89 @@ TEST_F(Conv2dOpTest, FusedOPENCLSimpleWinograd) {
   TestFusedNHWCSimple3x3WithoutBias<RuntimeType::RT_OPENCL, float>(4);
 }
 
+namespace {
+// Bounds the largest error of the Winograd conv storing T, relative to the
+// largest output of the direct conv in float.
+template <typename T>
+void TestWinogradAccuracy(const std::vector<index_t> &input_shape,
+                          const index_t out_channels,
+                          const Padding padding,
+                          const float max_error) {
+  OpsTestNet net;
+  net.AddRandomInput<RuntimeType::RT_CPU, float>("Input", input_shape, false,
+                                                 false);
+  net.AddRandomInput<RuntimeType::RT_CPU, float>(
+      "Filter", {out_channels, input_shape[1], 3, 3}, true, false);
+  const Tensor *input = net.GetTensor("Input");
+  const Tensor *filter = net.GetTensor("Filter");
+
+  auto *cpu_runtime = OpTestContext::Get()->GetRuntime(RuntimeType::RT_CPU);
+  OpContext context(net.ws(), cpu_runtime);
+  const std::vector<int> strides = {1, 1};
+  const std::vector<int> dilations = {1, 1};
+  const std::vector<int> paddings;
+  delegator::Conv2dParam param(strides, dilations, paddings, padding);
+
+  std::unique_ptr<delegator::Conv2d> direct = delegator::Conv2d::Create(
+      context.workspace(),
+      MACE_DELEGATOR_KEY(Conv2d, RuntimeType::RT_CPU, float, ImplType::REF),
+      param);
+  Tensor expected(cpu_runtime, DataType::DT_FLOAT);
+  direct->Compute(&context, input, filter, &expected);
+
+  Tensor input_t(cpu_runtime, DataTypeToEnum<T>::v());
+  input_t.Resize(input->shape());
+  Tensor filter_t(cpu_runtime, DataTypeToEnum<T>::v(), filter->shape(), true);
+  filter_t.Resize(filter->shape());
+  std::transform(input->data<float>(), input->data<float>() + input->size(),
+                 input_t.mutable_data<T>(),
+                 [](float value) { return static_cast<T>(value); });
+  std::transform(filter->data<float>(),
+                 filter->data<float>() + filter->size(),
+                 filter_t.mutable_data<T>(),
+                 [](float value) { return static_cast<T>(value); });
+
+  std::unique_ptr<delegator::Conv2d> winograd = delegator::Conv2d::Create(
+      context.workspace(),
+      MACE_DELEGATOR_KEY_EX(Conv2d, RuntimeType::RT_CPU, T, ImplType::REF,
+                            K3x3Winograd),
+      param);
+  Tensor output(cpu_runtime, DataTypeToEnum<T>::v());
+  // twice, the second time with the cached filter transform
+  for (int i = 0; i < 2; ++i) {
+    winograd->Compute(&context, &input_t, &filter_t, &output);
+    ASSERT_EQ(expected.shape(), output.shape());
+    float max_expected = 0;
+    float max_diff = 0;
+    for (index_t j = 0; j < expected.size(); ++j) {
+      const float expected_value = expected.data<float>()[j];
+      max_expected = std::max(max_expected, std::abs(expected_value));
+      max_diff = std::max(max_diff, std::abs(
+          expected_value - static_cast<float>(output.data<T>()[j])));
+    }
+    EXPECT_LE(max_diff, max_error * max_expected)
+        << MakeString(input_shape) << " x " << out_channels;
+  }
+}
+}  // namespace
+
+TEST_F(Conv2dOpTest, CPUWinogradAccuracy) {
+  // the output sizes pick the 2x2, 4x4 and 6x6 output tiles
+  for (Padding padding : {VALID, SAME, FULL}) {
+    TestWinogradAccuracy<float>({1, 8, 7, 9}, 8, padding, 1e-5);
+    TestWinogradAccuracy<float>({2, 9, 13, 11}, 16, padding, 1e-5);
+    TestWinogradAccuracy<float>({1, 16, 33, 29}, 9, padding, 1e-4);
+  }
+#ifdef MACE_ENABLE_BFLOAT16
+  TestWinogradAccuracy<BFloat16>({1, 16, 7, 9}, 8, SAME, 3e-2);
+  TestWinogradAccuracy<BFloat16>({1, 16, 33, 29}, 8, SAME, 3e-2);
+#endif  // MACE_ENABLE_BFLOAT16
+#ifdef MACE_ENABLE_FP16
+  TestWinogradAccuracy<float16_t>({1, 16, 7, 9}, 8, SAME, 1e-2);
+  TestWinogradAccuracy<float16_t>({1, 16, 33, 29}, 8, SAME, 1e-2);
+#endif  // MACE_ENABLE_FP16
+}
+
 namespace {
 template <RuntimeType D>
 void TestConv1x1() {
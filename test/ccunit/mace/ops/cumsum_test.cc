@@ -56,6 +56,38 @@ void SimpleTestWithDataFormat(const std::vector<index_t> &shape,
   ExpectTensorNear<T>(*net.GetOutput("ExpectedOutput"),
                       *net.GetOutput("Output"));
 }
+
+void LongRowTest(const index_t batch, const index_t length,
+                 const int exclusive, const int reverse) {
+  OpsTestNet net;
+  net.AddRandomInput<RuntimeType::RT_CPU, float>("Input", {batch, length});
+
+  OpDefBuilder("Cumsum", "CumsumTest")
+    .Input("Input")
+    .Output("Output")
+    .AddIntArg("axis", -1)
+    .AddIntArg("exclusive", exclusive)
+    .AddIntArg("reverse", reverse)
+    .AddIntArg("T", static_cast<int>(DataTypeToEnum<float>::value))
+    .Finalize(net.NewOperatorDef());
+  net.RunOp(RuntimeType::RT_CPU);
+
+  auto input = net.GetTensor("Input");
+  std::vector<float> expected(input->size());
+  const float *input_data = input->data<float>();
+  for (index_t b = 0; b < batch; ++b) {
+    double sum = 0;
+    for (index_t k = 0; k < length; ++k) {
+      const index_t i = b * length + (reverse ? length - 1 - k : k);
+      expected[i] = static_cast<float>(exclusive ? sum : sum + input_data[i]);
+      sum += input_data[i];
+    }
+  }
+  net.AddInputFromArray<RuntimeType::RT_CPU, float>(
+      "ExpectedOutput", {batch, length}, expected);
+  ExpectTensorNear<float>(*net.GetOutput("ExpectedOutput"),
+                          *net.GetOutput("Output"), 1e-3, 1e-3);
+}
 }  // namespace
 
 TEST_F(CumsumOpTest, HasDataFormatCPU) {
@@ -87,6 +119,13 @@ TEST_F(CumsumOpTest, HasDataFormatCPU) {
       {4., 5., 6., 7., 0., 0., 0., 0., 12., 13., 14., 15., 0., 0., 0., 0.});
 }
 
+TEST_F(CumsumOpTest, LongRowCPU) {
+  LongRowTest(2, 50000, 0, 0);
+  LongRowTest(2, 50000, 1, 0);
+  LongRowTest(2, 50000, 0, 1);
+  LongRowTest(2, 50000, 1, 1);
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
@@ -218,6 +218,15 @@ TEST_F(DepthwiseConv2dOpTest, ComplexCPU3x3s2) {
   ComplexValidTest<RuntimeType::RT_CPU, float>(1, 3, 10, 10, 3, 1, 2);
 }
 
+TEST_F(DepthwiseConv2dOpTest, ComplexCPUWide) {
+  for (int kernel : {3, 5}) {
+    for (int stride : {1, 2}) {
+      ComplexValidTest<RuntimeType::RT_CPU, float>(1, 3, 11, 71, kernel, 1,
+                                                   stride);
+    }
+  }
+}
+
 TEST_F(DepthwiseConv2dOpTest, ComplexOpenCL) {
   ComplexValidTest<RuntimeType::RT_OPENCL, float>(1, 3, 10, 10, 5, 1, 2);
 }
@@ -13,7 +13,9 @@
 // limitations under the License.
 
 #include <fstream>
+#include <vector>
 
+#include "mace/ops/common/reduce_type.h"
 #include "mace/ops/ops_test_util.h"
 
 namespace mace {
@@ -89,6 +91,80 @@ TEST_F(GatherOpTest, CPURankHighIndex) {
              {1, 3}, {2, 4, 6}, 0, {1, 3, 2}, {4, 5, 8, 9, 12, 13});
 }
 
+TEST_F(GatherOpTest, CPUEmbeddingBag) {
+  OpsTestNet net;
+  net.AddInputFromArray<RuntimeType::RT_CPU, float>(
+      "Params", {5, 2}, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}, true);
+  net.AddInputFromArray<RuntimeType::RT_CPU, int32_t>(
+      "Indices", {2, 3}, {0, 2, 4, 1, 1, 3});
+  for (auto combiner : {ReduceType::SUM, ReduceType::MEAN}) {
+    OpDefBuilder("Gather", "GatherTest")
+        .Input("Params")
+        .Input("Indices")
+        .AddIntArg("axis", 0)
+        .AddIntArg("combiner", combiner)
+        .Output("Output")
+        .Finalize(net.NewOperatorDef());
+    net.RunOp(RuntimeType::RT_CPU);
+
+    const float scale = combiner == ReduceType::MEAN ? 1.f / 3 : 1.f;
+    auto expected = net.CreateTensor<float>(
+        {2, 2}, {12 * scale, 15 * scale, 10 * scale, 13 * scale});
+    ExpectTensorNear<float>(*expected, *net.GetOutput("Output"), 1e-5);
+  }
+}
+
+TEST_F(GatherOpTest, CPUCompressedTable) {
+  const index_t vocab = 300;
+  const index_t embedding = 33;
+  std::vector<float> table(vocab * embedding);
+  std::vector<half> half_table(table.size());
+  std::vector<uint8_t> uint8_table(table.size());
+  const float scale = 0.05f;
+  const int32_t zero_point = 128;
+  for (size_t i = 0; i < table.size(); ++i) {
+    uint8_table[i] = static_cast<uint8_t>(i * 7 % 256);
+    table[i] = scale * (uint8_table[i] - zero_point);
+    half_table[i] = half_float::half_cast<half>(table[i]);
+  }
+  std::vector<int32_t> indices(64);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    indices[i] = static_cast<int32_t>(i * 37 % vocab);
+  }
+  std::vector<float> expected_data;
+  for (auto idx : indices) {
+    expected_data.insert(expected_data.end(),
+                         table.begin() + idx * embedding,
+                         table.begin() + (idx + 1) * embedding);
+  }
+
+  for (auto table_type : {DT_HALF, DT_UINT8}) {
+    OpsTestNet net;
+    if (table_type == DT_HALF) {
+      net.AddInputFromArray<RuntimeType::RT_CPU, half>(
+          "Params", {vocab, embedding}, half_table, true);
+    } else {
+      net.AddInputFromArray<RuntimeType::RT_CPU, uint8_t>(
+          "Params", {vocab, embedding}, uint8_table, true, scale,
+          zero_point);
+    }
+    net.AddInputFromArray<RuntimeType::RT_CPU, int32_t>(
+        "Indices", {4, 16}, indices);
+    OpDefBuilder("Gather", "GatherTest")
+        .Input("Params")
+        .Input("Indices")
+        .AddIntArg("T", DT_FLOAT)
+        .AddIntArg("axis", 0)
+        .Output("Output")
+        .Finalize(net.NewOperatorDef());
+    net.RunOp(RuntimeType::RT_CPU);
+
+    auto expected = net.CreateTensor<float>({4, 16, embedding},
+                                            expected_data);
+    ExpectTensorNear<float>(*expected, *net.GetOutput("Output"), 1e-3);
+  }
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
@@ -0,0 +1,137 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <vector>
+
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+class LayerNormOpTest : public OpsTestBase {};
+
+namespace {
+void TestLayerNorm(const std::vector<index_t> &shape, const int axis,
+                   const bool with_gamma, const bool with_beta) {
+  OpsTestNet net;
+  net.AddRandomInput<RuntimeType::RT_CPU, float>("Input", shape);
+  const int rank = static_cast<int>(shape.size());
+  const int norm_axis = axis < 0 ? axis + rank : axis;
+  index_t inner = 1;
+  for (int i = norm_axis; i < rank; ++i) {
+    inner *= shape[i];
+  }
+  if (with_gamma) {
+    net.AddRandomInput<RuntimeType::RT_CPU, float>("Gamma", {inner}, true);
+  }
+  if (with_beta) {
+    net.AddRandomInput<RuntimeType::RT_CPU, float>("Beta", {inner}, true);
+  }
+
+  auto builder = OpDefBuilder("LayerNorm", "LayerNormTest").Input("Input");
+  // beta is the third input, so it always comes with gamma
+  if (with_gamma) {
+    builder = builder.Input("Gamma");
+  }
+  if (with_beta) {
+    builder = builder.Input("Beta");
+  }
+  builder.Output("Output")
+      .AddIntArg("axis", axis)
+      .AddFloatArg("epsilon", 1e-5f)
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(RuntimeType::RT_CPU);
+
+  // two-pass reference in double precision
+  const Tensor *input = net.GetTensor("Input");
+  const float *in = input->data<float>();
+  const float *gamma =
+      with_gamma ? net.GetTensor("Gamma")->data<float>() : nullptr;
+  const float *beta =
+      with_beta ? net.GetTensor("Beta")->data<float>() : nullptr;
+  auto expected = net.CreateTensor<float>();
+  expected->Resize(shape);
+  float *out = expected->mutable_data<float>();
+  const index_t outer = input->size() / inner;
+  for (index_t i = 0; i < outer; ++i) {
+    const float *row = in + i * inner;
+    double mean = 0;
+    for (index_t j = 0; j < inner; ++j) mean += row[j];
+    mean /= inner;
+    double var = 0;
+    for (index_t j = 0; j < inner; ++j) {
+      var += (row[j] - mean) * (row[j] - mean);
+    }
+    var /= inner;
+    for (index_t j = 0; j < inner; ++j) {
+      double val = (row[j] - mean) / std::sqrt(var + 1e-5);
+      if (gamma != nullptr) val *= gamma[j];
+      if (beta != nullptr) val += beta[j];
+      out[i * inner + j] = static_cast<float>(val);
+    }
+  }
+
+  ExpectTensorNear<float>(*expected, *net.GetOutput("Output"), 1e-4, 1e-3);
+}
+}  // namespace
+
+TEST_F(LayerNormOpTest, Simple) {
+  OpsTestNet net;
+  net.AddInputFromArray<RuntimeType::RT_CPU, float>(
+      "Input", {2, 4}, {1, 2, 3, 4, -2, -2, 2, 2});
+  net.AddInputFromArray<RuntimeType::RT_CPU, float>(
+      "Gamma", {4}, {1, 2, 1, 2}, true);
+  net.AddInputFromArray<RuntimeType::RT_CPU, float>(
+      "Beta", {4}, {0, 0, 1, 1}, true);
+  OpDefBuilder("LayerNorm", "LayerNormTest")
+      .Input("Input")
+      .Input("Gamma")
+      .Input("Beta")
+      .Output("Output")
+      .AddFloatArg("epsilon", 0.f)
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(RuntimeType::RT_CPU);
+
+  const float s = 1.f / std::sqrt(1.25f);
+  auto expected = net.CreateTensor<float>(
+      {2, 4}, {-1.5f * s, -1.f * s, 1.f + 0.5f * s, 1.f + 3.f * s,
+               -1.f, -2.f, 2.f, 3.f});
+  ExpectTensorNear<float>(*expected, *net.GetOutput("Output"), 1e-5);
+}
+
+TEST_F(LayerNormOpTest, Random) {
+  TestLayerNorm({3, 7}, -1, false, false);
+  TestLayerNorm({2, 13, 768}, -1, true, true);
+  TestLayerNorm({2, 5, 6, 10}, 2, true, false);
+}
+
+TEST_F(LayerNormOpTest, NCHW) {
+  // 4D patterns are folded from NCHW models only, the axis counts the dims
+  // of the NCHW tensor: over [C, H, W] or over the last dim
+  TestLayerNorm({2, 8, 7, 9}, 1, true, true);
+  TestLayerNorm({2, 8, 7, 9}, -1, true, true);
+  TestLayerNorm({1, 3, 16, 16}, 2, false, false);
+}
+
+TEST_F(LayerNormOpTest, LongRows) {
+  // few long rows are split into chunks whose statistics are merged
+  TestLayerNorm({1, 100003}, -1, true, true);
+  TestLayerNorm({3, 4, 9000}, 1, false, false);
+}
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
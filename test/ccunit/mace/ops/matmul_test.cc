@@ -14,6 +14,7 @@
 
 #include <fstream>
 
+#include "mace/ops/common/gemm_split.h"
 #include "mace/ops/delegator/gemm.h"
 #include "mace/ops/ops_test_util.h"
 
@@ -116,6 +117,7 @@ void Complex(const std::vector<index_t> &batch,
       MACE_DELEGATOR_KEY(Gemm, RuntimeType::RT_CPU, float, ImplType::REF),
       delegator::GemmParam());
   auto cpu_runtime = OpTestContext::Get()->GetRuntime(RuntimeType::RT_CPU);
+  OpContext context(net.ws(), cpu_runtime);
   Tensor expected_output_tensor(cpu_runtime, DT_FLOAT);
   std::vector<index_t> expected_output_shape({rows, cols});
   expected_output_shape.insert(expected_output_shape.begin(),
@@ -124,7 +126,7 @@ void Complex(const std::vector<index_t> &batch,
   expected_output_tensor.Resize(expected_output_shape);
   index_t batch_count = std::accumulate(batch.begin(), batch.end(), 1,
                                         std::multiplies<index_t>());
-  gemm->Compute(nullptr,
+  gemm->Compute(&context,
                 net.GetTensor("A"),
                 net.GetTensor("B"),
                 batch_count,
@@ -152,12 +154,27 @@ TEST_F(MatMulOpTest, ComplexCPUWithBatch) {
   Complex<RuntimeType::RT_CPU>({2, 3}, 31, 61, 67, true, true, true, true);
   Complex<RuntimeType::RT_CPU>({1}, 1, 30001, 253, false, true, true, true);
   Complex<RuntimeType::RT_CPU>({2}, 253, 300, 1, false, false, true, true);
+  // tall-skinny, split along depth with enough threads
+  Complex<RuntimeType::RT_CPU>({1}, 4, 4099, 9, false, false, true, true);
+  Complex<RuntimeType::RT_CPU>({2}, 1, 2050, 3, true, true, true, false);
   // test one-side batched
   Complex<RuntimeType::RT_CPU>({2, 3}, 31, 61, 67, true, true, false, true);
   Complex<RuntimeType::RT_CPU>({2, 3}, 31, 61, 67, true, true, true, false);
   Complex<RuntimeType::RT_CPU>({2, 3}, 31, 61, 67, true, true, false, true);
 }
 
+TEST_F(MatMulOpTest, GemmDepthSliceCount) {
+  // enough tiles or a single thread
+  EXPECT_EQ(1, GemmDepthSliceCount(8, 4096, 256, 4));
+  EXPECT_EQ(1, GemmDepthSliceCount(1, 4096, 256, 1));
+  // slices fill the threads
+  EXPECT_EQ(4, GemmDepthSliceCount(1, 4096, 256, 4));
+  EXPECT_EQ(2, GemmDepthSliceCount(3, 4096, 256, 4));
+  // slices are not shorter than the minimum
+  EXPECT_EQ(2, GemmDepthSliceCount(1, 600, 256, 8));
+  EXPECT_EQ(1, GemmDepthSliceCount(1, 300, 256, 8));
+}
+
 namespace {
 void QuantOutputUint8(const std::vector<index_t> &batch,
                       const index_t rows,
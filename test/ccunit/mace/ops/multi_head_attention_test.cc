@@ -0,0 +1,229 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+class MultiHeadAttentionOpTest : public OpsTestBase {};
+
+namespace {
+// Naive softmax(scale * Q * K^T + mask) * V with a full score matrix.
+void ReferenceAttention(const float *q, const float *k, const float *v,
+                        const float *mask, const index_t batch,
+                        const index_t heads, const index_t seq_q,
+                        const index_t seq_k, const index_t head_dim,
+                        const float scale, const bool causal, float *out) {
+  std::vector<float> scores(seq_k);
+  for (index_t bh = 0; bh < batch * heads; ++bh) {
+    const float *q_head = q + bh * seq_q * head_dim;
+    const float *k_head = k + bh * seq_k * head_dim;
+    const float *v_head = v + bh * seq_k * head_dim;
+    float *out_head = out + bh * seq_q * head_dim;
+    for (index_t i = 0; i < seq_q; ++i) {
+      float max_val = std::numeric_limits<float>::lowest();
+      const index_t valid = causal ? std::min(i + 1, seq_k) : seq_k;
+      for (index_t j = 0; j < valid; ++j) {
+        float dot = 0.f;
+        for (index_t d = 0; d < head_dim; ++d) {
+          dot += q_head[i * head_dim + d] * k_head[j * head_dim + d];
+        }
+        scores[j] = dot * scale;
+        if (mask != nullptr) {
+          scores[j] += mask[(bh / heads) * seq_k + j];
+        }
+        max_val = std::max(max_val, scores[j]);
+      }
+      float sum = 0.f;
+      for (index_t j = 0; j < valid; ++j) {
+        scores[j] = std::exp(scores[j] - max_val);
+        sum += scores[j];
+      }
+      for (index_t d = 0; d < head_dim; ++d) {
+        float val = 0.f;
+        for (index_t j = 0; j < valid; ++j) {
+          val += scores[j] * v_head[j * head_dim + d];
+        }
+        out_head[i * head_dim + d] = val / sum;
+      }
+    }
+  }
+}
+
+void TestAttention(const index_t batch, const index_t heads,
+                   const index_t seq_q, const index_t seq_k,
+                   const index_t head_dim, const bool with_mask,
+                   const bool causal) {
+  OpsTestNet net;
+  net.AddRandomInput<RuntimeType::RT_CPU, float>(
+      "Query", {batch, heads, seq_q, head_dim});
+  net.AddRandomInput<RuntimeType::RT_CPU, float>(
+      "Key", {batch, heads, seq_k, head_dim});
+  net.AddRandomInput<RuntimeType::RT_CPU, float>(
+      "Value", {batch, heads, seq_k, head_dim});
+  if (with_mask) {
+    // BERT-style padding mask: [batch, 1, 1, seq_k]
+    std::vector<float> mask(batch * seq_k, 0.f);
+    for (index_t b = 0; b < batch; ++b) {
+      for (index_t j = seq_k - b; j < seq_k; ++j) {
+        mask[b * seq_k + j] = -10000.f;
+      }
+    }
+    net.AddInputFromArray<RuntimeType::RT_CPU, float>(
+        "Mask", {batch, 1, 1, seq_k}, mask);
+  }
+
+  auto builder = OpDefBuilder("MultiHeadAttention", "MultiHeadAttentionTest")
+      .Input("Query")
+      .Input("Key")
+      .Input("Value");
+  if (with_mask) {
+    builder = builder.Input("Mask");
+  }
+  builder.Output("Output")
+      .AddIntArg("causal", causal ? 1 : 0)
+      .Finalize(net.NewOperatorDef());
+
+  net.RunOp(RuntimeType::RT_CPU);
+
+  auto expected = net.CreateTensor<float>();
+  expected->Resize({batch, heads, seq_q, head_dim});
+  ReferenceAttention(
+      net.GetTensor("Query")->data<float>(),
+      net.GetTensor("Key")->data<float>(),
+      net.GetTensor("Value")->data<float>(),
+      with_mask ? net.GetTensor("Mask")->data<float>() : nullptr,
+      batch, heads, seq_q, seq_k, head_dim,
+      1.f / std::sqrt(static_cast<float>(head_dim)), causal,
+      expected->mutable_data<float>());
+
+  ExpectTensorNear<float>(*expected, *net.GetOutput("Output"), 1e-5, 1e-4);
+}
+}  // namespace
+
+TEST_F(MultiHeadAttentionOpTest, Simple) {
+  OpsTestNet net;
+  // one head, two queries, two keys, head_dim 2
+  net.AddInputFromArray<RuntimeType::RT_CPU, float>(
+      "Query", {1, 1, 2, 2}, {1, 0, 0, 1});
+  net.AddInputFromArray<RuntimeType::RT_CPU, float>(
+      "Key", {1, 1, 2, 2}, {1, 0, 0, 1});
+  net.AddInputFromArray<RuntimeType::RT_CPU, float>(
+      "Value", {1, 1, 2, 2}, {1, 2, 3, 4});
+  OpDefBuilder("MultiHeadAttention", "MultiHeadAttentionTest")
+      .Input("Query")
+      .Input("Key")
+      .Input("Value")
+      .Output("Output")
+      .AddFloatArg("scale", 1.f)
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(RuntimeType::RT_CPU);
+
+  const float e = std::exp(1.f);
+  const float p = e / (e + 1.f);
+  auto expected = net.CreateTensor<float>(
+      {1, 1, 2, 2}, {p * 1 + (1 - p) * 3, p * 2 + (1 - p) * 4,
+                     (1 - p) * 1 + p * 3, (1 - p) * 2 + p * 4});
+  ExpectTensorNear<float>(*expected, *net.GetOutput("Output"), 1e-5);
+}
+
+TEST_F(MultiHeadAttentionOpTest, Random) {
+  TestAttention(1, 2, 7, 9, 8, false, false);
+  TestAttention(2, 4, 33, 65, 16, false, false);
+  TestAttention(2, 12, 128, 128, 64, false, false);
+}
+
+TEST_F(MultiHeadAttentionOpTest, WithMask) {
+  TestAttention(3, 2, 17, 70, 8, true, false);
+  TestAttention(2, 8, 64, 130, 32, true, false);
+}
+
+TEST_F(MultiHeadAttentionOpTest, Causal) {
+  TestAttention(1, 2, 70, 70, 8, false, true);
+  TestAttention(2, 4, 129, 129, 32, true, true);
+}
+
+TEST_F(MultiHeadAttentionOpTest, FullyMaskedRow) {
+  const index_t seq_q = 3;
+  const index_t seq_k = 130;
+  const index_t head_dim = 8;
+  OpsTestNet net;
+  net.AddRandomInput<RuntimeType::RT_CPU, float>(
+      "Query", {1, 1, seq_q, head_dim});
+  net.AddRandomInput<RuntimeType::RT_CPU, float>(
+      "Key", {1, 1, seq_k, head_dim});
+  net.AddRandomInput<RuntimeType::RT_CPU, float>(
+      "Value", {1, 1, seq_k, head_dim});
+  // row 0 masks every key, row 1 the whole first key block, row 2 nothing
+  const float inf = std::numeric_limits<float>::infinity();
+  std::vector<float> mask(seq_q * seq_k, 0.f);
+  std::fill_n(mask.begin(), seq_k, -inf);
+  std::fill_n(mask.begin() + seq_k, 64, -inf);
+  net.AddInputFromArray<RuntimeType::RT_CPU, float>(
+      "Mask", {seq_q, seq_k}, mask);
+  OpDefBuilder("MultiHeadAttention", "MultiHeadAttentionTest")
+      .Input("Query")
+      .Input("Key")
+      .Input("Value")
+      .Input("Mask")
+      .Output("Output")
+      .AddFloatArg("scale", 1.f)
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(RuntimeType::RT_CPU);
+
+  // softmax over the keys left, zeros when there are none
+  const float *q = net.GetTensor("Query")->data<float>();
+  const float *k = net.GetTensor("Key")->data<float>();
+  const float *v = net.GetTensor("Value")->data<float>();
+  std::vector<float> expected_data(seq_q * head_dim, 0.f);
+  for (index_t i = 0; i < seq_q; ++i) {
+    std::vector<float> scores(seq_k, 0.f);
+    float max_val = -inf;
+    for (index_t j = 0; j < seq_k; ++j) {
+      for (index_t d = 0; d < head_dim; ++d) {
+        scores[j] += q[i * head_dim + d] * k[j * head_dim + d];
+      }
+      scores[j] += mask[i * seq_k + j];
+      max_val = std::max(max_val, scores[j]);
+    }
+    if (max_val == -inf) {
+      continue;
+    }
+    float sum = 0.f;
+    for (index_t j = 0; j < seq_k; ++j) {
+      scores[j] = std::exp(scores[j] - max_val);
+      sum += scores[j];
+    }
+    for (index_t d = 0; d < head_dim; ++d) {
+      for (index_t j = 0; j < seq_k; ++j) {
+        expected_data[i * head_dim + d] +=
+            scores[j] / sum * v[j * head_dim + d];
+      }
+    }
+  }
+  auto expected =
+      net.CreateTensor<float>({1, 1, seq_q, head_dim}, expected_data);
+  ExpectTensorNear<float>(*expected, *net.GetOutput("Output"), 1e-5, 1e-4);
+}
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
@@ -12,7 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <random>
+
 #include "mace/core/quantize.h"
+#include "mace/core/quantize_x86.h"
 #include "mace/ops/ops_test_util.h"
 
 namespace mace {
@@ -58,6 +61,122 @@ void TestQuantizeDequantize(const std::vector<float> &input, bool non_zero) {
                           0.1);
 }
 
+// Checks the vectorized kernels against the scalar formula, the sizes cover
+// the vector tails and the parallel blocks.
+void TestQuantizeUtil(const index_t size) {
+  std::mt19937 rng(size);
+  std::uniform_real_distribution<float> uniform(-3.f, 5.f);
+  std::vector<float> input(size);
+  for (auto &value : input) {
+    value = uniform(rng);
+  }
+  float min_val = 0.f;
+  float max_val = 0.f;
+  FindMinMax(input.data(), size, &min_val, &max_val);
+  EXPECT_EQ(*std::min_element(input.begin(), input.end()), min_val);
+  EXPECT_EQ(*std::max_element(input.begin(), input.end()), max_val);
+
+  utils::ThreadPool thread_pool(4, AFFINITY_NONE);
+  thread_pool.Init();
+  QuantizeUtil<float, uint8_t> quantize_util(&thread_pool);
+  std::vector<uint8_t> quantized(size);
+  float scale = 0.f;
+  int32_t zero_point = 0;
+  quantize_util.Quantize(input.data(), size, false, quantized.data(),
+                         &scale, &zero_point);
+  float expected_scale = 0.f;
+  int32_t expected_zero_point = 0;
+  AdjustRange<uint8_t>(min_val, max_val, false,
+                       &expected_scale, &expected_zero_point);
+  EXPECT_EQ(expected_scale, scale);
+  EXPECT_EQ(expected_zero_point, zero_point);
+  const float recip_scale = 1 / scale;
+  for (index_t i = 0; i < size; ++i) {
+    ASSERT_EQ(Saturate<uint8_t>(roundf(zero_point + recip_scale * input[i])),
+              quantized[i])
+        << "at " << i << " of " << size;
+  }
+
+  std::vector<float> dequantized(size);
+  quantize_util.Dequantize(quantized.data(), size, scale, zero_point,
+                           dequantized.data());
+  for (index_t i = 0; i < size; ++i) {
+    ASSERT_EQ(scale * (quantized[i] - zero_point), dequantized[i])
+        << "at " << i << " of " << size;
+  }
+}
+
+// Runs the kernels of every x86 instruction set the cpu supports directly,
+// whatever path QuantizeUtil picks, and checks them against the scalar
+// formulas bit for bit.
+void TestX86QuantizeKernels(const index_t size) {
+  std::mt19937 rng(size);
+  std::uniform_real_distribution<float> uniform(-3.f, 5.f);
+  std::vector<float> input(size);
+  for (auto &value : input) {
+    value = uniform(rng);
+  }
+  const float scale = 8.f / 255;
+  const float recip_scale = 1 / scale;
+  const int32_t zero_point = 96;
+  std::vector<int32_t> input_int32(size);
+  for (index_t i = 0; i < size; ++i) {
+    input_int32[i] = static_cast<int32_t>(input[i] * 1000);
+  }
+
+  for (int isa = quantize_x86::ISA_SSE41; isa <= quantize_x86::DetectIsa();
+       ++isa) {
+    const quantize_x86::QuantizeKernels *kernels =
+        quantize_x86::GetQuantizeKernels(static_cast<quantize_x86::Isa>(isa));
+    ASSERT_NE(kernels, nullptr);
+
+    float min_val = 0.f;
+    float max_val = 0.f;
+    kernels->find_min_max(input.data(), size, &min_val, &max_val);
+    EXPECT_EQ(*std::min_element(input.begin(), input.end()), min_val);
+    EXPECT_EQ(*std::max_element(input.begin(), input.end()), max_val);
+
+    std::vector<uint8_t> quantized(size);
+    kernels->quantize_uint8(input.data(), size, recip_scale, zero_point,
+                            quantized.data());
+    for (index_t i = 0; i < size; ++i) {
+      ASSERT_EQ(Saturate<uint8_t>(roundf(zero_point + recip_scale * input[i])),
+                quantized[i])
+          << "isa " << isa << " at " << i << " of " << size;
+    }
+
+    // values at and next to the rounding midpoints, repeated to fill whole
+    // vectors; 0.5f - 2^-25 plus 0.5f is 1.f in float
+    const float kMidpoints[] = {
+        -0.5f, 0.5f - 1.f / (1 << 25), 0.5f, 1.5f, 2.5f, 254.5f, 255.5f};
+    std::vector<float> midpoints(64);
+    for (size_t i = 0; i < midpoints.size(); ++i) {
+      midpoints[i] = kMidpoints[i % 7];
+    }
+    std::vector<uint8_t> rounded(midpoints.size());
+    kernels->quantize_uint8(midpoints.data(), midpoints.size(), 1.f, 0,
+                            rounded.data());
+    for (size_t i = 0; i < midpoints.size(); ++i) {
+      EXPECT_EQ(Saturate<uint8_t>(roundf(midpoints[i])), rounded[i])
+          << "isa " << isa << " at " << midpoints[i];
+    }
+
+    std::vector<float> dequantized(size);
+    kernels->dequantize_uint8(quantized.data(), size, scale, zero_point,
+                              dequantized.data());
+    for (index_t i = 0; i < size; ++i) {
+      ASSERT_EQ(scale * (quantized[i] - zero_point), dequantized[i])
+          << "isa " << isa << " at " << i << " of " << size;
+    }
+    kernels->dequantize_int32(input_int32.data(), size, scale, zero_point,
+                              dequantized.data());
+    for (index_t i = 0; i < size; ++i) {
+      ASSERT_EQ(scale * (input_int32[i] - zero_point), dequantized[i])
+          << "isa " << isa << " at " << i << " of " << size;
+    }
+  }
+}
+
 }  // namespace
 
 class QuantizeTest : public OpsTestBase {};
@@ -75,6 +194,18 @@ TEST_F(QuantizeTest, TestQuantize) {
   TestQuantizeDequantize({-2, -4, -6, -8}, true);
 }
 
+TEST_F(QuantizeTest, TestQuantizeUtil) {
+  for (index_t size : {1, 7, 16, 31, 33, 100, 16384, 50001}) {
+    TestQuantizeUtil(size);
+  }
+}
+
+TEST_F(QuantizeTest, TestX86QuantizeKernels) {
+  for (index_t size : {1, 7, 16, 31, 33, 100, 5003}) {
+    TestX86QuantizeKernels(size);
+  }
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
@@ -0,0 +1,157 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "mace/ops/common/scan.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+class ScanTest : public OpsTestBase {};
+
+namespace {
+
+double Combine(const ScanType type, const double a, const double b) {
+  switch (type) {
+    case SCAN_SUM: return a + b;
+    case SCAN_PROD: return a * b;
+    default: return std::max(a, b);
+  }
+}
+
+float Identity(const ScanType type) {
+  switch (type) {
+    case SCAN_SUM: return 0.f;
+    case SCAN_PROD: return 1.f;
+    default: return -std::numeric_limits<float>::infinity();
+  }
+}
+
+void TestScan(const ScanType type, const index_t outer_size,
+              const index_t scan_size, const index_t inner_size) {
+  const index_t size = outer_size * scan_size * inner_size;
+  std::mt19937 rng(static_cast<unsigned int>(size));
+  // the products stay around one
+  std::uniform_real_distribution<float> uniform(
+      type == SCAN_PROD ? 0.999f : -1.f, type == SCAN_PROD ? 1.001f : 1.f);
+  std::vector<float> input(size);
+  for (auto &value : input) {
+    value = uniform(rng);
+  }
+
+  utils::ThreadPool thread_pool(4, AFFINITY_NONE);
+  thread_pool.Init();
+  std::vector<float> output(size);
+  std::vector<float> expected(size);
+  for (const bool exclusive : {false, true}) {
+    for (const bool reverse : {false, true}) {
+      Scanner scanner(type, exclusive, reverse);
+      scanner.Compute(&thread_pool, input.data(), outer_size, scan_size,
+                      inner_size, output.data());
+
+      for (index_t i = 0; i < outer_size; ++i) {
+        for (index_t j = 0; j < inner_size; ++j) {
+          // accumulates in double
+          double carry = Identity(type);
+          for (index_t k = 0; k < scan_size; ++k) {
+            const index_t c = reverse ? scan_size - 1 - k : k;
+            const index_t idx = (i * scan_size + c) * inner_size + j;
+            const double value = Combine(type, carry, input[idx]);
+            expected[idx] = static_cast<float>(exclusive ? carry : value);
+            carry = value;
+          }
+        }
+      }
+      for (index_t i = 0; i < size; ++i) {
+        if (std::isinf(expected[i])) {
+          ASSERT_EQ(expected[i], output[i]);
+          continue;
+        }
+        ASSERT_NEAR(expected[i], output[i],
+                    1e-4 * std::max(10.f, std::abs(expected[i])))
+            << "type " << type << ", exclusive " << exclusive
+            << ", reverse " << reverse << ", shape [" << outer_size << ", "
+            << scan_size << ", " << inner_size << "] at " << i;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST_F(ScanTest, Rows) {
+  for (const ScanType type : {SCAN_SUM, SCAN_PROD, SCAN_MAX}) {
+    TestScan(type, 1, 1, 1);
+    TestScan(type, 3, 7, 1);
+    TestScan(type, 2, 64, 1);
+    TestScan(type, 3, 8193, 1);
+    TestScan(type, 2, 50001, 1);
+  }
+}
+
+TEST_F(ScanTest, Columns) {
+  for (const ScanType type : {SCAN_SUM, SCAN_PROD, SCAN_MAX}) {
+    TestScan(type, 1, 5, 3);
+    TestScan(type, 3, 17, 33);
+    TestScan(type, 2, 100, 64);
+  }
+}
+
+#ifdef MACE_ENABLE_BFLOAT16
+TEST_F(ScanTest, BFloat16LongColumns) {
+  // a bf16 sum of positive values stops growing past a few hundred if the
+  // running value is rounded to bf16 at each step
+  const index_t outer_size = 2;
+  const index_t scan_size = 4000;
+  const index_t inner_size = 5;
+  const index_t size = outer_size * scan_size * inner_size;
+  std::mt19937 rng(size);
+  std::uniform_real_distribution<float> uniform(0.5f, 1.f);
+  std::vector<BFloat16> input(size);
+  for (auto &value : input) {
+    value = uniform(rng);
+  }
+
+  utils::ThreadPool thread_pool(4, AFFINITY_NONE);
+  thread_pool.Init();
+  std::vector<BFloat16> output(size);
+  Scanner scanner(SCAN_SUM, false, false);
+  scanner.Compute(&thread_pool, input.data(), outer_size, scan_size,
+                  inner_size, output.data());
+
+  for (index_t i = 0; i < outer_size; ++i) {
+    for (index_t j = 0; j < inner_size; ++j) {
+      double expected = 0;
+      for (index_t k = 0; k < scan_size; ++k) {
+        const index_t idx = (i * scan_size + k) * inner_size + j;
+        expected += static_cast<float>(input[idx]);
+        // only the stored value is rounded to bf16
+        ASSERT_NEAR(expected, static_cast<float>(output[idx]),
+                    expected / 128) << "at " << idx;
+      }
+    }
+  }
+}
+#endif  // MACE_ENABLE_BFLOAT16
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
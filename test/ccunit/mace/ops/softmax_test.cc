@@ -102,6 +102,33 @@ TEST_F(SoftmaxOpTest, OPENCLSimple) { Simple<RuntimeType::RT_OPENCL>(); }
 TEST_F(LogSoftmaxOpTest, CPUSimple) { Simple<RuntimeType::RT_CPU>(true); }
 TEST_F(LogSoftmaxOpTest, OPENCLSimple) { Simple<RuntimeType::RT_OPENCL>(true); }
 
+TEST_F(SoftmaxOpTest, CPUScratchOverBudget) {
+  OpsTestNet net;
+  net.AddRandomInput<RuntimeType::RT_CPU, float>("Input", {1, 4, 8, 8});
+  OpDefBuilder("Softmax", "SoftmaxTest")
+      .Input("Input")
+      .Output("Output")
+      .AddIntArg("has_data_format", 1)
+      .Finalize(net.NewOperatorDef());
+  EXPECT_EQ(net.RunOp(RuntimeType::RT_CPU), MaceStatus::MACE_SUCCESS);
+  auto expected = net.CreateTensor<float>();
+  expected->Copy(*net.GetOutput("Output"));
+
+  // a budget holding no more than the tensors refuses the scratch buffer
+  auto *runtime = OpTestContext::Get()->GetRuntime(RuntimeType::RT_CPU);
+  runtime->ReleaseAllBuffer(RENT_SCRATCH, true);
+  index_t held_bytes = 0;
+  for (auto *memory_manager : runtime->GetMemoryManagers()) {
+    held_bytes += memory_manager->GetMemoryCounter().current;
+  }
+  runtime->SetMemoryBudget(std::make_shared<MemoryBudget>(held_bytes));
+  EXPECT_EQ(net.Run(), MaceStatus::MACE_OUT_OF_RESOURCES);
+
+  runtime->SetMemoryBudget(nullptr);
+  EXPECT_EQ(net.Run(), MaceStatus::MACE_SUCCESS);
+  ExpectTensorNear<float>(*expected, *net.GetOutput("Output"), 1e-5);
+}
+
 namespace {
 template <RuntimeType D>
 void Complex(const std::vector<index_t> &logits_shape,
@@ -0,0 +1,155 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+class TopKOpTest : public OpsTestBase {};
+
+namespace {
+void TopKTest(const std::vector<index_t> &input_shape,
+              const std::vector<float> &input,
+              const int k,
+              const int axis,
+              const bool largest,
+              const std::vector<index_t> &output_shape,
+              const std::vector<float> &values,
+              const std::vector<int32_t> &indices) {
+  OpsTestNet net;
+  net.AddInputFromArray<RuntimeType::RT_CPU, float>("Input", input_shape,
+                                                    input);
+  OpDefBuilder("TopK", "TopKTest")
+      .Input("Input")
+      .Output("Values")
+      .Output("Indices")
+      .AddIntArg("k", k)
+      .AddIntArg("axis", axis)
+      .AddIntArg("largest", largest)
+      .OutputType({DT_FLOAT, DT_INT32})
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(RuntimeType::RT_CPU);
+
+  auto expected_values = net.CreateTensor<float>(output_shape, values);
+  ExpectTensorNear<float>(*expected_values, *net.GetOutput("Values"), 1e-5);
+  auto expected_indices = net.CreateTensor<int32_t>(output_shape, indices);
+  ExpectTensorNear<int32_t>(*expected_indices, *net.GetOutput("Indices"),
+                            0);
+}
+
+// Checks against a stable sort of every row along the axis.
+void RandomTest(const std::vector<index_t> &shape, const int k,
+                const int axis, const bool largest) {
+  OpsTestNet net;
+  const index_t size = std::accumulate(shape.begin(), shape.end(),
+                                       static_cast<index_t>(1),
+                                       std::multiplies<index_t>());
+  std::mt19937 rng(static_cast<unsigned int>(size + k));
+  // few distinct values for ties
+  std::uniform_int_distribution<int> uniform(-500, 500);
+  std::vector<float> input(size);
+  for (auto &value : input) {
+    value = uniform(rng) * 0.25f;
+  }
+  net.AddInputFromArray<RuntimeType::RT_CPU, float>("Input", shape, input);
+  net.AddInputFromArray<RuntimeType::RT_CPU, int32_t>("K", {}, {k});
+  OpDefBuilder("TopK", "TopKTest")
+      .Input("Input")
+      .Input("K")
+      .Output("Values")
+      .Output("Indices")
+      .AddIntArg("axis", axis)
+      .AddIntArg("largest", largest)
+      .OutputType({DT_FLOAT, DT_INT32})
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(RuntimeType::RT_CPU);
+
+  const index_t outer_size = std::accumulate(shape.begin(),
+                                             shape.begin() + axis,
+                                             static_cast<index_t>(1),
+                                             std::multiplies<index_t>());
+  const index_t inner_size = std::accumulate(shape.begin() + axis + 1,
+                                             shape.end(),
+                                             static_cast<index_t>(1),
+                                             std::multiplies<index_t>());
+  const index_t axis_size = shape[axis];
+  std::vector<index_t> output_shape(shape);
+  output_shape[axis] = k;
+  std::vector<float> values(outer_size * k * inner_size);
+  std::vector<int32_t> indices(values.size());
+  std::vector<int32_t> order(axis_size);
+  for (index_t o = 0; o < outer_size; ++o) {
+    for (index_t i = 0; i < inner_size; ++i) {
+      const float *row = input.data() + o * axis_size * inner_size + i;
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(),
+                       [row, inner_size, largest](int32_t a, int32_t b) {
+                         return largest
+                             ? row[a * inner_size] > row[b * inner_size]
+                             : row[a * inner_size] < row[b * inner_size];
+                       });
+      for (int j = 0; j < k; ++j) {
+        const index_t idx = (o * k + j) * inner_size + i;
+        values[idx] = row[order[j] * inner_size];
+        indices[idx] = order[j];
+      }
+    }
+  }
+  auto expected_values = net.CreateTensor<float>(output_shape, values);
+  ExpectTensorNear<float>(*expected_values, *net.GetOutput("Values"), 1e-5);
+  auto expected_indices = net.CreateTensor<int32_t>(output_shape, indices);
+  ExpectTensorNear<int32_t>(*expected_indices, *net.GetOutput("Indices"),
+                            0);
+}
+}  // namespace
+
+TEST_F(TopKOpTest, Simple) {
+  TopKTest({2, 4}, {1, 4, 3, 2, 5, 8, 8, 6}, 2, -1, true,
+           {2, 2}, {4, 3, 8, 8}, {1, 2, 1, 2});
+  TopKTest({2, 4}, {1, 4, 3, 2, 5, 8, 8, 6}, 3, 1, false,
+           {2, 3}, {1, 2, 3, 5, 6, 8}, {0, 3, 2, 0, 3, 1});
+  TopKTest({3, 2}, {1, 4, 3, 2, 5, 0}, 2, 0, true,
+           {2, 2}, {5, 4, 3, 2}, {2, 0, 1, 1});
+}
+
+TEST_F(TopKOpTest, Random) {
+  for (const bool largest : {true, false}) {
+    RandomTest({3, 100}, 1, 1, largest);
+    RandomTest({3, 100}, 100, 1, largest);
+    RandomTest({2, 17, 5}, 4, 1, largest);
+    RandomTest({40, 3}, 7, 0, largest);
+  }
+}
+
+TEST_F(TopKOpTest, LongRow) {
+  for (const bool largest : {true, false}) {
+    RandomTest({2, 50000}, 1, 1, largest);
+    RandomTest({2, 50000}, 10, 1, largest);
+    RandomTest({1, 50000}, 300, 1, largest);
+    RandomTest({1, 20000, 2}, 5, 1, largest);
+    RandomTest({1, 10000}, 2000, 1, largest);
+  }
+}
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
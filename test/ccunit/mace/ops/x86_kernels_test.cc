@@ -0,0 +1,192 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mace/ops/common/x86_gemm.h"
+#include "mace/ops/common/x86_kernels.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+class X86KernelsTest : public ::testing::Test {};
+
+namespace {
+
+// All instruction sets the cpu supports.
+std::vector<x86::Isa> SupportedIsas() {
+  std::vector<x86::Isa> isas;
+  for (int isa = x86::ISA_AVX2; isa <= x86::DetectIsa(); ++isa) {
+    isas.push_back(static_cast<x86::Isa>(isa));
+  }
+  return isas;
+}
+
+std::vector<float> RandomVector(const index_t size) {
+  static std::mt19937 engine(0);
+  std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+  std::vector<float> data(size);
+  for (auto &value : data) {
+    value = distribution(engine);
+  }
+  return data;
+}
+
+void TestGemmKernel(const x86::Isa isa,
+                    const index_t rows,
+                    const index_t cols,
+                    const index_t depth) {
+  const x86::GemmKernel *kernel = x86::GetGemmKernel(isa, rows, cols);
+  ASSERT_NE(kernel, nullptr);
+  const index_t mr = kernel->mr;
+  const index_t nr = kernel->nr;
+  ASSERT_LE(mr * nr, x86::kMaxGemmTileSize);
+  const std::vector<float> lhs = RandomVector(mr * depth);
+  const std::vector<float> rhs = RandomVector(depth * nr);
+  std::vector<float> tile(mr * nr);
+  kernel->compute(lhs.data(), rhs.data(), depth, tile.data());
+
+  for (index_t i = 0; i < mr; ++i) {
+    for (index_t j = 0; j < nr; ++j) {
+      float expected = 0;
+      for (index_t d = 0; d < depth; ++d) {
+        expected += lhs[d * mr + i] * rhs[d * nr + j];
+      }
+      EXPECT_NEAR(expected, tile[i * nr + j], 1e-4) << i << ", " << j;
+    }
+  }
+}
+
+void TestDepthwiseConv2dRowKernel(const x86::Isa isa,
+                                  const int filter_size,
+                                  const int stride,
+                                  const index_t count) {
+  const x86::DepthwiseConv2dRowKernel kernel =
+      x86::GetDepthwiseConv2dRowKernel(isa, filter_size, filter_size, stride);
+  ASSERT_NE(kernel, nullptr);
+  // exactly wide enough, so that any read past the row goes out of bounds
+  const index_t in_width = (count - 1) * stride + filter_size;
+  const std::vector<float> input = RandomVector(filter_size * in_width);
+  const std::vector<float> filter = RandomVector(filter_size * filter_size);
+  std::vector<float> output(count);
+  kernel(input.data(), in_width, filter.data(), count, output.data());
+
+  for (index_t n = 0; n < count; ++n) {
+    float expected = 0;
+    for (int kh = 0; kh < filter_size; ++kh) {
+      for (int kw = 0; kw < filter_size; ++kw) {
+        expected += input[kh * in_width + n * stride + kw] *
+            filter[kh * filter_size + kw];
+      }
+    }
+    EXPECT_NEAR(expected, output[n], 1e-5) << n;
+  }
+}
+
+// A batch stride of 0 broadcasts the first matrix, whose panels are then
+// shared by the whole batch.
+void TestBatchedGemm(const index_t batch,
+                     const index_t rows,
+                     const index_t cols,
+                     const index_t depth,
+                     const MatrixMajor lhs_major,
+                     const MatrixMajor rhs_major,
+                     const index_t lhs_batch_stride,
+                     const index_t rhs_batch_stride) {
+  OpsTestNet net;
+  net.AddRandomInput<RuntimeType::RT_CPU, float>(
+      "Lhs", {lhs_batch_stride * (batch - 1) + rows * depth});
+  net.AddRandomInput<RuntimeType::RT_CPU, float>(
+      "Rhs", {rhs_batch_stride * (batch - 1) + depth * cols});
+  const Tensor *lhs = net.GetTensor("Lhs");
+  const Tensor *rhs = net.GetTensor("Rhs");
+
+  auto *cpu_runtime = OpTestContext::Get()->GetRuntime(RuntimeType::RT_CPU);
+  OpContext context(net.ws(), cpu_runtime);
+  Tensor output(cpu_runtime, DataType::DT_FLOAT);
+  output.Resize({batch, rows, cols});
+  ASSERT_TRUE(x86::ComputeGemm(&context, lhs, rhs, batch, rows, cols, depth,
+                               lhs_major, rhs_major, RowMajor,
+                               lhs_batch_stride, rhs_batch_stride, &output));
+
+  const float *lhs_data = lhs->data<float>();
+  const float *rhs_data = rhs->data<float>();
+  const float *output_data = output.data<float>();
+  for (index_t b = 0; b < batch; ++b) {
+    MatrixMap<const float> lhs_matrix(lhs_data + b * lhs_batch_stride,
+                                      lhs_major, rows, depth);
+    MatrixMap<const float> rhs_matrix(rhs_data + b * rhs_batch_stride,
+                                      rhs_major, depth, cols);
+    for (index_t r = 0; r < rows; ++r) {
+      for (index_t c = 0; c < cols; ++c) {
+        float expected = 0;
+        for (index_t d = 0; d < depth; ++d) {
+          expected += lhs_matrix(r, d) * rhs_matrix(d, c);
+        }
+        EXPECT_NEAR(expected, output_data[(b * rows + r) * cols + c], 1e-4)
+            << b << ", " << r << ", " << c;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST_F(X86KernelsTest, GemmKernel) {
+  for (const x86::Isa isa : SupportedIsas()) {
+    // each shape class
+    for (const index_t rows : {1, 3, 64}) {
+      for (const index_t cols : {1, 8, 16, 64}) {
+        for (const index_t depth : {1, 4, 7, 33}) {
+          TestGemmKernel(isa, rows, cols, depth);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(X86KernelsTest, BatchedGemm) {
+  if (x86::DetectIsa() == x86::ISA_NONE) {
+    return;
+  }
+  TestBatchedGemm(4, 64, 64, 64, RowMajor, RowMajor, 64 * 64, 64 * 64);
+  TestBatchedGemm(3, 17, 33, 9, ColMajor, ColMajor, 17 * 9, 9 * 33);
+  TestBatchedGemm(8, 31, 10, 13, RowMajor, RowMajor, 0, 13 * 10);
+  TestBatchedGemm(8, 5, 40, 7, RowMajor, ColMajor, 5 * 7, 0);
+  TestBatchedGemm(6, 12, 20, 16, RowMajor, RowMajor, 2 * 12 * 16, 0);
+}
+
+TEST_F(X86KernelsTest, DepthwiseConv2dRowKernel) {
+  for (const x86::Isa isa : SupportedIsas()) {
+    for (const int filter_size : {3, 5}) {
+      for (const int stride : {1, 2}) {
+        for (const index_t count : {1, 7, 8, 16, 17, 33, 40}) {
+          TestDepthwiseConv2dRowKernel(isa, filter_size, stride, count);
+        }
+      }
+    }
+    EXPECT_EQ(x86::GetDepthwiseConv2dRowKernel(isa, 3, 3, 3), nullptr);
+    EXPECT_EQ(x86::GetDepthwiseConv2dRowKernel(isa, 3, 5, 1), nullptr);
+  }
+  EXPECT_EQ(x86::GetDepthwiseConv2dRowKernel(x86::ISA_NONE, 3, 3, 1),
+            nullptr);
+}
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
@@ -0,0 +1,52 @@
+// Copyright 2021 The MACE Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+#include "mace/utils/hash.h"
+
+namespace mace {
+namespace hash {
+
+namespace {
+
+class HashTest : public ::testing::Test {
+};
+
+TEST_F(HashTest, XXHash64) {
+  // reference values of the xxHash library
+  EXPECT_EQ(0xEF46DB3751D8E999ULL, XXHash64("", 0));
+  EXPECT_EQ(0x44BC2CF5AD770999ULL, XXHash64("abc", 3));
+  EXPECT_EQ(0x9E755206156676D7ULL, XXHash64("abc", 3, 7));
+  const char *text = "Nobody inspects the spammish repetition";
+  EXPECT_EQ(0xFBCEA83C8A378BF1ULL, XXHash64(text, strlen(text)));
+  std::vector<uint8_t> data(100);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<uint8_t>(i);
+  }
+  EXPECT_EQ(0x3D19A3A2098A7023ULL, XXHash64(data.data(), data.size(), 1));
+}
+
+TEST_F(HashTest, HashCombine) {
+  EXPECT_NE(HashCombine(HashCombine(0, 1), 2),
+            HashCombine(HashCombine(0, 2), 1));
+  EXPECT_EQ(HashCombine(3, 4), HashCombine(3, 4));
+}
+
+}  // namespace
+
+}  // namespace hash
+}  // namespace mace
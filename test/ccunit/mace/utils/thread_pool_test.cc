@@ -13,7 +13,9 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <atomic>
 #include <cstdlib>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 #include "mace/utils/thread_pool.h"
 
@@ -105,6 +107,103 @@ TEST_F(ThreadPoolTest, Compute3D) {
   }
 }
 
+// Simulates a slow core: the calling thread stalls in its first chunk until
+// the other threads have done all the other items. They only start once the
+// calling thread has claimed its chunk, so the split of the work does not
+// depend on timing.
+class AsymmetricThreadPoolTest : public ::testing::Test {
+ public:
+  AsymmetricThreadPoolTest()
+      : thread_pool(4, CPUAffinityPolicy::AFFINITY_NONE,
+                    {2.4f, 2.4f, 1.8f, 1.8f}),
+        caller_id(std::this_thread::get_id()) {
+    thread_pool.Init();
+  }
+
+  // Runs `test_size` items, returns the chunks and items of the calling
+  // thread.
+  void StalledCompute1D(const int64_t test_size,
+                        std::vector<int> *actual,
+                        int *caller_chunks,
+                        int64_t *caller_items) {
+    std::atomic<bool> caller_started(false);
+    std::atomic<int64_t> done(0);
+    *caller_chunks = 0;
+    *caller_items = 0;
+    thread_pool.Compute1D([&](int64_t start, int64_t end, int64_t step) {
+      const bool is_caller = std::this_thread::get_id() == caller_id;
+      if (is_caller) {
+        caller_started = true;
+        ++*caller_chunks;
+        *caller_items += end - start;
+      } else {
+        while (!caller_started) {
+          std::this_thread::yield();
+        }
+      }
+      Test1D(start, end, step, actual);
+      done += end - start;
+      while (is_caller && done < test_size) {
+        std::this_thread::yield();
+      }
+    }, 0, test_size, 1);
+  }
+
+  ThreadPool thread_pool;
+  const std::thread::id caller_id;
+};
+
+TEST_F(AsymmetricThreadPoolTest, Stealing) {
+  ASSERT_EQ(4, thread_pool.thread_count());
+  const int64_t test_size = 200;
+  for (int run = 0; run < 10; ++run) {
+    std::vector<int> actual(test_size, 0);
+    int caller_chunks;
+    int64_t caller_items;
+    StalledCompute1D(test_size, &actual, &caller_chunks, &caller_items);
+    for (int64_t i = 0; i < test_size; ++i) {
+      ASSERT_EQ(1, actual[i]) << "run " << run << " at " << i;
+    }
+    // the rest of the range of the calling thread was stolen
+    ASSERT_EQ(1, caller_chunks) << "run " << run;
+    ASSERT_LT(0, caller_items) << "run " << run;
+    ASSERT_GE(test_size / 2, caller_items) << "run " << run;
+    if (run == 0) {
+      // the ranges start equal, the calling thread did half of its own
+      ASSERT_EQ(test_size / thread_pool.thread_count() / 2, caller_items);
+    }
+  }
+
+  float total_capacity = 0;
+  for (int i = 0; i < thread_pool.thread_count(); ++i) {
+    EXPECT_LE(0.05f, thread_pool.capacity(i));
+    total_capacity += thread_pool.capacity(i);
+  }
+  EXPECT_NEAR(4.f, total_capacity, 1e-3);
+}
+
+TEST_F(AsymmetricThreadPoolTest, Compute) {
+  const int64_t test_size = 40;
+  std::vector<int> actual(test_size * 100, 0);
+  thread_pool.Compute2D([&](int64_t start0, int64_t end0, int64_t step0,
+                            int64_t start1, int64_t end1, int64_t step1) {
+    Test2D(start0, end0, step0, start1, end1, step1, &actual);
+  }, 0, test_size, 1, 0, test_size, 3, 1, 1);
+  std::vector<int> expected(test_size * 100, 0);
+  Test2D(0, test_size, 1, 0, test_size, 3, &expected);
+  for (int64_t i = 0; i < test_size * 100; ++i) {
+    EXPECT_EQ(expected[i], actual[i]);
+  }
+
+  std::vector<int> counts(1000, 0);
+  thread_pool.Run([&](const int64_t i) {
+    ++counts[i];
+  }, 1000);
+  for (int count : counts) {
+    EXPECT_EQ(1, count);
+  }
+}
+
 }  // namespace
 }  // namespace utils
 }  // namespace mace
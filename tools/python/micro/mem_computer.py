@@ -12,7 +12,10 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+from transform.base_converter import MaceKeyword
+from transform.base_converter import MaceOp
 from utils.convert_util import data_type_to_np_dt
+from utils.net_util import NetUtil
 from utils.util import mace_check
 
 import numpy as np
@@ -25,10 +28,22 @@ class MemBlock:
         self.size = size
 
 
+# The ops which can run row by row, see Graph::RunRowChain
+RowBufferOps = [
+    MaceOp.Conv2D.name,
+    MaceOp.DepthwiseConv2d.name,
+    MaceOp.Pooling.name,
+]
+
+# Should be the same as kMaxRowChainSize in micro/framework/graph.cc
+MaxRowChainSize = 8
+
+
 class MemComputer:
-    def __init__(self, net_def, np_data_type):
+    def __init__(self, net_def, np_data_type, row_buffer=False):
         self.net_def = net_def
         self.np_data_type = np_data_type
+        self.row_buffer = row_buffer
         self.const_tensor_names = []
         for const_tensor in net_def.tensors:
             self.const_tensor_names.append(const_tensor.name)
@@ -41,21 +56,107 @@ class MemComputer:
         self.used_mem_list = []
         self.buffer_size = 0
         self.ref_counts = {}
-        for op in self.net_def.op:
+        self.consumers = {}
+        for op_idx, op in enumerate(self.net_def.op):
             for tensor_name in op.input:
                 if tensor_name in self.const_tensor_names or \
                         tensor_name in self.input_names:
                     continue
                 if tensor_name not in self.ref_counts:
                     self.ref_counts[tensor_name] = 0
+                    self.consumers[tensor_name] = []
                 self.ref_counts[tensor_name] += 1
+                self.consumers[tensor_name].append(op_idx)
+        self.output_names = []
+        for output_info in self.net_def.output_info:
+            self.output_names.append(output_info.name)
+        self.row_buffer_sizes = {}
+        self.row_chains = {}
+        if self.row_buffer:
+            self.plan_row_chains()
 
-    def get_mem_size(self, op, output_shape):
+    def can_run_rows(self, op):
+        if op.type not in RowBufferOps or len(op.output) != 1 or \
+                len(op.output_shape[0].dims) != 4:
+            return False
+        output_dims = op.output_shape[0].dims
+        # The s4 kernels compute four output positions of a row at once
+        return output_dims[0] == 1 and output_dims[2] >= 4
+
+    # the rows of the input an op reads for one output row
+    def get_window_rows(self, op):
+        if op.type == MaceOp.Pooling.name:
+            kernel_height = NetUtil.get_arg(
+                op, MaceKeyword.mace_kernel_str).ints[0]
+        else:
+            kernel_height = NetUtil.get_input_dims(op, self.net_def, 1)[1]
+        dilation = 1
+        for arg in op.arg:
+            if arg.name == MaceKeyword.mace_dilations_str:
+                dilation = arg.ints[0]
+        return (kernel_height - 1) * dilation + 1
+
+    def get_row_size(self, op, dims):
+        return dims[2] * dims[3] * self.get_data_type_bytes(op)
+
+    def is_row_producer(self, op_idx):
+        op = self.net_def.op[op_idx]
+        next_op = self.net_def.op[op_idx + 1]
+        tensor_name = op.output[0]
+        return self.can_run_rows(next_op) and \
+            tensor_name not in self.output_names and \
+            self.consumers.get(tensor_name) == [op_idx + 1] and \
+            next_op.input[0] == tensor_name and \
+            list(next_op.input).count(tensor_name) == 1
+
+    # Finds the runs of Conv2D, DepthwiseConv2d and Pooling ops which feed
+    # only the next one. Each op of a run but the last keeps the rows of
+    # its output which the next op reads instead of the whole feature map.
+    def plan_row_chains(self):
+        ops = self.net_def.op
+        i = 0
+        while i < len(ops):
+            last = i
+            while last + 1 < len(ops) and \
+                    last - i + 1 < MaxRowChainSize and \
+                    self.can_run_rows(ops[last]) and \
+                    self.is_row_producer(last):
+                last += 1
+            if last == i:
+                i += 1
+                continue
+
+            chain = ops[i:last + 1]
+            for j, op in enumerate(chain):
+                output_dims = op.output_shape[0].dims
+                input_dims = NetUtil.get_input_dims(op, self.net_def, 0)
+                if j + 1 < len(chain):
+                    rows = min(self.get_window_rows(chain[j + 1]),
+                               output_dims[1])
+                    row_size = self.get_row_size(op, output_dims)
+                    self.row_buffer_sizes[op.output[0]] = \
+                        int((rows * row_size + 3) / 4) * 4
+                else:
+                    rows = 0
+                arg = op.arg.add()
+                arg.name = 'row_buffer'
+                arg.ints.extend([rows,
+                                 self.get_row_size(op, input_dims),
+                                 self.get_row_size(op, output_dims)])
+            self.row_chains[i] = last
+            i = last + 1
+
+    def get_data_type_bytes(self, op):
         np_data_type = self.np_data_type
         if len(op.output_type) > 0:
             np_data_type = \
                 data_type_to_np_dt(op.output_type[0], self.np_data_type)
-        data_type_bytes = np.dtype(np_data_type).itemsize
+        return np.dtype(np_data_type).itemsize
+
+    def get_mem_size(self, op, output_shape):
+        if op.output[0] in self.row_buffer_sizes:
+            return self.row_buffer_sizes[op.output[0]]
+        data_type_bytes = self.get_data_type_bytes(op)
         if op.type == 'WinogradTransform' or op.type == 'GEMM':
             mace_check(len(output_shape) == 4,
                        "WinogradTransform and GEMM only support 4-dim")
@@ -133,6 +234,19 @@ class MemComputer:
     # return the tensor memory size needed by mace micro
     def compute(self):
         self.init_computer()
-        for op in self.net_def.op:
-            self.fake_execute_op(op)
+        ops = self.net_def.op
+        i = 0
+        while i < len(ops):
+            if i in self.row_chains:
+                # the ops of a chain run interleaved, so they all hold
+                # their buffers and inputs until the last one finishes
+                chain = ops[i:self.row_chains[i] + 1]
+                for op in chain:
+                    self.fake_new(op)
+                for op in chain:
+                    self.fake_delete(op)
+                i += len(chain)
+            else:
+                self.fake_execute_op(ops[i])
+                i += 1
         return self.buffer_size
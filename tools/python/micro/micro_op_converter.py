@@ -12,6 +12,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+from py_proto import mace_pb2
 from transform.base_converter import ConverterUtil
 from transform.base_converter import DataFormat
 from transform.base_converter import MaceKeyword
@@ -19,13 +20,26 @@ from transform.base_converter import MaceOp
 from utils.util import mace_check
 import numpy as np
 
+DataTypeBytes = {
+    mace_pb2.DT_FLOAT: 4,
+    mace_pb2.DT_INT32: 4,
+    mace_pb2.DT_HALF: 2,
+    mace_pb2.DT_FLOAT16: 2,
+    mace_pb2.DT_BFLOAT16: 2,
+    mace_pb2.DT_INT16: 2,
+    mace_pb2.DT_UINT8: 1,
+    mace_pb2.DT_INT8: 1,
+}
+
 
 class MicroOpConverter:
-    def __init__(self, pb_model, model_weights, data_type=np.float32):
+    def __init__(self, pb_model, model_weights, data_type=np.float32,
+                 weight_bits=8):
         self.net_def = pb_model
         self.model_weights = model_weights
         self.weight_bytes = bytearray(model_weights)
         self.data_type = data_type
+        self.weight_bits = weight_bits
         self._consts = {}
         for tensor in self.net_def.tensors:
             self._consts[tensor.name] = tensor
@@ -58,5 +72,80 @@ class MicroOpConverter:
                 filter.dims[:] = filter_data.shape
                 transposed_filter.add(op.input[1])
 
+    def pack_rows(self, data):
+        rows, cols = data.shape
+        values_per_byte = 8 // self.weight_bits
+        row_bytes = (cols * self.weight_bits + 7) // 8
+        mask = (1 << self.weight_bits) - 1
+        packed = np.zeros((rows, row_bytes), np.uint8)
+        for i in range(values_per_byte):
+            values = (data[:, i::values_per_byte] & mask) << \
+                (i * self.weight_bits)
+            packed[:, :values.shape[1]] |= values.astype(np.uint8)
+        return bytearray(packed.tobytes())
+
+    # lay the tensors out again like merge_params, as the packed ones shrink
+    def merge_packed_tensors(self, packed_tensors):
+        model_weights = bytearray()
+        for tensor in sorted(self.net_def.tensors, key=lambda t: t.offset):
+            if tensor.name in packed_tensors:
+                raw_data = packed_tensors[tensor.name]
+                tensor.data_size = len(raw_data)
+            else:
+                size = tensor.data_size * DataTypeBytes[tensor.data_type]
+                raw_data = self.model_weights[tensor.offset:
+                                              tensor.offset + size]
+            if tensor.data_type != mace_pb2.DT_UINT8 and \
+                    len(model_weights) % 4 != 0:
+                model_weights.extend(bytearray(4 - len(model_weights) % 4))
+            tensor.offset = len(model_weights)
+            model_weights.extend(raw_data)
+        return model_weights
+
+    # Requantizes the symmetric int8 weights of Conv2D and MatMul to
+    # weight_bits and packs the row of each output channel, see
+    # micro/ops/utils/packed_weights.h
+    def pack_weights(self):
+        ref_counts = {}
+        for op in self.net_def.op:
+            for tensor_name in op.input:
+                ref_counts[tensor_name] = ref_counts.get(tensor_name, 0) + 1
+
+        packed_tensors = {}
+        max_value = (1 << (self.weight_bits - 1)) - 1
+        for op in self.net_def.op:
+            if len(op.input) < 2 or op.input[1] not in self._consts:
+                continue
+            weight = self._consts[op.input[1]]
+            if weight.data_type != mace_pb2.DT_INT8 or \
+                    ref_counts[weight.name] != 1:
+                continue
+            if op.type == MaceOp.MatMul.name:
+                transpose_b = ConverterUtil.get_arg(
+                    op, MaceKeyword.mace_transpose_b_str)
+                if transpose_b is None or transpose_b.i == 0:
+                    continue
+            elif op.type != MaceOp.Conv2D.name:
+                continue
+
+            data = np.frombuffer(bytes(bytearray(self.model_weights)),
+                                 np.int8, weight.data_size, weight.offset)
+            data = data.reshape(weight.dims[0], -1).astype(np.int32)
+            max_abs = np.abs(data).max()
+            ratio = float(max_value) / max_abs if max_abs > 0 else 1.0
+            data = np.clip(np.round(data * ratio), -max_value,
+                           max_value).astype(np.int32)
+            weight.scale = weight.scale / ratio
+            packed_tensors[weight.name] = self.pack_rows(data)
+            arg = op.arg.add()
+            arg.name = 'weight_bits'
+            arg.i = self.weight_bits
+            print("pack %s weights to %s bits" % (op.type, self.weight_bits))
+
+        if len(packed_tensors) > 0:
+            self.model_weights = self.merge_packed_tensors(packed_tensors)
+
     def convert_op_params(self):
         self.convert_filters_format()
+        if self.weight_bits < 8:
+            self.pack_weights()
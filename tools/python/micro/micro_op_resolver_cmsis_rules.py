@@ -50,18 +50,6 @@ CmsisOPSResolverRules = [
         mace_pb2.DT_INT8,
         100
     ),
-    MicroOPSResolverRule(
-        'micro/ops/cmsis_nn/quantize.h',
-        'QuantizeOp',
-        MaceOp.Quantize.name, mace_pb2.DT_INT8,
-        100
-    ),
-    MicroOPSResolverRule(
-        'micro/ops/cmsis_nn/dequantize.h',
-        'DequantizeOp',
-        MaceOp.Dequantize.name, mace_pb2.DT_INT8,
-        100
-    ),
     MicroOPSResolverRule(
         'micro/ops/cmsis_nn/arm_conv_2d_int8.h',
         'ArmConv2dInt8Op',
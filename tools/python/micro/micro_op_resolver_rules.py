@@ -234,6 +234,48 @@ RefOPSResolverRules = [
         MaceOp.Reshape.name,
         mace_pb2.DT_INT8,
         1
+    ),
+    MicroOPSResolverRule(
+        'micro/ops/quantize.h', 'QuantizeOp',
+        MaceOp.Quantize.name,
+        mace_pb2.DT_INT8,
+        1
+    ),
+    MicroOPSResolverRule(
+        'micro/ops/dequantize.h', 'DequantizeOp',
+        MaceOp.Dequantize.name,
+        mace_pb2.DT_INT8,
+        1
+    ),
+    MicroOPSResolverRule(
+        'micro/ops/nhwc/conv_2d_int8.h', 'Conv2dInt8Op',
+        MaceOp.Conv2D.name,
+        mace_pb2.DT_INT8,
+        1
+    ),
+    MicroOPSResolverRule(
+        'micro/ops/nhwc/depthwise_conv_2d_int8.h', 'DepthwiseConv2dInt8Op',
+        MaceOp.DepthwiseConv2d.name,
+        mace_pb2.DT_INT8,
+        1
+    ),
+    MicroOPSResolverRule(
+        'micro/ops/nhwc/pooling_int8.h', 'PoolingInt8Op',
+        MaceOp.Pooling.name,
+        mace_pb2.DT_INT8,
+        1
+    ),
+    MicroOPSResolverRule(
+        'micro/ops/softmax_int8.h', 'SoftmaxInt8Op',
+        MaceOp.Softmax.name,
+        mace_pb2.DT_INT8,
+        1
+    ),
+    MicroOPSResolverRule(
+        'micro/ops/matmul_int8.h', 'MatMulInt8Op',
+        MaceOp.MatMul.name,
+        mace_pb2.DT_INT8,
+        1
     )
 ]
 
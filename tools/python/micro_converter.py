@@ -66,12 +66,19 @@ class MicroConverter:
         util.mkdir_p(self.model_dir)
         self.op_resolver = OpResolver(self.net_def, self.model_conf)
 
+    # Only the portable kernels can run row by row
+    def use_row_buffer(self):
+        micro_conf = self.model_conf.get("micro", {})
+        return micro_conf.get("row_buffer", False) and \
+            micro_conf.get("backend") not in ["cmsis", "xtensa"]
+
     def gen_code_from_model(self, model_name, pb_model, model_weights):
         net_def = pb_model
 
         # comput mem size and mem block offset and update the net_def,
         # should count before ProtoConverter
-        mem_computer = MemComputer(net_def, self.np_data_type)
+        mem_computer = MemComputer(net_def, self.np_data_type,
+                                   self.use_row_buffer())
         tensor_mem_size = mem_computer.compute()
 
         # gen the c++ NetDef struct
@@ -125,9 +132,24 @@ class MicroConverter:
         self.code_gen.gen_cmake_file(model_name,
                                      self.model_dir + 'CMakeLists.txt')
 
+    # Only the default int8 kernels take the packed weights
+    def get_weight_bits(self):
+        micro_conf = self.model_conf.get("micro", {})
+        weight_bits = micro_conf.get("weight_bits", 8)
+        mace_check(weight_bits in [8, 4, 2],
+                   "weight_bits should be 8, 4 or 2")
+        mace_check(weight_bits == 8 or
+                   micro_conf.get("backend") not in ["cmsis", "xtensa"],
+                   "weight_bits is unsupported by the cmsis and xtensa"
+                   " backends")
+        return weight_bits
+
     def gen_code(self):
-        MicroOpConverter(self.net_def, self.model_weights,
-                         self.np_data_type).convert_op_params()
+        op_converter = MicroOpConverter(self.net_def, self.model_weights,
+                                        self.np_data_type,
+                                        self.get_weight_bits())
+        op_converter.convert_op_params()
+        self.model_weights = op_converter.model_weights
         self.gen_code_from_model(
             self.model_name, self.net_def, self.model_weights)
         self.gen_engine_interface_code(self.model_name)
@@ -18,6 +18,7 @@ from __future__ import print_function
 
 import numpy as np
 import math
+import struct
 
 from transform.base_converter import DeviceType
 
@@ -249,3 +250,38 @@ def scale_zero_to_min_max(scale, zero_point):
     minval = -zero_point * scale
     maxval = (255. - zero_point) * scale
     return minval, maxval
+
+
+CALIBRATION_MAGIC = b'MCAL'
+
+
+def read_range_file(range_file):
+    """Returns the (tensor name, min, max) ranges of a range file, either the
+    text output of quantize_stat.py or the binary file saved by setting
+    MACE_CALIBRATION_FILE when running the model."""
+    with open(range_file, 'rb') as f:
+        content = f.read()
+    ranges = []
+    if not content.startswith(CALIBRATION_MAGIC):
+        for line in content.decode('utf-8').splitlines():
+            if not line.strip():
+                continue
+            tensor_name, minmax = line.split("@@")[:2]
+            min_val, max_val = [float(i) for i in minmax.strip().split(",")]
+            ranges.append((tensor_name, min_val, max_val))
+        return ranges
+
+    offset = len(CALIBRATION_MAGIC)
+    version, method, count = struct.unpack_from('<III', content, offset)
+    assert version == 1, "unsupported calibration file version %d" % version
+    offset += 12
+    for _ in range(count):
+        name_size, = struct.unpack_from('<I', content, offset)
+        offset += 4
+        tensor_name = content[offset:offset + name_size].decode('utf-8')
+        offset += name_size
+        # the chosen range, then the observed range
+        min_val, max_val, _, _ = struct.unpack_from('<ffff', content, offset)
+        offset += 16
+        ranges.append((tensor_name, min_val, max_val))
+    return ranges
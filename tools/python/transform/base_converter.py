@@ -131,12 +131,14 @@ MaceSupportedOps = [
     'IfDefined',
     'InferConv2dShape',
     'KaldiBatchNorm',
+    'LayerNorm',
     'LocalResponseNorm',
     'LpNorm',
     'LSTMCell',
     'LstmNonlinear',
     'DynamicLSTM',
     'MatMul',
+    'MultiHeadAttention',
     'MVNorm',
     'NonlocalReshape',
     'OneHot',
@@ -173,6 +175,7 @@ MaceSupportedOps = [
     'SumGroup',
     'TargetRMSNorm',
     'Tile',
+    'TopK',
     'Transpose',
 ]
 
@@ -285,6 +288,9 @@ class MaceKeyword(object):
     mace_argmin_str = 'argmin'
     mace_out_val_str = 'out_val'
     mace_top_k_str = 'top_k'
+    mace_k_str = 'k'
+    mace_largest_str = 'largest'
+    mace_sorted_str = 'sorted'
     mace_round_mode_str = 'round_mode'
     mace_min_size_str = 'min_size'
     mace_max_size_str = 'max_size'
@@ -309,6 +315,9 @@ class MaceKeyword(object):
     mace_apu_16bit_per_tensor = 'mace_apu_16bit_per_tensor'
     mace_apu_data_type_arg_str = 'apu_data_type'
     mace_int8 = 'int8'
+    mace_scale_str = 'scale'
+    mace_causal_str = 'causal'
+    mace_combiner_str = 'combiner'
 
 
 class TransformerRule(Enum):
@@ -363,6 +372,9 @@ class TransformerRule(Enum):
     TRANSFORM_KERAS_QUANTIZE_INFO = 49
     ADD_GENERRAL_INFO = 50
     FOLD_DIV_BN = 51
+    FOLD_MULTI_HEAD_ATTENTION = 52
+    FOLD_LAYER_NORM = 53
+    FOLD_EMBEDDING_BAG = 54
 
 
 class ConverterInterface(object):
@@ -631,6 +643,8 @@ class ConverterOption(object):
                 TransformerRule.TRANSPOSE_SHAPE_TENSOR_TO_PARAM,
                 TransformerRule.FOLD_RESHAPE,
                 TransformerRule.TRANSFORM_MATMUL_TO_FC,
+                # Before fold_batchnorm takes the gamma and beta
+                TransformerRule.FOLD_LAYER_NORM,
                 # For StoB -> conv -> BtoS -> BN pattern
                 # Insert flatten_atrous_conv before fold_xxx_and_bn
                 TransformerRule.FLATTEN_ATROUS_CONV,
@@ -644,6 +658,8 @@ class ConverterOption(object):
                 TransformerRule.FLATTEN_ATROUS_CONV,
                 TransformerRule.FOLD_ACTIVATION,
                 TransformerRule.FOLD_SQRDIFF_MEAN,
+                TransformerRule.FOLD_MULTI_HEAD_ATTENTION,
+                TransformerRule.FOLD_EMBEDDING_BAG,
                 TransformerRule.TRANSFORM_GLOBAL_CONV_TO_FC,
                 TransformerRule.RESHAPE_FC_WEIGHT,
                 TransformerRule.FOLD_FC_RESHAPE,
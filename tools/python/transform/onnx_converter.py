@@ -190,7 +190,7 @@ OnnxSupportedOps = [
     'Tanh',
     'TargetRMSNorm',
     # 'Tile',
-    # 'TopK',
+    'TopK',
     'Transpose',
     'Unsqueeze',
     'Upsample',
@@ -413,6 +413,7 @@ class OnnxConverter(base_converter.ConverterInterface):
             OnnxOpType.SumGroup.name: self.convert_sum_group,
             OnnxOpType.Tanh.name: self.convert_activation,
             OnnxOpType.TargetRMSNorm: self.convert_target_rms_norm,
+            OnnxOpType.TopK.name: self.convert_topk,
             OnnxOpType.Transpose.name: self.convert_transpose,
             OnnxOpType.Unsqueeze.name: self.convert_unsqueeze,
             OnnxOpType.Upsample.name: self.convert_upsample,
@@ -1624,6 +1625,27 @@ class OnnxConverter(base_converter.ConverterInterface):
         self.copy_node_attr(op, node, 'block_dim',
                             AttributeType.INT, default=0)
 
+    def convert_topk(self, node):
+        op = self.convert_general_op(node)
+        op.type = MaceOp.TopK.name
+        op.output_type.extend([self._option.data_type, mace_pb2.DT_INT32])
+
+        # k is an attribute before opset 10, then a tensor
+        if 'k' in node.attrs:
+            k = node.attrs['k']
+        else:
+            mace_check(len(node.inputs) > 1 and node.inputs[1] in self._consts,
+                       "TopK only supports constant k.")
+            k = self._consts[node.inputs[1]].int32_data[0]
+            del op.input[1:]
+        k_arg = op.arg.add()
+        k_arg.name = MaceKeyword.mace_k_str
+        k_arg.i = k
+
+        self.copy_node_attr(op, node, 'axis', AttributeType.INT, default=-1)
+        self.copy_node_attr(op, node, 'largest', AttributeType.INT, default=1)
+        self.copy_node_attr(op, node, 'sorted', AttributeType.INT, default=1)
+
     def convert_transpose(self, node):
         op = self.convert_general_op(node)
         op.type = MaceOp.Transpose.name
@@ -78,6 +78,10 @@ class Transformer(base_converter.ConverterInterface):
             TransformerRule.FLATTEN_ATROUS_CONV: self.flatten_atrous_conv,
             TransformerRule.FOLD_ACTIVATION: self.fold_activation,
             TransformerRule.FOLD_SQRDIFF_MEAN: self.fold_squared_diff_mean,
+            TransformerRule.FOLD_MULTI_HEAD_ATTENTION:
+                self.fold_multi_head_attention,
+            TransformerRule.FOLD_LAYER_NORM: self.fold_layer_norm,
+            TransformerRule.FOLD_EMBEDDING_BAG: self.fold_embedding_bag,
             TransformerRule.FOLD_EMBEDDING_LOOKUP: self.fold_embedding_lookup,
             TransformerRule.TRANSPOSE_FILTERS: self.transpose_filters,
             TransformerRule.TRANSPOSE_MATMUL_WEIGHT:
@@ -474,6 +478,378 @@ class Transformer(base_converter.ConverterInterface):
 
         return False
 
+    def single_consumer(self, op):
+        if len(op.output) != 1 or self.is_op_output_node(op) \
+                or self.consumer_count(op.output[0]) != 1:
+            return None
+        return self._consumers[op.output[0]][0]
+
+    def fold_multi_head_attention(self):
+        """Fold MatMul(Q, K^T) -> [Mul/Div scale] -> [Add mask] -> Softmax
+        -> MatMul(V) into one MultiHeadAttention op, CPU float only."""
+        if self._option.device != DeviceType.CPU.value \
+                or self._option.quantize or self._option.quantize_stat:
+            return False
+        net = self._model
+        for op in net.op:
+            if op.type != MaceOp.MatMul.name or len(op.input) != 2 \
+                    or len(op.output_shape) != 1 \
+                    or len(op.output_shape[0].dims) != 4 \
+                    or op.input[0] in self._consts \
+                    or op.input[1] in self._consts:
+                continue
+            transpose_a = ConverterUtil.get_arg(
+                op, MaceKeyword.mace_transpose_a_str)
+            if transpose_a is not None and transpose_a.i != 0:
+                continue
+            transpose_b = ConverterUtil.get_arg(
+                op, MaceKeyword.mace_transpose_b_str)
+            key = op.input[1]
+            key_transpose_op = None
+            if transpose_b is None or transpose_b.i == 0:
+                # K^T produced by an explicit Transpose(0, 1, 3, 2)
+                key_transpose_op = self._producer.get(key, None)
+                if key_transpose_op is None \
+                        or key_transpose_op.type != MaceOp.Transpose.name \
+                        or list(ConverterUtil.get_arg(
+                            key_transpose_op,
+                            MaceKeyword.mace_dims_str).ints) != [0, 1, 3, 2]:
+                    continue
+                key = key_transpose_op.input[0]
+
+            removed_ops = [op]
+            scale = 1.0
+            mask = None
+            consumer = self.single_consumer(op)
+            if consumer is not None and \
+                    consumer.type == MaceOp.Eltwise.name and \
+                    len(consumer.input) == 1:
+                elt_type = ConverterUtil.get_arg(
+                    consumer, MaceKeyword.mace_element_type_str).i
+                scalar = ConverterUtil.get_arg(
+                    consumer, MaceKeyword.mace_scalar_input_str)
+                scalar_index = ConverterUtil.get_arg(
+                    consumer, MaceKeyword.mace_scalar_input_index_str)
+                if scalar is None or (scalar_index is not None and
+                                      scalar_index.i != 1):
+                    continue
+                if elt_type == EltwiseType.PROD.value:
+                    scale *= scalar.f
+                elif elt_type == EltwiseType.DIV.value and scalar.f != 0:
+                    scale /= scalar.f
+                else:
+                    continue
+                removed_ops.append(consumer)
+                consumer = self.single_consumer(consumer)
+            if consumer is not None and \
+                    consumer.type == MaceOp.Eltwise.name and \
+                    len(consumer.input) == 2 and \
+                    ConverterUtil.get_arg(
+                        consumer, MaceKeyword.mace_element_type_str).i == \
+                    EltwiseType.SUM.value:
+                mask = consumer.input[1] \
+                    if consumer.input[0] == removed_ops[-1].output[0] \
+                    else consumer.input[0]
+                mask_shape = self.get_tensor_shape(mask)
+                if mask_shape is None or len(mask_shape) not in [2, 4]:
+                    continue
+                removed_ops.append(consumer)
+                consumer = self.single_consumer(consumer)
+            if consumer is None or consumer.type != MaceOp.Softmax.name:
+                continue
+            use_log = ConverterUtil.get_arg(consumer, 'use_log')
+            if use_log is not None and use_log.i != 0:
+                continue
+            # the attention softmax is over the keys, the last axis; with a
+            # data format it is over the channels instead
+            has_data_format = ConverterUtil.get_arg(
+                consumer, MaceKeyword.mace_has_data_format_str)
+            if has_data_format is not None and has_data_format.i != 0:
+                continue
+            softmax_axis = ConverterUtil.get_arg(
+                consumer, MaceKeyword.mace_axis_str)
+            if softmax_axis is not None and softmax_axis.i not in [-1, 3]:
+                continue
+            removed_ops.append(consumer)
+            matmul_v = self.single_consumer(consumer)
+            if matmul_v is None or matmul_v.type != MaceOp.MatMul.name \
+                    or len(matmul_v.input) != 2 \
+                    or matmul_v.input[0] != consumer.output[0]:
+                continue
+            transposed = False
+            for arg_name in [MaceKeyword.mace_transpose_a_str,
+                             MaceKeyword.mace_transpose_b_str]:
+                arg = ConverterUtil.get_arg(matmul_v, arg_name)
+                if arg is not None and arg.i != 0:
+                    transposed = True
+            if transposed:
+                continue
+            # MatMul broadcasts the batch dims, e.g. K and V shared by the
+            # heads, the fused kernel takes them with the dims of Q only
+            query_shape = self.get_tensor_shape(op.input[0])
+            key_shape = self.get_tensor_shape(key)
+            value_shape = self.get_tensor_shape(matmul_v.input[1])
+            if query_shape is None or key_shape is None \
+                    or value_shape is None or len(query_shape) != 4 \
+                    or len(key_shape) != 4 or len(value_shape) != 4 \
+                    or key_shape[:2] != query_shape[:2] \
+                    or value_shape[:2] != query_shape[:2] \
+                    or key_shape[3] != query_shape[3] \
+                    or value_shape[2] != key_shape[2] \
+                    or value_shape[3] != query_shape[3]:
+                continue
+
+            print("Fold multi-head attention: %s(%s)"
+                  % (matmul_v.name, matmul_v.type))
+            mha_op = matmul_v
+            value = matmul_v.input[1]
+            mha_op.type = MaceOp.MultiHeadAttention.name
+            del mha_op.input[:]
+            mha_op.input.extend([op.input[0], key, value])
+            if mask is not None:
+                mha_op.input.append(mask)
+            ConverterUtil.del_arg(mha_op, MaceKeyword.mace_transpose_a_str)
+            ConverterUtil.del_arg(mha_op, MaceKeyword.mace_transpose_b_str)
+            scale_arg = mha_op.arg.add()
+            scale_arg.name = MaceKeyword.mace_scale_str
+            scale_arg.f = scale
+            for removed_op in removed_ops:
+                net.op.remove(removed_op)
+            if key_transpose_op is not None and \
+                    self.consumer_count(key_transpose_op.output[0]) == 1 \
+                    and not self.is_op_output_node(key_transpose_op):
+                net.op.remove(key_transpose_op)
+            return True
+
+        return False
+
+    def is_eltwise(self, op, elt_type):
+        return op is not None and op.type == MaceOp.Eltwise.name and \
+            ConverterUtil.get_arg(
+                op, MaceKeyword.mace_element_type_str).i == elt_type.value
+
+    def eltwise_scalar(self, op):
+        """Scalar right operand of an Eltwise op, either as the scalar_input
+        argument or as a const tensor with one element, None otherwise."""
+        if len(op.input) == 1:
+            scalar = ConverterUtil.get_arg(
+                op, MaceKeyword.mace_scalar_input_str)
+            scalar_index = ConverterUtil.get_arg(
+                op, MaceKeyword.mace_scalar_input_index_str)
+            if scalar is None or (scalar_index is not None and
+                                  scalar_index.i != 1):
+                return None
+            return scalar.f
+        if len(op.input) == 2 and op.input[1] in self._consts:
+            tensor = self._consts[op.input[1]]
+            if tensor.data_type == mace_pb2.DT_FLOAT and \
+                    len(tensor.float_data) == 1:
+                return tensor.float_data[0]
+        return None
+
+    def trailing_mean_axis(self, op, rank):
+        """First axis of a keepdims mean Reduce over the trailing axes
+        [axis, rank), None for any other op."""
+        if op is None or op.type != MaceOp.Reduce.name or len(op.input) != 1:
+            return None
+        reduce_type = ConverterUtil.get_arg(
+            op, MaceKeyword.mace_reduce_type_str)
+        keep_dims = ConverterUtil.get_arg(op, MaceKeyword.mace_keepdims_str)
+        axis = ConverterUtil.get_arg(op, MaceKeyword.mace_axis_str)
+        if reduce_type is None or reduce_type.i != ReduceType.MEAN.value \
+                or keep_dims is None or keep_dims.i == 0 or axis is None:
+            return None
+        axes = sorted([a + rank if a < 0 else a for a in axis.ints])
+        if not axes or axes != list(range(axes[0], rank)):
+            return None
+        return axes[0]
+
+    def fold_layer_norm(self):
+        """Fold the decomposed layer normalization exported by ONNX and
+        PyTorch:
+            mean = ReduceMean(x), diff = x - mean,
+            var = ReduceMean(diff ^ 2) or ReduceMean(SquaredDiff(x, mean)),
+            y = diff / (var + eps) ^ 0.5 or diff * (var + eps) ^ -0.5,
+            [y = y * gamma], [y = y + beta]
+        into one LayerNorm op, CPU float only. The 4D tensors of an NHWC
+        model are run as NCHW on CPU while the axis counts the NHWC dims, so
+        4D patterns are only folded in NCHW models."""
+        if self._option.device != DeviceType.CPU.value \
+                or self._option.quantize or self._option.quantize_stat:
+            return False
+        net = self._model
+        src_data_format = ConverterUtil.data_format(net)
+        for op in net.op:
+            is_div = self.is_eltwise(op, EltwiseType.DIV)
+            if not (is_div or self.is_eltwise(op, EltwiseType.PROD)) \
+                    or len(op.input) != 2 or len(op.output_shape) != 1:
+                continue
+            diff_op = self._producer.get(op.input[0], None)
+            std_op = self._producer.get(op.input[1], None)
+            if not is_div and not self.is_eltwise(diff_op, EltwiseType.SUB):
+                diff_op, std_op = std_op, diff_op
+            if not self.is_eltwise(diff_op, EltwiseType.SUB) \
+                    or len(diff_op.input) != 2:
+                continue
+            rank = len(op.output_shape[0].dims)
+            if rank == 4 and src_data_format != DataFormat.NCHW:
+                continue
+            x = diff_op.input[0]
+            mean_op = self._producer.get(diff_op.input[1], None)
+            axis = self.trailing_mean_axis(mean_op, rank)
+            if axis is None or mean_op.input[0] != x:
+                continue
+
+            exponent = 0.5 if is_div else -0.5
+            if not self.is_eltwise(std_op, EltwiseType.POW) \
+                    or self.eltwise_scalar(std_op) != exponent:
+                continue
+            eps_op = self._producer.get(std_op.input[0], None)
+            if not self.is_eltwise(eps_op, EltwiseType.SUM):
+                continue
+            epsilon = self.eltwise_scalar(eps_op)
+            var_op = self._producer.get(eps_op.input[0], None)
+            if epsilon is None or \
+                    self.trailing_mean_axis(var_op, rank) != axis:
+                continue
+            sq_op = self._producer.get(var_op.input[0], None)
+            diff = diff_op.output[0]
+            if self.is_eltwise(sq_op, EltwiseType.POW):
+                matched = self.eltwise_scalar(sq_op) == 2 and \
+                    sq_op.input[0] == diff
+            elif self.is_eltwise(sq_op, EltwiseType.PROD):
+                matched = list(sq_op.input) == [diff, diff]
+            elif self.is_eltwise(sq_op, EltwiseType.SQR_DIFF):
+                matched = sorted(sq_op.input) == sorted(
+                    [x, mean_op.output[0]])
+            else:
+                matched = False
+            if not matched:
+                continue
+
+            folded_ops = [mean_op, diff_op, sq_op, var_op, eps_op, std_op, op]
+            inner_size = np.prod(op.output_shape[0].dims[axis:])
+
+            def affine_param(consumer, elt_type):
+                if not self.is_eltwise(consumer, elt_type) \
+                        or len(consumer.input) != 2 \
+                        or consumer.input[1] not in self._consts:
+                    return None
+                tensor = self._consts[consumer.input[1]]
+                if tensor.data_type != mace_pb2.DT_FLOAT \
+                        or np.prod(tensor.dims) != inner_size:
+                    return None
+                return consumer.input[1]
+
+            affine = []
+            consumer = self.single_consumer(op)
+            gamma = affine_param(consumer, EltwiseType.PROD)
+            if gamma is not None:
+                affine.append(gamma)
+                folded_ops.append(consumer)
+                consumer = self.single_consumer(consumer)
+                beta = affine_param(consumer, EltwiseType.SUM)
+                if beta is not None:
+                    affine.append(beta)
+                    folded_ops.append(consumer)
+
+            # every intermediate result must stay inside the pattern
+            internal = True
+            for folded_op in folded_ops[:-1]:
+                if self.is_op_output_node(folded_op) or any(
+                        c not in folded_ops
+                        for c in self._consumers.get(folded_op.output[0],
+                                                     [])):
+                    internal = False
+                    break
+            if not internal:
+                continue
+
+            layer_norm_op = folded_ops[-1]
+            print("Fold layer norm: %s(%s)"
+                  % (layer_norm_op.name, layer_norm_op.type))
+            layer_norm_op.type = MaceOp.LayerNorm.name
+            del layer_norm_op.input[:]
+            layer_norm_op.input.extend([x] + affine)
+            for arg_name in [MaceKeyword.mace_element_type_str,
+                             MaceKeyword.mace_scalar_input_str,
+                             MaceKeyword.mace_scalar_input_index_str,
+                             MaceKeyword.mace_coeff_str]:
+                ConverterUtil.del_arg(layer_norm_op, arg_name)
+            axis_arg = layer_norm_op.arg.add()
+            axis_arg.name = MaceKeyword.mace_axis_str
+            axis_arg.i = axis
+            epsilon_arg = layer_norm_op.arg.add()
+            epsilon_arg.name = MaceKeyword.mace_epsilon_str
+            epsilon_arg.f = epsilon
+            for folded_op in folded_ops[:-1]:
+                net.op.remove(folded_op)
+            return True
+
+        return False
+
+    def fold_embedding_bag(self):
+        """Fold Gather(axis 0) -> ReduceSum/ReduceMean over the last axis of
+        the indices into one Gather with the combiner argument, CPU float
+        only."""
+        if self._option.device != DeviceType.CPU.value \
+                or self._option.quantize or self._option.quantize_stat:
+            return False
+        net = self._model
+        for op in net.op:
+            if op.type != MaceOp.Gather.name or len(op.output_shape) != 1 \
+                    or ConverterUtil.get_arg(
+                        op, MaceKeyword.mace_combiner_str) is not None:
+                continue
+            axis = ConverterUtil.get_arg(op, MaceKeyword.mace_axis_str)
+            params_shape = self.get_tensor_shape(op.input[0])
+            if (axis is not None and axis.i != 0) or params_shape is None:
+                continue
+            indices_rank = \
+                len(op.output_shape[0].dims) - len(params_shape) + 1
+            reduce_op = self.single_consumer(op)
+            if indices_rank < 1 or reduce_op is None \
+                    or reduce_op.type != MaceOp.Reduce.name \
+                    or len(reduce_op.input) != 1:
+                continue
+            reduce_type = ConverterUtil.get_arg(
+                reduce_op, MaceKeyword.mace_reduce_type_str)
+            keep_dims = ConverterUtil.get_arg(
+                reduce_op, MaceKeyword.mace_keepdims_str)
+            reduce_axis = ConverterUtil.get_arg(
+                reduce_op, MaceKeyword.mace_axis_str)
+            if reduce_type is None or reduce_type.i not in \
+                    [ReduceType.SUM.value, ReduceType.MEAN.value] \
+                    or (keep_dims is not None and keep_dims.i != 0) \
+                    or reduce_axis is None or len(reduce_axis.ints) != 1:
+                continue
+            rank = len(op.output_shape[0].dims)
+            bag_axis = reduce_axis.ints[0]
+            if bag_axis < 0:
+                bag_axis += rank
+            if bag_axis != indices_rank - 1:
+                continue
+
+            print("Fold embedding bag: %s(%s)" % (op.name, op.type))
+            combiner = reduce_type.i
+            reduce_op.type = MaceOp.Gather.name
+            del reduce_op.input[:]
+            reduce_op.input.extend(op.input)
+            for arg_name in [MaceKeyword.mace_reduce_type_str,
+                             MaceKeyword.mace_keepdims_str,
+                             MaceKeyword.mace_axis_str]:
+                ConverterUtil.del_arg(reduce_op, arg_name)
+            axis_arg = reduce_op.arg.add()
+            axis_arg.name = MaceKeyword.mace_axis_str
+            axis_arg.i = 0
+            combiner_arg = reduce_op.arg.add()
+            combiner_arg.name = MaceKeyword.mace_combiner_str
+            combiner_arg.i = combiner
+            net.op.remove(op)
+            return True
+
+        return False
+
     def fold_embedding_lookup(self):
         net = self._model
         for op in net.op:
@@ -1903,9 +2279,13 @@ class Transformer(base_converter.ConverterInterface):
         if tensor.data_type == mace_pb2.DT_FLOAT:
             ops = self._consumers.get(tensor.name, None)
             if ops is not None and len(ops) == 1:
+                # embedding tables stay quantized at runtime, Gather
+                # dequantizes the rows it reads
                 if ops[0].type in [MaceOp.Conv2D.name,
                                    MaceOp.FullyConnected.name,
-                                   MaceOp.MatMul.name]:
+                                   MaceOp.MatMul.name] or \
+                        (ops[0].type == MaceOp.Gather.name and
+                         ops[0].input[0] == tensor.name):
                     quantized_tensor = \
                         quantize_util.quantize(tensor.float_data,
                                                self._option.device,
@@ -2039,32 +2419,29 @@ class Transformer(base_converter.ConverterInterface):
         if range_file:
             print("Add quantize tensor range")
             post_quantize_info = {}
-            with open(range_file) as f:
-                for line in f:
-                    tensor_name, minmax = line.split("@@")[:2]
-                    min_val, max_val = [float(i) for i in
-                                        minmax.strip().split(",")]
-                    if (quantize_schema ==
-                            MaceKeyword.mace_apu_16bit_per_tensor):
-                        max_val = max(abs(min_val), abs(max_val))
-                        min_val = -max_val
-                        scale = max_val / 2**15
-                        zero = 0
-                    elif quantize_schema == MaceKeyword.mace_int8:
-                        scale, zero, min_val, max_val = \
-                            quantize_util.adjust_range_int8(min_val, max_val)
-                    else:
-                        scale, zero, min_val, max_val = \
-                            quantize_util.adjust_range(min_val, max_val,
-                                                       self._option.device,
-                                                       non_zero=False)
-                    activation_info = mace_pb2.QuantizeActivationInfo()
-                    activation_info.minval = min_val
-                    activation_info.maxval = max_val
-                    activation_info.scale = scale
-                    activation_info.zero_point = zero
-                    if tensor_name not in self._quantize_activation_info:
-                        post_quantize_info[tensor_name] = activation_info
+            for tensor_name, min_val, max_val in \
+                    quantize_util.read_range_file(range_file):
+                if (quantize_schema ==
+                        MaceKeyword.mace_apu_16bit_per_tensor):
+                    max_val = max(abs(min_val), abs(max_val))
+                    min_val = -max_val
+                    scale = max_val / 2**15
+                    zero = 0
+                elif quantize_schema == MaceKeyword.mace_int8:
+                    scale, zero, min_val, max_val = \
+                        quantize_util.adjust_range_int8(min_val, max_val)
+                else:
+                    scale, zero, min_val, max_val = \
+                        quantize_util.adjust_range(min_val, max_val,
+                                                   self._option.device,
+                                                   non_zero=False)
+                activation_info = mace_pb2.QuantizeActivationInfo()
+                activation_info.minval = min_val
+                activation_info.maxval = max_val
+                activation_info.scale = scale
+                activation_info.zero_point = zero
+                if tensor_name not in self._quantize_activation_info:
+                    post_quantize_info[tensor_name] = activation_info
 
             for op in self._model.op:
                 if op.name.find(MaceKeyword.mace_output_node_name) >= 0:
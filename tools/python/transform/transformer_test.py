@@ -0,0 +1,93 @@
+# Copyright 2021 The MACE Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+from py_proto import mace_pb2
+from transform import base_converter as cvt
+from transform.base_converter import DataFormat
+from transform.base_converter import MaceKeyword
+from transform.base_converter import MaceOp
+from transform.base_converter import TransformerRule
+from transform.transformer import Transformer
+
+
+def add_node(nodes, name, shape):
+    node = cvt.NodeInfo()
+    node.name = name
+    node.shape = shape
+    node.data_format = DataFormat.NONE
+    nodes.append(node)
+
+
+def add_op(net, op_type, inputs, output, shape, args):
+    op = net.op.add()
+    op.name = output
+    op.type = op_type
+    op.input.extend(inputs)
+    op.output.append(output)
+    op.output_shape.add().dims.extend(shape)
+    for name, value in args:
+        arg = op.arg.add()
+        arg.name = name
+        arg.i = value
+
+
+def fold_attention(query_shape, key_shape, value_shape):
+    """Runs FOLD_MULTI_HEAD_ATTENTION on
+    MatMul(Q, K^T) -> Softmax -> MatMul(V), returns the op types left."""
+    option = cvt.ConverterOption()
+    option.transformer_option = [TransformerRule.FOLD_MULTI_HEAD_ATTENTION]
+    inputs = []
+    add_node(inputs, 'query', query_shape)
+    add_node(inputs, 'key', key_shape)
+    add_node(inputs, 'value', value_shape)
+    for node in inputs:
+        option.add_input_node(node)
+    scores_shape = query_shape[:3] + key_shape[2:3]
+    output_shape = query_shape[:3] + value_shape[3:]
+    outputs = []
+    add_node(outputs, 'output', output_shape)
+    option.add_output_node(outputs[0])
+
+    net = mace_pb2.NetDef()
+    add_op(net, MaceOp.MatMul.name, ['query', 'key'], 'scores',
+           scores_shape, [(MaceKeyword.mace_transpose_b_str, 1)])
+    add_op(net, MaceOp.Softmax.name, ['scores'], 'probs',
+           scores_shape, [(MaceKeyword.mace_axis_str, -1)])
+    add_op(net, MaceOp.MatMul.name, ['probs', 'value'], 'output',
+           output_shape, [])
+    net, _ = Transformer(option, net).run()
+    return [op.type for op in net.op]
+
+
+class TestFoldMultiHeadAttention(unittest.TestCase):
+
+    def test_fold(self):
+        self.assertEqual(
+            [MaceOp.MultiHeadAttention.name],
+            fold_attention([2, 4, 8, 16], [2, 4, 10, 16], [2, 4, 10, 16]))
+
+    def test_shared_key_value_heads(self):
+        # MatMul broadcasts K and V over the heads, the fused op does not
+        self.assertEqual(
+            [MaceOp.MatMul.name, MaceOp.Softmax.name, MaceOp.MatMul.name],
+            fold_attention([2, 4, 8, 16], [2, 1, 10, 16], [2, 1, 10, 16]))
+        self.assertEqual(
+            [MaceOp.MatMul.name, MaceOp.Softmax.name, MaceOp.MatMul.name],
+            fold_attention([2, 4, 8, 16], [2, 4, 10, 16], [1, 1, 10, 16]))
+
+
+if __name__ == '__main__':
+    unittest.main()